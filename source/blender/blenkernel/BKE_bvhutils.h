@@ -196,6 +196,18 @@ BVHTree *BKE_bvhtree_from_mesh_get(struct BVHTreeFromMesh *data,
                                    BVHCacheType bvh_cache_type,
                                    int tree_type);
 
+/**
+ * Build the BVH-trees of all types in the `bvh_cache_types` bit-mask of #BVHCacheType that are
+ * not cached yet, in parallel. Used to build the trees that are likely to be requested by other
+ * objects right after the mesh is evaluated, see #bvhcache_types_used.
+ *
+ * \param tree_types: The tree type to build for every #BVHCacheType, as requested from the
+ * previous cache (see #bvhcache_tree_type_get). Trees with a zero tree type are skipped.
+ */
+void BKE_bvhtree_from_mesh_prebuild(const struct Mesh *mesh,
+                                    int bvh_cache_types,
+                                    const char *tree_types);
+
 /**
  * Builds or queries a BVH-cache for the cache BVH-tree of the request type.
  */
@@ -253,6 +265,35 @@ struct BVHCache *bvhcache_init(void);
  * Frees a BVH-cache.
  */
 void bvhcache_free(struct BVHCache *bvh_cache);
+/**
+ * Bit-mask of the #BVHCacheType that were requested from the cache, not counting the trees built
+ * by #BKE_bvhtree_from_mesh_prebuild.
+ */
+int bvhcache_types_used(const struct BVHCache *bvh_cache);
+/**
+ * The tree type of the cached tree of the given type, as chosen by the code which requested it,
+ * or zero if there is no such tree.
+ */
+int bvhcache_tree_type_get(const struct BVHCache *bvh_cache, BVHCacheType type);
+
+typedef struct BVHCacheStats {
+  /** Requests of a tree that was already built. */
+  uint64_t hits;
+  /** Requests that had to build the tree. */
+  uint64_t misses;
+  /** Hits that had to wait for another thread building the same tree. */
+  uint64_t waits;
+  /** Trees built by #BKE_bvhtree_from_mesh_prebuild. */
+  uint64_t prebuilt;
+  /** Total time spent building trees, in seconds. */
+  double build_time;
+} BVHCacheStats;
+
+/**
+ * Statistics of all BVH-caches since startup or the last call to #BKE_bvhcache_stats_reset.
+ */
+void BKE_bvhcache_stats_get(BVHCacheStats *r_stats);
+void BKE_bvhcache_stats_reset(void);
 
 #ifdef __cplusplus
 }
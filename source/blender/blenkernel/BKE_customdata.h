@@ -345,6 +345,27 @@ void CustomData_interp(const struct CustomData *source,
                        const float *sub_weights,
                        int count,
                        int dest_index);
+/**
+ * Interpolate many destination items at once, like calling #CustomData_interp for each of them,
+ * but only matching the layers once, using type-specialized code for common generic attribute
+ * types and processing the items in parallel.
+ *
+ * \param src_offsets: The sources of destination item `i` are
+ * `src_indices[src_offsets[i]]` to `src_indices[src_offsets[i + 1] - 1]` (size `dest_num + 1`).
+ * \param weights: The weight of each source index, in the same layout as `src_indices`. If NULL,
+ * the sources of every item will be averaged. Items without sources are left unchanged.
+ * \param dest_indices: Indices of the destination items, or NULL to write to the first `dest_num`
+ * items in order.
+ *
+ * \note Destination items must not be used as the source of other items.
+ */
+void CustomData_interp_batch(const struct CustomData *source,
+                             struct CustomData *dest,
+                             const int *src_offsets,
+                             const int *src_indices,
+                             const float *weights,
+                             const int *dest_indices,
+                             int dest_num);
 /**
  * \note src_blocks_ofs & dst_block_ofs
  * must be pointers to the data, offset by layer->offset already.
@@ -6,9 +6,13 @@
  * \ingroup bke
  */
 
+#include <array>
 #include <atomic>
 #include <iostream>
+#include <memory>
+#include <mutex>
 
+#include "BLI_array.hh"
 #include "BLI_float4x4.hh"
 #include "BLI_function_ref.hh"
 #include "BLI_hash.hh"
@@ -878,6 +882,37 @@ class InstanceReference {
  * areas that work with all visible geometry, that is handled by the dependency graph iterator
  * (see `DEG_depsgraph_query.h`).
  */
+namespace blender::bke {
+
+/**
+ * A compact storage for instance transforms, decomposed into separate arrays for the positions,
+ * rotations and scales. Rotations are stored as quantized quaternions and the scales are not
+ * stored at all when every instance has unit scale. This uses 20 bytes per instance, or 32 with
+ * scale, instead of 64 for a full matrix. Transforms with shear can't be stored.
+ */
+struct CompactInstanceTransforms {
+  Array<float3> positions;
+  /** Unit quaternions, every component is mapped to the full range of a 16 bit integer. */
+  Array<std::array<int16_t, 4>> rotations;
+  /** Empty when all instances have unit scale. */
+  Array<float3> scales;
+
+  int64_t size() const
+  {
+    return positions.size();
+  }
+
+  float4x4 transform(int64_t index) const;
+  void to_transforms(MutableSpan<float4x4> r_transforms) const;
+
+  /**
+   * Returns null when a transform can't be represented, e.g. because it has shear.
+   */
+  static std::unique_ptr<CompactInstanceTransforms> from_transforms(Span<float4x4> transforms);
+};
+
+}  // namespace blender::bke
+
 class InstancesComponent : public GeometryComponent {
  private:
   /**
@@ -888,8 +923,10 @@ class InstancesComponent : public GeometryComponent {
 
   /** Index into `references_`. Determines what data is instanced. */
   blender::Vector<int> instance_reference_handles_;
-  /** Transformation of the instances. */
+  /** Transformation of the instances. Empty when #compact_transforms_ is used. */
   blender::Vector<blender::float4x4> instance_transforms_;
+  /** Optional compact storage of the transforms, see #compact_transforms. */
+  std::shared_ptr<const blender::bke::CompactInstanceTransforms> compact_transforms_;
 
   /* These almost unique ids are generated based on the `id` attribute, which might not contain
    * unique ids at all. They are *almost* unique, because under certain very unlikely
@@ -947,8 +984,35 @@ class InstancesComponent : public GeometryComponent {
 
   blender::Span<int> instance_reference_handles() const;
   blender::MutableSpan<int> instance_reference_handles();
+  /**
+   * Write access to the full transforms, compact transforms are expanded and discarded first.
+   */
   blender::MutableSpan<blender::float4x4> instance_transforms();
-  blender::Span<blender::float4x4> instance_transforms() const;
+  /**
+   * Read access to the transforms. When compact transforms are used, every transform is
+   * decompressed on access, so they are not stored expanded.
+   */
+  blender::VArray<blender::float4x4> instance_transforms() const;
+  /**
+   * Get a single transform without expanding compact transforms. This is preferred when the
+   * transforms are only read once, e.g. when creating render instances.
+   */
+  blender::float4x4 instance_transform(int index) const;
+
+  /**
+   * Use #blender::bke::CompactInstanceTransforms to store the transforms, which reduces memory
+   * usage for many instances at the cost of some rotation precision. Returns false when some
+   * transform can't be represented.
+   */
+  bool compact_transforms();
+  /**
+   * Like copying the component and calling #compact_transforms on the copy, but without copying
+   * the full transforms. This is useful when the component is shared. Returns null when some
+   * transform can't be represented.
+   */
+  InstancesComponent *copy_with_compact_transforms() const;
+  /** Returns null when the compact transforms are not used. */
+  const blender::bke::CompactInstanceTransforms *compact_transforms_for_read() const;
 
   int instances_num() const;
   int references_num() const;
@@ -978,6 +1042,7 @@ class InstancesComponent : public GeometryComponent {
 
  private:
   const blender::bke::ComponentAttributeProviders *get_attribute_providers() const final;
+  void discard_compact_transforms();
 };
 
 /**
@@ -198,6 +198,10 @@ enum {
 
   G_DEBUG_GHOST = (1 << 21),  /* Debug GHOST module. */
   G_DEBUG_WINTAB = (1 << 22), /* Debug Wintab. */
+
+  G_DEBUG_GEOMETRY_NODES_PROFILE = (1 << 23), /* Write geometry nodes profiles to disk. */
+  G_DEBUG_DEPSGRAPH_INCREMENTAL = (1 << 24),  /* Verify incremental relations updates against
+                                               * a full depsgraph rebuild. */
 };
 
 #define G_DEBUG_ALL \
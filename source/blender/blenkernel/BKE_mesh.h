@@ -253,6 +253,21 @@ struct Mesh *BKE_mesh_new_from_object(struct Depsgraph *depsgraph,
                                       bool preserve_all_data_layers,
                                       bool preserve_origindex);
 
+/**
+ * Create new meshes for many objects at once, like #BKE_mesh_new_from_object for every object.
+ * Objects that don't need to be evaluated again are converted on multiple threads, and the
+ * preparation of a mesh used by many objects (e.g. instances) is shared.
+ *
+ * \param r_meshes: Array of \a objects_num meshes, an item is null when the object has no
+ * geometry.
+ */
+void BKE_mesh_new_from_objects(struct Depsgraph *depsgraph,
+                               struct Object **objects,
+                               int objects_num,
+                               bool preserve_all_data_layers,
+                               bool preserve_origindex,
+                               struct Mesh **r_meshes);
+
 /**
  * This is a version of BKE_mesh_new_from_object() which stores mesh in the given main database.
  * However, that function enforces object type to be a geometry one, and ensures a mesh is always
@@ -390,6 +405,14 @@ const float (*BKE_mesh_poly_normals_ensure(const struct Mesh *mesh))[3];
  */
 void BKE_mesh_normals_tag_dirty(struct Mesh *mesh);
 
+/**
+ * Tag the normals around the vertices in \a changed_verts (a #BLI_bitmap with a bit per vertex)
+ * as dirty, for when only some vertices moved. If the normals were valid before, they are updated
+ * incrementally the next time they are needed: only faces using these vertices and the vertices
+ * of those faces are recalculated. Otherwise this does nothing, the normals are already dirty.
+ */
+void BKE_mesh_normals_tag_dirty_verts(struct Mesh *mesh, const uint32_t *changed_verts);
+
 /**
  * Check that a mesh with non-dirty normals has vertex and face custom data layers.
  * If these asserts fail, it means some area cleared the dirty flag but didn't copy or add the
@@ -962,6 +985,9 @@ void BKE_mesh_calc_relative_deform(const struct MPoly *mpoly,
 /**
  * Validates and corrects a Mesh.
  *
+ * A fast multi-threaded check is done first, the detailed validation only runs when that check
+ * finds something that may need to be fixed.
+ *
  * \returns true if a change is made.
  */
 bool BKE_mesh_validate(struct Mesh *me, bool do_verbose, bool cddata_check_mask);
@@ -970,6 +996,12 @@ bool BKE_mesh_validate(struct Mesh *me, bool do_verbose, bool cddata_check_mask)
  * \returns True if the mesh is valid.
  */
 bool BKE_mesh_is_valid(struct Mesh *me);
+/**
+ * Fast multi-threaded check used by #BKE_mesh_validate and #BKE_mesh_is_valid.
+ * \returns True if the detailed validation would neither report nor fix anything. False does not
+ * mean that the mesh is invalid.
+ */
+bool BKE_mesh_is_likely_valid(const struct Mesh *me);
 /**
  * Check all material indices of polygons are valid, invalid ones are set to 0.
  * \returns True if the material indices are valid.
@@ -77,6 +77,19 @@ typedef struct MeshElemMap {
   int count;
 } MeshElemMap;
 
+/**
+ * Compact connectivity data stored as compressed sparse rows: the elements connected to element
+ * `i` are `indices[offsets[i]]` up to (but not including) `indices[offsets[i + 1]]`.
+ * Indices for each element are sorted in ascending order.
+ */
+typedef struct MeshTopologyMap {
+  /** Size is the number of mapped elements plus one. */
+  int *offsets;
+  /** Size is the last value in #offsets. */
+  int *indices;
+  int elems_num;
+} MeshTopologyMap;
+
 /* mapping */
 UvVertMap *BKE_mesh_uv_vert_map_create(const struct MPoly *mpoly,
                                        const struct MLoop *mloop,
@@ -315,3 +328,21 @@ int *BKE_mesh_calc_smoothgroups(const struct MEdge *medge,
 #ifdef __cplusplus
 }
 #endif
+
+#ifdef __cplusplus
+
+#  include "BLI_span.hh"
+
+namespace blender::bke::mesh_topology {
+
+/** The indices of the elements connected to element \a index in \a map. */
+inline Span<int> map_lookup(const MeshTopologyMap &map, const int index)
+{
+  BLI_assert(index >= 0 && index < map.elems_num);
+  const int start = map.offsets[index];
+  return {map.indices + start, map.offsets[index + 1] - start};
+}
+
+}  // namespace blender::bke::mesh_topology
+
+#endif
@@ -7,17 +7,37 @@
  * \ingroup bke
  */
 
+#include "BLI_sys_types.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 struct Mesh;
+struct RemeshVoxelCache;
 
 struct Mesh *BKE_mesh_remesh_voxel_fix_poles(const struct Mesh *mesh);
 struct Mesh *BKE_mesh_remesh_voxel(const struct Mesh *mesh,
                                    float voxel_size,
                                    float adaptivity,
                                    float isovalue);
+/**
+ * Same as #BKE_mesh_remesh_voxel, but the level set is kept in \a *cache_p (allocated when null)
+ * and reused by the next call with the same voxel size and the same geometry, so that only the
+ * conversion back to a mesh is done again, e.g. when just the adaptivity changed.
+ * Very large level sets are not kept. Free the cache with #BKE_mesh_remesh_voxel_cache_free.
+ */
+struct Mesh *BKE_mesh_remesh_voxel_cached(const struct Mesh *mesh,
+                                          float voxel_size,
+                                          float adaptivity,
+                                          float isovalue,
+                                          struct RemeshVoxelCache **cache_p);
+void BKE_mesh_remesh_voxel_cache_free(struct RemeshVoxelCache *cache);
+/**
+ * A hash of the vertex positions and triangles of \a mesh, used by
+ * #BKE_mesh_remesh_voxel_cached to detect whether the level set has to be created again.
+ */
+uint64_t BKE_mesh_remesh_voxel_geometry_hash(const struct Mesh *mesh);
 struct Mesh *BKE_mesh_remesh_quadriflow(const struct Mesh *mesh,
                                         int target_faces,
                                         int seed,
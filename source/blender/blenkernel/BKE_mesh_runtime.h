@@ -22,6 +22,7 @@ struct MLoop;
 struct MLoopTri;
 struct MVertTri;
 struct Mesh;
+struct MeshTopologyMap;
 struct Object;
 struct Scene;
 
@@ -49,6 +50,19 @@ void BKE_mesh_runtime_looptri_recalc(struct Mesh *mesh);
  * \note This is a ported copy of dm_getLoopTriArray(dm).
  */
 const struct MLoopTri *BKE_mesh_runtime_looptri_ensure(const struct Mesh *mesh);
+
+/**
+ * Cached connectivity maps, see #MeshTopologyMap for the layout.
+ *
+ * \note These functions only fill a cache, so the mesh argument can be considered logically
+ * const. Concurrent access is protected by a mutex. The returned map is owned by the mesh and
+ * stays valid until the topology changes (#BKE_mesh_runtime_clear_geometry).
+ */
+const struct MeshTopologyMap *BKE_mesh_runtime_vert_edge_map_ensure(const struct Mesh *mesh);
+const struct MeshTopologyMap *BKE_mesh_runtime_vert_loop_map_ensure(const struct Mesh *mesh);
+const struct MeshTopologyMap *BKE_mesh_runtime_vert_poly_map_ensure(const struct Mesh *mesh);
+const struct MeshTopologyMap *BKE_mesh_runtime_edge_poly_map_ensure(const struct Mesh *mesh);
+
 bool BKE_mesh_runtime_ensure_edit_data(struct Mesh *mesh);
 bool BKE_mesh_runtime_clear_edit_data(struct Mesh *mesh);
 bool BKE_mesh_runtime_reset_edit_data(struct Mesh *mesh);
@@ -2,7 +2,9 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
+#include <mutex>
 
 #include "BLI_sys_types.h"
 #include "BLI_utility_mixins.hh"
@@ -10,6 +12,7 @@
 namespace blender::nodes {
 struct FieldInferencingInterface;
 class NodeDeclaration;
+class CachedDerivedNodeTree;
 }  // namespace blender::nodes
 
 namespace blender::bke {
@@ -34,8 +37,28 @@ class bNodeTreeRuntime : NonCopyable, NonMovable {
    */
   uint8_t runtime_flag = 0;
 
+  /**
+   * Changes whenever the node tree is tagged for an update. Values are unique across all node
+   * trees, so a copied node tree never has the same counter as the tree it was copied from. This
+   * can be used to check whether data derived from the node tree is still valid.
+   */
+  uint64_t update_counter = new_update_counter();
+
   /** Information about how inputs and outputs of the node group interact with fields. */
   std::unique_ptr<nodes::FieldInferencingInterface> field_inferencing_interface;
+
+  /**
+   * Derived node tree with this tree as root, shared by all evaluations of the tree. See
+   * #nodes::get_cached_derived_node_tree.
+   */
+  std::shared_ptr<const nodes::CachedDerivedNodeTree> derived_node_tree_cache;
+  std::mutex derived_node_tree_cache_mutex;
+
+  static uint64_t new_update_counter()
+  {
+    static std::atomic<uint64_t> counter = 0;
+    return ++counter;
+  }
 };
 
 /**
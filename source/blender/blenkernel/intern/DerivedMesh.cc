@@ -1656,6 +1656,13 @@ static void mesh_build_data(struct Depsgraph *depsgraph,
   }
 
   mesh_build_extra_data(depsgraph, ob, mesh_eval);
+
+  /* Build the BVH-trees used by other objects from the previous evaluated mesh now, in parallel,
+   * instead of one after another in the evaluation of the objects using them. */
+  if (ob->runtime.bvh_prebuild_types != 0) {
+    BKE_bvhtree_from_mesh_prebuild(
+        mesh_eval, ob->runtime.bvh_prebuild_types, ob->runtime.bvh_prebuild_tree_types);
+  }
 }
 
 static void editbmesh_build_data(struct Depsgraph *depsgraph,
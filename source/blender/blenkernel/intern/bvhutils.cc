@@ -5,6 +5,7 @@
  * \ingroup bke
  */
 
+#include <atomic>
 #include <cmath>
 #include <cstdio>
 #include <cstring>
@@ -16,8 +17,10 @@
 #include "BLI_linklist.h"
 #include "BLI_math.h"
 #include "BLI_task.h"
+#include "BLI_task.hh"
 #include "BLI_threads.h"
 #include "BLI_utildefines.h"
+#include "BLI_vector.hh"
 
 #include "BKE_bvhutils.h"
 #include "BKE_editmesh.h"
@@ -26,6 +29,10 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "PIL_time.h"
+
+#include "atomic_ops.h"
+
 /* -------------------------------------------------------------------- */
 /** \name BVHCache
  * \{ */
@@ -33,18 +40,33 @@
 struct BVHCacheItem {
   bool is_filled;
   BVHTree *tree;
+  /**
+   * Held while building the tree. Every tree type has its own lock, so different trees can be
+   * built at the same time, while threads requesting a tree that is being built wait for it.
+   */
+  ThreadMutex mutex;
 };
 
 struct BVHCache {
   BVHCacheItem items[BVHTREE_MAX_ITEM];
-  ThreadMutex mutex;
+  /** Bit-mask of the #BVHCacheType requested from outside of #BKE_bvhtree_from_mesh_prebuild. */
+  int types_used;
 };
 
+/** Statistics of all caches, see #BKE_bvhcache_stats_get. */
+static struct {
+  std::atomic<uint64_t> hits;
+  std::atomic<uint64_t> misses;
+  std::atomic<uint64_t> waits;
+  std::atomic<uint64_t> prebuilt;
+  std::atomic<uint64_t> build_time_ns;
+} bvhcache_stats;
+
 /**
  * Queries a bvhcache for the cache bvhtree of the request type
  *
- * When the `r_locked` is filled and the tree could not be found the caches mutex will be
- * locked. This mutex can be unlocked by calling `bvhcache_unlock`.
+ * When the `r_locked` is filled and the tree could not be found the mutex of the tree type will
+ * be locked. This mutex can be unlocked by calling `bvhcache_unlock`.
  *
  * When `r_locked` is used the `mesh_eval_mutex` must contain the `Mesh_Runtime.eval_mutex`.
  */
@@ -71,27 +93,35 @@ static bool bvhcache_find(BVHCache **bvh_cache_p,
     BLI_mutex_unlock(mesh_eval_mutex);
   }
   BVHCache *bvh_cache = *bvh_cache_p;
+  BVHCacheItem *item = &bvh_cache->items[type];
 
-  if (bvh_cache->items[type].is_filled) {
-    *r_tree = bvh_cache->items[type].tree;
+  if (item->is_filled) {
+    *r_tree = item->tree;
+    if (do_lock) {
+      bvhcache_stats.hits++;
+    }
     return true;
   }
   if (do_lock) {
-    BLI_mutex_lock(&bvh_cache->mutex);
+    BLI_mutex_lock(&item->mutex);
     bool in_cache = bvhcache_find(bvh_cache_p, type, r_tree, nullptr, nullptr);
     if (in_cache) {
-      BLI_mutex_unlock(&bvh_cache->mutex);
+      /* The tree was built by another thread while waiting for the lock. */
+      BLI_mutex_unlock(&item->mutex);
+      bvhcache_stats.hits++;
+      bvhcache_stats.waits++;
       return in_cache;
     }
     *r_locked = true;
+    bvhcache_stats.misses++;
   }
   return false;
 }
 
-static void bvhcache_unlock(BVHCache *bvh_cache, bool lock_started)
+static void bvhcache_unlock(BVHCache *bvh_cache, BVHCacheType type, bool lock_started)
 {
   if (lock_started) {
-    BLI_mutex_unlock(&bvh_cache->mutex);
+    BLI_mutex_unlock(&bvh_cache->items[type].mutex);
   }
 }
 
@@ -112,7 +142,9 @@ bool bvhcache_has_tree(const BVHCache *bvh_cache, const BVHTree *tree)
 BVHCache *bvhcache_init()
 {
   BVHCache *cache = MEM_cnew<BVHCache>(__func__);
-  BLI_mutex_init(&cache->mutex);
+  for (int index = 0; index < BVHTREE_MAX_ITEM; index++) {
+    BLI_mutex_init(&cache->items[index].mutex);
+  }
   return cache;
 }
 /**
@@ -137,11 +169,52 @@ void bvhcache_free(BVHCache *bvh_cache)
     BVHCacheItem *item = &bvh_cache->items[index];
     BLI_bvhtree_free(item->tree);
     item->tree = nullptr;
+    BLI_mutex_end(&item->mutex);
   }
-  BLI_mutex_end(&bvh_cache->mutex);
   MEM_freeN(bvh_cache);
 }
 
+int bvhcache_types_used(const BVHCache *bvh_cache)
+{
+  return bvh_cache ? atomic_load_int32(const_cast<int *>(&bvh_cache->types_used)) : 0;
+}
+
+int bvhcache_tree_type_get(const BVHCache *bvh_cache, const BVHCacheType type)
+{
+  if (bvh_cache == nullptr) {
+    return 0;
+  }
+  const BVHCacheItem &item = bvh_cache->items[type];
+  if (!item.is_filled || item.tree == nullptr) {
+    return 0;
+  }
+  return BLI_bvhtree_get_tree_type(item.tree);
+}
+
+void BKE_bvhcache_stats_get(BVHCacheStats *r_stats)
+{
+  r_stats->hits = bvhcache_stats.hits;
+  r_stats->misses = bvhcache_stats.misses;
+  r_stats->waits = bvhcache_stats.waits;
+  r_stats->prebuilt = bvhcache_stats.prebuilt;
+  r_stats->build_time = double(bvhcache_stats.build_time_ns) * 1e-9;
+}
+
+void BKE_bvhcache_stats_reset()
+{
+  bvhcache_stats.hits = 0;
+  bvhcache_stats.misses = 0;
+  bvhcache_stats.waits = 0;
+  bvhcache_stats.prebuilt = 0;
+  bvhcache_stats.build_time_ns = 0;
+}
+
+static void bvhcache_stats_add_build_time(const double start_time)
+{
+  const double duration = PIL_check_seconds_timer() - start_time;
+  bvhcache_stats.build_time_ns += uint64_t(duration * 1e9);
+}
+
 /**
  * BVH-tree balancing inside a mutex lock must be run in isolation. Balancing
  * is multithreaded, and we do not want the current thread to start another task
@@ -1209,10 +1282,11 @@ static BLI_bitmap *looptri_no_hidden_map_get(const MPoly *mpoly,
   return looptri_mask;
 }
 
-BVHTree *BKE_bvhtree_from_mesh_get(struct BVHTreeFromMesh *data,
-                                   const struct Mesh *mesh,
-                                   const BVHCacheType bvh_cache_type,
-                                   const int tree_type)
+static BVHTree *bvhtree_from_mesh_get_ex(struct BVHTreeFromMesh *data,
+                                         const struct Mesh *mesh,
+                                         const BVHCacheType bvh_cache_type,
+                                         const int tree_type,
+                                         const bool is_prebuild)
 {
   BVHCache **bvh_cache_p = (BVHCache **)&mesh->runtime.bvh_cache;
   ThreadMutex *mesh_eval_mutex = (ThreadMutex *)mesh->runtime.eval_mutex;
@@ -1239,6 +1313,10 @@ BVHTree *BKE_bvhtree_from_mesh_get(struct BVHTreeFromMesh *data,
   data->cached = bvhcache_find(
       bvh_cache_p, bvh_cache_type, &data->tree, &lock_started, mesh_eval_mutex);
 
+  if (!is_prebuild) {
+    atomic_fetch_and_or_int32(&(*bvh_cache_p)->types_used, 1 << bvh_cache_type);
+  }
+
   if (data->cached) {
     BLI_assert(lock_started == false);
 
@@ -1247,6 +1325,7 @@ BVHTree *BKE_bvhtree_from_mesh_get(struct BVHTreeFromMesh *data,
   }
 
   /* Create BVHTree. */
+  const double build_start_time = PIL_check_seconds_timer();
 
   BLI_bitmap *mask = nullptr;
   int mask_bits_act_len = -1;
@@ -1302,13 +1381,17 @@ BVHTree *BKE_bvhtree_from_mesh_get(struct BVHTreeFromMesh *data,
   }
 
   bvhtree_balance(data->tree, lock_started);
+  bvhcache_stats_add_build_time(build_start_time);
+  if (is_prebuild) {
+    bvhcache_stats.prebuilt++;
+  }
 
   /* Save on cache for later use */
   // printf("BVHTree built and saved on cache\n");
   BLI_assert(data->cached == false);
   data->cached = true;
   bvhcache_insert(*bvh_cache_p, data->tree, bvh_cache_type);
-  bvhcache_unlock(*bvh_cache_p, lock_started);
+  bvhcache_unlock(*bvh_cache_p, bvh_cache_type, lock_started);
 
 #ifdef DEBUG
   if (data->tree != nullptr) {
@@ -1323,6 +1406,41 @@ BVHTree *BKE_bvhtree_from_mesh_get(struct BVHTreeFromMesh *data,
   return data->tree;
 }
 
+BVHTree *BKE_bvhtree_from_mesh_get(struct BVHTreeFromMesh *data,
+                                   const struct Mesh *mesh,
+                                   const BVHCacheType bvh_cache_type,
+                                   const int tree_type)
+{
+  return bvhtree_from_mesh_get_ex(data, mesh, bvh_cache_type, tree_type, false);
+}
+
+void BKE_bvhtree_from_mesh_prebuild(const struct Mesh *mesh,
+                                    const int bvh_cache_types,
+                                    const char *tree_types)
+{
+  /* Only types that can be built from a mesh without additional data. */
+  const int supported_types = (1 << BVHTREE_FROM_VERTS) | (1 << BVHTREE_FROM_EDGES) |
+                              (1 << BVHTREE_FROM_LOOPTRI) |
+                              (1 << BVHTREE_FROM_LOOPTRI_NO_HIDDEN) |
+                              (1 << BVHTREE_FROM_LOOSEVERTS) | (1 << BVHTREE_FROM_LOOSEEDGES);
+  blender::Vector<BVHCacheType, BVHTREE_MAX_ITEM> types;
+  for (int type = 0; type < BVHTREE_MAX_ITEM; type++) {
+    if ((bvh_cache_types & supported_types & (1 << type)) && tree_types[type] != 0) {
+      types.append(BVHCacheType(type));
+    }
+  }
+
+  /* The trees are built in parallel, each of them is balanced with multiple threads as well. */
+  blender::threading::parallel_for(types.index_range(), 1, [&](const blender::IndexRange range) {
+    for (const int i : range) {
+      const BVHCacheType type = types[i];
+      BVHTreeFromMesh data;
+      bvhtree_from_mesh_get_ex(&data, mesh, type, tree_types[type], true);
+      free_bvhtree_from_mesh(&data);
+    }
+  });
+}
+
 BVHTree *BKE_bvhtree_from_editmesh_get(BVHTreeFromEditMesh *data,
                                        struct BMEditMesh *em,
                                        const int tree_type,
@@ -1344,6 +1462,7 @@ BVHTree *BKE_bvhtree_from_editmesh_get(BVHTreeFromEditMesh *data,
     }
   }
 
+  const double build_start_time = PIL_check_seconds_timer();
   switch (bvh_cache_type) {
     case BVHTREE_FROM_EM_VERTS:
       data->tree = bvhtree_from_editmesh_verts_create_tree(0.0f, tree_type, 6, em, nullptr, -1);
@@ -1367,6 +1486,7 @@ BVHTree *BKE_bvhtree_from_editmesh_get(BVHTreeFromEditMesh *data,
   }
 
   bvhtree_balance(data->tree, lock_started);
+  bvhcache_stats_add_build_time(build_start_time);
 
   if (bvh_cache_p) {
     /* Save on cache for later use */
@@ -1374,7 +1494,7 @@ BVHTree *BKE_bvhtree_from_editmesh_get(BVHTreeFromEditMesh *data,
     BLI_assert(data->cached == false);
     data->cached = true;
     bvhcache_insert(*bvh_cache_p, data->tree, bvh_cache_type);
-    bvhcache_unlock(*bvh_cache_p, lock_started);
+    bvhcache_unlock(*bvh_cache_p, bvh_cache_type, lock_started);
   }
 
 #ifdef DEBUG
@@ -0,0 +1,81 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "testing/testing.h"
+
+#include "BKE_bvhutils.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+
+#include "DNA_mesh_types.h"
+
+#include "mesh_test_utils.hh"
+
+namespace blender::bke::tests {
+
+class BVHCacheTest : public MeshTest {
+};
+
+TEST_F(BVHCacheTest, stats)
+{
+  Mesh *mesh = create_grid_mesh(10, 10);
+  BKE_bvhcache_stats_reset();
+
+  BVHTreeFromMesh data;
+  for ([[maybe_unused]] const int i : IndexRange(3)) {
+    EXPECT_NE(BKE_bvhtree_from_mesh_get(&data, mesh, BVHTREE_FROM_LOOPTRI, 4), nullptr);
+    free_bvhtree_from_mesh(&data);
+  }
+
+  BVHCacheStats stats;
+  BKE_bvhcache_stats_get(&stats);
+  EXPECT_EQ(stats.misses, 1u);
+  EXPECT_EQ(stats.hits, 2u);
+  EXPECT_EQ(stats.prebuilt, 0u);
+
+  const BVHCache *bvh_cache = mesh->runtime.bvh_cache;
+  EXPECT_EQ(bvhcache_types_used(bvh_cache), 1 << BVHTREE_FROM_LOOPTRI);
+  EXPECT_EQ(bvhcache_tree_type_get(bvh_cache, BVHTREE_FROM_LOOPTRI), 4);
+  EXPECT_EQ(bvhcache_tree_type_get(bvh_cache, BVHTREE_FROM_VERTS), 0);
+
+  BKE_bvhcache_stats_reset();
+  BKE_bvhcache_stats_get(&stats);
+  EXPECT_EQ(stats.misses, 0u);
+  EXPECT_EQ(stats.hits, 0u);
+
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(BVHCacheTest, prebuild_uses_requested_tree_type)
+{
+  GridMeshOptions options;
+  options.use_edges = true;
+  Mesh *mesh = create_grid_mesh(10, 10, options);
+  BKE_bvhcache_stats_reset();
+
+  char tree_types[BVHTREE_MAX_ITEM] = {0};
+  tree_types[BVHTREE_FROM_VERTS] = 6;
+  /* Edges are in the mask but were never built before, so they are skipped. */
+  BKE_bvhtree_from_mesh_prebuild(
+      mesh, (1 << BVHTREE_FROM_VERTS) | (1 << BVHTREE_FROM_EDGES), tree_types);
+
+  const BVHCache *bvh_cache = mesh->runtime.bvh_cache;
+  EXPECT_EQ(bvhcache_tree_type_get(bvh_cache, BVHTREE_FROM_VERTS), 6);
+  EXPECT_EQ(bvhcache_tree_type_get(bvh_cache, BVHTREE_FROM_EDGES), 0);
+  /* Prebuilt trees don't count as used, until they are requested. */
+  EXPECT_EQ(bvhcache_types_used(bvh_cache), 0);
+
+  BVHTreeFromMesh data;
+  BKE_bvhtree_from_mesh_get(&data, mesh, BVHTREE_FROM_VERTS, 2);
+  free_bvhtree_from_mesh(&data);
+  EXPECT_EQ(bvhcache_types_used(bvh_cache), 1 << BVHTREE_FROM_VERTS);
+
+  BVHCacheStats stats;
+  BKE_bvhcache_stats_get(&stats);
+  EXPECT_EQ(stats.prebuilt, 1u);
+  EXPECT_EQ(stats.misses, 1u);
+  EXPECT_EQ(stats.hits, 1u);
+
+  BKE_id_free(nullptr, mesh);
+}
+
+}  // namespace blender::bke::tests
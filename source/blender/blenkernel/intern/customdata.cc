@@ -28,6 +28,7 @@
 #include "BLI_span.hh"
 #include "BLI_string.h"
 #include "BLI_string_utils.h"
+#include "BLI_task.hh"
 #include "BLI_utildefines.h"
 
 #ifndef NDEBUG
@@ -3225,6 +3226,114 @@ void CustomData_free_elem(CustomData *data, int index, int count)
   }
 }
 
+/**
+ * Type-specialized versions of the #LayerTypeInfo.interp callbacks of the most common generic
+ * attribute types, interpolating many destination elements at once without indirect calls. The
+ * sources of destination element `i` are `src_indices[src_offsets[i]..src_offsets[i + 1]]`.
+ * The result must match the callbacks exactly. Destination elements without sources are left
+ * unchanged, like when the callbacks are skipped for them.
+ */
+template<int ComponentsNum>
+static void interp_float_components(const float *src_data,
+                                    float *dst_data,
+                                    const int *src_offsets,
+                                    const int *src_indices,
+                                    const float *weights,
+                                    const int *dst_indices,
+                                    const IndexRange range)
+{
+  for (const int i : range) {
+    const int src_start = src_offsets[i];
+    const int src_end = src_offsets[i + 1];
+    if (src_start == src_end) {
+      continue;
+    }
+    const float default_weight = 1.0f / (src_end - src_start);
+    float result[ComponentsNum] = {0.0f};
+    for (int j = src_start; j < src_end; j++) {
+      const float weight = weights ? weights[j] : default_weight;
+      const float *src = &src_data[(size_t)src_indices[j] * ComponentsNum];
+      for (int k = 0; k < ComponentsNum; k++) {
+        result[k] += src[k] * weight;
+      }
+    }
+    float *dst = &dst_data[(size_t)(dst_indices ? dst_indices[i] : i) * ComponentsNum];
+    for (int k = 0; k < ComponentsNum; k++) {
+      dst[k] = result[k];
+    }
+  }
+}
+
+static void interp_int(const int *src_data,
+                       int *dst_data,
+                       const int *src_offsets,
+                       const int *src_indices,
+                       const float *weights,
+                       const int *dst_indices,
+                       const IndexRange range)
+{
+  for (const int i : range) {
+    const int src_start = src_offsets[i];
+    const int src_end = src_offsets[i + 1];
+    if (src_start == src_end) {
+      continue;
+    }
+    const float default_weight = 1.0f / (src_end - src_start);
+    float result = 0.0f;
+    for (int j = src_start; j < src_end; j++) {
+      const float weight = weights ? weights[j] : default_weight;
+      result += float(src_data[src_indices[j]]) * weight;
+    }
+    dst_data[dst_indices ? dst_indices[i] : i] = static_cast<int>(round(result));
+  }
+}
+
+/**
+ * \return False if there is no type-specialized interpolation for the layer type, and the
+ * #LayerTypeInfo.interp callback has to be used instead.
+ */
+static bool customdata_layer_interp_typed(const int type,
+                                          const void *src_data,
+                                          void *dst_data,
+                                          const int *src_offsets,
+                                          const int *src_indices,
+                                          const float *weights,
+                                          const int *dst_indices,
+                                          const IndexRange range)
+{
+  const float *src_float = static_cast<const float *>(src_data);
+  float *dst_float = static_cast<float *>(dst_data);
+  switch (type) {
+    case CD_PROP_FLOAT:
+      interp_float_components<1>(
+          src_float, dst_float, src_offsets, src_indices, weights, dst_indices, range);
+      return true;
+    case CD_PROP_FLOAT2:
+      interp_float_components<2>(
+          src_float, dst_float, src_offsets, src_indices, weights, dst_indices, range);
+      return true;
+    case CD_PROP_FLOAT3:
+      interp_float_components<3>(
+          src_float, dst_float, src_offsets, src_indices, weights, dst_indices, range);
+      return true;
+    case CD_PROP_COLOR:
+      interp_float_components<4>(
+          src_float, dst_float, src_offsets, src_indices, weights, dst_indices, range);
+      return true;
+    case CD_PROP_INT32:
+      interp_int(static_cast<const int *>(src_data),
+                 static_cast<int *>(dst_data),
+                 src_offsets,
+                 src_indices,
+                 weights,
+                 dst_indices,
+                 range);
+      return true;
+    default:
+      return false;
+  }
+}
+
 #define SOURCE_BUF_SIZE 100
 
 void CustomData_interp(const CustomData *source,
@@ -3283,6 +3392,19 @@ void CustomData_interp(const CustomData *source,
     if (dest->layers[dest_i].type == source->layers[src_i].type) {
       void *src_data = source->layers[src_i].data;
 
+      const int src_offsets[2] = {0, count};
+      if (customdata_layer_interp_typed(source->layers[src_i].type,
+                                        src_data,
+                                        dest->layers[dest_i].data,
+                                        src_offsets,
+                                        src_indices,
+                                        weights,
+                                        &dest_index,
+                                        IndexRange(1))) {
+        dest_i++;
+        continue;
+      }
+
       for (int j = 0; j < count; j++) {
         sources[j] = POINTER_OFFSET(src_data, (size_t)src_indices[j] * typeInfo->size);
       }
@@ -3310,6 +3432,88 @@ void CustomData_interp(const CustomData *source,
   }
 }
 
+void CustomData_interp_batch(const CustomData *source,
+                             CustomData *dest,
+                             const int *src_offsets,
+                             const int *src_indices,
+                             const float *weights,
+                             const int *dest_indices,
+                             const int dest_num)
+{
+  if (dest_num <= 0) {
+    return;
+  }
+
+  /* Match the layers once, in the same way as #CustomData_interp. */
+  struct LayerPair {
+    const CustomDataLayer *src;
+    CustomDataLayer *dst;
+    const LayerTypeInfo *type_info;
+  };
+  Vector<LayerPair, 16> layer_pairs;
+  int dest_i = 0;
+  for (int src_i = 0; src_i < source->totlayer; src_i++) {
+    const LayerTypeInfo *typeInfo = layerType_getInfo(source->layers[src_i].type);
+    if (!typeInfo->interp) {
+      continue;
+    }
+    while (dest_i < dest->totlayer && dest->layers[dest_i].type < source->layers[src_i].type) {
+      dest_i++;
+    }
+    if (dest_i >= dest->totlayer) {
+      break;
+    }
+    if (dest->layers[dest_i].type == source->layers[src_i].type) {
+      layer_pairs.append({&source->layers[src_i], &dest->layers[dest_i], typeInfo});
+      dest_i++;
+    }
+  }
+  if (layer_pairs.is_empty()) {
+    return;
+  }
+
+  blender::threading::parallel_for(IndexRange(dest_num), 1024, [&](const IndexRange range) {
+    Vector<const void *, 16> sources;
+    Vector<float, 16> default_weights;
+    for (const LayerPair &pair : layer_pairs) {
+      if (customdata_layer_interp_typed(pair.src->type,
+                                        pair.src->data,
+                                        pair.dst->data,
+                                        src_offsets,
+                                        src_indices,
+                                        weights,
+                                        dest_indices,
+                                        range)) {
+        continue;
+      }
+      const size_t size = size_t(pair.type_info->size);
+      for (const int i : range) {
+        const int src_start = src_offsets[i];
+        const int count = src_offsets[i + 1] - src_start;
+        if (count <= 0) {
+          continue;
+        }
+        sources.clear();
+        for (const int j : IndexRange(src_start, count)) {
+          sources.append(POINTER_OFFSET(pair.src->data, size_t(src_indices[j]) * size));
+        }
+        const float *elem_weights = weights ? &weights[src_start] : nullptr;
+        if (elem_weights == nullptr) {
+          default_weights.clear();
+          default_weights.append_n_times(1.0f / count, count);
+          elem_weights = default_weights.data();
+        }
+        const int dest_index = dest_indices ? dest_indices[i] : i;
+        pair.type_info->interp(sources.data(),
+                               elem_weights,
+                               nullptr,
+                               count,
+                               POINTER_OFFSET(pair.dst->data, size_t(dest_index) * size));
+      }
+    }
+  });
+}
+
 void CustomData_swap_corners(struct CustomData *data, int index, const int *corner_indices)
 {
   for (int i = 0; i < data->totlayer; i++) {
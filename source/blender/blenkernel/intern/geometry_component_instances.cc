@@ -5,6 +5,9 @@
 #include "BLI_float4x4.hh"
 #include "BLI_index_mask.hh"
 #include "BLI_map.hh"
+#include "BLI_math_matrix.h"
+#include "BLI_math_rotation.h"
+#include "BLI_math_vector.hh"
 #include "BLI_rand.hh"
 #include "BLI_set.hh"
 #include "BLI_span.hh"
@@ -33,6 +36,105 @@ using blender::VectorSet;
 
 BLI_CPP_TYPE_MAKE(InstanceReference, InstanceReference, CPPTypeFlags::None)
 
+/* -------------------------------------------------------------------- */
+/** \name Compact Instance Transforms
+ * \{ */
+
+namespace blender::bke {
+
+static constexpr float quaternion_quantize_scale = 32767.0f;
+
+float4x4 CompactInstanceTransforms::transform(const int64_t index) const
+{
+  const std::array<int16_t, 4> &rotation = rotations[index];
+  float quat[4];
+  for (const int i : IndexRange(4)) {
+    quat[i] = rotation[i] / quaternion_quantize_scale;
+  }
+  normalize_qt(quat);
+  const float3 scale = scales.is_empty() ? float3(1.0f) : scales[index];
+  float4x4 transform;
+  loc_quat_size_to_mat4(transform.values, positions[index], quat, scale);
+  return transform;
+}
+
+void CompactInstanceTransforms::to_transforms(MutableSpan<float4x4> r_transforms) const
+{
+  BLI_assert(r_transforms.size() == this->size());
+  threading::parallel_for(r_transforms.index_range(), 2048, [&](const IndexRange range) {
+    for (const int64_t i : range) {
+      r_transforms[i] = this->transform(i);
+    }
+  });
+}
+
+std::unique_ptr<CompactInstanceTransforms> CompactInstanceTransforms::from_transforms(
+    const Span<float4x4> transforms)
+{
+  std::unique_ptr<CompactInstanceTransforms> compact =
+      std::make_unique<CompactInstanceTransforms>();
+  compact->positions.reinitialize(transforms.size());
+  compact->rotations.reinitialize(transforms.size());
+  Array<float3> scales(transforms.size());
+
+  std::atomic<bool> is_valid = true;
+  std::atomic<bool> has_scale = false;
+  threading::parallel_for(transforms.index_range(), 2048, [&](const IndexRange range) {
+    for (const int64_t i : range) {
+      const float4x4 &transform = transforms[i];
+      compact->positions[i] = transform.translation();
+
+      float3 scale;
+      mat4_to_size(scale, transform.values);
+      if (ELEM(0.0f, scale.x, scale.y, scale.z)) {
+        is_valid = false;
+        return;
+      }
+      float rotation[3][3];
+      copy_m3_m4(rotation, transform.values);
+      normalize_m3(rotation);
+      if (std::abs(dot_v3v3(rotation[0], rotation[1])) > 1e-4f ||
+          std::abs(dot_v3v3(rotation[0], rotation[2])) > 1e-4f ||
+          std::abs(dot_v3v3(rotation[1], rotation[2])) > 1e-4f) {
+        /* Shear can't be represented by a rotation and a scale. */
+        is_valid = false;
+        return;
+      }
+      if (is_negative_m3(rotation)) {
+        negate_v3(rotation[0]);
+        scale.x = -scale.x;
+      }
+      if (!compare_v3v3(scale, float3(1.0f), 1e-6f)) {
+        has_scale = true;
+      }
+      scales[i] = scale;
+
+      float quat[4];
+      mat3_normalized_to_quat(quat, rotation);
+      /* Use the quaternion with positive w, both represent the same rotation. */
+      if (quat[0] < 0.0f) {
+        negate_v4(quat);
+      }
+      for (const int j : IndexRange(4)) {
+        compact->rotations[i][j] = int16_t(
+            std::round(std::clamp(quat[j], -1.0f, 1.0f) * quaternion_quantize_scale));
+      }
+    }
+  });
+
+  if (!is_valid) {
+    return {};
+  }
+  if (has_scale) {
+    compact->scales = std::move(scales);
+  }
+  return compact;
+}
+
+}  // namespace blender::bke
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Geometry Component Implementation
  * \{ */
@@ -45,7 +147,13 @@ GeometryComponent *InstancesComponent::copy() const
 {
   InstancesComponent *new_component = new InstancesComponent();
   new_component->instance_reference_handles_ = instance_reference_handles_;
-  new_component->instance_transforms_ = instance_transforms_;
+  if (compact_transforms_) {
+    /* The compact transforms are immutable, so they can be shared. */
+    new_component->compact_transforms_ = compact_transforms_;
+  }
+  else {
+    new_component->instance_transforms_ = instance_transforms_;
+  }
   new_component->references_ = references_;
   new_component->attributes_ = attributes_;
   return new_component;
@@ -53,6 +161,7 @@ GeometryComponent *InstancesComponent::copy() const
 
 void InstancesComponent::reserve(int min_capacity)
 {
+  this->discard_compact_transforms();
   instance_reference_handles_.reserve(min_capacity);
   instance_transforms_.reserve(min_capacity);
   attributes_.reallocate(min_capacity);
@@ -60,6 +169,7 @@ void InstancesComponent::reserve(int min_capacity)
 
 void InstancesComponent::resize(int capacity)
 {
+  this->discard_compact_transforms();
   instance_reference_handles_.resize(capacity);
   instance_transforms_.resize(capacity);
   attributes_.reallocate(capacity);
@@ -69,6 +179,7 @@ void InstancesComponent::clear()
 {
   instance_reference_handles_.clear();
   instance_transforms_.clear();
+  compact_transforms_.reset();
   attributes_.clear();
   references_.clear();
 }
@@ -77,6 +188,7 @@ void InstancesComponent::add_instance(const int instance_handle, const float4x4
 {
   BLI_assert(instance_handle >= 0);
   BLI_assert(instance_handle < references_.size());
+  this->discard_compact_transforms();
   instance_reference_handles_.append(instance_handle);
   instance_transforms_.append(transform);
   attributes_.reallocate(this->instances_num());
@@ -94,11 +206,75 @@ blender::MutableSpan<int> InstancesComponent::instance_reference_handles()
 
 blender::MutableSpan<blender::float4x4> InstancesComponent::instance_transforms()
 {
+  this->discard_compact_transforms();
   return instance_transforms_;
 }
-blender::Span<blender::float4x4> InstancesComponent::instance_transforms() const
+blender::VArray<blender::float4x4> InstancesComponent::instance_transforms() const
 {
-  return instance_transforms_;
+  if (compact_transforms_) {
+    /* The array shares ownership, so it stays valid when the component changes. */
+    return blender::VArray<float4x4>::ForFunc(
+        compact_transforms_->size(), [compact = compact_transforms_](const int64_t index) {
+          return compact->transform(index);
+        });
+  }
+  return blender::VArray<float4x4>::ForSpan(instance_transforms_);
+}
+
+float4x4 InstancesComponent::instance_transform(const int index) const
+{
+  if (compact_transforms_) {
+    return compact_transforms_->transform(index);
+  }
+  return instance_transforms_[index];
+}
+
+bool InstancesComponent::compact_transforms()
+{
+  if (compact_transforms_) {
+    return true;
+  }
+  std::unique_ptr<blender::bke::CompactInstanceTransforms> compact =
+      blender::bke::CompactInstanceTransforms::from_transforms(instance_transforms_);
+  if (!compact) {
+    return false;
+  }
+  compact_transforms_ = std::move(compact);
+  instance_transforms_.clear_and_make_inline();
+  return true;
+}
+
+InstancesComponent *InstancesComponent::copy_with_compact_transforms() const
+{
+  std::shared_ptr<const blender::bke::CompactInstanceTransforms> compact = compact_transforms_;
+  if (!compact) {
+    compact = blender::bke::CompactInstanceTransforms::from_transforms(instance_transforms_);
+    if (!compact) {
+      return nullptr;
+    }
+  }
+  InstancesComponent *new_component = new InstancesComponent();
+  new_component->instance_reference_handles_ = instance_reference_handles_;
+  new_component->compact_transforms_ = std::move(compact);
+  new_component->references_ = references_;
+  new_component->attributes_ = attributes_;
+  return new_component;
+}
+
+const blender::bke::CompactInstanceTransforms *InstancesComponent::compact_transforms_for_read()
+    const
+{
+  return compact_transforms_.get();
+}
+
+void InstancesComponent::discard_compact_transforms()
+{
+  if (!compact_transforms_) {
+    return;
+  }
+  instance_transforms_.reinitialize(compact_transforms_->size());
+  compact_transforms_->to_transforms(instance_transforms_);
+  compact_transforms_.reset();
 }
 
 GeometrySet &InstancesComponent::geometry_set_from_reference(const int reference_index)
@@ -260,7 +436,7 @@ void InstancesComponent::remove_unused_references()
 
 int InstancesComponent::instances_num() const
 {
-  return instance_transforms_.size();
+  return instance_reference_handles_.size();
 }
 
 int InstancesComponent::references_num() const
@@ -408,8 +584,13 @@ class InstancePositionAttributeProvider final : public BuiltinAttributeProvider
   {
     const InstancesComponent &instances_component = static_cast<const InstancesComponent &>(
         component);
-    Span<float4x4> transforms = instances_component.instance_transforms();
-    return VArray<float3>::ForDerivedSpan<float4x4, get_transform_position>(transforms);
+    if (const CompactInstanceTransforms *compact =
+            instances_component.compact_transforms_for_read()) {
+      return VArray<float3>::ForSpan(compact->positions);
+    }
+    const VArray<float4x4> transforms = instances_component.instance_transforms();
+    return VArray<float3>::ForDerivedSpan<float4x4, get_transform_position>(
+        transforms.get_internal_span());
   }
 
   WriteAttributeLookup try_get_for_write(GeometryComponent &component) const final
@@ -0,0 +1,139 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "testing/testing.h"
+
+#include "BLI_float4x4.hh"
+#include "BLI_math_base.h"
+#include "BLI_rand.hh"
+#include "BLI_vector.hh"
+
+#include "BKE_geometry_set.hh"
+
+namespace blender::bke::tests {
+
+/** Quantized rotations are not exact, this is the largest expected error per matrix element. */
+static constexpr float rotation_error = 5e-4f;
+
+static float3 random_float3(RandomNumberGenerator &rng)
+{
+  return {rng.get_float(), rng.get_float(), rng.get_float()};
+}
+
+static Vector<float4x4> random_transforms(const int size, const float max_scale)
+{
+  RandomNumberGenerator rng(42);
+  Vector<float4x4> transforms;
+  for ([[maybe_unused]] const int i : IndexRange(size)) {
+    const float3 location = (random_float3(rng) - float3(0.5f)) * 200.0f;
+    const float3 rotation = random_float3(rng) * float(2.0 * M_PI);
+    const float3 scale = float3(0.5f) + random_float3(rng) * (max_scale - 0.5f);
+    transforms.append(float4x4::from_loc_eul_scale(location, rotation, scale));
+  }
+  return transforms;
+}
+
+static void expect_transforms_near(const float4x4 &a, const float4x4 &b, const float max_scale)
+{
+  for (const int col : IndexRange(3)) {
+    EXPECT_V3_NEAR(a.values[col], b.values[col], rotation_error * max_scale);
+  }
+  EXPECT_V3_NEAR(a.translation(), b.translation(), 1e-5f);
+}
+
+TEST(compact_instance_transforms, round_trip_error)
+{
+  for (const float max_scale : {1.0f, 2.0f}) {
+    const Vector<float4x4> transforms = random_transforms(1000, max_scale);
+    std::unique_ptr<CompactInstanceTransforms> compact =
+        CompactInstanceTransforms::from_transforms(transforms);
+    ASSERT_TRUE(compact);
+    EXPECT_EQ(compact->size(), transforms.size());
+    /* Scales are only stored when some instance is scaled. */
+    EXPECT_EQ(compact->scales.is_empty(), max_scale == 1.0f);
+    for (const int i : transforms.index_range()) {
+      expect_transforms_near(compact->transform(i), transforms[i], max_scale);
+    }
+  }
+}
+
+TEST(compact_instance_transforms, negative_scale)
+{
+  Vector<float4x4> transforms;
+  transforms.append(float4x4::from_loc_eul_scale({1, 2, 3}, {0.3f, 0.2f, 0.1f}, {-1, 1, 1}));
+  transforms.append(float4x4::from_loc_eul_scale({0, 0, 0}, {1.0f, 0.0f, 2.0f}, {1, -2, 1}));
+  transforms.append(float4x4::from_loc_eul_scale({0, 0, 0}, {0.0f, 0.5f, 0.0f}, {-1, -1, -1}));
+  std::unique_ptr<CompactInstanceTransforms> compact = CompactInstanceTransforms::from_transforms(
+      transforms);
+  ASSERT_TRUE(compact);
+  for (const int i : transforms.index_range()) {
+    expect_transforms_near(compact->transform(i), transforms[i], 2.0f);
+  }
+}
+
+TEST(compact_instance_transforms, unsupported_transforms)
+{
+  /* Shear can't be represented by a rotation and a scale. */
+  float4x4 shear = float4x4::identity();
+  shear.values[1][0] = 0.5f;
+  Vector<float4x4> transforms = random_transforms(10, 2.0f);
+  transforms.append(shear);
+  EXPECT_FALSE(CompactInstanceTransforms::from_transforms(transforms));
+
+  /* Neither can a zero scale. */
+  transforms.last() = float4x4::from_loc_eul_scale({0, 0, 0}, {0, 0, 0}, {1, 0, 1});
+  EXPECT_FALSE(CompactInstanceTransforms::from_transforms(transforms));
+
+  /* The component keeps its matrices when they can't be compacted. */
+  InstancesComponent instances;
+  const int handle = instances.add_reference(InstanceReference{GeometrySet()});
+  instances.add_instance(handle, float4x4::identity());
+  instances.add_instance(handle, shear);
+  EXPECT_FALSE(instances.compact_transforms());
+  EXPECT_EQ(instances.compact_transforms_for_read(), nullptr);
+  EXPECT_EQ(instances.copy_with_compact_transforms(), nullptr);
+}
+
+TEST(compact_instance_transforms, instances_component)
+{
+  const Vector<float4x4> transforms = random_transforms(100, 2.0f);
+  GeometrySet geometry;
+  InstancesComponent &instances = geometry.get_component_for_write<InstancesComponent>();
+  const int handle = instances.add_reference(InstanceReference{GeometrySet()});
+  for (const float4x4 &transform : transforms) {
+    instances.add_instance(handle, transform);
+  }
+
+  /* Compacting a shared component copy leaves the original unchanged. */
+  const InstancesComponent &instances_for_read = instances;
+  InstancesComponent *compact_instances = instances_for_read.copy_with_compact_transforms();
+  ASSERT_NE(compact_instances, nullptr);
+  EXPECT_EQ(instances.compact_transforms_for_read(), nullptr);
+  EXPECT_EQ(compact_instances->instances_num(), transforms.size());
+  const VArray<float4x4> compact_transforms = std::as_const(*compact_instances)
+                                                  .instance_transforms();
+  EXPECT_FALSE(compact_transforms.is_span());
+  for (const int i : transforms.index_range()) {
+    expect_transforms_near(compact_transforms[i], transforms[i], 2.0f);
+    expect_transforms_near(compact_instances->instance_transform(i), transforms[i], 2.0f);
+  }
+  compact_instances->user_remove();
+
+  /* Positions are stored without loss. */
+  EXPECT_TRUE(instances.compact_transforms());
+  ASSERT_NE(instances.compact_transforms_for_read(), nullptr);
+  const VArray<float3> positions = instances.attribute_get_for_read<float3>(
+      "position", ATTR_DOMAIN_INSTANCE, float3(0));
+  for (const int i : transforms.index_range()) {
+    EXPECT_EQ(positions[i], transforms[i].translation());
+  }
+
+  /* Write access expands the transforms again. */
+  MutableSpan<float4x4> expanded_transforms = instances.instance_transforms();
+  EXPECT_EQ(instances.compact_transforms_for_read(), nullptr);
+  ASSERT_EQ(expanded_transforms.size(), transforms.size());
+  for (const int i : transforms.index_range()) {
+    expect_transforms_near(expanded_transforms[i], transforms[i], 2.0f);
+  }
+}
+
+}  // namespace blender::bke::tests
@@ -14,6 +14,8 @@
 #include "BKE_geometry_set.hh"
 #include "BKE_lib_id.h"
 #include "BKE_mesh.h"
+#include "BKE_mesh_mapping.h"
+#include "BKE_mesh_runtime.h"
 
 #include "attribute_access_intern.hh"
 
@@ -191,251 +193,274 @@ int MeshComponent::attribute_domain_num(const AttributeDomain domain) const
 
 namespace blender::bke {
 
-template<typename T>
-static void adapt_mesh_domain_corner_to_point_impl(const Mesh &mesh,
-                                                   const VArray<T> &old_values,
-                                                   MutableSpan<T> r_values)
-{
-  BLI_assert(r_values.size() == mesh.totvert);
-  attribute_math::DefaultMixer<T> mixer(r_values);
-
-  for (const int loop_index : IndexRange(mesh.totloop)) {
-    const T value = old_values[loop_index];
-    const MLoop &loop = mesh.mloop[loop_index];
-    const int point_index = loop.v;
-    mixer.mix_in(point_index, value);
-  }
-  mixer.finalize();
-}
+/**
+ * A virtual array that computes each of its elements by gathering values from another domain of
+ * the mesh with \a GatherFn, which is called with the source values (a span when possible) and
+ * the index. Only the requested indices are computed, on multiple threads for larger masks, so
+ * e.g. evaluating a field on a selection doesn't interpolate the whole domain.
+ */
+template<typename T, typename GatherFn>
+class VArrayImpl_For_MeshDomainGather final : public VArrayImpl<T> {
+ private:
+  VArray<T> src_;
+  GatherFn gather_fn_;
 
-/* A vertex is selected if all connected face corners were selected and it is not loose. */
-template<>
-void adapt_mesh_domain_corner_to_point_impl(const Mesh &mesh,
-                                            const VArray<bool> &old_values,
-                                            MutableSpan<bool> r_values)
-{
-  BLI_assert(r_values.size() == mesh.totvert);
-  Array<bool> loose_verts(mesh.totvert, true);
+ public:
+  VArrayImpl_For_MeshDomainGather(const int64_t size, VArray<T> src, GatherFn gather_fn)
+      : VArrayImpl<T>(size), src_(std::move(src)), gather_fn_(std::move(gather_fn))
+  {
+  }
 
-  r_values.fill(true);
-  for (const int loop_index : IndexRange(mesh.totloop)) {
-    const MLoop &loop = mesh.mloop[loop_index];
-    const int point_index = loop.v;
+ private:
+  T get(const int64_t index) const override
+  {
+    return gather_fn_(src_, index);
+  }
 
-    loose_verts[point_index] = false;
-    if (!old_values[loop_index]) {
-      r_values[point_index] = false;
+  /** Call \a fn with the position in \a mask, the index and the source values. */
+  template<typename Fn> void foreach_gather(const IndexMask mask, const Fn &fn) const
+  {
+    const auto gather_all = [&](const auto &src) {
+      threading::parallel_for(mask.index_range(), 2048, [&](const IndexRange range) {
+        for (const int64_t i : range) {
+          fn(i, mask[i], gather_fn_(src, mask[i]));
+        }
+      });
+    };
+    if (src_.is_span()) {
+      gather_all(src_.get_internal_span());
+    }
+    else {
+      gather_all(src_);
     }
   }
 
-  /* Deselect loose vertices without corners that are still selected from the 'true' default. */
-  for (const int vert_index : IndexRange(mesh.totvert)) {
-    if (loose_verts[vert_index]) {
-      r_values[vert_index] = false;
-    }
+  void materialize(IndexMask mask, MutableSpan<T> r_span) const override
+  {
+    T *dst = r_span.data();
+    this->foreach_gather(mask, [&](int64_t /*i*/, const int64_t index, T value) {
+      dst[index] = std::move(value);
+    });
+  }
+
+  void materialize_to_uninitialized(IndexMask mask, MutableSpan<T> r_span) const override
+  {
+    T *dst = r_span.data();
+    this->foreach_gather(mask, [&](int64_t /*i*/, const int64_t index, T value) {
+      new (dst + index) T(std::move(value));
+    });
+  }
+
+  void materialize_compressed(IndexMask mask, MutableSpan<T> r_span) const override
+  {
+    BLI_assert(mask.size() == r_span.size());
+    T *dst = r_span.data();
+    this->foreach_gather(mask, [&](const int64_t i, int64_t /*index*/, T value) {
+      dst[i] = std::move(value);
+    });
+  }
+
+  void materialize_compressed_to_uninitialized(IndexMask mask,
+                                               MutableSpan<T> r_span) const override
+  {
+    BLI_assert(mask.size() == r_span.size());
+    T *dst = r_span.data();
+    this->foreach_gather(mask, [&](const int64_t i, int64_t /*index*/, T value) {
+      new (dst + i) T(std::move(value));
+    });
   }
+};
+
+/**
+ * Gather the values of a new domain lazily, for the adaptations which only read a few values per
+ * element through the arrays of the mesh itself. The gather function must not use the topology
+ * maps in the runtime cache of the mesh, which can be freed while the result is still used.
+ */
+template<typename T, typename GatherFn>
+static VArray<T> make_lazy_gather_varray(const int64_t size, VArray<T> src, GatherFn gather_fn)
+{
+  return VArray<T>::template For<VArrayImpl_For_MeshDomainGather<T, GatherFn>>(
+      size, std::move(src), std::move(gather_fn));
 }
 
-static GVArray adapt_mesh_domain_corner_to_point(const Mesh &mesh, const GVArray &varray)
+/**
+ * Compute the values of a new domain like #make_lazy_gather_varray, but right away. Used for the
+ * adaptations which average values found with the cached topology maps of the mesh.
+ */
+template<typename T, typename GatherFn>
+static VArray<T> make_gather_varray(const int64_t size, VArray<T> src, GatherFn gather_fn)
 {
-  GVArray new_varray;
-  attribute_math::convert_to_static_type(varray.type(), [&](auto dummy) {
-    using T = decltype(dummy);
-    if constexpr (!std::is_void_v<attribute_math::DefaultMixer<T>>) {
-      /* We compute all interpolated values at once, because for this interpolation, one has to
-       * iterate over all loops anyway. */
-      Array<T> values(mesh.totvert);
-      adapt_mesh_domain_corner_to_point_impl<T>(mesh, varray.typed<T>(), values);
-      new_varray = VArray<T>::ForContainer(std::move(values));
-    }
-  });
-  return new_varray;
+  Array<T> values(size);
+  make_lazy_gather_varray<T>(size, std::move(src), std::move(gather_fn)).materialize(values);
+  return VArray<T>::ForContainer(std::move(values));
 }
 
 /**
- * Each corner's value is simply a copy of the value at its vertex.
+ * Mix all values passed to the callback of \a foreach_value, with the same result as
+ * #attribute_math::DefaultMixer for a single element. Float vector types are summed directly.
  */
-static GVArray adapt_mesh_domain_point_to_corner(const Mesh &mesh, const GVArray &varray)
+template<typename T, typename ForeachFn> static T mix_values(const ForeachFn &foreach_value)
 {
-  GVArray new_varray;
-  attribute_math::convert_to_static_type(varray.type(), [&](auto dummy) {
-    using T = decltype(dummy);
-    new_varray = VArray<T>::ForFunc(mesh.totloop,
-                                    [&mesh, varray = varray.typed<T>()](const int64_t loop_index) {
-                                      const int vertex_index = mesh.mloop[loop_index].v;
-                                      return varray[vertex_index];
-                                    });
+  if constexpr (std::is_same_v<T, float> || std::is_same_v<T, float2> ||
+                std::is_same_v<T, float3>) {
+    T sum{};
+    int count = 0;
+    foreach_value([&](const T &value) {
+      sum += value;
+      count++;
+    });
+    return count == 0 ? T{} : sum * (1.0f / count);
+  }
+  else {
+    T result;
+    attribute_math::DefaultMixer<T> mixer({&result, 1});
+    foreach_value([&](const T &value) { mixer.mix_in(0, value); });
+    mixer.finalize();
+    return result;
+  }
+}
+
+/** Mix the values of \a src at \a indices. */
+template<typename T, typename Src> static T mix_indices(const Src &src, const Span<int> indices)
+{
+  return mix_values<T>([&](const auto &fn) {
+    for (const int index : indices) {
+      fn(src[index]);
+    }
   });
-  return new_varray;
 }
 
-static GVArray adapt_mesh_domain_corner_to_face(const Mesh &mesh, const GVArray &varray)
+/**
+ * Call \a fn with a dummy value and the typed values if the type can be mixed, and return its
+ * result as generic virtual array.
+ */
+template<typename Fn> static GVArray adapt_for_mixable_type(const GVArray &varray, const Fn &fn)
 {
   GVArray new_varray;
   attribute_math::convert_to_static_type(varray.type(), [&](auto dummy) {
     using T = decltype(dummy);
     if constexpr (!std::is_void_v<attribute_math::DefaultMixer<T>>) {
-      if constexpr (std::is_same_v<T, bool>) {
-        new_varray = VArray<T>::ForFunc(
-            mesh.totpoly, [&mesh, varray = varray.typed<bool>()](const int face_index) {
-              /* A face is selected if all of its corners were selected. */
-              const MPoly &poly = mesh.mpoly[face_index];
-              for (const int loop_index : IndexRange(poly.loopstart, poly.totloop)) {
-                if (!varray[loop_index]) {
-                  return false;
-                }
-              }
-              return true;
-            });
-      }
-      else {
-        new_varray = VArray<T>::ForFunc(
-            mesh.totpoly, [&mesh, varray = varray.typed<T>()](const int face_index) {
-              T return_value;
-              attribute_math::DefaultMixer<T> mixer({&return_value, 1});
-              const MPoly &poly = mesh.mpoly[face_index];
-              for (const int loop_index : IndexRange(poly.loopstart, poly.totloop)) {
-                const T value = varray[loop_index];
-                mixer.mix_in(0, value);
-              }
-              mixer.finalize();
-              return return_value;
-            });
-      }
+      new_varray = fn(dummy, varray.typed<T>());
     }
   });
   return new_varray;
 }
 
-template<typename T>
-static void adapt_mesh_domain_corner_to_edge_impl(const Mesh &mesh,
-                                                  const VArray<T> &old_values,
-                                                  MutableSpan<T> r_values)
-{
-  BLI_assert(r_values.size() == mesh.totedge);
-  attribute_math::DefaultMixer<T> mixer(r_values);
-
-  for (const int poly_index : IndexRange(mesh.totpoly)) {
-    const MPoly &poly = mesh.mpoly[poly_index];
-
-    /* For every edge, mix values from the two adjacent corners (the current and next corner). */
-    for (const int loop_index : IndexRange(poly.loopstart, poly.totloop)) {
-      const int loop_index_next = (loop_index + 1) % poly.totloop;
-      const MLoop &loop = mesh.mloop[loop_index];
-      const int edge_index = loop.e;
-      mixer.mix_in(edge_index, old_values[loop_index]);
-      mixer.mix_in(edge_index, old_values[loop_index_next]);
-    }
-  }
-
-  mixer.finalize();
-}
-
-/* An edge is selected if all corners on adjacent faces were selected. */
-template<>
-void adapt_mesh_domain_corner_to_edge_impl(const Mesh &mesh,
-                                           const VArray<bool> &old_values,
-                                           MutableSpan<bool> r_values)
+static GVArray adapt_mesh_domain_corner_to_point(const Mesh &mesh, const GVArray &varray)
 {
-  BLI_assert(r_values.size() == mesh.totedge);
-
-  /* It may be possible to rely on the #ME_LOOSEEDGE flag, but that seems error-prone. */
-  Array<bool> loose_edges(mesh.totedge, true);
-
-  r_values.fill(true);
-  for (const int poly_index : IndexRange(mesh.totpoly)) {
-    const MPoly &poly = mesh.mpoly[poly_index];
-
-    for (const int loop_index : IndexRange(poly.loopstart, poly.totloop)) {
-      const int loop_index_next = (loop_index == poly.totloop) ? poly.loopstart : (loop_index + 1);
-      const MLoop &loop = mesh.mloop[loop_index];
-      const int edge_index = loop.e;
-      loose_edges[edge_index] = false;
-
-      if (!old_values[loop_index] || !old_values[loop_index_next]) {
-        r_values[edge_index] = false;
-      }
-    }
-  }
-
-  /* Deselect loose edges without corners that are still selected from the 'true' default. */
-  threading::parallel_for(IndexRange(mesh.totedge), 2048, [&](const IndexRange range) {
-    for (const int edge_index : range) {
-      if (loose_edges[edge_index]) {
-        r_values[edge_index] = false;
-      }
-    }
+  const MeshTopologyMap &vert_loops = *BKE_mesh_runtime_vert_loop_map_ensure(&mesh);
+  return adapt_for_mixable_type(varray, [&](auto dummy, VArray<decltype(dummy)> src) {
+    using T = decltype(dummy);
+    return make_gather_varray<T>(
+        mesh.totvert, src, [&vert_loops](const auto &src, const int64_t vert) {
+          const Span<int> loops = mesh_topology::map_lookup(vert_loops, vert);
+          if constexpr (std::is_same_v<T, bool>) {
+            /* A vertex is selected if all connected face corners were selected and it is not
+             * loose. */
+            return !loops.is_empty() && std::all_of(loops.begin(), loops.end(), [&](int loop) {
+              return bool(src[loop]);
+            });
+          }
+          else {
+            return mix_indices<T>(src, loops);
+          }
+        });
   });
 }
 
-static GVArray adapt_mesh_domain_corner_to_edge(const Mesh &mesh, const GVArray &varray)
+/**
+ * Each corner's value is simply a copy of the value at its vertex.
+ */
+static GVArray adapt_mesh_domain_point_to_corner(const Mesh &mesh, const GVArray &varray)
 {
   GVArray new_varray;
   attribute_math::convert_to_static_type(varray.type(), [&](auto dummy) {
     using T = decltype(dummy);
-    if constexpr (!std::is_void_v<attribute_math::DefaultMixer<T>>) {
-      Array<T> values(mesh.totedge);
-      adapt_mesh_domain_corner_to_edge_impl<T>(mesh, varray.typed<T>(), values);
-      new_varray = VArray<T>::ForContainer(std::move(values));
-    }
+    new_varray = make_lazy_gather_varray<T>(
+        mesh.totloop, varray.typed<T>(), [&mesh](const auto &src, const int64_t loop_index) {
+          return T(src[mesh.mloop[loop_index].v]);
+        });
   });
   return new_varray;
 }
 
-template<typename T>
-void adapt_mesh_domain_face_to_point_impl(const Mesh &mesh,
-                                          const VArray<T> &old_values,
-                                          MutableSpan<T> r_values)
+static GVArray adapt_mesh_domain_corner_to_face(const Mesh &mesh, const GVArray &varray)
 {
-  BLI_assert(r_values.size() == mesh.totvert);
-  attribute_math::DefaultMixer<T> mixer(r_values);
-
-  for (const int poly_index : IndexRange(mesh.totpoly)) {
-    const MPoly &poly = mesh.mpoly[poly_index];
-    const T value = old_values[poly_index];
-    for (const int loop_index : IndexRange(poly.loopstart, poly.totloop)) {
-      const MLoop &loop = mesh.mloop[loop_index];
-      const int point_index = loop.v;
-      mixer.mix_in(point_index, value);
-    }
-  }
-
-  mixer.finalize();
+  return adapt_for_mixable_type(varray, [&](auto dummy, VArray<decltype(dummy)> src) {
+    using T = decltype(dummy);
+    return make_lazy_gather_varray<T>(
+        mesh.totpoly, src, [&mesh](const auto &src, const int64_t face_index) {
+          const MPoly &poly = mesh.mpoly[face_index];
+          const IndexRange loops(poly.loopstart, poly.totloop);
+          if constexpr (std::is_same_v<T, bool>) {
+            /* A face is selected if all of its corners were selected. */
+            return std::all_of(
+                loops.begin(), loops.end(), [&](const int64_t loop) { return bool(src[loop]); });
+          }
+          else {
+            return mix_values<T>([&](const auto &fn) {
+              for (const int64_t loop_index : loops) {
+                fn(src[loop_index]);
+              }
+            });
+          }
+        });
+  });
 }
 
-/* A vertex is selected if any of the connected faces were selected. */
-template<>
-void adapt_mesh_domain_face_to_point_impl(const Mesh &mesh,
-                                          const VArray<bool> &old_values,
-                                          MutableSpan<bool> r_values)
+static GVArray adapt_mesh_domain_corner_to_edge(const Mesh &mesh, const GVArray &varray)
 {
-  BLI_assert(r_values.size() == mesh.totvert);
-
-  r_values.fill(false);
-  for (const int poly_index : IndexRange(mesh.totpoly)) {
-    const MPoly &poly = mesh.mpoly[poly_index];
-    if (old_values[poly_index]) {
-      for (const int loop_index : IndexRange(poly.loopstart, poly.totloop)) {
-        const MLoop &loop = mesh.mloop[loop_index];
-        const int vert_index = loop.v;
-        r_values[vert_index] = true;
-      }
-    }
-  }
+  const MeshTopologyMap &edge_polys = *BKE_mesh_runtime_edge_poly_map_ensure(&mesh);
+  return adapt_for_mixable_type(varray, [&](auto dummy, VArray<decltype(dummy)> src) {
+    using T = decltype(dummy);
+    return make_gather_varray<T>(
+        mesh.totedge, src, [&mesh, &edge_polys](const auto &src, const int64_t edge_index) {
+          const Span<int> polys = mesh_topology::map_lookup(edge_polys, edge_index);
+          /* Call the function for the two corners of the edge on every adjacent face. */
+          const auto foreach_edge_corner_value = [&](const auto &fn) {
+            for (const int poly_index : polys) {
+              const MPoly &poly = mesh.mpoly[poly_index];
+              for (const int i : IndexRange(poly.totloop)) {
+                if (mesh.mloop[poly.loopstart + i].e == edge_index) {
+                  fn(src[poly.loopstart + i]);
+                  fn(src[poly.loopstart + (i + 1) % poly.totloop]);
+                }
+              }
+            }
+          };
+          if constexpr (std::is_same_v<T, bool>) {
+            /* An edge is selected if all corners on adjacent faces were selected. It may be
+             * possible to rely on the #ME_LOOSEEDGE flag for loose edges, but that seems
+             * error-prone. */
+            bool selected = !polys.is_empty();
+            foreach_edge_corner_value([&](const bool value) { selected &= value; });
+            return selected;
+          }
+          else {
+            return mix_values<T>(foreach_edge_corner_value);
+          }
+        });
+  });
 }
 
 static GVArray adapt_mesh_domain_face_to_point(const Mesh &mesh, const GVArray &varray)
 {
-  GVArray new_varray;
-  attribute_math::convert_to_static_type(varray.type(), [&](auto dummy) {
+  const MeshTopologyMap &vert_polys = *BKE_mesh_runtime_vert_poly_map_ensure(&mesh);
+  return adapt_for_mixable_type(varray, [&](auto dummy, VArray<decltype(dummy)> src) {
     using T = decltype(dummy);
-    if constexpr (!std::is_void_v<attribute_math::DefaultMixer<T>>) {
-      Array<T> values(mesh.totvert);
-      adapt_mesh_domain_face_to_point_impl<T>(mesh, varray.typed<T>(), values);
-      new_varray = VArray<T>::ForContainer(std::move(values));
-    }
+    return make_gather_varray<T>(
+        mesh.totvert, src, [&vert_polys](const auto &src, const int64_t vert) {
+          const Span<int> polys = mesh_topology::map_lookup(vert_polys, vert);
+          if constexpr (std::is_same_v<T, bool>) {
+            /* A vertex is selected if any of the connected faces were selected. */
+            return std::any_of(
+                polys.begin(), polys.end(), [&](const int poly) { return bool(src[poly]); });
+          }
+          else {
+            return mix_indices<T>(src, polys);
+          }
+        });
   });
-  return new_varray;
 }
 
 /* Each corner's value is simply a copy of the value at its face. */
@@ -469,129 +494,69 @@ static GVArray adapt_mesh_domain_face_to_corner(const Mesh &mesh, const GVArray
   return new_varray;
 }
 
-template<typename T>
-void adapt_mesh_domain_face_to_edge_impl(const Mesh &mesh,
-                                         const VArray<T> &old_values,
-                                         MutableSpan<T> r_values)
-{
-  BLI_assert(r_values.size() == mesh.totedge);
-  attribute_math::DefaultMixer<T> mixer(r_values);
-
-  for (const int poly_index : IndexRange(mesh.totpoly)) {
-    const MPoly &poly = mesh.mpoly[poly_index];
-    const T value = old_values[poly_index];
-    for (const int loop_index : IndexRange(poly.loopstart, poly.totloop)) {
-      const MLoop &loop = mesh.mloop[loop_index];
-      mixer.mix_in(loop.e, value);
-    }
-  }
-  mixer.finalize();
-}
-
-/* An edge is selected if any connected face was selected. */
-template<>
-void adapt_mesh_domain_face_to_edge_impl(const Mesh &mesh,
-                                         const VArray<bool> &old_values,
-                                         MutableSpan<bool> r_values)
-{
-  BLI_assert(r_values.size() == mesh.totedge);
-
-  r_values.fill(false);
-  for (const int poly_index : IndexRange(mesh.totpoly)) {
-    const MPoly &poly = mesh.mpoly[poly_index];
-    if (old_values[poly_index]) {
-      for (const int loop_index : IndexRange(poly.loopstart, poly.totloop)) {
-        const MLoop &loop = mesh.mloop[loop_index];
-        const int edge_index = loop.e;
-        r_values[edge_index] = true;
-      }
-    }
-  }
-}
-
 static GVArray adapt_mesh_domain_face_to_edge(const Mesh &mesh, const GVArray &varray)
 {
-  GVArray new_varray;
-  attribute_math::convert_to_static_type(varray.type(), [&](auto dummy) {
+  const MeshTopologyMap &edge_polys = *BKE_mesh_runtime_edge_poly_map_ensure(&mesh);
+  return adapt_for_mixable_type(varray, [&](auto dummy, VArray<decltype(dummy)> src) {
     using T = decltype(dummy);
-    if constexpr (!std::is_void_v<attribute_math::DefaultMixer<T>>) {
-      Array<T> values(mesh.totedge);
-      adapt_mesh_domain_face_to_edge_impl<T>(mesh, varray.typed<T>(), values);
-      new_varray = VArray<T>::ForContainer(std::move(values));
-    }
+    return make_gather_varray<T>(
+        mesh.totedge, src, [&edge_polys](const auto &src, const int64_t edge) {
+          const Span<int> polys = mesh_topology::map_lookup(edge_polys, edge);
+          if constexpr (std::is_same_v<T, bool>) {
+            /* An edge is selected if any connected face was selected. */
+            return std::any_of(
+                polys.begin(), polys.end(), [&](const int poly) { return bool(src[poly]); });
+          }
+          else {
+            return mix_indices<T>(src, polys);
+          }
+        });
   });
-  return new_varray;
 }
 
 static GVArray adapt_mesh_domain_point_to_face(const Mesh &mesh, const GVArray &varray)
 {
-  GVArray new_varray;
-  attribute_math::convert_to_static_type(varray.type(), [&](auto dummy) {
+  return adapt_for_mixable_type(varray, [&](auto dummy, VArray<decltype(dummy)> src) {
     using T = decltype(dummy);
-    if constexpr (!std::is_void_v<attribute_math::DefaultMixer<T>>) {
-      if constexpr (std::is_same_v<T, bool>) {
-        new_varray = VArray<T>::ForFunc(
-            mesh.totpoly, [&mesh, varray = varray.typed<bool>()](const int face_index) {
-              /* A face is selected if all of its vertices were selected. */
-              const MPoly &poly = mesh.mpoly[face_index];
-              for (const int loop_index : IndexRange(poly.loopstart, poly.totloop)) {
-                const MLoop &loop = mesh.mloop[loop_index];
-                if (!varray[loop.v]) {
-                  return false;
-                }
-              }
-              return true;
-            });
-      }
-      else {
-        new_varray = VArray<T>::ForFunc(
-            mesh.totpoly, [&mesh, varray = varray.typed<T>()](const int face_index) {
-              T return_value;
-              attribute_math::DefaultMixer<T> mixer({&return_value, 1});
-              const MPoly &poly = mesh.mpoly[face_index];
-              for (const int loop_index : IndexRange(poly.loopstart, poly.totloop)) {
-                const MLoop &loop = mesh.mloop[loop_index];
-                const T value = varray[loop.v];
-                mixer.mix_in(0, value);
+    return make_lazy_gather_varray<T>(
+        mesh.totpoly, src, [&mesh](const auto &src, const int64_t face_index) {
+          const MPoly &poly = mesh.mpoly[face_index];
+          const Span<MLoop> loops(&mesh.mloop[poly.loopstart], poly.totloop);
+          if constexpr (std::is_same_v<T, bool>) {
+            /* A face is selected if all of its vertices were selected. */
+            return std::all_of(
+                loops.begin(), loops.end(), [&](const MLoop &loop) { return bool(src[loop.v]); });
+          }
+          else {
+            return mix_values<T>([&](const auto &fn) {
+              for (const MLoop &loop : loops) {
+                fn(src[loop.v]);
               }
-              mixer.finalize();
-              return return_value;
             });
-      }
-    }
+          }
+        });
   });
-  return new_varray;
 }
 
 static GVArray adapt_mesh_domain_point_to_edge(const Mesh &mesh, const GVArray &varray)
 {
-  GVArray new_varray;
-  attribute_math::convert_to_static_type(varray.type(), [&](auto dummy) {
+  return adapt_for_mixable_type(varray, [&](auto dummy, VArray<decltype(dummy)> src) {
     using T = decltype(dummy);
-    if constexpr (!std::is_void_v<attribute_math::DefaultMixer<T>>) {
-      if constexpr (std::is_same_v<T, bool>) {
-        /* An edge is selected if both of its vertices were selected. */
-        new_varray = VArray<bool>::ForFunc(
-            mesh.totedge, [&mesh, varray = varray.typed<bool>()](const int edge_index) {
-              const MEdge &edge = mesh.medge[edge_index];
-              return varray[edge.v1] && varray[edge.v2];
+    return make_lazy_gather_varray<T>(
+        mesh.totedge, src, [&mesh](const auto &src, const int64_t edge_index) {
+          const MEdge &edge = mesh.medge[edge_index];
+          if constexpr (std::is_same_v<T, bool>) {
+            /* An edge is selected if both of its vertices were selected. */
+            return bool(src[edge.v1]) && bool(src[edge.v2]);
+          }
+          else {
+            return mix_values<T>([&](const auto &fn) {
+              fn(src[edge.v1]);
+              fn(src[edge.v2]);
             });
-      }
-      else {
-        new_varray = VArray<T>::ForFunc(
-            mesh.totedge, [&mesh, varray = varray.typed<T>()](const int edge_index) {
-              T return_value;
-              attribute_math::DefaultMixer<T> mixer({&return_value, 1});
-              const MEdge &edge = mesh.medge[edge_index];
-              mixer.mix_in(0, varray[edge.v1]);
-              mixer.mix_in(0, varray[edge.v2]);
-              mixer.finalize();
-              return return_value;
-            });
-      }
-    }
+          }
+        });
   });
-  return new_varray;
 }
 
 template<typename T>
@@ -600,45 +565,30 @@ void adapt_mesh_domain_edge_to_corner_impl(const Mesh &mesh,
                                            MutableSpan<T> r_values)
 {
   BLI_assert(r_values.size() == mesh.totloop);
-  attribute_math::DefaultMixer<T> mixer(r_values);
-
-  for (const int poly_index : IndexRange(mesh.totpoly)) {
-    const MPoly &poly = mesh.mpoly[poly_index];
-
-    /* For every corner, mix the values from the adjacent edges on the face. */
-    for (const int loop_index : IndexRange(poly.loopstart, poly.totloop)) {
-      const int loop_index_prev = loop_index - 1 + (loop_index == poly.loopstart) * poly.totloop;
-      const MLoop &loop = mesh.mloop[loop_index];
-      const MLoop &loop_prev = mesh.mloop[loop_index_prev];
-      mixer.mix_in(loop_index, old_values[loop.e]);
-      mixer.mix_in(loop_index, old_values[loop_prev.e]);
-    }
-  }
-
-  mixer.finalize();
-}
-
-/* A corner is selected if its two adjacent edges were selected. */
-template<>
-void adapt_mesh_domain_edge_to_corner_impl(const Mesh &mesh,
-                                           const VArray<bool> &old_values,
-                                           MutableSpan<bool> r_values)
-{
-  BLI_assert(r_values.size() == mesh.totloop);
 
-  r_values.fill(false);
+  threading::parallel_for(IndexRange(mesh.totpoly), 1024, [&](const IndexRange range) {
+    for (const int poly_index : range) {
+      const MPoly &poly = mesh.mpoly[poly_index];
 
-  for (const int poly_index : IndexRange(mesh.totpoly)) {
-    const MPoly &poly = mesh.mpoly[poly_index];
-    for (const int loop_index : IndexRange(poly.loopstart, poly.totloop)) {
-      const int loop_index_prev = loop_index - 1 + (loop_index == poly.loopstart) * poly.totloop;
-      const MLoop &loop = mesh.mloop[loop_index];
-      const MLoop &loop_prev = mesh.mloop[loop_index_prev];
-      if (old_values[loop.e] && old_values[loop_prev.e]) {
-        r_values[loop_index] = true;
+      /* For every corner, mix the values from the adjacent edges on the face. */
+      for (const int loop_index : IndexRange(poly.loopstart, poly.totloop)) {
+        const int loop_index_prev = loop_index - 1 +
+                                    (loop_index == poly.loopstart) * poly.totloop;
+        const MLoop &loop = mesh.mloop[loop_index];
+        const MLoop &loop_prev = mesh.mloop[loop_index_prev];
+        if constexpr (std::is_same_v<T, bool>) {
+          /* A corner is selected if its two adjacent edges were selected. */
+          r_values[loop_index] = old_values[loop.e] && old_values[loop_prev.e];
+        }
+        else {
+          r_values[loop_index] = mix_values<T>([&](const auto &fn) {
+            fn(old_values[loop.e]);
+            fn(old_values[loop_prev.e]);
+          });
+        }
       }
     }
-  }
+  });
 }
 
 static GVArray adapt_mesh_domain_edge_to_corner(const Mesh &mesh, const GVArray &varray)
@@ -655,94 +605,48 @@ static GVArray adapt_mesh_domain_edge_to_corner(const Mesh &mesh, const GVArray
   return new_varray;
 }
 
-template<typename T>
-static void adapt_mesh_domain_edge_to_point_impl(const Mesh &mesh,
-                                                 const VArray<T> &old_values,
-                                                 MutableSpan<T> r_values)
-{
-  BLI_assert(r_values.size() == mesh.totvert);
-  attribute_math::DefaultMixer<T> mixer(r_values);
-
-  for (const int edge_index : IndexRange(mesh.totedge)) {
-    const MEdge &edge = mesh.medge[edge_index];
-    const T value = old_values[edge_index];
-    mixer.mix_in(edge.v1, value);
-    mixer.mix_in(edge.v2, value);
-  }
-
-  mixer.finalize();
-}
-
-/* A vertex is selected if any connected edge was selected. */
-template<>
-void adapt_mesh_domain_edge_to_point_impl(const Mesh &mesh,
-                                          const VArray<bool> &old_values,
-                                          MutableSpan<bool> r_values)
-{
-  BLI_assert(r_values.size() == mesh.totvert);
-
-  r_values.fill(false);
-  for (const int edge_index : IndexRange(mesh.totedge)) {
-    const MEdge &edge = mesh.medge[edge_index];
-    if (old_values[edge_index]) {
-      r_values[edge.v1] = true;
-      r_values[edge.v2] = true;
-    }
-  }
-}
-
 static GVArray adapt_mesh_domain_edge_to_point(const Mesh &mesh, const GVArray &varray)
 {
-  GVArray new_varray;
-  attribute_math::convert_to_static_type(varray.type(), [&](auto dummy) {
+  const MeshTopologyMap &vert_edges = *BKE_mesh_runtime_vert_edge_map_ensure(&mesh);
+  return adapt_for_mixable_type(varray, [&](auto dummy, VArray<decltype(dummy)> src) {
     using T = decltype(dummy);
-    if constexpr (!std::is_void_v<attribute_math::DefaultMixer<T>>) {
-      Array<T> values(mesh.totvert);
-      adapt_mesh_domain_edge_to_point_impl<T>(mesh, varray.typed<T>(), values);
-      new_varray = VArray<T>::ForContainer(std::move(values));
-    }
+    return make_gather_varray<T>(
+        mesh.totvert, src, [&vert_edges](const auto &src, const int64_t vert) {
+          const Span<int> edges = mesh_topology::map_lookup(vert_edges, vert);
+          if constexpr (std::is_same_v<T, bool>) {
+            /* A vertex is selected if any connected edge was selected. */
+            return std::any_of(
+                edges.begin(), edges.end(), [&](const int edge) { return bool(src[edge]); });
+          }
+          else {
+            return mix_indices<T>(src, edges);
+          }
+        });
   });
-  return new_varray;
 }
 
 static GVArray adapt_mesh_domain_edge_to_face(const Mesh &mesh, const GVArray &varray)
 {
-  GVArray new_varray;
-  attribute_math::convert_to_static_type(varray.type(), [&](auto dummy) {
+  return adapt_for_mixable_type(varray, [&](auto dummy, VArray<decltype(dummy)> src) {
     using T = decltype(dummy);
-    if constexpr (!std::is_void_v<attribute_math::DefaultMixer<T>>) {
-      if constexpr (std::is_same_v<T, bool>) {
-        /* A face is selected if all of its edges are selected. */
-        new_varray = VArray<bool>::ForFunc(
-            mesh.totpoly, [&mesh, varray = varray.typed<T>()](const int face_index) {
-              const MPoly &poly = mesh.mpoly[face_index];
-              for (const int loop_index : IndexRange(poly.loopstart, poly.totloop)) {
-                const MLoop &loop = mesh.mloop[loop_index];
-                if (!varray[loop.e]) {
-                  return false;
-                }
-              }
-              return true;
-            });
-      }
-      else {
-        new_varray = VArray<T>::ForFunc(
-            mesh.totpoly, [&mesh, varray = varray.typed<T>()](const int face_index) {
-              T return_value;
-              attribute_math::DefaultMixer<T> mixer({&return_value, 1});
-              const MPoly &poly = mesh.mpoly[face_index];
-              for (const int loop_index : IndexRange(poly.loopstart, poly.totloop)) {
-                const MLoop &loop = mesh.mloop[loop_index];
-                const T value = varray[loop.e];
-                mixer.mix_in(0, value);
+    return make_lazy_gather_varray<T>(
+        mesh.totpoly, src, [&mesh](const auto &src, const int64_t face_index) {
+          const MPoly &poly = mesh.mpoly[face_index];
+          const Span<MLoop> loops(&mesh.mloop[poly.loopstart], poly.totloop);
+          if constexpr (std::is_same_v<T, bool>) {
+            /* A face is selected if all of its edges are selected. */
+            return std::all_of(
+                loops.begin(), loops.end(), [&](const MLoop &loop) { return bool(src[loop.e]); });
+          }
+          else {
+            return mix_values<T>([&](const auto &fn) {
+              for (const MLoop &loop : loops) {
+                fn(src[loop.e]);
               }
-              mixer.finalize();
-              return return_value;
             });
-      }
-    }
+          }
+        });
   });
-  return new_varray;
 }
 
 }  // namespace blender::bke
@@ -0,0 +1,247 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "testing/testing.h"
+
+#include "BLI_array.hh"
+#include "BLI_math_vec_types.hh"
+#include "BLI_math_vector.hh"
+#include "BLI_rand.hh"
+#include "BLI_timeit.hh"
+#include "BLI_vector.hh"
+
+#include "BKE_geometry_set.hh"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+#include "BKE_mesh_runtime.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "mesh_test_utils.hh"
+
+#define DO_PERF_TESTS 0
+
+namespace blender::bke::tests {
+
+class MeshDomainInterpolationTest : public MeshTest {
+};
+
+/** Create a grid of quads with edges, the last row of vertices is loose. */
+static Mesh *create_grid_with_loose_verts(const int verts_x, const int verts_y)
+{
+  GridMeshOptions options;
+  options.loose_rows = 1;
+  options.use_edges = true;
+  return create_grid_mesh(verts_x, verts_y, options);
+}
+
+TEST_F(MeshDomainInterpolationTest, corner_to_point_matches_average)
+{
+  Mesh *mesh = create_grid_with_loose_verts(10, 8);
+  MeshComponent component;
+  component.replace(mesh, GeometryOwnershipType::ReadOnly);
+
+  RandomNumberGenerator rng(0);
+  Array<float> corner_values(mesh->totloop);
+  for (float &value : corner_values) {
+    value = rng.get_float();
+  }
+
+  Array<float> expected_sum(mesh->totvert, 0.0f);
+  Array<int> expected_count(mesh->totvert, 0);
+  for (const int i : IndexRange(mesh->totloop)) {
+    expected_sum[mesh->mloop[i].v] += corner_values[i];
+    expected_count[mesh->mloop[i].v]++;
+  }
+
+  const VArray<float> point_values = component.attribute_try_adapt_domain<float>(
+      VArray<float>::ForSpan(corner_values), ATTR_DOMAIN_CORNER, ATTR_DOMAIN_POINT);
+  ASSERT_EQ(point_values.size(), mesh->totvert);
+  for (const int i : IndexRange(mesh->totvert)) {
+    const float expected = expected_count[i] ? expected_sum[i] / expected_count[i] : 0.0f;
+    EXPECT_NEAR(point_values[i], expected, 1e-6f);
+  }
+
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(MeshDomainInterpolationTest, selection_propagation)
+{
+  Mesh *mesh = create_grid_with_loose_verts(4, 4);
+  MeshComponent component;
+  component.replace(mesh, GeometryOwnershipType::ReadOnly);
+
+  /* Only select the first face. */
+  Array<bool> face_selection(mesh->totpoly, false);
+  face_selection[0] = true;
+  const VArray<bool> face_varray = VArray<bool>::ForSpan(face_selection);
+
+  const VArray<bool> point_selection = component.attribute_try_adapt_domain<bool>(
+      face_varray, ATTR_DOMAIN_FACE, ATTR_DOMAIN_POINT);
+  for (const int i : IndexRange(mesh->totvert)) {
+    EXPECT_EQ(point_selection[i], ELEM(i, 0, 1, 4, 5));
+  }
+
+  /* Loose vertices are never selected from corners. */
+  const VArray<bool> corner_selection = component.attribute_try_adapt_domain<bool>(
+      face_varray, ATTR_DOMAIN_FACE, ATTR_DOMAIN_CORNER);
+  const VArray<bool> point_from_corner = component.attribute_try_adapt_domain<bool>(
+      corner_selection, ATTR_DOMAIN_CORNER, ATTR_DOMAIN_POINT);
+  for (const int i : IndexRange(mesh->totvert)) {
+    EXPECT_EQ(point_from_corner[i], i == 0);
+  }
+
+  /* Edges of the selected face are selected when all their corners are. */
+  const VArray<bool> edge_selection = component.attribute_try_adapt_domain<bool>(
+      corner_selection, ATTR_DOMAIN_CORNER, ATTR_DOMAIN_EDGE);
+  for (const int i : IndexRange(mesh->totedge)) {
+    const MEdge &edge = mesh->medge[i];
+    EXPECT_EQ(edge_selection[i], (edge.v1 == 0 && ELEM(edge.v2, 1, 4)));
+  }
+
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(MeshDomainInterpolationTest, masked_materialize)
+{
+  Mesh *mesh = create_grid_with_loose_verts(20, 20);
+  MeshComponent component;
+  component.replace(mesh, GeometryOwnershipType::ReadOnly);
+
+  Array<float3> point_values(mesh->totvert);
+  for (const int i : point_values.index_range()) {
+    point_values[i] = mesh->mvert[i].co;
+  }
+  const VArray<float3> face_values = component.attribute_try_adapt_domain<float3>(
+      VArray<float3>::ForSpan(point_values), ATTR_DOMAIN_POINT, ATTR_DOMAIN_FACE);
+  /* The values are only computed for the masked faces. */
+  EXPECT_FALSE(face_values.is_span());
+
+  Vector<int64_t> indices;
+  for (int64_t i = 0; i < mesh->totpoly; i += 7) {
+    indices.append(i);
+  }
+  Array<float3> compressed(indices.size());
+  face_values.materialize_compressed(indices.as_span(), compressed);
+  for (const int i : indices.index_range()) {
+    const MPoly &poly = mesh->mpoly[indices[i]];
+    float3 center(0.0f);
+    for (const int loop : IndexRange(poly.loopstart, poly.totloop)) {
+      center += point_values[mesh->mloop[loop].v];
+    }
+    EXPECT_V3_NEAR(compressed[i], (center / 4.0f), 1e-5f);
+  }
+
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(MeshDomainInterpolationTest, result_outlives_topology_cache)
+{
+  Mesh *mesh = create_grid_with_loose_verts(6, 5);
+  MeshComponent component;
+  component.replace(mesh, GeometryOwnershipType::ReadOnly);
+
+  Array<float> face_values(mesh->totpoly);
+  for (const int i : face_values.index_range()) {
+    face_values[i] = float(i);
+  }
+  const VArray<float> face_varray = VArray<float>::ForSpan(face_values);
+  const VArray<float> point_values = component.attribute_try_adapt_domain<float>(
+      face_varray, ATTR_DOMAIN_FACE, ATTR_DOMAIN_POINT);
+  const VArray<float> edge_values = component.attribute_try_adapt_domain<float>(
+      face_varray, ATTR_DOMAIN_FACE, ATTR_DOMAIN_EDGE);
+  /* Chained adaptations use the result of the previous one. */
+  const VArray<float> point_from_edge_values = component.attribute_try_adapt_domain<float>(
+      edge_values, ATTR_DOMAIN_EDGE, ATTR_DOMAIN_POINT);
+
+  /* Free the topology maps while the adapted values are still used. */
+  BKE_mesh_runtime_clear_cache(mesh);
+
+  Array<float> point_values_after(mesh->totvert);
+  point_values.materialize(point_values_after);
+  Array<float> edge_values_after(mesh->totedge);
+  edge_values.materialize(edge_values_after);
+  Array<float> point_from_edge_values_after(mesh->totvert);
+  point_from_edge_values.materialize(point_from_edge_values_after);
+
+  /* Compare with adapting again, which builds the topology maps again. */
+  const VArray<float> point_values_rebuilt = component.attribute_try_adapt_domain<float>(
+      face_varray, ATTR_DOMAIN_FACE, ATTR_DOMAIN_POINT);
+  const VArray<float> edge_values_rebuilt = component.attribute_try_adapt_domain<float>(
+      face_varray, ATTR_DOMAIN_FACE, ATTR_DOMAIN_EDGE);
+  const VArray<float> point_from_edge_values_rebuilt =
+      component.attribute_try_adapt_domain<float>(
+          edge_values_rebuilt, ATTR_DOMAIN_EDGE, ATTR_DOMAIN_POINT);
+  for (const int i : IndexRange(mesh->totvert)) {
+    EXPECT_EQ(point_values_after[i], point_values_rebuilt[i]);
+    EXPECT_EQ(point_from_edge_values_after[i], point_from_edge_values_rebuilt[i]);
+  }
+  for (const int i : IndexRange(mesh->totedge)) {
+    EXPECT_EQ(edge_values_after[i], edge_values_rebuilt[i]);
+  }
+
+  BKE_id_free(nullptr, mesh);
+}
+
+#if DO_PERF_TESTS
+
+static void domain_interpolation_performance(const int verts_x, const int verts_y)
+{
+  Mesh *mesh = create_grid_with_loose_verts(verts_x, verts_y);
+  std::cout << "Mesh with " << mesh->totpoly << " faces\n";
+  MeshComponent component;
+  component.replace(mesh, GeometryOwnershipType::ReadOnly);
+
+  Array<float3> corner_values(mesh->totloop, float3(1.0f));
+  Array<float3> point_values(mesh->totvert);
+  const VArray<float3> corner_varray = VArray<float3>::ForSpan(corner_values);
+  for (int i = 0; i < 3; i++) {
+    SCOPED_TIMER("corner to point (topology map cached after first run)");
+    component
+        .attribute_try_adapt_domain<float3>(corner_varray, ATTR_DOMAIN_CORNER, ATTR_DOMAIN_POINT)
+        .materialize(point_values);
+  }
+  Array<float3> edge_values(mesh->totedge);
+  for (int i = 0; i < 3; i++) {
+    SCOPED_TIMER("corner to edge (topology map cached after first run)");
+    component
+        .attribute_try_adapt_domain<float3>(corner_varray, ATTR_DOMAIN_CORNER, ATTR_DOMAIN_EDGE)
+        .materialize(edge_values);
+  }
+  Array<float3> face_values(mesh->totpoly);
+  for (int i = 0; i < 3; i++) {
+    SCOPED_TIMER("point to face");
+    component
+        .attribute_try_adapt_domain<float3>(
+            VArray<float3>::ForSpan(point_values), ATTR_DOMAIN_POINT, ATTR_DOMAIN_FACE)
+        .materialize(face_values);
+  }
+  {
+    Array<int64_t> indices(mesh->totpoly / 100);
+    for (const int i : indices.index_range()) {
+      indices[i] = i * 100;
+    }
+    Array<float3> compressed(indices.size());
+    SCOPED_TIMER("point to face, 1% of faces");
+    component
+        .attribute_try_adapt_domain<float3>(
+            VArray<float3>::ForSpan(point_values), ATTR_DOMAIN_POINT, ATTR_DOMAIN_FACE)
+        .materialize_compressed(indices.as_span(), compressed);
+  }
+
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(MeshDomainInterpolationTest, performance_1M)
+{
+  domain_interpolation_performance(1000, 1000);
+}
+
+TEST_F(MeshDomainInterpolationTest, performance_10M)
+{
+  domain_interpolation_performance(3163, 3163);
+}
+
+#endif
+
+}  // namespace blender::bke::tests
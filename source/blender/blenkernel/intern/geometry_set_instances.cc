@@ -126,7 +126,7 @@ static void geometry_set_collect_recursive(const GeometrySet &geometry_set,
     const InstancesComponent &instances_component =
         *geometry_set.get_component_for_read<InstancesComponent>();
 
-    Span<float4x4> transforms = instances_component.instance_transforms();
+    const VArray<float4x4> transforms = instances_component.instance_transforms();
     Span<int> handles = instances_component.instance_reference_handles();
     Span<InstanceReference> references = instances_component.references();
     for (const int i : transforms.index_range()) {
@@ -4,112 +4,107 @@
  * \ingroup bke
  */
 
+#include <algorithm>
+
 #include "DNA_mesh_types.h"
 #include "DNA_meshdata_types.h"
 #include "DNA_object_types.h"
 
-#include "BLI_map.hh"
+#include "BLI_array.hh"
 #include "BLI_task.hh"
-#include "BLI_threads.h"
-#include "BLI_timeit.hh"
 
 #include "BKE_customdata.h"
 #include "BKE_mesh.h"
 
-namespace blender::bke::calc_edges {
-
-/** This is used to uniquely identify edges in a hash map. */
-struct OrderedEdge {
-  int v_low, v_high;
+#include "atomic_ops.h"
 
-  OrderedEdge(const int v1, const int v2)
-  {
-    if (v1 < v2) {
-      v_low = v1;
-      v_high = v2;
-    }
-    else {
-      v_low = v2;
-      v_high = v1;
-    }
-  }
+namespace blender::bke::calc_edges {
 
-  OrderedEdge(const uint v1, const uint v2)
-      : OrderedEdge(static_cast<int>(v1), static_cast<int>(v2))
-  {
-  }
+/** Stored in the lower bits of an edge key when the edge does not exist yet. */
+static constexpr uint32_t NEW_EDGE = UINT32_MAX;
 
-  uint64_t hash() const
-  {
-    return (this->v_low << 8) ^ this->v_high;
-  }
+/**
+ * Every edge is stored in the bucket of its lower vertex as a single 64 bit key. The higher
+ * vertex is stored in the upper bits, so that sorting a bucket groups duplicate edges. The index
+ * of the original edge is stored in the lower bits, so that existing edges are sorted before
+ * the new edges connecting the same vertices and are preferred when de-duplicating.
+ */
+static uint64_t edge_key(const uint v_high, const uint32_t orig_edge)
+{
+  return (uint64_t(v_high) << 32) | orig_edge;
+}
 
-  /** Return a hash value that is likely to be different in the low bits from the normal `hash()`
-   * function. This is necessary to avoid collisions in #BKE_mesh_calc_edges. */
-  uint64_t hash2() const
-  {
-    return this->v_low;
-  }
+static uint edge_key_v_high(const uint64_t key)
+{
+  return uint(key >> 32);
+}
 
-  friend bool operator==(const OrderedEdge &e1, const OrderedEdge &e2)
-  {
-    BLI_assert(e1.v_low < e1.v_high);
-    BLI_assert(e2.v_low < e2.v_high);
-    return e1.v_low == e2.v_low && e1.v_high == e2.v_high;
-  }
-};
-
-/* The map first contains an edge pointer and later an index. */
-union OrigEdgeOrIndex {
-  const MEdge *original_edge;
-  int index;
-};
-using EdgeMap = Map<OrderedEdge, OrigEdgeOrIndex>;
-
-static void reserve_hash_maps(const Mesh *mesh,
-                              const bool keep_existing_edges,
-                              MutableSpan<EdgeMap> edge_maps)
+static uint32_t edge_key_orig_edge(const uint64_t key)
 {
-  const int totedge_guess = std::max(keep_existing_edges ? mesh->totedge : 0, mesh->totpoly * 2);
-  threading::parallel_for_each(
-      edge_maps, [&](EdgeMap &edge_map) { edge_map.reserve(totedge_guess / edge_maps.size()); });
+  return uint32_t(key & 0xffffffff);
 }
 
-static void add_existing_edges_to_hash_maps(Mesh *mesh,
-                                            MutableSpan<EdgeMap> edge_maps,
-                                            uint32_t parallel_mask)
+/**
+ * Invalid meshes (e.g. from importers) may reference vertices that do not exist. Make the
+ * buckets large enough for every referenced index instead of relying on `totvert`.
+ */
+static int get_buckets_num(const Mesh *mesh, const bool keep_existing_edges)
 {
-  /* Assume existing edges are valid. */
-  threading::parallel_for_each(edge_maps, [&](EdgeMap &edge_map) {
-    const int task_index = &edge_map - &edge_maps[0];
-    for (const MEdge &edge : Span(mesh->medge, mesh->totedge)) {
-      OrderedEdge ordered_edge{edge.v1, edge.v2};
-      /* Only add the edge when it belongs into this map. */
-      if (task_index == (parallel_mask & ordered_edge.hash2())) {
-        edge_map.add_new(ordered_edge, {&edge});
-      }
-    }
-  });
+  const Span<MLoop> loops{mesh->mloop, mesh->totloop};
+  const auto max_reduce = [](const uint a, const uint b) { return std::max(a, b); };
+  uint max_vert = threading::parallel_reduce(
+      loops.index_range(),
+      4096,
+      0u,
+      [&](const IndexRange range, uint max) {
+        for (const MLoop &loop : loops.slice(range)) {
+          max = std::max(max, loop.v);
+        }
+        return max;
+      },
+      max_reduce);
+  if (keep_existing_edges) {
+    const Span<MEdge> edges{mesh->medge, mesh->totedge};
+    max_vert = threading::parallel_reduce(
+        edges.index_range(),
+        4096,
+        max_vert,
+        [&](const IndexRange range, uint max) {
+          for (const MEdge &edge : edges.slice(range)) {
+            max = std::max({max, edge.v1, edge.v2});
+          }
+          return max;
+        },
+        max_reduce);
+  }
+  return std::max(mesh->totvert, int(max_vert) + 1);
 }
 
-static void add_polygon_edges_to_hash_maps(Mesh *mesh,
-                                           MutableSpan<EdgeMap> edge_maps,
-                                           uint32_t parallel_mask)
+/**
+ * Call \a fn for every existing edge (when they are kept) and for every polygon edge, from
+ * multiple threads. Existing edges are assumed to be valid.
+ */
+template<typename Fn>
+static void foreach_edge_to_add(const Mesh *mesh, const bool keep_existing_edges, const Fn &fn)
 {
+  if (keep_existing_edges) {
+    const Span<MEdge> edges{mesh->medge, mesh->totedge};
+    threading::parallel_for(edges.index_range(), 4096, [&](IndexRange range) {
+      for (const int i : range) {
+        fn(edges[i].v1, edges[i].v2, uint32_t(i));
+      }
+    });
+  }
   const Span<MLoop> loops{mesh->mloop, mesh->totloop};
-  threading::parallel_for_each(edge_maps, [&](EdgeMap &edge_map) {
-    const int task_index = &edge_map - &edge_maps[0];
-    for (const MPoly &poly : Span(mesh->mpoly, mesh->totpoly)) {
-      Span<MLoop> poly_loops = loops.slice(poly.loopstart, poly.totloop);
+  const Span<MPoly> polys{mesh->mpoly, mesh->totpoly};
+  threading::parallel_for(polys.index_range(), 1024, [&](IndexRange range) {
+    for (const MPoly &poly : polys.slice(range)) {
+      const Span<MLoop> poly_loops = loops.slice(poly.loopstart, poly.totloop);
       const MLoop *prev_loop = &poly_loops.last();
       for (const MLoop &next_loop : poly_loops) {
         /* Can only be the same when the mesh data is invalid. */
         if (prev_loop->v != next_loop.v) {
-          OrderedEdge ordered_edge{prev_loop->v, next_loop.v};
-          /* Only add the edge when it belongs into this map. */
-          if (task_index == (parallel_mask & ordered_edge.hash2())) {
-            edge_map.lookup_or_add(ordered_edge, {nullptr});
-          }
+          fn(prev_loop->v, next_loop.v, NEW_EDGE);
         }
         prev_loop = &next_loop;
       }
@@ -117,45 +112,107 @@ static void add_polygon_edges_to_hash_maps(Mesh *mesh,
   });
 }
 
-static void serialize_and_initialize_deduplicated_edges(MutableSpan<EdgeMap> edge_maps,
-                                                        MutableSpan<MEdge> new_edges,
-                                                        short new_edge_flag)
+/** Turn the sizes stored in \a counts into offsets, the total is stored in the last element. */
+static void accumulate_counts_to_offsets(MutableSpan<int> counts)
 {
-  /* All edges are distributed in the hash tables now. They have to be serialized into a single
-   * array below. To be able to parallelize this, we have to compute edge index offsets for each
-   * map. */
-  Array<int> edge_index_offsets(edge_maps.size());
-  edge_index_offsets[0] = 0;
-  for (const int i : IndexRange(edge_maps.size() - 1)) {
-    edge_index_offsets[i + 1] = edge_index_offsets[i] + edge_maps[i].size();
+  int offset = 0;
+  for (int &count : counts) {
+    const int size = count;
+    count = offset;
+    offset += size;
   }
+}
+
+/**
+ * Sort all edge keys into the buckets of their lower vertex. This is the first (and usually only
+ * necessary) pass of a radix sort, with the vertex index as the digit. The remaining keys in
+ * each bucket are few, so they are sorted with a comparison sort afterwards.
+ */
+static void sort_edge_keys_into_buckets(const Mesh *mesh,
+                                        const bool keep_existing_edges,
+                                        MutableSpan<int> bucket_offsets,
+                                        Array<uint64_t> &r_keys)
+{
+  bucket_offsets.fill(0);
+  foreach_edge_to_add(mesh, keep_existing_edges, [&](const uint v1, const uint v2, uint32_t) {
+    atomic_add_and_fetch_int32(&bucket_offsets[std::min(v1, v2)], 1);
+  });
+  accumulate_counts_to_offsets(bucket_offsets);
 
-  threading::parallel_for_each(edge_maps, [&](EdgeMap &edge_map) {
-    const int task_index = &edge_map - &edge_maps[0];
+  r_keys.reinitialize(bucket_offsets.last());
+  Array<int> bucket_fill(bucket_offsets.size() - 1, NoInitialization());
+  threading::parallel_for(bucket_fill.index_range(), 4096, [&](IndexRange range) {
+    bucket_fill.as_mutable_span().slice(range).copy_from(bucket_offsets.slice(range));
+  });
+  foreach_edge_to_add(
+      mesh, keep_existing_edges, [&](const uint v1, const uint v2, const uint32_t orig_edge) {
+        const uint v_low = std::min(v1, v2);
+        const int index = atomic_fetch_and_add_int32(&bucket_fill[v_low], 1);
+        r_keys[index] = edge_key(std::max(v1, v2), orig_edge);
+      });
+}
 
-    int new_edge_index = edge_index_offsets[task_index];
-    for (EdgeMap::MutableItem item : edge_map.items()) {
-      MEdge &new_edge = new_edges[new_edge_index];
-      const MEdge *orig_edge = item.value.original_edge;
-      if (orig_edge != nullptr) {
-        /* Copy values from original edge. */
-        new_edge = *orig_edge;
+/**
+ * Sort every bucket and move its unique keys to the front. The number of unique edges in each
+ * bucket is written to \a r_edge_offsets, which is then accumulated to the final edge indices.
+ */
+static void deduplicate_buckets(Span<int> bucket_offsets,
+                                MutableSpan<uint64_t> keys,
+                                MutableSpan<int> r_edge_offsets)
+{
+  threading::parallel_for(IndexRange(bucket_offsets.size() - 1), 1024, [&](IndexRange range) {
+    for (const int v : range) {
+      MutableSpan<uint64_t> bucket = keys.slice(bucket_offsets[v],
+                                                bucket_offsets[v + 1] - bucket_offsets[v]);
+      std::sort(bucket.begin(), bucket.end());
+      int unique_num = 0;
+      for (const uint64_t key : bucket) {
+        if (unique_num == 0 || edge_key_v_high(key) != edge_key_v_high(bucket[unique_num - 1])) {
+          bucket[unique_num] = key;
+          unique_num++;
+        }
       }
-      else {
-        /* Initialize new edge. */
-        new_edge.v1 = item.key.v_low;
-        new_edge.v2 = item.key.v_high;
-        new_edge.flag = new_edge_flag;
+      r_edge_offsets[v] = unique_num;
+    }
+  });
+  r_edge_offsets.last() = 0;
+  accumulate_counts_to_offsets(r_edge_offsets);
+}
+
+static void initialize_deduplicated_edges(const Mesh *mesh,
+                                          Span<int> bucket_offsets,
+                                          Span<uint64_t> keys,
+                                          Span<int> edge_offsets,
+                                          MutableSpan<MEdge> new_edges,
+                                          const short new_edge_flag)
+{
+  threading::parallel_for(IndexRange(edge_offsets.size() - 1), 1024, [&](IndexRange range) {
+    for (const int v : range) {
+      const int edge_start = edge_offsets[v];
+      const int edges_num = edge_offsets[v + 1] - edge_start;
+      const Span<uint64_t> bucket = keys.slice(bucket_offsets[v], edges_num);
+      for (const int i : IndexRange(edges_num)) {
+        MEdge &new_edge = new_edges[edge_start + i];
+        const uint32_t orig_edge = edge_key_orig_edge(bucket[i]);
+        if (orig_edge != NEW_EDGE) {
+          /* Copy values from original edge. */
+          new_edge = mesh->medge[orig_edge];
+        }
+        else {
+          /* Initialize new edge. */
+          new_edge.v1 = v;
+          new_edge.v2 = edge_key_v_high(bucket[i]);
+          new_edge.flag = new_edge_flag;
+        }
       }
-      item.value.index = new_edge_index;
-      new_edge_index++;
     }
   });
 }
 
 static void update_edge_indices_in_poly_loops(Mesh *mesh,
-                                              Span<EdgeMap> edge_maps,
-                                              uint32_t parallel_mask)
+                                              Span<int> bucket_offsets,
+                                              Span<uint64_t> keys,
+                                              Span<int> edge_offsets)
 {
   const MutableSpan<MLoop> loops{mesh->mloop, mesh->totloop};
   threading::parallel_for(IndexRange(mesh->totpoly), 100, [&](IndexRange range) {
@@ -167,10 +224,16 @@ static void update_edge_indices_in_poly_loops(Mesh *mesh,
       for (MLoop &next_loop : poly_loops) {
         int edge_index;
         if (prev_loop->v != next_loop.v) {
-          OrderedEdge ordered_edge{prev_loop->v, next_loop.v};
-          /* Double lookup: First find the map that contains the edge, then lookup the edge. */
-          const EdgeMap &edge_map = edge_maps[parallel_mask & ordered_edge.hash2()];
-          edge_index = edge_map.lookup(ordered_edge).index;
+          const uint v_low = std::min(prev_loop->v, next_loop.v);
+          const uint v_high = std::max(prev_loop->v, next_loop.v);
+          const int edge_start = edge_offsets[v_low];
+          const Span<uint64_t> bucket = keys.slice(bucket_offsets[v_low],
+                                                   edge_offsets[v_low + 1] - edge_start);
+          /* The unique keys of the bucket are sorted by their higher vertex. */
+          const uint64_t *key = std::lower_bound(
+              bucket.begin(), bucket.end(), edge_key(v_high, 0));
+          BLI_assert(key != bucket.end() && edge_key_v_high(*key) == v_high);
+          edge_index = edge_start + int(key - bucket.begin());
         }
         else {
           /* This is an invalid edge; normally this does not happen in Blender,
@@ -185,23 +248,6 @@ static void update_edge_indices_in_poly_loops(Mesh *mesh,
   });
 }
 
-static int get_parallel_maps_count(const Mesh *mesh)
-{
-  /* Don't use parallelization when the mesh is small. */
-  if (mesh->totpoly < 1000) {
-    return 1;
-  }
-  /* Use at most 8 separate hash tables. Using more threads has diminishing returns. These threads
-   * can better do something more useful instead. */
-  const int system_thread_count = BLI_system_thread_count();
-  return power_of_2_min_i(std::min(8, system_thread_count));
-}
-
-static void clear_hash_tables(MutableSpan<EdgeMap> edge_maps)
-{
-  threading::parallel_for_each(edge_maps, [](EdgeMap &edge_map) { edge_map.clear(); });
-}
-
 }  // namespace blender::bke::calc_edges
 
 void BKE_mesh_calc_edges(Mesh *mesh, bool keep_existing_edges, const bool select_new_edges)
@@ -210,32 +256,25 @@ void BKE_mesh_calc_edges(Mesh *mesh, bool keep_existing_edges, const bool select
   using namespace blender::bke;
   using namespace blender::bke::calc_edges;
 
-  /* Parallelization is achieved by having multiple hash tables for different subsets of edges.
-   * Each edge is assigned to one of the hash maps based on the lower bits of a hash value. */
-  const int parallel_maps = get_parallel_maps_count(mesh);
-  BLI_assert(is_power_of_2_i(parallel_maps));
-  const uint32_t parallel_mask = static_cast<uint32_t>(parallel_maps) - 1;
-  Array<EdgeMap> edge_maps(parallel_maps);
-  reserve_hash_maps(mesh, keep_existing_edges, edge_maps);
+  /* Edges are grouped by their lower vertex with a parallel counting sort. Because every group is
+   * small, sorting and de-duplicating them can be done independently on all threads, and the
+   * resulting edge order only depends on the topology, not on the number of threads. */
+  const int buckets_num = get_buckets_num(mesh, keep_existing_edges);
+  Array<int> bucket_offsets(buckets_num + 1);
+  Array<uint64_t> keys;
+  sort_edge_keys_into_buckets(mesh, keep_existing_edges, bucket_offsets, keys);
 
-  /* Add all edges. */
-  if (keep_existing_edges) {
-    calc_edges::add_existing_edges_to_hash_maps(mesh, edge_maps, parallel_mask);
-  }
-  calc_edges::add_polygon_edges_to_hash_maps(mesh, edge_maps, parallel_mask);
-
-  /* Compute total number of edges. */
-  int new_totedge = 0;
-  for (EdgeMap &edge_map : edge_maps) {
-    new_totedge += edge_map.size();
-  }
+  Array<int> edge_offsets(buckets_num + 1);
+  deduplicate_buckets(bucket_offsets, keys, edge_offsets);
+  const int new_totedge = edge_offsets.last();
 
   /* Create new edges. */
   MutableSpan<MEdge> new_edges{
       static_cast<MEdge *>(MEM_calloc_arrayN(new_totedge, sizeof(MEdge), __func__)), new_totedge};
   const short new_edge_flag = (ME_EDGEDRAW | ME_EDGERENDER) | (select_new_edges ? SELECT : 0);
-  calc_edges::serialize_and_initialize_deduplicated_edges(edge_maps, new_edges, new_edge_flag);
-  calc_edges::update_edge_indices_in_poly_loops(mesh, edge_maps, parallel_mask);
+  initialize_deduplicated_edges(
+      mesh, bucket_offsets, keys, edge_offsets, new_edges, new_edge_flag);
+  update_edge_indices_in_poly_loops(mesh, bucket_offsets, keys, edge_offsets);
 
   /* Free old CustomData and assign new one. */
   CustomData_free(&mesh->edata, mesh->totedge);
@@ -243,7 +282,4 @@ void BKE_mesh_calc_edges(Mesh *mesh, bool keep_existing_edges, const bool select
   CustomData_add_layer(&mesh->edata, CD_MEDGE, CD_ASSIGN, new_edges.data(), new_totedge);
   mesh->totedge = new_totedge;
   mesh->medge = new_edges.data();
-
-  /* Explicitly clear edge maps, because that way it can be parallelized. */
-  clear_hash_tables(edge_maps);
 }
@@ -0,0 +1,167 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "testing/testing.h"
+
+#include "BLI_set.hh"
+#include "BLI_vector.hh"
+
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_object_types.h"
+
+#include "mesh_test_utils.hh"
+
+namespace blender::bke::tests {
+
+class MeshCalcEdgesTest : public MeshTest {
+};
+
+/** Create a mesh without edges from the vertex indices of every polygon. */
+static Mesh *create_mesh_from_polys(const int verts_num,
+                                    const Span<Vector<int>> polys,
+                                    const int edges_num = 0)
+{
+  int loops_num = 0;
+  for (const Span<int> poly_verts : polys) {
+    loops_num += poly_verts.size();
+  }
+  Mesh *mesh = BKE_mesh_new_nomain(verts_num, edges_num, 0, loops_num, polys.size());
+  int loop_index = 0;
+  for (const int poly_index : polys.index_range()) {
+    MPoly &poly = mesh->mpoly[poly_index];
+    poly.loopstart = loop_index;
+    poly.totloop = polys[poly_index].size();
+    for (const int vert : polys[poly_index]) {
+      mesh->mloop[loop_index++].v = vert;
+    }
+  }
+  return mesh;
+}
+
+static const MEdge *find_edge(const Mesh *mesh, const uint v1, const uint v2)
+{
+  for (const MEdge &edge : Span(mesh->medge, mesh->totedge)) {
+    if ((edge.v1 == v1 && edge.v2 == v2) || (edge.v1 == v2 && edge.v2 == v1)) {
+      return &edge;
+    }
+  }
+  return nullptr;
+}
+
+/** Check that every polygon edge references the edge between its two corners. */
+static void expect_loop_edges_match(const Mesh *mesh)
+{
+  for (const MPoly &poly : Span(mesh->mpoly, mesh->totpoly)) {
+    const Span<MLoop> loops(&mesh->mloop[poly.loopstart], poly.totloop);
+    for (const int i : loops.index_range()) {
+      const MLoop &loop = loops[i];
+      const uint v_next = loops[(i + 1) % loops.size()].v;
+      if (loop.v == v_next) {
+        continue;
+      }
+      ASSERT_LT(int(loop.e), mesh->totedge);
+      const MEdge &edge = mesh->medge[loop.e];
+      EXPECT_TRUE((edge.v1 == loop.v && edge.v2 == v_next) ||
+                  (edge.v1 == v_next && edge.v2 == loop.v));
+    }
+  }
+}
+
+TEST_F(MeshCalcEdgesTest, shared_edges_are_deduplicated)
+{
+  /* A 4x3 grid of quads. */
+  Mesh *mesh = create_grid_mesh(5, 4);
+  BKE_mesh_calc_edges(mesh, false, false);
+
+  EXPECT_EQ(mesh->totedge, 4 * 4 + 5 * 3);
+  Set<std::pair<uint, uint>> unique_edges;
+  for (const MEdge &edge : Span(mesh->medge, mesh->totedge)) {
+    EXPECT_NE(edge.v1, edge.v2);
+    EXPECT_TRUE(unique_edges.add({std::min(edge.v1, edge.v2), std::max(edge.v1, edge.v2)}));
+    EXPECT_EQ(edge.flag, ME_EDGEDRAW | ME_EDGERENDER);
+  }
+  expect_loop_edges_match(mesh);
+
+  /* New edges can be selected. */
+  BKE_mesh_calc_edges(mesh, false, true);
+  for (const MEdge &edge : Span(mesh->medge, mesh->totedge)) {
+    EXPECT_EQ(edge.flag, ME_EDGEDRAW | ME_EDGERENDER | SELECT);
+  }
+
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(MeshCalcEdgesTest, keep_existing_edges)
+{
+  /* A quad and a loose edge. */
+  Mesh *mesh = create_mesh_from_polys(5, {{0, 1, 2, 3}}, 2);
+  mesh->medge[0].v1 = 1;
+  mesh->medge[0].v2 = 0;
+  mesh->medge[0].flag = ME_SEAM;
+  mesh->medge[0].crease = 100;
+  mesh->medge[1].v1 = 3;
+  mesh->medge[1].v2 = 4;
+  mesh->medge[1].flag = ME_SHARP | ME_LOOSEEDGE;
+
+  BKE_mesh_calc_edges(mesh, true, false);
+  EXPECT_EQ(mesh->totedge, 5);
+  /* The original edges are preferred over the new edges connecting the same vertices. */
+  const MEdge *seam_edge = find_edge(mesh, 0, 1);
+  ASSERT_NE(seam_edge, nullptr);
+  EXPECT_EQ(seam_edge->v1, 1u);
+  EXPECT_EQ(seam_edge->v2, 0u);
+  EXPECT_EQ(seam_edge->flag, ME_SEAM);
+  EXPECT_EQ(seam_edge->crease, 100);
+  const MEdge *loose_edge = find_edge(mesh, 3, 4);
+  ASSERT_NE(loose_edge, nullptr);
+  EXPECT_EQ(loose_edge->flag, ME_SHARP | ME_LOOSEEDGE);
+  EXPECT_EQ(find_edge(mesh, 1, 2)->flag, ME_EDGEDRAW | ME_EDGERENDER);
+  expect_loop_edges_match(mesh);
+
+  /* Without keeping them, the loose edge is removed and the seam is lost. */
+  BKE_mesh_calc_edges(mesh, false, false);
+  EXPECT_EQ(mesh->totedge, 4);
+  EXPECT_EQ(find_edge(mesh, 3, 4), nullptr);
+  EXPECT_EQ(find_edge(mesh, 0, 1)->flag, ME_EDGEDRAW | ME_EDGERENDER);
+  expect_loop_edges_match(mesh);
+
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(MeshCalcEdgesTest, degenerate_loops)
+{
+  /* The second and third corners use the same vertex, which doesn't create an edge. */
+  Mesh *mesh = create_mesh_from_polys(3, {{0, 1, 1, 2}});
+  BKE_mesh_calc_edges(mesh, false, false);
+
+  EXPECT_EQ(mesh->totedge, 3);
+  EXPECT_NE(find_edge(mesh, 0, 1), nullptr);
+  EXPECT_NE(find_edge(mesh, 1, 2), nullptr);
+  EXPECT_NE(find_edge(mesh, 2, 0), nullptr);
+  /* The degenerate corner uses the first edge. */
+  EXPECT_EQ(mesh->mloop[1].e, 0u);
+  expect_loop_edges_match(mesh);
+
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(MeshCalcEdgesTest, loop_vertices_out_of_range)
+{
+  /* Invalid meshes from importers can reference vertices that don't exist. */
+  Mesh *mesh = create_mesh_from_polys(3, {{0, 1, 2}, {1, 7, 2}, {7, 1, 12}});
+  BKE_mesh_calc_edges(mesh, false, false);
+
+  EXPECT_EQ(mesh->totedge, 7);
+  EXPECT_NE(find_edge(mesh, 1, 7), nullptr);
+  EXPECT_NE(find_edge(mesh, 7, 2), nullptr);
+  EXPECT_NE(find_edge(mesh, 7, 12), nullptr);
+  EXPECT_NE(find_edge(mesh, 12, 1), nullptr);
+  expect_loop_edges_match(mesh);
+
+  BKE_id_free(nullptr, mesh);
+}
+
+}  // namespace blender::bke::tests
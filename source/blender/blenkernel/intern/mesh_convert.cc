@@ -21,9 +21,12 @@
 #include "BLI_edgehash.h"
 #include "BLI_index_range.hh"
 #include "BLI_listbase.h"
+#include "BLI_map.hh"
 #include "BLI_math.h"
 #include "BLI_string.h"
+#include "BLI_task.hh"
 #include "BLI_utildefines.h"
+#include "BLI_vector.hh"
 
 #include "BKE_DerivedMesh.h"
 #include "BKE_curves.hh"
@@ -1021,17 +1024,22 @@ static Mesh *mesh_new_from_mball_object(Object *object)
   return mesh_result;
 }
 
-static Mesh *mesh_new_from_mesh(Object *object, Mesh *mesh)
+/**
+ * Return the mesh with regular mesh data that \a mesh wraps.
+ */
+static Mesh *mesh_ensure_mdata_for_copy(Object *object, Mesh *mesh)
 {
   /* While we could copy this into the new mesh,
    * add the data to 'mesh' so future calls to this function don't need to re-convert the data. */
   if (mesh->runtime.wrapper_type == ME_WRAPPER_TYPE_BMESH) {
     BKE_mesh_wrapper_ensure_mdata(mesh);
+    return mesh;
   }
-  else {
-    mesh = BKE_mesh_wrapper_ensure_subdivision(object, mesh);
-  }
+  return BKE_mesh_wrapper_ensure_subdivision(object, mesh);
+}
 
+static Mesh *mesh_copy_for_object(const Object *object, const Mesh *mesh)
+{
   Mesh *mesh_result = (Mesh *)BKE_id_copy_ex(
       nullptr, &mesh->id, nullptr, LIB_ID_CREATE_NO_MAIN | LIB_ID_CREATE_NO_USER_REFCOUNT);
   /* NOTE: Materials should already be copied. */
@@ -1040,6 +1048,11 @@ static Mesh *mesh_new_from_mesh(Object *object, Mesh *mesh)
   return mesh_result;
 }
 
+static Mesh *mesh_new_from_mesh(Object *object, Mesh *mesh)
+{
+  return mesh_copy_for_object(object, mesh_ensure_mdata_for_copy(object, mesh));
+}
+
 static Mesh *mesh_new_from_mesh_object_with_layers(Depsgraph *depsgraph,
                                                    Object *object,
                                                    const bool preserve_origindex)
@@ -1069,14 +1082,8 @@ static Mesh *mesh_new_from_mesh_object_with_layers(Depsgraph *depsgraph,
   return BKE_mesh_wrapper_ensure_subdivision(object, result);
 }
 
-static Mesh *mesh_new_from_mesh_object(Depsgraph *depsgraph,
-                                       Object *object,
-                                       const bool preserve_all_data_layers,
-                                       const bool preserve_origindex)
+static Mesh *mesh_object_get_input_mesh(Object *object)
 {
-  if (preserve_all_data_layers || preserve_origindex) {
-    return mesh_new_from_mesh_object_with_layers(depsgraph, object, preserve_origindex);
-  }
   Mesh *mesh_input = (Mesh *)object->data;
   /* If we are in edit mode, use evaluated mesh from edit structure, matching to what
    * viewport is using for visualization. */
@@ -1086,7 +1093,42 @@ static Mesh *mesh_new_from_mesh_object(Depsgraph *depsgraph,
       mesh_input = editmesh_eval_final;
     }
   }
-  return mesh_new_from_mesh(object, mesh_input);
+  return mesh_input;
+}
+
+static Mesh *mesh_new_from_mesh_object(Depsgraph *depsgraph,
+                                       Object *object,
+                                       const bool preserve_all_data_layers,
+                                       const bool preserve_origindex)
+{
+  if (preserve_all_data_layers || preserve_origindex) {
+    return mesh_new_from_mesh_object_with_layers(depsgraph, object, preserve_origindex);
+  }
+  return mesh_new_from_mesh(object, mesh_object_get_input_mesh(object));
+}
+
+static Mesh *mesh_new_from_object_finalize(Mesh *new_mesh)
+{
+  if (new_mesh == nullptr) {
+    /* Happens in special cases like request of mesh for non-mother meta ball. */
+    return nullptr;
+  }
+
+  /* The result must have 0 users, since it's just a mesh which is free-dangling data-block.
+   * All the conversion functions are supposed to ensure mesh is not counted. */
+  BLI_assert(new_mesh->id.us == 0);
+
+  /* It is possible that mesh came from modifier stack evaluation, which preserves edit_mesh
+   * pointer (which allows draw manager to access edit mesh when drawing). Normally this does
+   * not cause ownership problems because evaluated object runtime is keeping track of the real
+   * ownership.
+   *
+   * Here we are constructing a mesh which is supposed to be independent, which means no shared
+   * ownership is allowed, so we make sure edit mesh is reset to nullptr (which is similar to as if
+   * one duplicates the objects and applies all the modifiers). */
+  new_mesh->edit_mesh = nullptr;
+
+  return new_mesh;
 }
 
 Mesh *BKE_mesh_new_from_object(Depsgraph *depsgraph,
@@ -1112,26 +1154,101 @@ Mesh *BKE_mesh_new_from_object(Depsgraph *depsgraph,
       /* Object does not have geometry data. */
       return nullptr;
   }
-  if (new_mesh == nullptr) {
-    /* Happens in special cases like request of mesh for non-mother meta ball. */
-    return nullptr;
-  }
-
-  /* The result must have 0 users, since it's just a mesh which is free-dangling data-block.
-   * All the conversion functions are supposed to ensure mesh is not counted. */
-  BLI_assert(new_mesh->id.us == 0);
+  return mesh_new_from_object_finalize(new_mesh);
+}
 
-  /* It is possible that mesh came from modifier stack evaluation, which preserves edit_mesh
-   * pointer (which allows draw manager to access edit mesh when drawing). Normally this does
-   * not cause ownership problems because evaluated object runtime is keeping track of the real
-   * ownership.
-   *
-   * Here we are constructing a mesh which is supposed to be independent, which means no shared
-   * ownership is allowed, so we make sure edit mesh is reset to nullptr (which is similar to as if
-   * one duplicates the objects and applies all the modifiers). */
-  new_mesh->edit_mesh = nullptr;
+/**
+ * Copy the vertex and face normals of \a mesh_src if they are calculated already, so that
+ * the copies (possibly many for instanced meshes) don't have to calculate them again.
+ */
+static void mesh_copy_normals_if_calculated(Mesh *mesh, const Mesh *mesh_src)
+{
+  if (!BKE_mesh_vertex_normals_are_dirty(mesh_src)) {
+    memcpy(BKE_mesh_vertex_normals_for_write(mesh),
+           BKE_mesh_vertex_normals_ensure(mesh_src),
+           sizeof(float[3]) * mesh->totvert);
+    BKE_mesh_vertex_normals_clear_dirty(mesh);
+  }
+  if (!BKE_mesh_poly_normals_are_dirty(mesh_src)) {
+    memcpy(BKE_mesh_poly_normals_for_write(mesh),
+           BKE_mesh_poly_normals_ensure(mesh_src),
+           sizeof(float[3]) * mesh->totpoly);
+    BKE_mesh_poly_normals_clear_dirty(mesh);
+  }
+}
 
-  return new_mesh;
+void BKE_mesh_new_from_objects(Depsgraph *depsgraph,
+                               Object **objects,
+                               const int objects_num,
+                               const bool preserve_all_data_layers,
+                               const bool preserve_origindex,
+                               Mesh **r_meshes)
+{
+  using namespace blender;
+
+  /* Mesh objects are grouped by the mesh they are copied from, so that meshes used by many
+   * objects (i.e. instances) are prepared only once. */
+  Map<Mesh *, int> group_by_input_mesh;
+  Vector<Mesh *> group_input_meshes;
+  Vector<Vector<int>> group_objects;
+  Vector<int> evaluated_curve_objects;
+
+  for (const int i : IndexRange(objects_num)) {
+    Object *object = objects[i];
+    r_meshes[i] = nullptr;
+    switch (object->type) {
+      case OB_FONT:
+      case OB_CURVES_LEGACY:
+      case OB_SURF:
+        if (DEG_is_evaluated_object(object)) {
+          evaluated_curve_objects.append(i);
+          continue;
+        }
+        break;
+      case OB_MESH:
+        if (!(preserve_all_data_layers || preserve_origindex)) {
+          Mesh *mesh_input = mesh_object_get_input_mesh(object);
+          const int group = group_by_input_mesh.lookup_or_add_cb(mesh_input, [&]() {
+            group_input_meshes.append(mesh_input);
+            group_objects.append({});
+            return group_input_meshes.size() - 1;
+          });
+          group_objects[group].append(i);
+          continue;
+        }
+        break;
+    }
+    /* Conversions that evaluate the object again or create temporary objects are not thread-safe,
+     * they are done on the calling thread. */
+    r_meshes[i] = BKE_mesh_new_from_object(
+        depsgraph, object, preserve_all_data_layers, preserve_origindex);
+  }
+
+  threading::parallel_invoke(
+      [&]() {
+        threading::parallel_for(group_input_meshes.index_range(), 1, [&](IndexRange range) {
+          for (const int group : range) {
+            const Span<int> object_indices = group_objects[group];
+            const Mesh *mesh = mesh_ensure_mdata_for_copy(objects[object_indices.first()],
+                                                          group_input_meshes[group]);
+            threading::parallel_for(object_indices.index_range(), 8, [&](IndexRange sub_range) {
+              for (const int object_index : object_indices.slice(sub_range)) {
+                Mesh *new_mesh = mesh_copy_for_object(objects[object_index], mesh);
+                mesh_copy_normals_if_calculated(new_mesh, mesh);
+                r_meshes[object_index] = mesh_new_from_object_finalize(new_mesh);
+              }
+            });
+          }
+        });
+      },
+      [&]() {
+        threading::parallel_for(evaluated_curve_objects.index_range(), 8, [&](IndexRange range) {
+          for (const int object_index : evaluated_curve_objects.as_span().slice(range)) {
+            r_meshes[object_index] = mesh_new_from_object_finalize(
+                mesh_new_from_evaluated_curve_type_object(objects[object_index]));
+          }
+        });
+      });
 }
 
 static int foreach_libblock_make_original_callback(LibraryIDLinkCallbackData *cb_data)
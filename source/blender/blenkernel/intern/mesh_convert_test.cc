@@ -0,0 +1,72 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "testing/testing.h"
+
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_object_types.h"
+
+#include "mesh_test_utils.hh"
+
+namespace blender::bke::tests {
+
+class MeshConvertTest : public MeshTest {
+};
+
+static Object *create_object(const short type, Mesh *mesh)
+{
+  Object *object = static_cast<Object *>(BKE_id_new_nomain(ID_OB, nullptr));
+  object->type = type;
+  object->data = mesh;
+  return object;
+}
+
+TEST_F(MeshConvertTest, new_from_objects)
+{
+  GridMeshOptions options;
+  options.use_edges = true;
+  Mesh *mesh = create_grid_mesh(5, 4, options);
+  Mesh *other_mesh = create_grid_mesh(3, 3, options);
+  BKE_mesh_vertex_normals_ensure(mesh);
+
+  /* Two instances of the same mesh, another mesh and an object without geometry. */
+  Object *objects[4] = {create_object(OB_MESH, mesh),
+                        create_object(OB_MESH, other_mesh),
+                        create_object(OB_MESH, mesh),
+                        create_object(OB_EMPTY, nullptr)};
+  Mesh *meshes[4];
+  BKE_mesh_new_from_objects(nullptr, objects, 4, false, false, meshes);
+
+  EXPECT_EQ(meshes[3], nullptr);
+  for (const int i : IndexRange(3)) {
+    ASSERT_NE(meshes[i], nullptr);
+    EXPECT_NE(meshes[i], objects[i]->data);
+    EXPECT_EQ(meshes[i]->id.us, 0);
+
+    /* The result is the same as converting the object on its own. */
+    Mesh *expected = BKE_mesh_new_from_object(nullptr, objects[i], false, false);
+    EXPECT_EQ(meshes[i]->totvert, expected->totvert);
+    EXPECT_EQ(meshes[i]->totedge, expected->totedge);
+    EXPECT_EQ(meshes[i]->totpoly, expected->totpoly);
+    EXPECT_EQ(meshes[i]->totloop, expected->totloop);
+    BKE_id_free(nullptr, expected);
+  }
+  /* Instances are independent copies. */
+  EXPECT_NE(meshes[0], meshes[2]);
+  /* Already calculated normals are shared with the results. */
+  EXPECT_FALSE(BKE_mesh_vertex_normals_are_dirty(meshes[0]));
+  EXPECT_FALSE(BKE_mesh_vertex_normals_are_dirty(meshes[2]));
+
+  for (const int i : IndexRange(4)) {
+    if (meshes[i] != nullptr) {
+      BKE_id_free(nullptr, meshes[i]);
+    }
+    BKE_id_free(nullptr, objects[i]);
+  }
+  BKE_id_free(nullptr, mesh);
+  BKE_id_free(nullptr, other_mesh);
+}
+
+}  // namespace blender::bke::tests
@@ -17,27 +17,37 @@
 #include "DNA_meshdata_types.h"
 
 #include "BLI_alloca.h"
+#include "BLI_array.hh"
 #include "BLI_bitmap.h"
 
 #include "BLI_linklist.h"
 #include "BLI_linklist_stack.h"
 #include "BLI_math.h"
 #include "BLI_math_vec_types.hh"
+#include "BLI_math_vector.hh"
 #include "BLI_memarena.h"
 #include "BLI_span.hh"
 #include "BLI_stack.h"
 #include "BLI_task.h"
 #include "BLI_task.hh"
 #include "BLI_utildefines.h"
+#include "BLI_vector.hh"
 
 #include "BKE_customdata.h"
 #include "BKE_editmesh_cache.h"
 #include "BKE_global.h"
 #include "BKE_mesh.h"
+#include "BKE_mesh_mapping.h"
+#include "BKE_mesh_runtime.h"
 
 #include "atomic_ops.h"
 
+using blender::Array;
+using blender::float3;
+using blender::IndexRange;
+using blender::MutableSpan;
 using blender::Span;
+using blender::Vector;
 
 // #define DEBUG_TIME
 
@@ -96,6 +106,22 @@ void BKE_mesh_normals_tag_dirty(Mesh *mesh)
 {
   mesh->runtime.vert_normals_dirty = true;
   mesh->runtime.poly_normals_dirty = true;
+  MEM_SAFE_FREE(mesh->runtime.normals_dirty_verts);
+}
+
+void BKE_mesh_normals_tag_dirty_verts(Mesh *mesh, const uint32_t *changed_verts)
+{
+  Mesh_Runtime &runtime = mesh->runtime;
+  if (runtime.normals_dirty_verts == nullptr) {
+    if (runtime.vert_normals_dirty || runtime.poly_normals_dirty) {
+      /* The normals have to be recalculated for the whole mesh anyway. */
+      return;
+    }
+    runtime.normals_dirty_verts = BLI_BITMAP_NEW(mesh->totvert, __func__);
+  }
+  BLI_bitmap_or_all(runtime.normals_dirty_verts, changed_verts, size_t(mesh->totvert));
+  runtime.vert_normals_dirty = true;
+  runtime.poly_normals_dirty = true;
 }
 
 float (*BKE_mesh_vertex_normals_for_write(Mesh *mesh))[3]
@@ -125,6 +151,7 @@ float (*BKE_mesh_poly_normals_for_write(Mesh *mesh))[3]
 void BKE_mesh_vertex_normals_clear_dirty(Mesh *mesh)
 {
   mesh->runtime.vert_normals_dirty = false;
+  MEM_SAFE_FREE(mesh->runtime.normals_dirty_verts);
   BKE_mesh_assert_normals_dirty_or_calculated(mesh);
 }
 
@@ -148,6 +175,7 @@ void BKE_mesh_clear_derived_normals(Mesh *mesh)
 {
   MEM_SAFE_FREE(mesh->runtime.vert_normals);
   MEM_SAFE_FREE(mesh->runtime.poly_normals);
+  MEM_SAFE_FREE(mesh->runtime.normals_dirty_verts);
 
   mesh->runtime.vert_normals_dirty = true;
   mesh->runtime.poly_normals_dirty = true;
@@ -339,6 +367,265 @@ void BKE_mesh_calc_normals_poly_and_vertex(const MVert *mvert,
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Mesh Normal Calculation (Gather Vertex Normals)
+ *
+ * Unlike #BKE_mesh_calc_normals_poly_and_vertex, vertex normals are not accumulated by scattering
+ * face normals to vertices, which needs atomics that scale poorly with many threads on dense
+ * meshes. Instead the angle weighted contribution of every face corner is written to a corner
+ * sized buffer (each corner is only owned by a single face), then every vertex sums the
+ * contributions of its own corners using the cached vertex to corner map. Since the summation
+ * order doesn't depend on the threading, the result is also deterministic.
+ * \{ */
+
+/**
+ * Face normal calculation with fast paths for triangles and quads, which are the vast majority of
+ * faces in dense meshes. These only use plain vector arithmetic, so the compiler can vectorize
+ * them.
+ */
+static float3 poly_normal_calc(const Span<MVert> verts, const Span<MLoop> poly_loops)
+{
+  float3 normal;
+  if (poly_loops.size() == 3) {
+    const float3 v0 = verts[poly_loops[0].v].co;
+    const float3 v1 = verts[poly_loops[1].v].co;
+    const float3 v2 = verts[poly_loops[2].v].co;
+    normal = blender::math::cross(v1 - v0, v2 - v0);
+  }
+  else if (poly_loops.size() == 4) {
+    /* The area vector of a quad is the cross product of its diagonals. */
+    const float3 v0 = verts[poly_loops[0].v].co;
+    const float3 v1 = verts[poly_loops[1].v].co;
+    const float3 v2 = verts[poly_loops[2].v].co;
+    const float3 v3 = verts[poly_loops[3].v].co;
+    normal = blender::math::cross(v2 - v0, v3 - v1);
+  }
+  else {
+    /* Newell's Method */
+    normal = float3(0.0f);
+    const float *v_prev = verts[poly_loops.last().v].co;
+    for (const MLoop &loop : poly_loops) {
+      const float *v_curr = verts[loop.v].co;
+      add_newell_cross_v3_v3v3(normal, v_prev, v_curr);
+      v_prev = v_curr;
+    }
+  }
+
+  float length;
+  normal = blender::math::normalize_and_get_length(normal, length);
+  if (UNLIKELY(length == 0.0f)) {
+    return float3(0.0f, 0.0f, 1.0f);
+  }
+  return normal;
+}
+
+/**
+ * Calculate the face normal and the angle weighted face normal of each of its corners.
+ * The weighting matches #mesh_calc_normals_poly_and_vertex_accum_fn.
+ */
+static void poly_normal_and_corner_weights_calc(const Span<MVert> verts,
+                                                const Span<MLoop> poly_loops,
+                                                float3 &r_poly_normal,
+                                                MutableSpan<float3> r_corner_normals)
+{
+  const float3 poly_normal = poly_normal_calc(verts, poly_loops);
+  r_poly_normal = poly_normal;
+
+  const int i_end = poly_loops.size() - 1;
+  const float3 v_end = verts[poly_loops[i_end].v].co;
+  const float3 edvec_end = blender::math::normalize(float3(verts[poly_loops[i_end - 1].v].co) -
+                                                    v_end);
+
+  float3 v_curr = v_end;
+  float3 edvec_prev = edvec_end;
+  for (int i_next = 0, i_curr = i_end; i_next <= i_end; i_curr = i_next++) {
+    const float3 v_next = verts[poly_loops[i_next].v].co;
+    /* Skip an extra normalization by reusing the first calculated edge. */
+    const float3 edvec_next = (i_next != i_end) ? blender::math::normalize(v_curr - v_next) :
+                                                  edvec_end;
+
+    /* Calculate angle between the two poly edges incident on this vertex. */
+    const float fac = saacos(-blender::math::dot(edvec_prev, edvec_next));
+    r_corner_normals[i_curr] = poly_normal * fac;
+
+    v_curr = v_next;
+    edvec_prev = edvec_next;
+  }
+}
+
+static void mesh_calc_normals_poly_and_vertex_gather(const Mesh &mesh,
+                                                     MutableSpan<float3> poly_normals,
+                                                     MutableSpan<float3> vert_normals)
+{
+  using namespace blender;
+  const Span<MVert> verts(mesh.mvert, mesh.totvert);
+  const Span<MPoly> polys(mesh.mpoly, mesh.totpoly);
+  const Span<MLoop> loops(mesh.mloop, mesh.totloop);
+
+  /* Build the map first, so it isn't built from inside a task of the parallel loops below. */
+  const MeshTopologyMap &vert_to_loop_map = *BKE_mesh_runtime_vert_loop_map_ensure(&mesh);
+
+  Array<float3> corner_normals(loops.size(), NoInitialization());
+
+  threading::parallel_for(polys.index_range(), 1024, [&](const IndexRange range) {
+    for (const int poly_i : range) {
+      const MPoly &poly = polys[poly_i];
+      const IndexRange poly_range(poly.loopstart, poly.totloop);
+      poly_normal_and_corner_weights_calc(verts,
+                                          loops.slice(poly_range),
+                                          poly_normals[poly_i],
+                                          corner_normals.as_mutable_span().slice(poly_range));
+    }
+  });
+
+  threading::parallel_for(verts.index_range(), 1024, [&](const IndexRange range) {
+    for (const int vert_i : range) {
+      float3 normal(0.0f);
+      for (const int loop_i : bke::mesh_topology::map_lookup(vert_to_loop_map, vert_i)) {
+        normal += corner_normals[loop_i];
+      }
+
+      float length;
+      normal = math::normalize_and_get_length(normal, length);
+      if (UNLIKELY(length == 0.0f)) {
+        /* Following Mesh convention; we use vertex coordinate itself for normal in this case. */
+        normal = math::normalize(float3(verts[vert_i].co));
+      }
+      vert_normals[vert_i] = normal;
+    }
+  });
+}
+
+/**
+ * The angle weight of a single face corner, the same as calculated by
+ * #poly_normal_and_corner_weights_calc.
+ */
+static float corner_angle_weight(const Span<MVert> verts,
+                                 const Span<MLoop> poly_loops,
+                                 const int corner)
+{
+  const int size = poly_loops.size();
+  const float3 v_prev = verts[poly_loops[(corner + size - 1) % size].v].co;
+  const float3 v_curr = verts[poly_loops[corner].v].co;
+  const float3 v_next = verts[poly_loops[(corner + 1) % size].v].co;
+  const float3 edvec_prev = blender::math::normalize(v_prev - v_curr);
+  const float3 edvec_next = blender::math::normalize(v_curr - v_next);
+  return saacos(-blender::math::dot(edvec_prev, edvec_next));
+}
+
+static Vector<int> bitmap_to_indices(const BLI_bitmap *bitmap, const int size)
+{
+  Vector<int> indices;
+  for (const int i : IndexRange(size)) {
+    if (BLI_BITMAP_TEST(bitmap, i)) {
+      indices.append(i);
+    }
+  }
+  return indices;
+}
+
+/**
+ * Update the existing normals of faces that use a vertex in \a changed_verts, and of all vertices
+ * of these faces. The result is the same as recalculating the normals of the whole mesh with
+ * #mesh_calc_normals_poly_and_vertex_gather.
+ */
+static void mesh_calc_normals_poly_and_vertex_partial(const Mesh &mesh,
+                                                      const BLI_bitmap *changed_verts,
+                                                      MutableSpan<float3> poly_normals,
+                                                      MutableSpan<float3> vert_normals)
+{
+  using namespace blender;
+  const Span<MVert> verts(mesh.mvert, mesh.totvert);
+  const Span<MPoly> polys(mesh.mpoly, mesh.totpoly);
+  const Span<MLoop> loops(mesh.mloop, mesh.totloop);
+
+  const MeshTopologyMap &vert_to_poly_map = *BKE_mesh_runtime_vert_poly_map_ensure(&mesh);
+
+  BLI_bitmap *polys_to_update = BLI_BITMAP_NEW(polys.size(), __func__);
+  for (const int vert_i : bitmap_to_indices(changed_verts, verts.size())) {
+    for (const int poly_i : bke::mesh_topology::map_lookup(vert_to_poly_map, vert_i)) {
+      BLI_BITMAP_ENABLE(polys_to_update, poly_i);
+    }
+  }
+  const Vector<int> poly_indices = bitmap_to_indices(polys_to_update, polys.size());
+  MEM_freeN(polys_to_update);
+
+  /* Changing a face normal or corner angle affects the normals of all of the face's vertices. */
+  BLI_bitmap *verts_to_update = BLI_BITMAP_NEW(verts.size(), __func__);
+  for (const int poly_i : poly_indices) {
+    const MPoly &poly = polys[poly_i];
+    for (const MLoop &loop : loops.slice(poly.loopstart, poly.totloop)) {
+      BLI_BITMAP_ENABLE(verts_to_update, loop.v);
+    }
+  }
+  const Vector<int> vert_indices = bitmap_to_indices(verts_to_update, verts.size());
+  MEM_freeN(verts_to_update);
+
+  threading::parallel_for(poly_indices.index_range(), 1024, [&](const IndexRange range) {
+    for (const int poly_i : poly_indices.as_span().slice(range)) {
+      const MPoly &poly = polys[poly_i];
+      poly_normals[poly_i] = poly_normal_calc(verts, loops.slice(poly.loopstart, poly.totloop));
+    }
+  });
+
+  threading::parallel_for(vert_indices.index_range(), 1024, [&](const IndexRange range) {
+    for (const int vert_i : vert_indices.as_span().slice(range)) {
+      float3 normal(0.0f);
+      int prev_poly_i = -1;
+      for (const int poly_i : bke::mesh_topology::map_lookup(vert_to_poly_map, vert_i)) {
+        /* A degenerate face can use the same vertex twice, all of its corners are handled at
+         * once below. */
+        if (poly_i == prev_poly_i) {
+          continue;
+        }
+        prev_poly_i = poly_i;
+
+        const MPoly &poly = polys[poly_i];
+        const Span<MLoop> poly_loops = loops.slice(poly.loopstart, poly.totloop);
+        for (const int corner : poly_loops.index_range()) {
+          if (poly_loops[corner].v == vert_i) {
+            normal += poly_normals[poly_i] * corner_angle_weight(verts, poly_loops, corner);
+          }
+        }
+      }
+
+      float length;
+      normal = math::normalize_and_get_length(normal, length);
+      if (UNLIKELY(length == 0.0f)) {
+        normal = math::normalize(float3(verts[vert_i].co));
+      }
+      vert_normals[vert_i] = normal;
+    }
+  });
+}
+
+/**
+ * Recalculate all vertex and face normals, or only the ones around moved vertices
+ * if the mesh was tagged with #BKE_mesh_normals_tag_dirty_verts.
+ */
+static void mesh_calc_normals_poly_and_vertex_ex(Mesh &mesh)
+{
+  float(*vert_normals)[3] = BKE_mesh_vertex_normals_for_write(&mesh);
+  float(*poly_normals)[3] = BKE_mesh_poly_normals_for_write(&mesh);
+  const MutableSpan<float3> vert_normals_span{reinterpret_cast<float3 *>(vert_normals),
+                                              mesh.totvert};
+  const MutableSpan<float3> poly_normals_span{reinterpret_cast<float3 *>(poly_normals),
+                                              mesh.totpoly};
+
+  if (mesh.runtime.normals_dirty_verts != nullptr) {
+    mesh_calc_normals_poly_and_vertex_partial(
+        mesh, mesh.runtime.normals_dirty_verts, poly_normals_span, vert_normals_span);
+  }
+  else {
+    mesh_calc_normals_poly_and_vertex_gather(mesh, poly_normals_span, vert_normals_span);
+  }
+
+  BKE_mesh_vertex_normals_clear_dirty(&mesh);
+  BKE_mesh_poly_normals_clear_dirty(&mesh);
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Mesh Normal Calculation
  * \{ */
@@ -363,26 +650,12 @@ const float (*BKE_mesh_vertex_normals_ensure(const Mesh *mesh))[3]
   }
 
   float(*vert_normals)[3];
-  float(*poly_normals)[3];
 
   /* Isolate task because a mutex is locked and computing normals is multi-threaded. */
   blender::threading::isolate_task([&]() {
     Mesh &mesh_mutable = *const_cast<Mesh *>(mesh);
-
-    vert_normals = BKE_mesh_vertex_normals_for_write(&mesh_mutable);
-    poly_normals = BKE_mesh_poly_normals_for_write(&mesh_mutable);
-
-    BKE_mesh_calc_normals_poly_and_vertex(mesh_mutable.mvert,
-                                          mesh_mutable.totvert,
-                                          mesh_mutable.mloop,
-                                          mesh_mutable.totloop,
-                                          mesh_mutable.mpoly,
-                                          mesh_mutable.totpoly,
-                                          poly_normals,
-                                          vert_normals);
-
-    BKE_mesh_vertex_normals_clear_dirty(&mesh_mutable);
-    BKE_mesh_poly_normals_clear_dirty(&mesh_mutable);
+    mesh_calc_normals_poly_and_vertex_ex(mesh_mutable);
+    vert_normals = mesh_mutable.runtime.vert_normals;
   });
 
   BLI_mutex_unlock(normals_mutex);
@@ -414,6 +687,13 @@ const float (*BKE_mesh_poly_normals_ensure(const Mesh *mesh))[3]
   blender::threading::isolate_task([&]() {
     Mesh &mesh_mutable = *const_cast<Mesh *>(mesh);
 
+    if (mesh_mutable.runtime.normals_dirty_verts != nullptr) {
+      /* Updating vertex normals as well is cheap when only part of the mesh changed. */
+      mesh_calc_normals_poly_and_vertex_ex(mesh_mutable);
+      poly_normals = mesh_mutable.runtime.poly_normals;
+      return;
+    }
+
     poly_normals = BKE_mesh_poly_normals_for_write(&mesh_mutable);
 
     BKE_mesh_calc_normals_poly(mesh_mutable.mvert,
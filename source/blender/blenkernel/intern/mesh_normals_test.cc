@@ -0,0 +1,165 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_array.hh"
+#include "BLI_bitmap.h"
+#include "BLI_math_vec_types.hh"
+#include "BLI_math_vector.hh"
+#include "BLI_timeit.hh"
+
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "mesh_test_utils.hh"
+
+#define DO_PERF_TESTS 0
+
+namespace blender::bke::tests {
+
+class MeshNormalsTest : public MeshTest {
+};
+
+/** Grid with randomly displaced vertices, using both the quad and triangle code paths. */
+static Mesh *create_noisy_grid(const int verts_x, const int verts_y)
+{
+  GridMeshOptions options;
+  options.noise = 0.5f;
+  options.use_triangles = true;
+  return create_grid_mesh(verts_x, verts_y, options);
+}
+
+TEST_F(MeshNormalsTest, vertex_normals_match_accumulated)
+{
+  Mesh *mesh = create_noisy_grid(40, 30);
+
+  Array<float3> expected_poly_normals(mesh->totpoly);
+  Array<float3> expected_vert_normals(mesh->totvert);
+  BKE_mesh_calc_normals_poly_and_vertex(mesh->mvert,
+                                        mesh->totvert,
+                                        mesh->mloop,
+                                        mesh->totloop,
+                                        mesh->mpoly,
+                                        mesh->totpoly,
+                                        (float(*)[3])expected_poly_normals.data(),
+                                        (float(*)[3])expected_vert_normals.data());
+
+  const Span<float3> vert_normals((const float3 *)BKE_mesh_vertex_normals_ensure(mesh),
+                                  mesh->totvert);
+  const Span<float3> poly_normals((const float3 *)BKE_mesh_poly_normals_ensure(mesh),
+                                  mesh->totpoly);
+
+  for (const int i : poly_normals.index_range()) {
+    EXPECT_V3_NEAR(poly_normals[i], expected_poly_normals[i], 1e-5f);
+  }
+  for (const int i : vert_normals.index_range()) {
+    EXPECT_V3_NEAR(vert_normals[i], expected_vert_normals[i], 1e-5f);
+  }
+
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(MeshNormalsTest, vertex_normals_loose_vertex)
+{
+  /* Vertices without faces use their normalized position as normal. */
+  Mesh *mesh = BKE_mesh_new_nomain(1, 0, 0, 0, 0);
+  mesh->mvert[0].co[0] = 0.0f;
+  mesh->mvert[0].co[1] = 3.0f;
+  mesh->mvert[0].co[2] = 4.0f;
+
+  const float(*vert_normals)[3] = BKE_mesh_vertex_normals_ensure(mesh);
+  EXPECT_V3_NEAR(vert_normals[0], float3(0.0f, 0.6f, 0.8f), 1e-6f);
+
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(MeshNormalsTest, vertex_normals_partial_update)
+{
+  Mesh *mesh = create_noisy_grid(20, 20);
+  BKE_mesh_vertex_normals_ensure(mesh);
+
+  BLI_bitmap *changed_verts = BLI_BITMAP_NEW(mesh->totvert, __func__);
+  for (const int i : {0, 21, 22, 250, 399}) {
+    mesh->mvert[i].co[2] += 1.0f;
+    BLI_BITMAP_ENABLE(changed_verts, i);
+  }
+  BKE_mesh_normals_tag_dirty_verts(mesh, changed_verts);
+  MEM_freeN(changed_verts);
+  EXPECT_TRUE(BKE_mesh_vertex_normals_are_dirty(mesh));
+
+  const Span<float3> vert_normals((const float3 *)BKE_mesh_vertex_normals_ensure(mesh),
+                                  mesh->totvert);
+  const Span<float3> poly_normals((const float3 *)BKE_mesh_poly_normals_ensure(mesh),
+                                  mesh->totpoly);
+  const Array<float3> partial_vert_normals(vert_normals);
+  const Array<float3> partial_poly_normals(poly_normals);
+
+  BKE_mesh_normals_tag_dirty(mesh);
+  BKE_mesh_vertex_normals_ensure(mesh);
+
+  for (const int i : poly_normals.index_range()) {
+    EXPECT_V3_NEAR(partial_poly_normals[i], poly_normals[i], 1e-6f);
+  }
+  for (const int i : vert_normals.index_range()) {
+    EXPECT_V3_NEAR(partial_vert_normals[i], vert_normals[i], 1e-6f);
+  }
+
+  BKE_id_free(nullptr, mesh);
+}
+
+#if DO_PERF_TESTS
+
+static void vertex_normals_performance(const int verts_x, const int verts_y)
+{
+  Mesh *mesh = create_noisy_grid(verts_x, verts_y);
+  std::cout << "Mesh with " << mesh->totvert << " vertices\n";
+
+  Array<float3> poly_normals(mesh->totpoly);
+  Array<float3> vert_normals(mesh->totvert);
+  {
+    SCOPED_TIMER("accumulate (atomic)");
+    BKE_mesh_calc_normals_poly_and_vertex(mesh->mvert,
+                                          mesh->totvert,
+                                          mesh->mloop,
+                                          mesh->totloop,
+                                          mesh->mpoly,
+                                          mesh->totpoly,
+                                          (float(*)[3])poly_normals.data(),
+                                          (float(*)[3])vert_normals.data());
+  }
+  {
+    SCOPED_TIMER("gather (first, including topology map)");
+    BKE_mesh_vertex_normals_ensure(mesh);
+  }
+  for (int i = 0; i < 3; i++) {
+    BKE_mesh_normals_tag_dirty(mesh);
+    SCOPED_TIMER("gather (cached topology map)");
+    BKE_mesh_vertex_normals_ensure(mesh);
+  }
+
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(MeshNormalsTest, vertex_normals_performance_1M)
+{
+  vertex_normals_performance(1000, 1000);
+}
+
+TEST_F(MeshNormalsTest, vertex_normals_performance_10M)
+{
+  vertex_normals_performance(3163, 3163);
+}
+
+TEST_F(MeshNormalsTest, vertex_normals_performance_50M)
+{
+  vertex_normals_performance(7072, 7072);
+}
+
+#endif
+
+}  // namespace blender::bke::tests
@@ -15,10 +15,12 @@
 #include "MEM_guardedalloc.h"
 
 #include "BLI_array.hh"
+#include "BLI_function_ref.hh"
 #include "BLI_index_range.hh"
 #include "BLI_math_vec_types.hh"
 #include "BLI_math_vector.h"
 #include "BLI_span.hh"
+#include "BLI_task.hh"
 
 #include "DNA_mesh_types.h"
 #include "DNA_meshdata_types.h"
@@ -47,10 +49,13 @@
 
 using blender::Array;
 using blender::float3;
+using blender::FunctionRef;
 using blender::IndexRange;
 using blender::MutableSpan;
 using blender::Span;
 
+namespace threading = blender::threading;
+
 #ifdef WITH_QUADRIFLOW
 static Mesh *remesh_quadriflow(const Mesh *input_mesh,
                                int target_faces,
@@ -193,19 +198,24 @@ static openvdb::FloatGrid::Ptr remesh_voxel_level_set_create(const Mesh *mesh,
   std::vector<openvdb::Vec3s> points(mesh->totvert);
   std::vector<openvdb::Vec3I> triangles(looptris.size());
 
-  for (const int i : IndexRange(mesh->totvert)) {
-    const float3 co = mesh->mvert[i].co;
-    points[i] = openvdb::Vec3s(co.x, co.y, co.z);
-  }
+  threading::parallel_for(IndexRange(mesh->totvert), 4096, [&](const IndexRange range) {
+    for (const int i : range) {
+      const float3 co = mesh->mvert[i].co;
+      points[i] = openvdb::Vec3s(co.x, co.y, co.z);
+    }
+  });
 
-  for (const int i : IndexRange(looptris.size())) {
-    const MLoopTri &loop_tri = looptris[i];
-    triangles[i] = openvdb::Vec3I(
-        mloop[loop_tri.tri[0]].v, mloop[loop_tri.tri[1]].v, mloop[loop_tri.tri[2]].v);
-  }
+  threading::parallel_for(looptris.index_range(), 4096, [&](const IndexRange range) {
+    for (const int i : range) {
+      const MLoopTri &loop_tri = looptris[i];
+      triangles[i] = openvdb::Vec3I(
+          mloop[loop_tri.tri[0]].v, mloop[loop_tri.tri[1]].v, mloop[loop_tri.tri[2]].v);
+    }
+  });
 
   openvdb::math::Transform::Ptr transform = openvdb::math::Transform::createLinearTransform(
       voxel_size);
+  /* The conversion itself is multi-threaded by OpenVDB. */
   openvdb::FloatGrid::Ptr grid = openvdb::tools::meshToLevelSet<openvdb::FloatGrid>(
       *transform, points, triangles, 1.0f);
 
@@ -229,31 +239,37 @@ static Mesh *remesh_voxel_volume_to_mesh(const openvdb::FloatGrid::Ptr level_set
   MutableSpan<MLoop> mloops{mesh->mloop, mesh->totloop};
   MutableSpan<MPoly> mpolys{mesh->mpoly, mesh->totpoly};
 
-  for (const int i : mverts.index_range()) {
-    copy_v3_v3(mverts[i].co, float3(vertices[i].x(), vertices[i].y(), vertices[i].z()));
-  }
-
-  for (const int i : IndexRange(quads.size())) {
-    MPoly &poly = mpolys[i];
-    const int loopstart = i * 4;
-    poly.loopstart = loopstart;
-    poly.totloop = 4;
-    mloops[loopstart].v = quads[i][0];
-    mloops[loopstart + 1].v = quads[i][3];
-    mloops[loopstart + 2].v = quads[i][2];
-    mloops[loopstart + 3].v = quads[i][1];
-  }
+  threading::parallel_for(mverts.index_range(), 4096, [&](const IndexRange range) {
+    for (const int i : range) {
+      copy_v3_v3(mverts[i].co, float3(vertices[i].x(), vertices[i].y(), vertices[i].z()));
+    }
+  });
+
+  threading::parallel_for(IndexRange(quads.size()), 4096, [&](const IndexRange range) {
+    for (const int i : range) {
+      MPoly &poly = mpolys[i];
+      const int loopstart = i * 4;
+      poly.loopstart = loopstart;
+      poly.totloop = 4;
+      mloops[loopstart].v = quads[i][0];
+      mloops[loopstart + 1].v = quads[i][3];
+      mloops[loopstart + 2].v = quads[i][2];
+      mloops[loopstart + 3].v = quads[i][1];
+    }
+  });
 
   const int triangle_loop_start = quads.size() * 4;
-  for (const int i : IndexRange(tris.size())) {
-    MPoly &poly = mpolys[quads.size() + i];
-    const int loopstart = triangle_loop_start + i * 3;
-    poly.loopstart = loopstart;
-    poly.totloop = 3;
-    mloops[loopstart].v = tris[i][2];
-    mloops[loopstart + 1].v = tris[i][1];
-    mloops[loopstart + 2].v = tris[i][0];
-  }
+  threading::parallel_for(IndexRange(tris.size()), 4096, [&](const IndexRange range) {
+    for (const int i : range) {
+      MPoly &poly = mpolys[quads.size() + i];
+      const int loopstart = triangle_loop_start + i * 3;
+      poly.loopstart = loopstart;
+      poly.totloop = 3;
+      mloops[loopstart].v = tris[i][2];
+      mloops[loopstart + 1].v = tris[i][1];
+      mloops[loopstart + 2].v = tris[i][0];
+    }
+  });
 
   BKE_mesh_calc_edges(mesh, false, false);
 
@@ -275,11 +291,150 @@ Mesh *BKE_mesh_remesh_voxel(const Mesh *mesh,
 #endif
 }
 
+#ifdef WITH_OPENVDB
+/** Level sets that use more memory are not kept in #RemeshVoxelCache. */
+static constexpr uint64_t remesh_voxel_cache_max_bytes = 256 * 1024 * 1024;
+#endif
+
+struct RemeshVoxelCache {
+#ifdef WITH_OPENVDB
+  openvdb::FloatGrid::Ptr level_set;
+#endif
+  float voxel_size = 0.0f;
+  int verts_num = 0;
+  int looptris_num = 0;
+  uint64_t geometry_hash = 0;
+};
+
+/** Finalizer of the "splitmix64" generator. */
+static uint64_t remesh_voxel_hash_mix(uint64_t x)
+{
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+  return x ^ (x >> 31);
+}
+
+uint64_t BKE_mesh_remesh_voxel_geometry_hash(const Mesh *mesh)
+{
+  /* Every element is hashed by mixing in its index and its values one after another, so that
+   * e.g. swapping a coordinate between two vertices changes the hash. The hashes of the elements
+   * are combined with addition, so that they can be computed on multiple threads. */
+  const Span<MVert> verts{mesh->mvert, mesh->totvert};
+  const Span<MLoop> loops{mesh->mloop, mesh->totloop};
+  const Span<MLoopTri> looptris{BKE_mesh_runtime_looptri_ensure(mesh),
+                                BKE_mesh_runtime_looptri_len(mesh)};
+  const uint64_t verts_hash = threading::parallel_reduce(
+      verts.index_range(),
+      4096,
+      uint64_t(0),
+      [&](const IndexRange range, uint64_t hash) {
+        for (const int i : range) {
+          uint32_t co_bits[3];
+          memcpy(co_bits, verts[i].co, sizeof(co_bits));
+          uint64_t vert_hash = remesh_voxel_hash_mix(uint64_t(i));
+          for (const uint32_t bits : co_bits) {
+            vert_hash = remesh_voxel_hash_mix(vert_hash ^ bits);
+          }
+          hash += vert_hash;
+        }
+        return hash;
+      },
+      std::plus<uint64_t>());
+  const uint64_t tris_hash = threading::parallel_reduce(
+      looptris.index_range(),
+      4096,
+      uint64_t(0),
+      [&](const IndexRange range, uint64_t hash) {
+        for (const int i : range) {
+          uint64_t tri_hash = remesh_voxel_hash_mix(uint64_t(i));
+          for (const int loop : looptris[i].tri) {
+            tri_hash = remesh_voxel_hash_mix(tri_hash ^ loops[loop].v);
+          }
+          hash += tri_hash;
+        }
+        return hash;
+      },
+      std::plus<uint64_t>());
+  return verts_hash ^ remesh_voxel_hash_mix(tris_hash);
+}
+
+Mesh *BKE_mesh_remesh_voxel_cached(const Mesh *mesh,
+                                   const float voxel_size,
+                                   const float adaptivity,
+                                   const float isovalue,
+                                   RemeshVoxelCache **cache_p)
+{
+#ifdef WITH_OPENVDB
+  if (*cache_p == nullptr) {
+    *cache_p = MEM_new<RemeshVoxelCache>(__func__);
+  }
+  RemeshVoxelCache &cache = **cache_p;
+
+  const int looptris_num = BKE_mesh_runtime_looptri_len(mesh);
+  const uint64_t geometry_hash = BKE_mesh_remesh_voxel_geometry_hash(mesh);
+  if (!cache.level_set || cache.voxel_size != voxel_size || cache.verts_num != mesh->totvert ||
+      cache.looptris_num != looptris_num || cache.geometry_hash != geometry_hash) {
+    cache.level_set = remesh_voxel_level_set_create(mesh, voxel_size);
+    cache.voxel_size = voxel_size;
+    cache.verts_num = mesh->totvert;
+    cache.looptris_num = looptris_num;
+    cache.geometry_hash = geometry_hash;
+  }
+  Mesh *result = remesh_voxel_volume_to_mesh(cache.level_set, isovalue, adaptivity, false);
+  if (cache.level_set->memUsage() > remesh_voxel_cache_max_bytes) {
+    /* Don't keep large level sets around for the lifetime of the modifier. */
+    cache.level_set.reset();
+  }
+  return result;
+#else
+  UNUSED_VARS(mesh, voxel_size, adaptivity, isovalue, cache_p);
+  return nullptr;
+#endif
+}
+
+void BKE_mesh_remesh_voxel_cache_free(RemeshVoxelCache *cache)
+{
+  MEM_delete(cache);
+}
+
+/**
+ * Find the nearest element of \a bvhtree for every position on multiple threads.
+ * The index is -1 when nothing was found.
+ */
+static Array<int> remesh_reproject_find_nearest(BVHTreeFromMesh &bvhtree,
+                                                const int positions_num,
+                                                FunctionRef<void(int, float *)> get_position)
+{
+  Array<int> nearest_indices(positions_num);
+  threading::parallel_for(IndexRange(positions_num), 1024, [&](const IndexRange range) {
+    for (const int i : range) {
+      float from_co[3];
+      get_position(i, from_co);
+      BVHTreeNearest nearest;
+      nearest.index = -1;
+      nearest.dist_sq = FLT_MAX;
+      BLI_bvhtree_find_nearest(
+          bvhtree.tree, from_co, &nearest, bvhtree.nearest_callback, &bvhtree);
+      nearest_indices[i] = nearest.index;
+    }
+  });
+  return nearest_indices;
+}
+
+static Array<int> remesh_reproject_find_nearest_verts(BVHTreeFromMesh &bvhtree,
+                                                      const Mesh *target)
+{
+  const MVert *target_verts = target->mvert;
+  return remesh_reproject_find_nearest(
+      bvhtree, target->totvert, [&](const int i, float *r_co) {
+        copy_v3_v3(r_co, target_verts[i].co);
+      });
+}
+
 void BKE_mesh_remesh_reproject_paint_mask(Mesh *target, Mesh *source)
 {
   BVHTreeFromMesh bvhtree = {nullptr};
   BKE_bvhtree_from_mesh_get(&bvhtree, source, BVHTREE_FROM_VERTS, 2);
-  MVert *target_verts = (MVert *)CustomData_get_layer(&target->vdata, CD_MVERT);
 
   float *target_mask;
   if (CustomData_has_layer(&target->vdata, CD_PAINT_MASK)) {
@@ -299,17 +454,14 @@ void BKE_mesh_remesh_reproject_paint_mask(Mesh *target, Mesh *source)
         &source->vdata, CD_PAINT_MASK, CD_CALLOC, nullptr, source->totvert);
   }
 
-  for (int i = 0; i < target->totvert; i++) {
-    float from_co[3];
-    BVHTreeNearest nearest;
-    nearest.index = -1;
-    nearest.dist_sq = FLT_MAX;
-    copy_v3_v3(from_co, target_verts[i].co);
-    BLI_bvhtree_find_nearest(bvhtree.tree, from_co, &nearest, bvhtree.nearest_callback, &bvhtree);
-    if (nearest.index != -1) {
-      target_mask[i] = source_mask[nearest.index];
+  const Array<int> nearest_verts = remesh_reproject_find_nearest_verts(bvhtree, target);
+  threading::parallel_for(IndexRange(target->totvert), 4096, [&](const IndexRange range) {
+    for (const int i : range) {
+      if (nearest_verts[i] != -1) {
+        target_mask[i] = source_mask[nearest_verts[i]];
+      }
     }
-  }
+  });
   free_bvhtree_from_mesh(&bvhtree);
 }
 
@@ -342,21 +494,21 @@ void BKE_remesh_reproject_sculpt_face_sets(Mesh *target, Mesh *source)
   const MLoopTri *looptri = BKE_mesh_runtime_looptri_ensure(source);
   BKE_bvhtree_from_mesh_get(&bvhtree, source, BVHTREE_FROM_LOOPTRI, 2);
 
-  for (int i = 0; i < target->totpoly; i++) {
-    float from_co[3];
-    BVHTreeNearest nearest;
-    nearest.index = -1;
-    nearest.dist_sq = FLT_MAX;
-    const MPoly *mpoly = &target_polys[i];
-    BKE_mesh_calc_poly_center(mpoly, &target_loops[mpoly->loopstart], target_verts, from_co);
-    BLI_bvhtree_find_nearest(bvhtree.tree, from_co, &nearest, bvhtree.nearest_callback, &bvhtree);
-    if (nearest.index != -1) {
-      target_face_sets[i] = source_face_sets[looptri[nearest.index].poly];
-    }
-    else {
-      target_face_sets[i] = 1;
+  const Array<int> nearest_tris = remesh_reproject_find_nearest(
+      bvhtree, target->totpoly, [&](const int i, float *r_co) {
+        const MPoly *mpoly = &target_polys[i];
+        BKE_mesh_calc_poly_center(mpoly, &target_loops[mpoly->loopstart], target_verts, r_co);
+      });
+  threading::parallel_for(IndexRange(target->totpoly), 4096, [&](const IndexRange range) {
+    for (const int i : range) {
+      if (nearest_tris[i] != -1) {
+        target_face_sets[i] = source_face_sets[looptri[nearest_tris[i]].poly];
+      }
+      else {
+        target_face_sets[i] = 1;
+      }
     }
-  }
+  });
   free_bvhtree_from_mesh(&bvhtree);
 }
 
@@ -373,6 +525,8 @@ void BKE_remesh_reproject_vertex_paint(Mesh *target, const Mesh *source)
   MeshElemMap *target_lmap = nullptr;
   int *target_lmap_mem = nullptr;
 
+  Array<int> nearest_verts;
+
   while ((layer = BKE_id_attribute_from_index(
               const_cast<ID *>(&source->id), i++, ATTR_DOMAIN_MASK_COLOR, CD_MASK_COLOR_ALL))) {
     AttributeDomain domain = BKE_id_attribute_domain(&source->id, layer);
@@ -393,22 +547,22 @@ void BKE_remesh_reproject_vertex_paint(Mesh *target, const Mesh *source)
     size_t data_size = CustomData_sizeof(layer->type);
     void *target_data = target_cdata->layers[layer_i].data;
     void *source_data = layer->data;
-    MVert *target_verts = (MVert *)CustomData_get_layer(&target->vdata, CD_MVERT);
+
+    /* The nearest vertices are the same for all layers. */
+    if (nearest_verts.is_empty()) {
+      nearest_verts = remesh_reproject_find_nearest_verts(bvhtree, target);
+    }
 
     if (domain == ATTR_DOMAIN_POINT) {
-      for (int i = 0; i < target->totvert; i++) {
-        BVHTreeNearest nearest;
-        nearest.index = -1;
-        nearest.dist_sq = FLT_MAX;
-        BLI_bvhtree_find_nearest(
-            bvhtree.tree, target_verts[i].co, &nearest, bvhtree.nearest_callback, &bvhtree);
-
-        if (nearest.index != -1) {
-          memcpy(POINTER_OFFSET(target_data, (size_t)i * data_size),
-                 POINTER_OFFSET(source_data, (size_t)nearest.index * data_size),
-                 data_size);
+      threading::parallel_for(IndexRange(target->totvert), 4096, [&](const IndexRange range) {
+        for (const int i : range) {
+          if (nearest_verts[i] != -1) {
+            memcpy(POINTER_OFFSET(target_data, (size_t)i * data_size),
+                   POINTER_OFFSET(source_data, (size_t)nearest_verts[i] * data_size),
+                   data_size);
+          }
         }
-      }
+      });
     }
     else {
       /* Lazily init vertex -> loop maps. */
@@ -435,46 +589,43 @@ void BKE_remesh_reproject_vertex_paint(Mesh *target, const Mesh *source)
                                       target->totloop);
       }
 
-      for (int i = 0; i < target->totvert; i++) {
-        BVHTreeNearest nearest;
-        nearest.index = -1;
-        nearest.dist_sq = FLT_MAX;
-        BLI_bvhtree_find_nearest(
-            bvhtree.tree, target_verts[i].co, &nearest, bvhtree.nearest_callback, &bvhtree);
-
-        if (nearest.index == -1) {
-          continue;
-        }
-
-        MeshElemMap *source_loops = source_lmap + nearest.index;
-        MeshElemMap *target_loops = target_lmap + i;
-
-        if (target_loops->count == 0 || source_loops->count == 0) {
-          continue;
-        }
-
-        /*
-         * Average color data for loops around the source vertex into
-         * the first target loop around the target vertex
-         */
-
-        CustomData_interp(source_cdata,
-                          target_cdata,
-                          source_loops->indices,
-                          nullptr,
-                          nullptr,
-                          source_loops->count,
-                          target_loops->indices[0]);
-
-        void *elem = POINTER_OFFSET(target_data, (size_t)target_loops->indices[0] * data_size);
-
-        /* Copy to rest of target loops. */
-        for (int j = 1; j < target_loops->count; j++) {
-          memcpy(POINTER_OFFSET(target_data, (size_t)target_loops->indices[j] * data_size),
-                 elem,
-                 data_size);
+      /* Every target vertex writes to its own loops only. */
+      threading::parallel_for(IndexRange(target->totvert), 1024, [&](const IndexRange range) {
+        for (const int i : range) {
+          if (nearest_verts[i] == -1) {
+            continue;
+          }
+
+          MeshElemMap *source_loops = source_lmap + nearest_verts[i];
+          MeshElemMap *target_loops = target_lmap + i;
+
+          if (target_loops->count == 0 || source_loops->count == 0) {
+            continue;
+          }
+
+          /*
+           * Average color data for loops around the source vertex into
+           * the first target loop around the target vertex
+           */
+
+          CustomData_interp(source_cdata,
+                            target_cdata,
+                            source_loops->indices,
+                            nullptr,
+                            nullptr,
+                            source_loops->count,
+                            target_loops->indices[0]);
+
+          void *elem = POINTER_OFFSET(target_data, (size_t)target_loops->indices[0] * data_size);
+
+          /* Copy to rest of target loops. */
+          for (int j = 1; j < target_loops->count; j++) {
+            memcpy(POINTER_OFFSET(target_data, (size_t)target_loops->indices[j] * data_size),
+                   elem,
+                   data_size);
+          }
         }
-      }
+      });
     }
   }
 
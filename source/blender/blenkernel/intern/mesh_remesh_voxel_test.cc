@@ -0,0 +1,131 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "testing/testing.h"
+
+#include "BLI_math_vector.h"
+
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+#include "BKE_mesh_remesh_voxel.h"
+#include "BKE_mesh_runtime.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "mesh_test_utils.hh"
+
+namespace blender::bke::tests {
+
+class MeshRemeshVoxelTest : public MeshTest {
+};
+
+TEST_F(MeshRemeshVoxelTest, geometry_hash_swapped_coordinates)
+{
+  Mesh *mesh = create_grid_mesh(4, 4);
+  const uint64_t hash = BKE_mesh_remesh_voxel_geometry_hash(mesh);
+  EXPECT_EQ(BKE_mesh_remesh_voxel_geometry_hash(mesh), hash);
+
+  /* Swapping a single coordinate between two vertices changes the geometry. */
+  for (const int axis : IndexRange(3)) {
+    mesh->mvert[1].co[axis] = 2.0f;
+    mesh->mvert[2].co[axis] = 1.0f;
+    const uint64_t hash_a = BKE_mesh_remesh_voxel_geometry_hash(mesh);
+    std::swap(mesh->mvert[1].co[axis], mesh->mvert[2].co[axis]);
+    const uint64_t hash_b = BKE_mesh_remesh_voxel_geometry_hash(mesh);
+    EXPECT_NE(hash_a, hash_b);
+    mesh->mvert[1].co[axis] = 0.0f;
+    mesh->mvert[2].co[axis] = 0.0f;
+  }
+
+  /* Swapping all coordinates of two vertices changes the geometry as well. */
+  mesh->mvert[1].co[1] = 5.0f;
+  const uint64_t hash_unswapped = BKE_mesh_remesh_voxel_geometry_hash(mesh);
+  swap_v3_v3(mesh->mvert[1].co, mesh->mvert[2].co);
+  EXPECT_NE(BKE_mesh_remesh_voxel_geometry_hash(mesh), hash_unswapped);
+
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(MeshRemeshVoxelTest, geometry_hash_invalidation)
+{
+  Mesh *mesh = create_grid_mesh(4, 4);
+  const uint64_t hash = BKE_mesh_remesh_voxel_geometry_hash(mesh);
+
+  /* Moving a vertex changes the hash, moving it back restores it. */
+  mesh->mvert[5].co[2] = 1e-4f;
+  EXPECT_NE(BKE_mesh_remesh_voxel_geometry_hash(mesh), hash);
+  mesh->mvert[5].co[2] = 0.0f;
+  EXPECT_EQ(BKE_mesh_remesh_voxel_geometry_hash(mesh), hash);
+
+  /* Changing the vertices of a face with the same positions changes the hash too. */
+  std::swap(mesh->mloop[0].v, mesh->mloop[2].v);
+  BKE_mesh_runtime_clear_geometry(mesh);
+  EXPECT_NE(BKE_mesh_remesh_voxel_geometry_hash(mesh), hash);
+
+  BKE_id_free(nullptr, mesh);
+}
+
+#ifdef WITH_OPENVDB
+
+static Mesh *create_cube_mesh(const float size)
+{
+  Mesh *mesh = BKE_mesh_new_nomain(8, 0, 0, 24, 6);
+  for (const int i : IndexRange(8)) {
+    copy_v3_fl3(mesh->mvert[i].co, (i & 1) * size, ((i >> 1) & 1) * size, (i >> 2) * size);
+  }
+  const int faces[6][4] = {
+      {0, 2, 3, 1}, {4, 5, 7, 6}, {0, 1, 5, 4}, {2, 6, 7, 3}, {0, 4, 6, 2}, {1, 3, 7, 5}};
+  for (const int face : IndexRange(6)) {
+    mesh->mpoly[face].loopstart = face * 4;
+    mesh->mpoly[face].totloop = 4;
+    for (const int corner : IndexRange(4)) {
+      mesh->mloop[face * 4 + corner].v = faces[face][corner];
+    }
+  }
+  BKE_mesh_calc_edges(mesh, false, false);
+  return mesh;
+}
+
+static float mesh_max_x(const Mesh *mesh)
+{
+  float max_x = -FLT_MAX;
+  for (const int i : IndexRange(mesh->totvert)) {
+    max_x = std::max(max_x, mesh->mvert[i].co[0]);
+  }
+  return max_x;
+}
+
+TEST_F(MeshRemeshVoxelTest, cached_level_set_invalidation)
+{
+  Mesh *mesh = create_cube_mesh(1.0f);
+  RemeshVoxelCache *cache = nullptr;
+
+  Mesh *result = BKE_mesh_remesh_voxel_cached(mesh, 0.1f, 0.0f, 0.0f, &cache);
+  ASSERT_NE(result, nullptr);
+  const float max_x = mesh_max_x(result);
+  BKE_id_free(nullptr, result);
+
+  /* Only the adaptivity changed, the result of the cached level set matches. */
+  result = BKE_mesh_remesh_voxel_cached(mesh, 0.1f, 0.5f, 0.0f, &cache);
+  EXPECT_FLOAT_EQ(mesh_max_x(result), max_x);
+  BKE_id_free(nullptr, result);
+
+  /* Scale the cube along the X axis, the cache must not be used. */
+  for (const int i : IndexRange(mesh->totvert)) {
+    mesh->mvert[i].co[0] *= 2.0f;
+  }
+  result = BKE_mesh_remesh_voxel_cached(mesh, 0.1f, 0.0f, 0.0f, &cache);
+  Mesh *expected = BKE_mesh_remesh_voxel(mesh, 0.1f, 0.0f, 0.0f);
+  EXPECT_GT(mesh_max_x(result), max_x + 0.5f);
+  EXPECT_FLOAT_EQ(mesh_max_x(result), mesh_max_x(expected));
+  EXPECT_EQ(result->totvert, expected->totvert);
+  BKE_id_free(nullptr, result);
+  BKE_id_free(nullptr, expected);
+
+  BKE_mesh_remesh_voxel_cache_free(cache);
+  BKE_id_free(nullptr, mesh);
+}
+
+#endif
+
+}  // namespace blender::bke::tests
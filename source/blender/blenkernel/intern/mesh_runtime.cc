@@ -13,12 +13,14 @@
 #include "DNA_meshdata_types.h"
 #include "DNA_object_types.h"
 
+#include "BLI_array.hh"
 #include "BLI_math_geom.h"
 #include "BLI_task.hh"
 
 #include "BKE_bvhutils.h"
 #include "BKE_lib_id.h"
 #include "BKE_mesh.h"
+#include "BKE_mesh_mapping.h"
 #include "BKE_mesh_runtime.h"
 #include "BKE_shrinkwrap.h"
 #include "BKE_subdiv_ccg.h"
@@ -40,6 +42,8 @@ static void mesh_runtime_init_mutexes(Mesh *mesh)
   BLI_mutex_init(static_cast<ThreadMutex *>(mesh->runtime.normals_mutex));
   mesh->runtime.render_mutex = MEM_new<ThreadMutex>("mesh runtime render_mutex");
   BLI_mutex_init(static_cast<ThreadMutex *>(mesh->runtime.render_mutex));
+  mesh->runtime.topology_mutex = MEM_new<ThreadMutex>("mesh runtime topology_mutex");
+  BLI_mutex_init(static_cast<ThreadMutex *>(mesh->runtime.topology_mutex));
 }
 
 /**
@@ -62,6 +66,11 @@ static void mesh_runtime_free_mutexes(Mesh *mesh)
     MEM_freeN(mesh->runtime.render_mutex);
     mesh->runtime.render_mutex = nullptr;
   }
+  if (mesh->runtime.topology_mutex != nullptr) {
+    BLI_mutex_end(static_cast<ThreadMutex *>(mesh->runtime.topology_mutex));
+    MEM_freeN(mesh->runtime.topology_mutex);
+    mesh->runtime.topology_mutex = nullptr;
+  }
 }
 
 void BKE_mesh_runtime_init_data(Mesh *mesh)
@@ -92,6 +101,12 @@ void BKE_mesh_runtime_reset_on_copy(Mesh *mesh, const int UNUSED(flag))
   runtime->poly_normals_dirty = true;
   runtime->vert_normals = nullptr;
   runtime->poly_normals = nullptr;
+  runtime->normals_dirty_verts = nullptr;
+
+  runtime->vert_to_edge_map = nullptr;
+  runtime->vert_to_loop_map = nullptr;
+  runtime->vert_to_poly_map = nullptr;
+  runtime->edge_to_poly_map = nullptr;
 
   mesh_runtime_init_mutexes(mesh);
 }
@@ -192,6 +207,178 @@ const MLoopTri *BKE_mesh_runtime_looptri_ensure(const Mesh *mesh)
   return looptri;
 }
 
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Mesh Topology Maps
+ *
+ * The maps are built with a counting pass followed by a prefix sum and a fill pass, which keeps
+ * the indices of every element sorted and avoids the per-element allocations of the older
+ * #MeshElemMap based functions in `mesh_mapping.c`.
+ * \{ */
+
+static MeshTopologyMap *topology_map_alloc(const int elems_num)
+{
+  MeshTopologyMap *map = MEM_cnew<MeshTopologyMap>(__func__);
+  map->elems_num = elems_num;
+  map->offsets = static_cast<int *>(MEM_calloc_arrayN(elems_num + 1, sizeof(int), __func__));
+  return map;
+}
+
+static void topology_map_free(MeshTopologyMap **map)
+{
+  if (*map == nullptr) {
+    return;
+  }
+  MEM_SAFE_FREE((*map)->offsets);
+  MEM_SAFE_FREE((*map)->indices);
+  MEM_freeN(*map);
+  *map = nullptr;
+}
+
+/**
+ * Turn the per-element counts stored in the offsets array into start offsets, allocate the
+ * indices array and return the write cursors for the fill pass.
+ */
+static blender::Array<int> topology_map_finalize_offsets(MeshTopologyMap *map)
+{
+  int offset = 0;
+  for (const int i : blender::IndexRange(map->elems_num)) {
+    const int count = map->offsets[i];
+    map->offsets[i] = offset;
+    offset += count;
+  }
+  map->offsets[map->elems_num] = offset;
+  map->indices = static_cast<int *>(MEM_malloc_arrayN(offset, sizeof(int), __func__));
+  return blender::Array<int>(blender::Span<int>(map->offsets, map->elems_num));
+}
+
+static MeshTopologyMap *topology_map_build_vert_edge(const Mesh *mesh)
+{
+  MeshTopologyMap *map = topology_map_alloc(mesh->totvert);
+  const blender::Span<MEdge> edges(mesh->medge, mesh->totedge);
+  for (const MEdge &edge : edges) {
+    map->offsets[edge.v1]++;
+    map->offsets[edge.v2]++;
+  }
+  blender::Array<int> cursors = topology_map_finalize_offsets(map);
+  for (const int i : edges.index_range()) {
+    map->indices[cursors[edges[i].v1]++] = i;
+    map->indices[cursors[edges[i].v2]++] = i;
+  }
+  return map;
+}
+
+static MeshTopologyMap *topology_map_build_vert_loop(const Mesh *mesh)
+{
+  MeshTopologyMap *map = topology_map_alloc(mesh->totvert);
+  const blender::Span<MLoop> loops(mesh->mloop, mesh->totloop);
+  for (const MLoop &loop : loops) {
+    map->offsets[loop.v]++;
+  }
+  blender::Array<int> cursors = topology_map_finalize_offsets(map);
+  for (const int i : loops.index_range()) {
+    map->indices[cursors[loops[i].v]++] = i;
+  }
+  return map;
+}
+
+static MeshTopologyMap *topology_map_build_vert_poly(const Mesh *mesh)
+{
+  MeshTopologyMap *map = topology_map_alloc(mesh->totvert);
+  const blender::Span<MPoly> polys(mesh->mpoly, mesh->totpoly);
+  const blender::Span<MLoop> loops(mesh->mloop, mesh->totloop);
+  for (const MLoop &loop : loops) {
+    map->offsets[loop.v]++;
+  }
+  blender::Array<int> cursors = topology_map_finalize_offsets(map);
+  for (const int i : polys.index_range()) {
+    const MPoly &poly = polys[i];
+    for (const MLoop &loop : loops.slice(poly.loopstart, poly.totloop)) {
+      map->indices[cursors[loop.v]++] = i;
+    }
+  }
+  return map;
+}
+
+static MeshTopologyMap *topology_map_build_edge_poly(const Mesh *mesh)
+{
+  MeshTopologyMap *map = topology_map_alloc(mesh->totedge);
+  const blender::Span<MPoly> polys(mesh->mpoly, mesh->totpoly);
+  const blender::Span<MLoop> loops(mesh->mloop, mesh->totloop);
+  for (const MLoop &loop : loops) {
+    map->offsets[loop.e]++;
+  }
+  blender::Array<int> cursors = topology_map_finalize_offsets(map);
+  for (const int i : polys.index_range()) {
+    const MPoly &poly = polys[i];
+    for (const MLoop &loop : loops.slice(poly.loopstart, poly.totloop)) {
+      map->indices[cursors[loop.e]++] = i;
+    }
+  }
+  return map;
+}
+
+static const MeshTopologyMap *mesh_topology_map_ensure(const Mesh *mesh,
+                                                       MeshTopologyMap **map_cache,
+                                                       MeshTopologyMap *(*build_fn)(const Mesh *))
+{
+  ThreadMutex *topology_mutex = (ThreadMutex *)mesh->runtime.topology_mutex;
+  BLI_mutex_lock(topology_mutex);
+
+  if (*map_cache == nullptr) {
+    /* Must isolate multithreaded tasks while holding a mutex lock. */
+    blender::threading::isolate_task([&]() { *map_cache = build_fn(mesh); });
+  }
+  const MeshTopologyMap *map = *map_cache;
+
+  BLI_mutex_unlock(topology_mutex);
+
+  return map;
+}
+
+const MeshTopologyMap *BKE_mesh_runtime_vert_edge_map_ensure(const Mesh *mesh)
+{
+  return mesh_topology_map_ensure(mesh,
+                                  &const_cast<Mesh *>(mesh)->runtime.vert_to_edge_map,
+                                  topology_map_build_vert_edge);
+}
+
+const MeshTopologyMap *BKE_mesh_runtime_vert_loop_map_ensure(const Mesh *mesh)
+{
+  return mesh_topology_map_ensure(mesh,
+                                  &const_cast<Mesh *>(mesh)->runtime.vert_to_loop_map,
+                                  topology_map_build_vert_loop);
+}
+
+const MeshTopologyMap *BKE_mesh_runtime_vert_poly_map_ensure(const Mesh *mesh)
+{
+  return mesh_topology_map_ensure(mesh,
+                                  &const_cast<Mesh *>(mesh)->runtime.vert_to_poly_map,
+                                  topology_map_build_vert_poly);
+}
+
+const MeshTopologyMap *BKE_mesh_runtime_edge_poly_map_ensure(const Mesh *mesh)
+{
+  return mesh_topology_map_ensure(mesh,
+                                  &const_cast<Mesh *>(mesh)->runtime.edge_to_poly_map,
+                                  topology_map_build_edge_poly);
+}
+
+static void mesh_runtime_clear_topology_maps(Mesh *mesh)
+{
+  topology_map_free(&mesh->runtime.vert_to_edge_map);
+  topology_map_free(&mesh->runtime.vert_to_loop_map);
+  topology_map_free(&mesh->runtime.vert_to_poly_map);
+  topology_map_free(&mesh->runtime.edge_to_poly_map);
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Mesh Runtime Data Utils
+ * \{ */
+
 void BKE_mesh_runtime_verttri_from_looptri(MVertTri *r_verttri,
                                            const MLoop *mloop,
                                            const MLoopTri *looptri,
@@ -255,6 +442,7 @@ void BKE_mesh_runtime_clear_geometry(Mesh *mesh)
     mesh->runtime.subdiv_ccg = nullptr;
   }
   BKE_shrinkwrap_discard_boundary_data(mesh);
+  mesh_runtime_clear_topology_maps(mesh);
 
   MEM_SAFE_FREE(mesh->runtime.subsurf_face_dot_tags);
 }
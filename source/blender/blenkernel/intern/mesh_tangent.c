@@ -8,6 +8,7 @@
  */
 
 #include <limits.h>
+#include <stdlib.h>
 
 #include "MEM_guardedalloc.h"
 
@@ -220,13 +221,30 @@ typedef struct {
   int num_face_as_quad_map;
 #endif
 
+  /* When only calculating a chunk of the mesh, the 'fake' faces passed to mikktspace
+   * (sorted, the faces of the chunk and all faces sharing a vertex with them),
+   * tangents are only written for the faces in the `[chunk_start, chunk_end)` range. */
+  const int *chunk_faces;
+  int chunk_faces_num;
+  int chunk_start;
+  int chunk_end;
 } SGLSLMeshToTangent;
 
+/* Map face index passed by mikktspace to the 'fake' face index. */
+BLI_INLINE int dm_ts_face_index(const SGLSLMeshToTangent *pMesh, const int chunk_face_num)
+{
+  return pMesh->chunk_faces ? pMesh->chunk_faces[chunk_face_num] : chunk_face_num;
+}
+
 /* interface */
 static int dm_ts_GetNumFaces(const SMikkTSpaceContext *pContext)
 {
   SGLSLMeshToTangent *pMesh = pContext->m_pUserData;
 
+  if (pMesh->chunk_faces) {
+    return pMesh->chunk_faces_num;
+  }
+
 #ifdef USE_LOOPTRI_DETECT_QUADS
   return pMesh->num_face_as_quad_map;
 #else
@@ -234,10 +252,12 @@ static int dm_ts_GetNumFaces(const SMikkTSpaceContext *pContext)
 #endif
 }
 
-static int dm_ts_GetNumVertsOfFace(const SMikkTSpaceContext *pContext, const int face_num)
+static int dm_ts_GetNumVertsOfFace(const SMikkTSpaceContext *pContext,
+                                   const int chunk_face_num)
 {
 #ifdef USE_LOOPTRI_DETECT_QUADS
   SGLSLMeshToTangent *pMesh = pContext->m_pUserData;
+  const int face_num = dm_ts_face_index(pMesh, chunk_face_num);
   if (pMesh->face_as_quad_map) {
     const MLoopTri *lt = &pMesh->looptri[pMesh->face_as_quad_map[face_num]];
     const MPoly *mp = &pMesh->mpoly[lt->poly];
@@ -247,18 +267,19 @@ static int dm_ts_GetNumVertsOfFace(const SMikkTSpaceContext *pContext, const int
   }
   return 3;
 #else
-  UNUSED_VARS(pContext, face_num);
+  UNUSED_VARS(pContext, chunk_face_num);
   return 3;
 #endif
 }
 
 static void dm_ts_GetPosition(const SMikkTSpaceContext *pContext,
                               float r_co[3],
-                              const int face_num,
+                              const int chunk_face_num,
                               const int vert_index)
 {
   // assert(vert_index >= 0 && vert_index < 4);
   SGLSLMeshToTangent *pMesh = pContext->m_pUserData;
+  const int face_num = dm_ts_face_index(pMesh, chunk_face_num);
   const MLoopTri *lt;
   uint loop_index;
   const float *co;
@@ -288,11 +309,12 @@ finally:
 
 static void dm_ts_GetTextureCoordinate(const SMikkTSpaceContext *pContext,
                                        float r_uv[2],
-                                       const int face_num,
+                                       const int chunk_face_num,
                                        const int vert_index)
 {
   // assert(vert_index >= 0 && vert_index < 4);
   SGLSLMeshToTangent *pMesh = pContext->m_pUserData;
+  const int face_num = dm_ts_face_index(pMesh, chunk_face_num);
   const MLoopTri *lt;
   uint loop_index;
 
@@ -327,11 +349,12 @@ finally:
 
 static void dm_ts_GetNormal(const SMikkTSpaceContext *pContext,
                             float r_no[3],
-                            const int face_num,
+                            const int chunk_face_num,
                             const int vert_index)
 {
   // assert(vert_index >= 0 && vert_index < 4);
   SGLSLMeshToTangent *pMesh = (SGLSLMeshToTangent *)pContext->m_pUserData;
+  const int face_num = dm_ts_face_index(pMesh, chunk_face_num);
   const MLoopTri *lt;
   uint loop_index;
 
@@ -389,11 +412,16 @@ finally:
 static void dm_ts_SetTSpace(const SMikkTSpaceContext *pContext,
                             const float fvTangent[3],
                             const float fSign,
-                            const int face_num,
+                            const int chunk_face_num,
                             const int vert_index)
 {
   // assert(vert_index >= 0 && vert_index < 4);
   SGLSLMeshToTangent *pMesh = (SGLSLMeshToTangent *)pContext->m_pUserData;
+  const int face_num = dm_ts_face_index(pMesh, chunk_face_num);
+  if (pMesh->chunk_faces && (face_num < pMesh->chunk_start || face_num >= pMesh->chunk_end)) {
+    /* The face is only used as context, its tangents are written by another chunk. */
+    return;
+  }
   const MLoopTri *lt;
   uint loop_index;
 
@@ -423,26 +451,252 @@ finally:
   pRes[3] = fSign;
 }
 
+static void dm_calc_loop_tangents_mikktspace(SGLSLMeshToTangent *mesh2tangent)
+{
+  SMikkTSpaceContext sContext = {NULL};
+  SMikkTSpaceInterface sInterface = {NULL};
+
+  sContext.m_pUserData = mesh2tangent;
+  sContext.m_pInterface = &sInterface;
+  sInterface.m_getNumFaces = dm_ts_GetNumFaces;
+  sInterface.m_getNumVerticesOfFace = dm_ts_GetNumVertsOfFace;
+  sInterface.m_getPosition = dm_ts_GetPosition;
+  sInterface.m_getTexCoord = dm_ts_GetTextureCoordinate;
+  sInterface.m_getNormal = dm_ts_GetNormal;
+  sInterface.m_setTSpaceBasic = dm_ts_SetTSpace;
+
+  /* 0 if failed */
+  genTangSpaceDefault(&sContext);
+}
+
 static void DM_calc_loop_tangents_thread(TaskPool *__restrict UNUSED(pool), void *taskdata)
 {
-  struct SGLSLMeshToTangent *mesh2tangent = taskdata;
-  /* new computation method */
-  {
-    SMikkTSpaceContext sContext = {NULL};
-    SMikkTSpaceInterface sInterface = {NULL};
-
-    sContext.m_pUserData = mesh2tangent;
-    sContext.m_pInterface = &sInterface;
-    sInterface.m_getNumFaces = dm_ts_GetNumFaces;
-    sInterface.m_getNumVerticesOfFace = dm_ts_GetNumVertsOfFace;
-    sInterface.m_getPosition = dm_ts_GetPosition;
-    sInterface.m_getTexCoord = dm_ts_GetTextureCoordinate;
-    sInterface.m_getNormal = dm_ts_GetNormal;
-    sInterface.m_setTSpaceBasic = dm_ts_SetTSpace;
-
-    /* 0 if failed */
-    genTangSpaceDefault(&sContext);
+  SGLSLMeshToTangent *mesh2tangent = taskdata;
+  dm_calc_loop_tangents_mikktspace(mesh2tangent);
+}
+
+/* -------------------------------------------------------------------- */
+/* Chunked Tangent Calculation
+ *
+ * Mikktspace is single threaded and its cost grows faster than linear with the number of faces,
+ * so large meshes are split into chunks of consecutive 'fake' faces which are calculated in
+ * parallel. The tangent of a corner only depends on the faces using the same vertex, so each
+ * chunk also passes the faces sharing a vertex with it to mikktspace but only writes the tangents
+ * of its own faces. The result matches calculating the whole mesh at once, except for vertices
+ * that mikktspace would weld to a different vertex with the same position, normal and UV. */
+
+/* Meshes with at least two chunks of this many 'fake' faces are calculated in chunks. */
+#define TANGENT_CHUNK_SIZE 8192
+
+/* Map from vertices to the 'fake' faces using them, shared by all chunks. */
+typedef struct TangentVertFaceMap {
+  int *offsets;
+  int *faces;
+} TangentVertFaceMap;
+
+typedef struct TangentChunkTaskData {
+  /* One for every tangent layer, in the same order. */
+  const SGLSLMeshToTangent *layers;
+  int layers_num;
+  const TangentVertFaceMap *vert_face_map;
+  int chunk_start;
+  int chunk_end;
+} TangentChunkTaskData;
+
+static int dm_ts_face_loops_get(const SGLSLMeshToTangent *pMesh,
+                                const int face_num,
+                                uint r_loops[4])
+{
+  const MLoopTri *lt;
+#ifdef USE_LOOPTRI_DETECT_QUADS
+  if (pMesh->face_as_quad_map) {
+    lt = &pMesh->looptri[pMesh->face_as_quad_map[face_num]];
+    const MPoly *mp = &pMesh->mpoly[lt->poly];
+    if (mp->totloop == 4) {
+      for (int i = 0; i < 4; i++) {
+        r_loops[i] = (uint)(mp->loopstart + i);
+      }
+      return 4;
+    }
+  }
+  else {
+    lt = &pMesh->looptri[face_num];
+  }
+#else
+  lt = &pMesh->looptri[face_num];
+#endif
+  for (int i = 0; i < 3; i++) {
+    r_loops[i] = lt->tri[i];
+  }
+  return 3;
+}
+
+static uint dm_ts_face_poly_get(const SGLSLMeshToTangent *pMesh, const int face_num)
+{
+#ifdef USE_LOOPTRI_DETECT_QUADS
+  if (pMesh->face_as_quad_map) {
+    return pMesh->looptri[pMesh->face_as_quad_map[face_num]].poly;
+  }
+#endif
+  return pMesh->looptri[face_num].poly;
+}
+
+static void dm_ts_vert_face_map_create(const SGLSLMeshToTangent *pMesh,
+                                       const int faces_num,
+                                       TangentVertFaceMap *r_map)
+{
+  uint loops[4];
+  uint verts_num = 0;
+  for (int face = 0; face < faces_num; face++) {
+    const int loops_num = dm_ts_face_loops_get(pMesh, face, loops);
+    for (int i = 0; i < loops_num; i++) {
+      verts_num = max_uu(verts_num, pMesh->mloop[loops[i]].v + 1);
+    }
+  }
+
+  int *offsets = MEM_calloc_arrayN((size_t)verts_num + 1, sizeof(int), __func__);
+  for (int face = 0; face < faces_num; face++) {
+    const int loops_num = dm_ts_face_loops_get(pMesh, face, loops);
+    for (int i = 0; i < loops_num; i++) {
+      offsets[pMesh->mloop[loops[i]].v]++;
+    }
+  }
+  int offset = 0;
+  for (uint v = 0; v < verts_num; v++) {
+    const int count = offsets[v];
+    offsets[v] = offset;
+    offset += count;
+  }
+  offsets[verts_num] = offset;
+
+  int *faces = MEM_malloc_arrayN((size_t)offset, sizeof(int), __func__);
+  int *cursors = MEM_dupallocN(offsets);
+  for (int face = 0; face < faces_num; face++) {
+    const int loops_num = dm_ts_face_loops_get(pMesh, face, loops);
+    for (int i = 0; i < loops_num; i++) {
+      faces[cursors[pMesh->mloop[loops[i]].v]++] = face;
+    }
+  }
+  MEM_freeN(cursors);
+
+  r_map->offsets = offsets;
+  r_map->faces = faces;
+}
+
+static int dm_ts_cmp_int(const void *a_, const void *b_)
+{
+  const int a = *(const int *)a_;
+  const int b = *(const int *)b_;
+  return (a > b) - (a < b);
+}
+
+/**
+ * Gather the faces of the chunk and all faces sharing a vertex with them, sorted so mikktspace
+ * processes them in the same order as when calculating the whole mesh.
+ */
+static int *dm_ts_chunk_faces_create(const SGLSLMeshToTangent *pMesh,
+                                     const TangentVertFaceMap *map,
+                                     const int chunk_start,
+                                     const int chunk_end,
+                                     int *r_faces_num)
+{
+  uint loops[4];
+  int faces_max = 0;
+  for (int face = chunk_start; face < chunk_end; face++) {
+    const int loops_num = dm_ts_face_loops_get(pMesh, face, loops);
+    for (int i = 0; i < loops_num; i++) {
+      const uint v = pMesh->mloop[loops[i]].v;
+      faces_max += map->offsets[v + 1] - map->offsets[v];
+    }
+  }
+
+  int *faces = MEM_malloc_arrayN((size_t)faces_max, sizeof(int), __func__);
+  int faces_num = 0;
+  for (int face = chunk_start; face < chunk_end; face++) {
+    const int loops_num = dm_ts_face_loops_get(pMesh, face, loops);
+    for (int i = 0; i < loops_num; i++) {
+      const uint v = pMesh->mloop[loops[i]].v;
+      const int count = map->offsets[v + 1] - map->offsets[v];
+      memcpy(&faces[faces_num], &map->faces[map->offsets[v]], sizeof(int) * (size_t)count);
+      faces_num += count;
+    }
+  }
+
+  qsort(faces, (size_t)faces_num, sizeof(int), dm_ts_cmp_int);
+  int unique_num = 0;
+  for (int i = 0; i < faces_num; i++) {
+    if (unique_num == 0 || faces[unique_num - 1] != faces[i]) {
+      faces[unique_num++] = faces[i];
+    }
+  }
+
+  *r_faces_num = unique_num;
+  return faces;
+}
+
+static void DM_calc_loop_tangents_chunk_thread(TaskPool *__restrict UNUSED(pool), void *taskdata)
+{
+  const TangentChunkTaskData *data = taskdata;
+  if (data->layers_num == 0) {
+    return;
+  }
+
+  /* The faces only depend on the topology, so they are shared by all layers. */
+  int chunk_faces_num;
+  int *chunk_faces = dm_ts_chunk_faces_create(
+      &data->layers[0], data->vert_face_map, data->chunk_start, data->chunk_end, &chunk_faces_num);
+
+  for (int n = 0; n < data->layers_num; n++) {
+    SGLSLMeshToTangent mesh2tangent = data->layers[n];
+    mesh2tangent.chunk_faces = chunk_faces;
+    mesh2tangent.chunk_faces_num = chunk_faces_num;
+    mesh2tangent.chunk_start = data->chunk_start;
+    mesh2tangent.chunk_end = data->chunk_end;
+    dm_calc_loop_tangents_mikktspace(&mesh2tangent);
   }
+
+  MEM_freeN(chunk_faces);
+}
+
+/**
+ * Calculate all layers in parallel chunks. Chunks never split the faces of a polygon, since the
+ * looptris of an n-gon share loops that would be written by multiple chunks otherwise.
+ */
+static void dm_calc_loop_tangents_chunked(TaskPool *task_pool,
+                                          const SGLSLMeshToTangent *layers,
+                                          const int layers_num,
+                                          const int faces_num)
+{
+  TangentVertFaceMap vert_face_map;
+  dm_ts_vert_face_map_create(&layers[0], faces_num, &vert_face_map);
+
+  const int chunks_max = faces_num / TANGENT_CHUNK_SIZE + 1;
+  TangentChunkTaskData *chunks = MEM_malloc_arrayN((size_t)chunks_max, sizeof(*chunks), __func__);
+  int chunks_num = 0;
+  for (int chunk_start = 0; chunk_start < faces_num; chunks_num++) {
+    int chunk_end = min_ii(chunk_start + TANGENT_CHUNK_SIZE, faces_num);
+    while (chunk_end < faces_num && dm_ts_face_poly_get(&layers[0], chunk_end) ==
+                                        dm_ts_face_poly_get(&layers[0], chunk_end - 1)) {
+      chunk_end++;
+    }
+    BLI_assert(chunks_num < chunks_max);
+    TangentChunkTaskData *chunk = &chunks[chunks_num];
+    chunk->layers = layers;
+    chunk->layers_num = layers_num;
+    chunk->vert_face_map = &vert_face_map;
+    chunk->chunk_start = chunk_start;
+    chunk->chunk_end = chunk_end;
+    chunk_start = chunk_end;
+  }
+
+  for (int i = 0; i < chunks_num; i++) {
+    BLI_task_pool_push(task_pool, DM_calc_loop_tangents_chunk_thread, &chunks[i], false, NULL);
+  }
+  BLI_task_pool_work_and_wait(task_pool);
+
+  MEM_freeN(chunks);
+  MEM_freeN(vert_face_map.offsets);
+  MEM_freeN(vert_face_map.faces);
 }
 
 void BKE_mesh_add_loop_tangent_named_layer_for_uv(CustomData *uv_data,
@@ -624,11 +878,13 @@ void BKE_mesh_calc_loop_tangent_ex(const MVert *mvert,
       tangent_mask_curr = 0;
       /* Calculate tangent layers */
       SGLSLMeshToTangent data_array[MAX_MTFACE];
+      int data_array_num = 0;
       const int tangent_layer_num = CustomData_number_of_layers(loopdata_out, CD_TANGENT);
       for (int n = 0; n < tangent_layer_num; n++) {
         int index = CustomData_get_layer_index_n(loopdata_out, CD_TANGENT, n);
         BLI_assert(n < MAX_MTFACE);
-        SGLSLMeshToTangent *mesh2tangent = &data_array[n];
+        SGLSLMeshToTangent *mesh2tangent = &data_array[data_array_num];
+        memset(mesh2tangent, 0, sizeof(*mesh2tangent));
         mesh2tangent->numTessFaces = (int)looptri_len;
 #ifdef USE_LOOPTRI_DETECT_QUADS
         mesh2tangent->face_as_quad_map = face_as_quad_map;
@@ -667,11 +923,24 @@ void BKE_mesh_calc_loop_tangent_ex(const MVert *mvert,
         }
 
         mesh2tangent->tangent = loopdata_out->layers[index].data;
-        BLI_task_pool_push(task_pool, DM_calc_loop_tangents_thread, mesh2tangent, false, NULL);
+        data_array_num++;
       }
 
       BLI_assert(tangent_mask_curr == tangent_mask);
-      BLI_task_pool_work_and_wait(task_pool);
+#ifdef USE_LOOPTRI_DETECT_QUADS
+      const int faces_num = num_face_as_quad_map;
+#else
+      const int faces_num = (int)looptri_len;
+#endif
+      if (faces_num >= TANGENT_CHUNK_SIZE * 2) {
+        dm_calc_loop_tangents_chunked(task_pool, data_array, data_array_num, faces_num);
+      }
+      else {
+        for (int n = 0; n < data_array_num; n++) {
+          BLI_task_pool_push(task_pool, DM_calc_loop_tangents_thread, &data_array[n], false, NULL);
+        }
+        BLI_task_pool_work_and_wait(task_pool);
+      }
       BLI_task_pool_free(task_pool);
     }
     else {
@@ -0,0 +1,71 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_array.hh"
+#include "BLI_math_vec_types.hh"
+
+#include "BKE_customdata.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+#include "BKE_mesh_tangent.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "mesh_test_utils.hh"
+
+namespace blender::bke::tests {
+
+class MeshTangentTest : public MeshTest {
+};
+
+/**
+ * Create a grid of quads and triangles with randomly displaced vertices and a UV map named
+ * "UVMap", large enough to be split into multiple chunks by the tangent calculation.
+ */
+static Mesh *create_uv_grid(const int verts_x, const int verts_y)
+{
+  GridMeshOptions options;
+  options.noise = 0.5f;
+  options.use_triangles = true;
+  Mesh *mesh = create_grid_mesh(verts_x, verts_y, options);
+  for (MPoly &poly : MutableSpan(mesh->mpoly, mesh->totpoly)) {
+    poly.flag |= ME_SMOOTH;
+  }
+
+  MLoopUV *uvs = static_cast<MLoopUV *>(CustomData_add_layer_named(
+      &mesh->ldata, CD_MLOOPUV, CD_CALLOC, nullptr, mesh->totloop, "UVMap"));
+  for (const int i : IndexRange(mesh->totloop)) {
+    const MVert &vert = mesh->mvert[mesh->mloop[i].v];
+    uvs[i].uv[0] = vert.co[0] * 0.1f + vert.co[2] * 0.05f;
+    uvs[i].uv[1] = vert.co[1] * 0.07f;
+  }
+
+  BKE_mesh_calc_normals_split(mesh);
+  return mesh;
+}
+
+TEST_F(MeshTangentTest, chunked_tangents_match_single)
+{
+  Mesh *mesh = create_uv_grid(200, 150);
+
+  Array<float4> expected(mesh->totloop);
+  BKE_mesh_calc_loop_tangent_single(mesh, "UVMap", (float(*)[4])expected.data(), nullptr);
+
+  BKE_mesh_calc_loop_tangents(mesh, true, nullptr, 0);
+  const float4 *tangents = static_cast<const float4 *>(
+      CustomData_get_layer(&mesh->ldata, CD_TANGENT));
+  ASSERT_NE(tangents, nullptr);
+
+  for (const int i : IndexRange(mesh->totloop)) {
+    EXPECT_V3_NEAR(tangents[i], expected[i], 1e-5f);
+    EXPECT_EQ(tangents[i][3], expected[i][3]);
+  }
+
+  BKE_id_free(nullptr, mesh);
+}
+
+}  // namespace blender::bke::tests
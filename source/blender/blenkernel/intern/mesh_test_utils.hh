@@ -0,0 +1,113 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#pragma once
+
+#include "testing/testing.h"
+
+#include "CLG_log.h"
+
+#include "BLI_index_range.hh"
+#include "BLI_rand.hh"
+#include "BLI_span.hh"
+
+#include "BKE_idtype.h"
+#include "BKE_mesh.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+namespace blender::bke::tests {
+
+/** Fixture for tests which create meshes, which requires ID types and logging. */
+class MeshTest : public testing::Test {
+ public:
+  static void SetUpTestSuite()
+  {
+    CLG_init();
+    BKE_idtype_init();
+  }
+  static void TearDownTestSuite()
+  {
+    CLG_exit();
+  }
+};
+
+struct GridMeshOptions {
+  /** Maximum random offset of the vertices along the Z axis, with a fixed seed. */
+  float noise = 0.0f;
+  /** Split every third cell into two triangles, so that quads and triangles are used. */
+  bool use_triangles = false;
+  /** Number of rows of vertices at the end of the grid which are not used by any face. */
+  int loose_rows = 0;
+  /** Create edges for the faces. */
+  bool use_edges = false;
+};
+
+/**
+ * Create a grid in the XY plane with one vertex per unit, built row by row so that the first
+ * face uses the vertices `0, 1, verts_x + 1, verts_x`.
+ */
+inline Mesh *create_grid_mesh(const int verts_x,
+                              const int verts_y,
+                              const GridMeshOptions &options = {})
+{
+  const int cells_x = verts_x - 1;
+  const int cells_y = verts_y - 1 - options.loose_rows;
+  auto cell_is_split = [&](const int x, const int y) {
+    return options.use_triangles && (x + y) % 3 == 0;
+  };
+
+  int polys_num = 0;
+  int loops_num = 0;
+  for (const int y : IndexRange(cells_y)) {
+    for (const int x : IndexRange(cells_x)) {
+      polys_num += cell_is_split(x, y) ? 2 : 1;
+      loops_num += cell_is_split(x, y) ? 6 : 4;
+    }
+  }
+
+  Mesh *mesh = BKE_mesh_new_nomain(verts_x * verts_y, 0, 0, loops_num, polys_num);
+
+  RandomNumberGenerator rng(0);
+  for (const int y : IndexRange(verts_y)) {
+    for (const int x : IndexRange(verts_x)) {
+      MVert &vert = mesh->mvert[y * verts_x + x];
+      vert.co[0] = float(x);
+      vert.co[1] = float(y);
+      vert.co[2] = options.noise == 0.0f ? 0.0f : rng.get_float() * options.noise;
+    }
+  }
+
+  int poly_index = 0;
+  int loop_index = 0;
+  auto add_poly = [&](const Span<int> poly_verts) {
+    MPoly &poly = mesh->mpoly[poly_index++];
+    poly.loopstart = loop_index;
+    poly.totloop = poly_verts.size();
+    for (const int vert : poly_verts) {
+      mesh->mloop[loop_index++].v = vert;
+    }
+  };
+  for (const int y : IndexRange(cells_y)) {
+    for (const int x : IndexRange(cells_x)) {
+      const int v0 = y * verts_x + x;
+      const int v1 = v0 + 1;
+      const int v2 = v1 + verts_x;
+      const int v3 = v0 + verts_x;
+      if (cell_is_split(x, y)) {
+        add_poly({v0, v1, v2});
+        add_poly({v0, v2, v3});
+      }
+      else {
+        add_poly({v0, v1, v2, v3});
+      }
+    }
+  }
+
+  if (options.use_edges) {
+    BKE_mesh_calc_edges(mesh, false, false);
+  }
+  return mesh;
+}
+
+}  // namespace blender::bke::tests
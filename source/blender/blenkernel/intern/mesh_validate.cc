@@ -5,6 +5,7 @@
  * \ingroup bke
  */
 
+#include <algorithm>
 #include <climits>
 #include <cstdio>
 #include <cstdlib>
@@ -19,10 +20,14 @@
 
 #include "BLI_sys_types.h"
 
+#include "BLI_array.hh"
 #include "BLI_edgehash.h"
 #include "BLI_math_base.h"
 #include "BLI_math_vector.h"
+#include "BLI_span.hh"
+#include "BLI_task.hh"
 #include "BLI_utildefines.h"
+#include "BLI_vector.hh"
 
 #include "BKE_customdata.h"
 #include "BKE_deform.h"
@@ -32,6 +37,8 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "atomic_ops.h"
+
 /* loop v/e are unsigned, so using max uint_32 value as invalid marker... */
 #define INVALID_LOOP_EDGE_MARKER 4294967295u
 
@@ -1048,6 +1055,280 @@ bool BKE_mesh_validate_all_customdata(CustomData *vdata,
   return is_valid;
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Fast Validity Check
+ *
+ * Most meshes passed to #BKE_mesh_validate are valid already. Checking that is done in parallel
+ * and without sorting large arrays, the detailed (serial) validation is only used when something
+ * looks wrong. The checks are conservative: a valid mesh may still fail them, in which case the
+ * full validation decides.
+ * \{ */
+
+namespace blender::bke::mesh_validate {
+
+/**
+ * Group the indices of \a items_num elements by the vertex returned by \a get_vert, using a
+ * parallel counting sort. Every group is small for typical meshes.
+ */
+template<typename GetVertFn>
+static void group_by_vertex(const int verts_num,
+                            const int items_num,
+                            const GetVertFn &get_vert,
+                            Array<int> &r_offsets,
+                            Array<int> &r_indices)
+{
+  r_offsets.reinitialize(verts_num + 1);
+  r_offsets.fill(0);
+  threading::parallel_for(IndexRange(items_num), 4096, [&](IndexRange range) {
+    for (const int i : range) {
+      atomic_add_and_fetch_int32(&r_offsets[get_vert(i)], 1);
+    }
+  });
+  int offset = 0;
+  for (int &count : r_offsets) {
+    const int size = count;
+    count = offset;
+    offset += size;
+  }
+  Array<int> fill(r_offsets.as_span().drop_back(1));
+  r_indices.reinitialize(items_num);
+  threading::parallel_for(IndexRange(items_num), 4096, [&](IndexRange range) {
+    for (const int i : range) {
+      r_indices[atomic_fetch_and_add_int32(&fill[get_vert(i)], 1)] = i;
+    }
+  });
+}
+
+/** Check all values in parallel, \a check is called with index ranges and returns false on
+ * failure. */
+template<typename CheckFn>
+static bool all_of_parallel(const IndexRange range, const int64_t grain, const CheckFn &check)
+{
+  return threading::parallel_reduce(
+      range,
+      grain,
+      true,
+      [&](const IndexRange sub_range, const bool valid) { return valid && check(sub_range); },
+      [](const bool a, const bool b) { return a && b; });
+}
+
+static bool verts_are_likely_valid(const Mesh *mesh)
+{
+  const Span<MVert> verts{mesh->mvert, mesh->totvert};
+  const float(*vert_normals)[3] = BKE_mesh_vertex_normals_are_dirty(mesh) ?
+                                      nullptr :
+                                      BKE_mesh_vertex_normals_ensure(mesh);
+  return all_of_parallel(verts.index_range(), 4096, [&](const IndexRange range) {
+    for (const int i : range) {
+      const float *co = verts[i].co;
+      if (!(isfinite(co[0]) && isfinite(co[1]) && isfinite(co[2]))) {
+        return false;
+      }
+      /* See the zero normal check in #BKE_mesh_validate_arrays. */
+      if (vert_normals && is_zero_v3(vert_normals[i]) && !is_zero_v3(co)) {
+        return false;
+      }
+    }
+    return true;
+  });
+}
+
+static bool edges_are_likely_valid(const Mesh *mesh)
+{
+  const Span<MEdge> edges{mesh->medge, mesh->totedge};
+  const uint verts_num = uint(mesh->totvert);
+  if (!all_of_parallel(edges.index_range(), 4096, [&](const IndexRange range) {
+        for (const MEdge &edge : edges.slice(range)) {
+          if (edge.v1 == edge.v2 || edge.v1 >= verts_num || edge.v2 >= verts_num) {
+            return false;
+          }
+        }
+        return true;
+      })) {
+    return false;
+  }
+
+  /* Duplicate edges have the same lower vertex. */
+  Array<int> offsets;
+  Array<int> indices;
+  group_by_vertex(
+      mesh->totvert,
+      edges.size(),
+      [&](const int i) { return std::min(edges[i].v1, edges[i].v2); },
+      offsets,
+      indices);
+  return all_of_parallel(IndexRange(mesh->totvert), 1024, [&](const IndexRange range) {
+    Vector<uint, 16> other_verts;
+    for (const int v : range) {
+      other_verts.clear();
+      const Span<int> group = indices.as_span().slice(offsets[v], offsets[v + 1] - offsets[v]);
+      for (const int edge_index : group) {
+        other_verts.append(std::max(edges[edge_index].v1, edges[edge_index].v2));
+      }
+      std::sort(other_verts.begin(), other_verts.end());
+      if (std::adjacent_find(other_verts.begin(), other_verts.end()) != other_verts.end()) {
+        return false;
+      }
+    }
+    return true;
+  });
+}
+
+/** Polygons larger than this are left to the full validation. */
+static constexpr int LIKELY_VALID_MAX_POLY_SIZE = 64;
+
+static bool polys_are_likely_valid(const Mesh *mesh)
+{
+  const Span<MPoly> polys{mesh->mpoly, mesh->totpoly};
+  const Span<MLoop> loops{mesh->mloop, mesh->totloop};
+  const Span<MEdge> edges{mesh->medge, mesh->totedge};
+  const uint verts_num = uint(mesh->totvert);
+  const uint edges_num = uint(mesh->totedge);
+
+  if (polys.is_empty()) {
+    return loops.is_empty();
+  }
+  /* Loops must be used by exactly one polygon. Only the common layout with consecutive loops is
+   * accepted here. */
+  if (polys.first().loopstart != 0 ||
+      polys.last().loopstart + int64_t(polys.last().totloop) != loops.size()) {
+    return false;
+  }
+
+  if (!all_of_parallel(polys.index_range(), 1024, [&](const IndexRange range) {
+        for (const int poly_index : range) {
+          const MPoly &poly = polys[poly_index];
+          if (poly.mat_nr < 0 || poly.totloop < 3 ||
+              poly.totloop > LIKELY_VALID_MAX_POLY_SIZE) {
+            return false;
+          }
+          if (poly_index + 1 < polys.size() &&
+              polys[poly_index + 1].loopstart != poly.loopstart + poly.totloop) {
+            return false;
+          }
+          const Span<MLoop> poly_loops = loops.slice(poly.loopstart, poly.totloop);
+          for (const int i : poly_loops.index_range()) {
+            const MLoop &loop = poly_loops[i];
+            const uint v_next = poly_loops[(i + 1) % poly_loops.size()].v;
+            if (loop.v >= verts_num || loop.e >= edges_num) {
+              return false;
+            }
+            const MEdge &edge = edges[loop.e];
+            if (!((edge.v1 == loop.v && edge.v2 == v_next) ||
+                  (edge.v1 == v_next && edge.v2 == loop.v))) {
+              return false;
+            }
+            for (const int j : IndexRange(i)) {
+              if (poly_loops[j].v == loop.v) {
+                return false;
+              }
+            }
+          }
+        }
+        return true;
+      })) {
+    return false;
+  }
+
+  /* Polygons using the same vertices have the same lowest vertex. Only compare polygons that have
+   * the same size and vertex sum, a false positive just means the full validation is used. */
+  const auto poly_min_vert = [&](const int poly_index) {
+    const MPoly &poly = polys[poly_index];
+    uint min_vert = UINT_MAX;
+    for (const MLoop &loop : loops.slice(poly.loopstart, poly.totloop)) {
+      min_vert = std::min(min_vert, loop.v);
+    }
+    return min_vert;
+  };
+  const auto poly_vert_sum = [&](const int poly_index) {
+    const MPoly &poly = polys[poly_index];
+    uint64_t sum = 0;
+    for (const MLoop &loop : loops.slice(poly.loopstart, poly.totloop)) {
+      sum += loop.v;
+    }
+    return sum;
+  };
+  Array<int> offsets;
+  Array<int> indices;
+  group_by_vertex(mesh->totvert, polys.size(), poly_min_vert, offsets, indices);
+  return all_of_parallel(IndexRange(mesh->totvert), 1024, [&](const IndexRange range) {
+    for (const int v : range) {
+      const Span<int> group = indices.as_span().slice(offsets[v], offsets[v + 1] - offsets[v]);
+      for (const int i : group.index_range()) {
+        for (const int j : IndexRange(i)) {
+          if (polys[group[i]].totloop == polys[group[j]].totloop &&
+              poly_vert_sum(group[i]) == poly_vert_sum(group[j])) {
+            return false;
+          }
+        }
+      }
+    }
+    return true;
+  });
+}
+
+static bool deform_verts_are_likely_valid(const Mesh *mesh)
+{
+  if (mesh->dvert == nullptr) {
+    return true;
+  }
+  const Span<MDeformVert> dverts{mesh->dvert, mesh->totvert};
+  return all_of_parallel(dverts.index_range(), 4096, [&](const IndexRange range) {
+    for (const MDeformVert &dvert : dverts.slice(range)) {
+      for (const MDeformWeight &dw : Span(dvert.dw, dvert.totweight)) {
+        /* Written to also fail for NAN weights. */
+        if (!(dw.weight >= 0.0f && dw.weight <= 1.0f) || dw.def_nr >= INT_MAX) {
+          return false;
+        }
+      }
+    }
+    return true;
+  });
+}
+
+static bool select_history_is_likely_valid(const Mesh *mesh)
+{
+  for (const MSelect &msel : Span(mesh->mselect, mesh->mselect ? mesh->totselect : 0)) {
+    if (msel.index < 0) {
+      return false;
+    }
+    const int tot_elem = msel.type == ME_VSEL ? mesh->totvert :
+                         msel.type == ME_ESEL ? mesh->totedge :
+                         msel.type == ME_FSEL ? mesh->totpoly :
+                                                0;
+    if (msel.index > tot_elem) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Return true when #BKE_mesh_validate_arrays would neither report nor fix anything. A false
+ * return value does not mean the mesh is invalid.
+ */
+static bool mesh_is_likely_valid(const Mesh *mesh)
+{
+  if (mesh->mface && !mesh->mpoly) {
+    return false;
+  }
+  if (mesh->totedge == 0 && mesh->totpoly != 0) {
+    return false;
+  }
+  bool verts_valid, edges_valid, polys_valid, dverts_valid;
+  threading::parallel_invoke(
+      [&]() { verts_valid = verts_are_likely_valid(mesh); },
+      [&]() { edges_valid = edges_are_likely_valid(mesh); },
+      [&]() { polys_valid = polys_are_likely_valid(mesh); },
+      [&]() { dverts_valid = deform_verts_are_likely_valid(mesh); });
+  return verts_valid && edges_valid && polys_valid && dverts_valid &&
+         select_history_is_likely_valid(mesh);
+}
+
+}  // namespace blender::bke::mesh_validate
+
+/** \} */
+
 bool BKE_mesh_validate(Mesh *me, const bool do_verbose, const bool cddata_check_mask)
 {
   bool changed;
@@ -1069,21 +1350,26 @@ bool BKE_mesh_validate(Mesh *me, const bool do_verbose, const bool cddata_check_
                                    true,
                                    &changed);
 
-  BKE_mesh_validate_arrays(me,
-                           me->mvert,
-                           me->totvert,
-                           me->medge,
-                           me->totedge,
-                           me->mface,
-                           me->totface,
-                           me->mloop,
-                           me->totloop,
-                           me->mpoly,
-                           me->totpoly,
-                           me->dvert,
-                           do_verbose,
-                           true,
-                           &changed);
+  if (blender::bke::mesh_validate::mesh_is_likely_valid(me)) {
+    PRINT_MSG("%s: fast check passed, skipping detailed validation\n", __func__);
+  }
+  else {
+    BKE_mesh_validate_arrays(me,
+                             me->mvert,
+                             me->totvert,
+                             me->medge,
+                             me->totedge,
+                             me->mface,
+                             me->totface,
+                             me->mloop,
+                             me->totloop,
+                             me->mpoly,
+                             me->totpoly,
+                             me->dvert,
+                             do_verbose,
+                             true,
+                             &changed);
+  }
 
   if (changed) {
     DEG_id_tag_update(&me->id, ID_RECALC_GEOMETRY_ALL_MODES);
@@ -1117,6 +1403,10 @@ bool BKE_mesh_is_valid(Mesh *me)
       do_fixes,
       &changed);
 
+  if (blender::bke::mesh_validate::mesh_is_likely_valid(me)) {
+    return is_valid;
+  }
+
   is_valid &= BKE_mesh_validate_arrays(me,
                                        me->mvert,
                                        me->totvert,
@@ -1138,6 +1428,11 @@ bool BKE_mesh_is_valid(Mesh *me)
   return is_valid;
 }
 
+bool BKE_mesh_is_likely_valid(const Mesh *me)
+{
+  return blender::bke::mesh_validate::mesh_is_likely_valid(me);
+}
+
 bool BKE_mesh_validate_material_indices(Mesh *me)
 {
   /* Cast to unsigned to catch negative indices too. */
@@ -0,0 +1,114 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "testing/testing.h"
+
+#include <cmath>
+
+#include "BLI_function_ref.hh"
+
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "mesh_test_utils.hh"
+
+namespace blender::bke::tests {
+
+class MeshValidateTest : public MeshTest {
+};
+
+static Mesh *create_valid_grid()
+{
+  GridMeshOptions options;
+  options.use_triangles = true;
+  options.use_edges = true;
+  return create_grid_mesh(8, 6, options);
+}
+
+/** Run the detailed validation without fixing anything, skipping the fast check. */
+static bool mesh_is_valid_detailed(Mesh *mesh)
+{
+  bool changed = false;
+  const bool is_valid = BKE_mesh_validate_arrays(mesh,
+                                                 mesh->mvert,
+                                                 mesh->totvert,
+                                                 mesh->medge,
+                                                 mesh->totedge,
+                                                 mesh->mface,
+                                                 mesh->totface,
+                                                 mesh->mloop,
+                                                 mesh->totloop,
+                                                 mesh->mpoly,
+                                                 mesh->totpoly,
+                                                 mesh->dvert,
+                                                 false,
+                                                 false,
+                                                 &changed);
+  EXPECT_FALSE(changed);
+  return is_valid;
+}
+
+TEST_F(MeshValidateTest, valid_mesh)
+{
+  Mesh *mesh = create_valid_grid();
+  EXPECT_TRUE(BKE_mesh_is_likely_valid(mesh));
+  EXPECT_TRUE(mesh_is_valid_detailed(mesh));
+  EXPECT_TRUE(BKE_mesh_is_valid(mesh));
+  EXPECT_FALSE(BKE_mesh_validate(mesh, false, false));
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(MeshValidateTest, corrupted_meshes)
+{
+  const auto test_corruption = [&](const char *name, const FunctionRef<void(Mesh &)> corrupt) {
+    SCOPED_TRACE(name);
+    Mesh *mesh = create_valid_grid();
+    corrupt(*mesh);
+    /* The fast check must never pass when the detailed validation finds an issue. */
+    EXPECT_FALSE(BKE_mesh_is_likely_valid(mesh));
+    EXPECT_FALSE(mesh_is_valid_detailed(mesh));
+    EXPECT_FALSE(BKE_mesh_is_valid(mesh));
+
+    /* The fast check doesn't skip fixing the mesh. */
+    EXPECT_TRUE(BKE_mesh_validate(mesh, false, false));
+    if (BKE_mesh_is_likely_valid(mesh)) {
+      EXPECT_TRUE(mesh_is_valid_detailed(mesh));
+    }
+    BKE_id_free(nullptr, mesh);
+  };
+
+  test_corruption("vertex coordinate", [](Mesh &mesh) { mesh.mvert[3].co[1] = NAN; });
+  test_corruption("edge vertex out of range",
+                  [](Mesh &mesh) { mesh.medge[2].v2 = mesh.totvert + 1; });
+  test_corruption("edge with a single vertex",
+                  [](Mesh &mesh) { mesh.medge[2].v2 = mesh.medge[2].v1; });
+  test_corruption("duplicate edge", [](Mesh &mesh) {
+    mesh.medge[4].v1 = mesh.medge[5].v2;
+    mesh.medge[4].v2 = mesh.medge[5].v1;
+  });
+  test_corruption("loop vertex out of range",
+                  [](Mesh &mesh) { mesh.mloop[5].v = mesh.totvert + 3; });
+  test_corruption("loop edge out of range",
+                  [](Mesh &mesh) { mesh.mloop[5].e = mesh.totedge; });
+  test_corruption("loop edge not connecting its vertices",
+                  [](Mesh &mesh) { mesh.mloop[5].e = mesh.mloop[7].e; });
+  test_corruption("polygon loops out of range", [](Mesh &mesh) { mesh.mpoly[2].totloop = 200; });
+  test_corruption("polygon with too few corners", [](Mesh &mesh) {
+    mesh.mpoly[2].totloop = 2;
+    mesh.mpoly[2].loopstart = mesh.mpoly[1].loopstart;
+  });
+  test_corruption("duplicate polygon", [](Mesh &mesh) {
+    /* Use the corners of the first polygon in the second, rotated by one. */
+    const MPoly &poly_a = mesh.mpoly[0];
+    const MPoly &poly_b = mesh.mpoly[1];
+    ASSERT_EQ(poly_a.totloop, poly_b.totloop);
+    for (const int i : IndexRange(poly_a.totloop)) {
+      mesh.mloop[poly_b.loopstart + i] =
+          mesh.mloop[poly_a.loopstart + (i + 1) % poly_a.totloop];
+    }
+  });
+}
+
+}  // namespace blender::bke::tests
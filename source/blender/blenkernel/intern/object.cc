@@ -69,6 +69,7 @@
 #include "BKE_armature.h"
 #include "BKE_asset.h"
 #include "BKE_bpath.h"
+#include "BKE_bvhutils.h"
 #include "BKE_camera.h"
 #include "BKE_collection.h"
 #include "BKE_constraint.h"
@@ -1783,6 +1784,16 @@ void BKE_object_free_derived_caches(Object *ob)
   ob->runtime.editmesh_eval_cage = nullptr;
 
   if (ob->runtime.data_eval != nullptr) {
+    if (GS(ob->runtime.data_eval->name) == ID_ME) {
+      const Mesh *mesh_eval = reinterpret_cast<const Mesh *>(ob->runtime.data_eval);
+      const BVHCache *bvh_cache = mesh_eval->runtime.bvh_cache;
+      ob->runtime.bvh_prebuild_types = short(bvhcache_types_used(bvh_cache));
+      static_assert(BVHTREE_FROM_LOOSEEDGES < ARRAY_SIZE(ob->runtime.bvh_prebuild_tree_types));
+      for (int type = 0; type < ARRAY_SIZE(ob->runtime.bvh_prebuild_tree_types); type++) {
+        ob->runtime.bvh_prebuild_tree_types[type] = char(
+            bvhcache_tree_type_get(bvh_cache, BVHCacheType(type)));
+      }
+    }
     if (ob->runtime.is_data_eval_owned) {
       ID *data_eval = ob->runtime.data_eval;
       if (GS(data_eval->name) == ID_ME) {
@@ -3,6 +3,7 @@
 #pragma once
 
 #include "BLI_math_vec_types.hh"
+#include "BLI_span.hh"
 
 namespace blender::noise {
 
@@ -388,4 +389,37 @@ void voronoi_n_sphere_radius(const float4 coord, float randomness, float *r_radi
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Batch Functions
+ *
+ * Evaluate noise for many positions at once with shared parameters. Multiple positions are
+ * processed together with SIMD instructions when those are available. The results match the
+ * functions above, except for small floating point differences.
+ * \{ */
+
+void perlin_fractal_distorted(Span<float3> positions,
+                              float octaves,
+                              float roughness,
+                              float distortion,
+                              MutableSpan<float> r_values);
+void perlin_float3_fractal_distorted(Span<float3> positions,
+                                     float octaves,
+                                     float roughness,
+                                     float distortion,
+                                     MutableSpan<float3> r_values);
+
+/**
+ * Same as #voronoi_f1 for a single 3D coordinate. Outputs that are not needed can be empty.
+ * The Minkowski metric is not vectorized.
+ */
+void voronoi_f1(Span<float3> coords,
+                float exponent,
+                float randomness,
+                int metric,
+                MutableSpan<float> r_distances,
+                MutableSpan<float3> r_colors,
+                MutableSpan<float3> r_positions);
+
+/** \} */
+
 }  // namespace blender::noise
@@ -9,6 +9,7 @@
 #include "BLI_math_base_safe.h"
 #include "BLI_math_vector.hh"
 #include "BLI_noise.hh"
+#include "BLI_simd.h"
 #include "BLI_utildefines.h"
 
 namespace blender::noise {
@@ -2328,4 +2329,512 @@ void voronoi_n_sphere_radius(const float4 coord, const float randomness, float *
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Batch Functions
+ *
+ * The SIMD versions process four positions at once. They follow the scalar functions above
+ * operation by operation, so that the results stay as close as possible. Sizes that are not a
+ * multiple of four are handled by repeating the last position in the unused lanes.
+ *
+ * Only 3D perlin and voronoi F1 noise have batch versions, and only the SSE2 baseline is used,
+ * because there is no runtime dispatch for wider instruction sets in this library.
+ * \{ */
+
+#ifdef BLI_HAVE_SSE2
+
+template<int K> BLI_INLINE __m128i hash_bit_rotate_4(const __m128i x)
+{
+  return _mm_or_si128(_mm_slli_epi32(x, K), _mm_srli_epi32(x, 32 - K));
+}
+
+BLI_INLINE void hash_bit_mix_4(__m128i &a, __m128i &b, __m128i &c)
+{
+  a = _mm_sub_epi32(a, c);
+  a = _mm_xor_si128(a, hash_bit_rotate_4<4>(c));
+  c = _mm_add_epi32(c, b);
+  b = _mm_sub_epi32(b, a);
+  b = _mm_xor_si128(b, hash_bit_rotate_4<6>(a));
+  a = _mm_add_epi32(a, c);
+  c = _mm_sub_epi32(c, b);
+  c = _mm_xor_si128(c, hash_bit_rotate_4<8>(b));
+  b = _mm_add_epi32(b, a);
+  a = _mm_sub_epi32(a, c);
+  a = _mm_xor_si128(a, hash_bit_rotate_4<16>(c));
+  c = _mm_add_epi32(c, b);
+  b = _mm_sub_epi32(b, a);
+  b = _mm_xor_si128(b, hash_bit_rotate_4<19>(a));
+  a = _mm_add_epi32(a, c);
+  c = _mm_sub_epi32(c, b);
+  c = _mm_xor_si128(c, hash_bit_rotate_4<4>(b));
+  b = _mm_add_epi32(b, a);
+}
+
+BLI_INLINE void hash_bit_final_4(__m128i &a, __m128i &b, __m128i &c)
+{
+  c = _mm_xor_si128(c, b);
+  c = _mm_sub_epi32(c, hash_bit_rotate_4<14>(b));
+  a = _mm_xor_si128(a, c);
+  a = _mm_sub_epi32(a, hash_bit_rotate_4<11>(c));
+  b = _mm_xor_si128(b, a);
+  b = _mm_sub_epi32(b, hash_bit_rotate_4<25>(a));
+  c = _mm_xor_si128(c, b);
+  c = _mm_sub_epi32(c, hash_bit_rotate_4<16>(b));
+  a = _mm_xor_si128(a, c);
+  a = _mm_sub_epi32(a, hash_bit_rotate_4<4>(c));
+  b = _mm_xor_si128(b, a);
+  b = _mm_sub_epi32(b, hash_bit_rotate_4<14>(a));
+  c = _mm_xor_si128(c, b);
+  c = _mm_sub_epi32(c, hash_bit_rotate_4<24>(b));
+}
+
+BLI_INLINE __m128i hash_4(const __m128i kx, const __m128i ky, const __m128i kz)
+{
+  __m128i a, b, c;
+  a = b = c = _mm_set1_epi32(int(0xdeadbeef + (3 << 2) + 13));
+
+  c = _mm_add_epi32(c, kz);
+  b = _mm_add_epi32(b, ky);
+  a = _mm_add_epi32(a, kx);
+  hash_bit_final_4(a, b, c);
+
+  return c;
+}
+
+BLI_INLINE __m128i hash_4(const __m128i kx, const __m128i ky, const __m128i kz, const __m128i kw)
+{
+  __m128i a, b, c;
+  a = b = c = _mm_set1_epi32(int(0xdeadbeef + (4 << 2) + 13));
+
+  a = _mm_add_epi32(a, kx);
+  b = _mm_add_epi32(b, ky);
+  c = _mm_add_epi32(c, kz);
+  hash_bit_mix_4(a, b, c);
+
+  a = _mm_add_epi32(a, kw);
+  hash_bit_final_4(a, b, c);
+
+  return c;
+}
+
+BLI_INLINE __m128 uint_to_float_01_4(const __m128i k)
+{
+  /* SSE2 can only convert signed integers. Converting both halves separately is exact and the
+   * final addition rounds the same way as a direct conversion. */
+  const __m128 high = _mm_cvtepi32_ps(_mm_srli_epi32(k, 16));
+  const __m128 low = _mm_cvtepi32_ps(_mm_and_si128(k, _mm_set1_epi32(0xFFFF)));
+  const __m128 value = _mm_add_ps(_mm_mul_ps(high, _mm_set1_ps(65536.0f)), low);
+  return _mm_div_ps(value, _mm_set1_ps(static_cast<float>(0xFFFFFFFFu)));
+}
+
+BLI_INLINE void hash_float_to_float3_4(const __m128 x,
+                                       const __m128 y,
+                                       const __m128 z,
+                                       __m128 &r_x,
+                                       __m128 &r_y,
+                                       __m128 &r_z)
+{
+  const __m128i kx = _mm_castps_si128(x);
+  const __m128i ky = _mm_castps_si128(y);
+  const __m128i kz = _mm_castps_si128(z);
+  r_x = uint_to_float_01_4(hash_4(kx, ky, kz));
+  r_y = uint_to_float_01_4(hash_4(kx, ky, kz, _mm_castps_si128(_mm_set1_ps(1.0f))));
+  r_z = uint_to_float_01_4(hash_4(kx, ky, kz, _mm_castps_si128(_mm_set1_ps(2.0f))));
+}
+
+BLI_INLINE __m128 select_4(const __m128 mask, const __m128 a, const __m128 b)
+{
+  return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+BLI_INLINE __m128 abs_4(const __m128 x)
+{
+  return _mm_andnot_ps(_mm_set1_ps(-0.0f), x);
+}
+
+BLI_INLINE __m128 floor_4(const __m128 x)
+{
+  const __m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(x));
+  const __m128 too_large = _mm_and_ps(_mm_cmpgt_ps(truncated, x), _mm_set1_ps(1.0f));
+  return _mm_sub_ps(truncated, too_large);
+}
+
+BLI_INLINE __m128 fade_4(const __m128 t)
+{
+  const __m128 t3 = _mm_mul_ps(_mm_mul_ps(t, t), t);
+  const __m128 inner = _mm_add_ps(
+      _mm_mul_ps(t, _mm_sub_ps(_mm_mul_ps(t, _mm_set1_ps(6.0f)), _mm_set1_ps(15.0f))),
+      _mm_set1_ps(10.0f));
+  return _mm_mul_ps(t3, inner);
+}
+
+BLI_INLINE __m128 negate_if_4(const __m128 value, const __m128i hash, const int bit)
+{
+  const __m128i bit_4 = _mm_set1_epi32(bit);
+  const __m128i is_set = _mm_cmpeq_epi32(_mm_and_si128(hash, bit_4), bit_4);
+  return _mm_xor_ps(value, _mm_and_ps(_mm_castsi128_ps(is_set), _mm_set1_ps(-0.0f)));
+}
+
+BLI_INLINE __m128 noise_grad_4(const __m128i hash, const __m128 x, const __m128 y, const __m128 z)
+{
+  const __m128i h = _mm_and_si128(hash, _mm_set1_epi32(15));
+  const __m128 h_lt_8 = _mm_castsi128_ps(_mm_cmplt_epi32(h, _mm_set1_epi32(8)));
+  const __m128 h_lt_4 = _mm_castsi128_ps(_mm_cmplt_epi32(h, _mm_set1_epi32(4)));
+  const __m128 h_is_12_or_14 = _mm_castsi128_ps(_mm_or_si128(
+      _mm_cmpeq_epi32(h, _mm_set1_epi32(12)), _mm_cmpeq_epi32(h, _mm_set1_epi32(14))));
+  const __m128 u = select_4(h_lt_8, x, y);
+  const __m128 vt = select_4(h_is_12_or_14, x, z);
+  const __m128 v = select_4(h_lt_4, y, vt);
+  return _mm_add_ps(negate_if_4(u, h, 1), negate_if_4(v, h, 2));
+}
+
+BLI_INLINE __m128 floor_fraction_4(const __m128 x, __m128i &i)
+{
+  /* Same as the scalar version, including the off-by-one for negative integers. */
+  const __m128i is_negative = _mm_castps_si128(_mm_cmplt_ps(x, _mm_setzero_ps()));
+  i = _mm_add_epi32(_mm_cvttps_epi32(x), is_negative);
+  return _mm_sub_ps(x, _mm_cvtepi32_ps(i));
+}
+
+BLI_INLINE __m128 mix_4(const __m128 v0, const __m128 v1, const __m128 x, const __m128 x1)
+{
+  return _mm_add_ps(_mm_mul_ps(v0, x1), _mm_mul_ps(v1, x));
+}
+
+BLI_INLINE __m128 perlin_signed_4(const __m128 x, const __m128 y, const __m128 z)
+{
+  __m128i X, Y, Z;
+  const __m128 fx = floor_fraction_4(x, X);
+  const __m128 fy = floor_fraction_4(y, Y);
+  const __m128 fz = floor_fraction_4(z, Z);
+  const __m128i one_i = _mm_set1_epi32(1);
+  const __m128i X1 = _mm_add_epi32(X, one_i);
+  const __m128i Y1 = _mm_add_epi32(Y, one_i);
+  const __m128i Z1 = _mm_add_epi32(Z, one_i);
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 fx1 = _mm_sub_ps(fx, one);
+  const __m128 fy1 = _mm_sub_ps(fy, one);
+  const __m128 fz1 = _mm_sub_ps(fz, one);
+
+  const __m128 u = fade_4(fx);
+  const __m128 v = fade_4(fy);
+  const __m128 w = fade_4(fz);
+  const __m128 u1 = _mm_sub_ps(one, u);
+  const __m128 v1 = _mm_sub_ps(one, v);
+  const __m128 w1 = _mm_sub_ps(one, w);
+
+  const __m128 g0 = noise_grad_4(hash_4(X, Y, Z), fx, fy, fz);
+  const __m128 g1 = noise_grad_4(hash_4(X1, Y, Z), fx1, fy, fz);
+  const __m128 g2 = noise_grad_4(hash_4(X, Y1, Z), fx, fy1, fz);
+  const __m128 g3 = noise_grad_4(hash_4(X1, Y1, Z), fx1, fy1, fz);
+  const __m128 g4 = noise_grad_4(hash_4(X, Y, Z1), fx, fy, fz1);
+  const __m128 g5 = noise_grad_4(hash_4(X1, Y, Z1), fx1, fy, fz1);
+  const __m128 g6 = noise_grad_4(hash_4(X, Y1, Z1), fx, fy1, fz1);
+  const __m128 g7 = noise_grad_4(hash_4(X1, Y1, Z1), fx1, fy1, fz1);
+
+  const __m128 r = mix_4(mix_4(mix_4(g0, g1, u, u1), mix_4(g2, g3, u, u1), v, v1),
+                         mix_4(mix_4(g4, g5, u, u1), mix_4(g6, g7, u, u1), v, v1),
+                         w,
+                         w1);
+  return _mm_mul_ps(r, _mm_set1_ps(0.9820f));
+}
+
+BLI_INLINE __m128 perlin_4(const __m128 x, const __m128 y, const __m128 z)
+{
+  return _mm_add_ps(_mm_mul_ps(perlin_signed_4(x, y, z), _mm_set1_ps(0.5f)), _mm_set1_ps(0.5f));
+}
+
+BLI_INLINE __m128 perlin_fractal_4(
+    const __m128 x, const __m128 y, const __m128 z, float octaves, const float roughness)
+{
+  float fscale = 1.0f;
+  float amp = 1.0f;
+  float maxamp = 0.0f;
+  __m128 sum = _mm_setzero_ps();
+  octaves = CLAMPIS(octaves, 0.0f, 15.0f);
+  const int n = static_cast<int>(octaves);
+  for (int i = 0; i <= n; i++) {
+    const __m128 scale = _mm_set1_ps(fscale);
+    const __m128 t = perlin_4(_mm_mul_ps(x, scale), _mm_mul_ps(y, scale), _mm_mul_ps(z, scale));
+    sum = _mm_add_ps(sum, _mm_mul_ps(t, _mm_set1_ps(amp)));
+    maxamp += amp;
+    amp *= CLAMPIS(roughness, 0.0f, 1.0f);
+    fscale *= 2.0f;
+  }
+  const float rmd = octaves - std::floor(octaves);
+  if (rmd == 0.0f) {
+    return _mm_div_ps(sum, _mm_set1_ps(maxamp));
+  }
+
+  const __m128 scale = _mm_set1_ps(fscale);
+  const __m128 t = perlin_4(_mm_mul_ps(x, scale), _mm_mul_ps(y, scale), _mm_mul_ps(z, scale));
+  __m128 sum2 = _mm_add_ps(sum, _mm_mul_ps(t, _mm_set1_ps(amp)));
+  sum = _mm_div_ps(sum, _mm_set1_ps(maxamp));
+  sum2 = _mm_div_ps(sum2, _mm_set1_ps(maxamp + amp));
+  return _mm_add_ps(_mm_mul_ps(_mm_set1_ps(1.0f - rmd), sum), _mm_mul_ps(_mm_set1_ps(rmd), sum2));
+}
+
+BLI_INLINE void perlin_distort_4(__m128 &x, __m128 &y, __m128 &z, const float distortion)
+{
+  if (distortion == 0.0f) {
+    return;
+  }
+  const __m128 strength = _mm_set1_ps(distortion);
+  __m128 offsets[3];
+  for (const int i : IndexRange(3)) {
+    const float3 offset = random_float3_offset(float(i));
+    offsets[i] = _mm_mul_ps(perlin_signed_4(_mm_add_ps(x, _mm_set1_ps(offset.x)),
+                                            _mm_add_ps(y, _mm_set1_ps(offset.y)),
+                                            _mm_add_ps(z, _mm_set1_ps(offset.z))),
+                            strength);
+  }
+  x = _mm_add_ps(x, offsets[0]);
+  y = _mm_add_ps(y, offsets[1]);
+  z = _mm_add_ps(z, offsets[2]);
+}
+
+/** Load four positions starting at #start, repeating the last one when there are fewer. */
+BLI_INLINE void load_float3_4(
+    const Span<float3> positions, const int64_t start, __m128 &r_x, __m128 &r_y, __m128 &r_z)
+{
+  const int64_t last = positions.size() - 1;
+  const float3 &p0 = positions[start];
+  const float3 &p1 = positions[std::min(start + 1, last)];
+  const float3 &p2 = positions[std::min(start + 2, last)];
+  const float3 &p3 = positions[std::min(start + 3, last)];
+  r_x = _mm_setr_ps(p0.x, p1.x, p2.x, p3.x);
+  r_y = _mm_setr_ps(p0.y, p1.y, p2.y, p3.y);
+  r_z = _mm_setr_ps(p0.z, p1.z, p2.z, p3.z);
+}
+
+BLI_INLINE void store_float_4(const __m128 value, const int64_t start, MutableSpan<float> dst)
+{
+  float buffer[4];
+  _mm_storeu_ps(buffer, value);
+  const int64_t size = std::min<int64_t>(4, dst.size() - start);
+  for (const int64_t i : IndexRange(size)) {
+    dst[start + i] = buffer[i];
+  }
+}
+
+BLI_INLINE void store_float3_4(const __m128 x,
+                               const __m128 y,
+                               const __m128 z,
+                               const int64_t start,
+                               MutableSpan<float3> dst)
+{
+  float buffer_x[4], buffer_y[4], buffer_z[4];
+  _mm_storeu_ps(buffer_x, x);
+  _mm_storeu_ps(buffer_y, y);
+  _mm_storeu_ps(buffer_z, z);
+  const int64_t size = std::min<int64_t>(4, dst.size() - start);
+  for (const int64_t i : IndexRange(size)) {
+    dst[start + i] = float3(buffer_x[i], buffer_y[i], buffer_z[i]);
+  }
+}
+
+void perlin_fractal_distorted(const Span<float3> positions,
+                              const float octaves,
+                              const float roughness,
+                              const float distortion,
+                              MutableSpan<float> r_values)
+{
+  BLI_assert(positions.size() == r_values.size());
+  for (int64_t start = 0; start < positions.size(); start += 4) {
+    __m128 x, y, z;
+    load_float3_4(positions, start, x, y, z);
+    perlin_distort_4(x, y, z, distortion);
+    store_float_4(perlin_fractal_4(x, y, z, octaves, roughness), start, r_values);
+  }
+}
+
+void perlin_float3_fractal_distorted(const Span<float3> positions,
+                                     const float octaves,
+                                     const float roughness,
+                                     const float distortion,
+                                     MutableSpan<float3> r_values)
+{
+  BLI_assert(positions.size() == r_values.size());
+  const float3 offset_1 = random_float3_offset(3.0f);
+  const float3 offset_2 = random_float3_offset(4.0f);
+  for (int64_t start = 0; start < positions.size(); start += 4) {
+    __m128 x, y, z;
+    load_float3_4(positions, start, x, y, z);
+    perlin_distort_4(x, y, z, distortion);
+    const __m128 r_x = perlin_fractal_4(x, y, z, octaves, roughness);
+    const __m128 r_y = perlin_fractal_4(_mm_add_ps(x, _mm_set1_ps(offset_1.x)),
+                                        _mm_add_ps(y, _mm_set1_ps(offset_1.y)),
+                                        _mm_add_ps(z, _mm_set1_ps(offset_1.z)),
+                                        octaves,
+                                        roughness);
+    const __m128 r_z = perlin_fractal_4(_mm_add_ps(x, _mm_set1_ps(offset_2.x)),
+                                        _mm_add_ps(y, _mm_set1_ps(offset_2.y)),
+                                        _mm_add_ps(z, _mm_set1_ps(offset_2.z)),
+                                        octaves,
+                                        roughness);
+    store_float3_4(r_x, r_y, r_z, start, r_values);
+  }
+}
+
+void voronoi_f1(const Span<float3> coords,
+                const float exponent,
+                const float randomness,
+                const int metric,
+                MutableSpan<float> r_distances,
+                MutableSpan<float3> r_colors,
+                MutableSpan<float3> r_positions)
+{
+  if (metric == NOISE_SHD_VORONOI_MINKOWSKI) {
+    for (const int64_t i : coords.index_range()) {
+      voronoi_f1(coords[i],
+                 exponent,
+                 randomness,
+                 metric,
+                 r_distances.is_empty() ? nullptr : &r_distances[i],
+                 r_colors.is_empty() ? nullptr : &r_colors[i],
+                 r_positions.is_empty() ? nullptr : &r_positions[i]);
+    }
+    return;
+  }
+
+  const __m128 randomness_4 = _mm_set1_ps(randomness);
+  for (int64_t start = 0; start < coords.size(); start += 4) {
+    __m128 coord_x, coord_y, coord_z;
+    load_float3_4(coords, start, coord_x, coord_y, coord_z);
+    const __m128 cell_x = floor_4(coord_x);
+    const __m128 cell_y = floor_4(coord_y);
+    const __m128 cell_z = floor_4(coord_z);
+    const __m128 local_x = _mm_sub_ps(coord_x, cell_x);
+    const __m128 local_y = _mm_sub_ps(coord_y, cell_y);
+    const __m128 local_z = _mm_sub_ps(coord_z, cell_z);
+
+    __m128 min_distance = _mm_set1_ps(8.0f);
+    __m128 target_offset_x = _mm_setzero_ps();
+    __m128 target_offset_y = _mm_setzero_ps();
+    __m128 target_offset_z = _mm_setzero_ps();
+    __m128 target_position_x = _mm_setzero_ps();
+    __m128 target_position_y = _mm_setzero_ps();
+    __m128 target_position_z = _mm_setzero_ps();
+    for (int k = -1; k <= 1; k++) {
+      for (int j = -1; j <= 1; j++) {
+        for (int i = -1; i <= 1; i++) {
+          const __m128 offset_x = _mm_set1_ps(float(i));
+          const __m128 offset_y = _mm_set1_ps(float(j));
+          const __m128 offset_z = _mm_set1_ps(float(k));
+          __m128 hash_x, hash_y, hash_z;
+          hash_float_to_float3_4(_mm_add_ps(cell_x, offset_x),
+                                 _mm_add_ps(cell_y, offset_y),
+                                 _mm_add_ps(cell_z, offset_z),
+                                 hash_x,
+                                 hash_y,
+                                 hash_z);
+          const __m128 point_x = _mm_add_ps(offset_x, _mm_mul_ps(hash_x, randomness_4));
+          const __m128 point_y = _mm_add_ps(offset_y, _mm_mul_ps(hash_y, randomness_4));
+          const __m128 point_z = _mm_add_ps(offset_z, _mm_mul_ps(hash_z, randomness_4));
+          const __m128 diff_x = _mm_sub_ps(point_x, local_x);
+          const __m128 diff_y = _mm_sub_ps(point_y, local_y);
+          const __m128 diff_z = _mm_sub_ps(point_z, local_z);
+
+          __m128 distance;
+          switch (metric) {
+            case NOISE_SHD_VORONOI_EUCLIDEAN:
+              distance = _mm_sqrt_ps(_mm_add_ps(
+                  _mm_add_ps(_mm_mul_ps(diff_x, diff_x), _mm_mul_ps(diff_y, diff_y)),
+                  _mm_mul_ps(diff_z, diff_z)));
+              break;
+            case NOISE_SHD_VORONOI_MANHATTAN:
+              distance = _mm_add_ps(_mm_add_ps(abs_4(diff_x), abs_4(diff_y)), abs_4(diff_z));
+              break;
+            case NOISE_SHD_VORONOI_CHEBYCHEV:
+              distance = _mm_max_ps(abs_4(diff_x), _mm_max_ps(abs_4(diff_y), abs_4(diff_z)));
+              break;
+            default:
+              BLI_assert_unreachable();
+              distance = _mm_setzero_ps();
+              break;
+          }
+
+          const __m128 is_closer = _mm_cmplt_ps(distance, min_distance);
+          min_distance = select_4(is_closer, distance, min_distance);
+          target_offset_x = select_4(is_closer, offset_x, target_offset_x);
+          target_offset_y = select_4(is_closer, offset_y, target_offset_y);
+          target_offset_z = select_4(is_closer, offset_z, target_offset_z);
+          target_position_x = select_4(is_closer, point_x, target_position_x);
+          target_position_y = select_4(is_closer, point_y, target_position_y);
+          target_position_z = select_4(is_closer, point_z, target_position_z);
+        }
+      }
+    }
+
+    if (!r_distances.is_empty()) {
+      store_float_4(min_distance, start, r_distances);
+    }
+    if (!r_colors.is_empty()) {
+      __m128 color_x, color_y, color_z;
+      hash_float_to_float3_4(_mm_add_ps(cell_x, target_offset_x),
+                             _mm_add_ps(cell_y, target_offset_y),
+                             _mm_add_ps(cell_z, target_offset_z),
+                             color_x,
+                             color_y,
+                             color_z);
+      store_float3_4(color_x, color_y, color_z, start, r_colors);
+    }
+    if (!r_positions.is_empty()) {
+      store_float3_4(_mm_add_ps(target_position_x, cell_x),
+                     _mm_add_ps(target_position_y, cell_y),
+                     _mm_add_ps(target_position_z, cell_z),
+                     start,
+                     r_positions);
+    }
+  }
+}
+
+#else
+
+void perlin_fractal_distorted(const Span<float3> positions,
+                              const float octaves,
+                              const float roughness,
+                              const float distortion,
+                              MutableSpan<float> r_values)
+{
+  BLI_assert(positions.size() == r_values.size());
+  for (const int64_t i : positions.index_range()) {
+    r_values[i] = perlin_fractal_distorted(positions[i], octaves, roughness, distortion);
+  }
+}
+
+void perlin_float3_fractal_distorted(const Span<float3> positions,
+                                     const float octaves,
+                                     const float roughness,
+                                     const float distortion,
+                                     MutableSpan<float3> r_values)
+{
+  BLI_assert(positions.size() == r_values.size());
+  for (const int64_t i : positions.index_range()) {
+    r_values[i] = perlin_float3_fractal_distorted(positions[i], octaves, roughness, distortion);
+  }
+}
+
+void voronoi_f1(const Span<float3> coords,
+                const float exponent,
+                const float randomness,
+                const int metric,
+                MutableSpan<float> r_distances,
+                MutableSpan<float3> r_colors,
+                MutableSpan<float3> r_positions)
+{
+  for (const int64_t i : coords.index_range()) {
+    voronoi_f1(coords[i],
+               exponent,
+               randomness,
+               metric,
+               r_distances.is_empty() ? nullptr : &r_distances[i],
+               r_colors.is_empty() ? nullptr : &r_colors[i],
+               r_positions.is_empty() ? nullptr : &r_positions[i]);
+  }
+}
+
+#endif
+
+/** \} */
+
 }  // namespace blender::noise
@@ -0,0 +1,109 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include "BLI_array.hh"
+#include "BLI_noise.hh"
+#include "BLI_rand.hh"
+#include "BLI_timeit.hh"
+
+#define DO_PERF_TESTS 0
+
+namespace blender::noise::tests {
+
+static Array<float3> random_positions(const int64_t size, const float range)
+{
+  RandomNumberGenerator rng(0);
+  Array<float3> positions(size);
+  for (float3 &position : positions) {
+    position = float3(rng.get_float(), rng.get_float(), rng.get_float()) * 2.0f - float3(1.0f);
+    position *= range;
+  }
+  return positions;
+}
+
+TEST(noise, PerlinFractalDistortedBatch)
+{
+  /* Use a size that is not a multiple of the SIMD width. */
+  const Array<float3> positions = random_positions(1003, 50.0f);
+  Array<float> values(positions.size());
+  Array<float3> colors(positions.size());
+
+  for (const float octaves : {0.0f, 2.0f, 4.5f}) {
+    for (const float distortion : {0.0f, 1.5f}) {
+      perlin_fractal_distorted(positions, octaves, 0.6f, distortion, values);
+      perlin_float3_fractal_distorted(positions, octaves, 0.6f, distortion, colors);
+      for (const int64_t i : positions.index_range()) {
+        EXPECT_NEAR(values[i], perlin_fractal_distorted(positions[i], octaves, 0.6f, distortion),
+                    1e-4f);
+        EXPECT_V3_NEAR(colors[i],
+                       perlin_float3_fractal_distorted(positions[i], octaves, 0.6f, distortion),
+                       1e-4f);
+      }
+    }
+  }
+}
+
+TEST(noise, VoronoiF1Batch)
+{
+  const Array<float3> coords = random_positions(1001, 20.0f);
+  Array<float> distances(coords.size());
+  Array<float3> colors(coords.size());
+  Array<float3> positions(coords.size());
+
+  for (const int metric : {0, 1, 2, 3}) {
+    voronoi_f1(coords, 1.5f, 0.8f, metric, distances, colors, positions);
+    for (const int64_t i : coords.index_range()) {
+      float expected_distance;
+      float3 expected_color;
+      float3 expected_position;
+      voronoi_f1(coords[i],
+                 1.5f,
+                 0.8f,
+                 metric,
+                 &expected_distance,
+                 &expected_color,
+                 &expected_position);
+      EXPECT_NEAR(distances[i], expected_distance, 1e-5f);
+      EXPECT_V3_NEAR(colors[i], expected_color, 1e-5f);
+      EXPECT_V3_NEAR(positions[i], expected_position, 1e-5f);
+    }
+  }
+
+  /* Outputs are optional. */
+  voronoi_f1(coords, 1.0f, 1.0f, 0, distances, {}, {});
+}
+
+#if DO_PERF_TESTS
+
+TEST(noise, BatchPerformance)
+{
+  const Array<float3> positions = random_positions(1'000'000, 100.0f);
+  Array<float> values(positions.size());
+  Array<float3> colors(positions.size());
+
+  {
+    SCOPED_TIMER("perlin fractal single");
+    for (const int64_t i : positions.index_range()) {
+      values[i] = perlin_fractal_distorted(positions[i], 4.0f, 0.5f, 1.0f);
+    }
+  }
+  {
+    SCOPED_TIMER("perlin fractal batch");
+    perlin_fractal_distorted(positions, 4.0f, 0.5f, 1.0f, values);
+  }
+  {
+    SCOPED_TIMER("voronoi f1 single");
+    for (const int64_t i : positions.index_range()) {
+      voronoi_f1(positions[i], 1.0f, 1.0f, 0, &values[i], &colors[i], nullptr);
+    }
+  }
+  {
+    SCOPED_TIMER("voronoi f1 batch");
+    voronoi_f1(positions, 1.0f, 1.0f, 0, values, colors, {});
+  }
+}
+
+#endif
+
+}  // namespace blender::noise::tests
@@ -67,6 +67,13 @@ void DEG_graph_relations_update(struct Depsgraph *graph);
 /** Tag all relations in the database for update. */
 void DEG_relations_tag_update(struct Main *bmain);
 
+/**
+ * Tag relations of the given ID for update, for changes which only affect the relations of that
+ * ID. For objects the graphs rebuild the relations of the ID and of the IDs connected to it, the
+ * whole graphs are rebuilt for other ID types.
+ */
+void DEG_id_relations_tag_update(struct Main *bmain, struct ID *id);
+
 /* Add Dependencies  ----------------------------- */
 
 /**
@@ -104,6 +104,7 @@
 #include "intern/builder/deg_builder.h"
 #include "intern/builder/deg_builder_rna.h"
 #include "intern/depsgraph.h"
+#include "intern/depsgraph_relation.h"
 #include "intern/depsgraph_tag.h"
 #include "intern/depsgraph_type.h"
 #include "intern/eval/deg_eval_copy_on_write.h"
@@ -328,43 +329,75 @@ ID *DepsgraphNodeBuilder::ensure_cow_id(ID *id_orig)
 
 /* **** Build functions for entity nodes **** */
 
+void DepsgraphNodeBuilder::save_id_info(IDNode *id_node)
+{
+  /* It is possible that the ID does not need to have CoW version in which case id_cow is the
+   * same as id_orig. Additionally, such ID might have been removed, which makes the check
+   * for whether id_cow is expanded to access freed memory. In order to deal with this we
+   * check whether CoW is needed based on a scalar value which does not lead to access of
+   * possibly deleted memory. */
+  IDInfo *id_info = (IDInfo *)MEM_mallocN(sizeof(IDInfo), "depsgraph id info");
+  if (deg_copy_on_write_is_needed(id_node->id_type) &&
+      deg_copy_on_write_is_expanded(id_node->id_cow) && id_node->id_orig != id_node->id_cow) {
+    id_info->id_cow = id_node->id_cow;
+  }
+  else {
+    id_info->id_cow = nullptr;
+  }
+  id_info->previously_visible_components_mask = id_node->visible_components_mask;
+  id_info->previous_eval_flags = id_node->eval_flags;
+  id_info->previous_customdata_masks = id_node->customdata_masks;
+  BLI_assert(!id_info_hash_.contains(id_node->id_orig_session_uuid));
+  id_info_hash_.add_new(id_node->id_orig_session_uuid, id_info);
+  id_node->id_cow = nullptr;
+}
+
+void DepsgraphNodeBuilder::save_entry_tag(OperationNode *op_node)
+{
+  ComponentNode *comp_node = op_node->owner;
+  IDNode *id_node = comp_node->owner;
+
+  SavedEntryTag entry_tag;
+  entry_tag.id_orig = id_node->id_orig;
+  entry_tag.component_type = comp_node->type;
+  entry_tag.opcode = op_node->opcode;
+  entry_tag.name = op_node->name;
+  entry_tag.name_tag = op_node->name_tag;
+  saved_entry_tags_.append(entry_tag);
+}
+
+void DepsgraphNodeBuilder::save_operation_times(IDNode *id_node)
+{
+  for (ComponentNode *comp_node : id_node->components.values()) {
+    for (OperationNode *op_node : comp_node->operations) {
+      if (op_node->stats.average_time == 0.0) {
+        /* Operation was never evaluated, nothing to keep. */
+        continue;
+      }
+      SavedOperationTime operation_time;
+      operation_time.id_orig = id_node->id_orig;
+      operation_time.component_type = comp_node->type;
+      operation_time.component_name = comp_node->name;
+      operation_time.opcode = op_node->opcode;
+      operation_time.name = op_node->name;
+      operation_time.name_tag = op_node->name_tag;
+      operation_time.average_time = op_node->stats.average_time;
+      saved_operation_times_.append(operation_time);
+    }
+  }
+}
+
 void DepsgraphNodeBuilder::begin_build()
 {
   /* Store existing copy-on-write versions of datablock, so we can re-use
    * them for new ID nodes. */
   for (IDNode *id_node : graph_->id_nodes) {
-    /* It is possible that the ID does not need to have CoW version in which case id_cow is the
-     * same as id_orig. Additionally, such ID might have been removed, which makes the check
-     * for whether id_cow is expanded to access freed memory. In order to deal with this we
-     * check whether CoW is needed based on a scalar value which does not lead to access of
-     * possibly deleted memory. */
-    IDInfo *id_info = (IDInfo *)MEM_mallocN(sizeof(IDInfo), "depsgraph id info");
-    if (deg_copy_on_write_is_needed(id_node->id_type) &&
-        deg_copy_on_write_is_expanded(id_node->id_cow) && id_node->id_orig != id_node->id_cow) {
-      id_info->id_cow = id_node->id_cow;
-    }
-    else {
-      id_info->id_cow = nullptr;
-    }
-    id_info->previously_visible_components_mask = id_node->visible_components_mask;
-    id_info->previous_eval_flags = id_node->eval_flags;
-    id_info->previous_customdata_masks = id_node->customdata_masks;
-    BLI_assert(!id_info_hash_.contains(id_node->id_orig_session_uuid));
-    id_info_hash_.add_new(id_node->id_orig_session_uuid, id_info);
-    id_node->id_cow = nullptr;
+    save_id_info(id_node);
+    save_operation_times(id_node);
   }
 
   for (OperationNode *op_node : graph_->entry_tags) {
-    ComponentNode *comp_node = op_node->owner;
-    IDNode *id_node = comp_node->owner;
-
-    SavedEntryTag entry_tag;
-    entry_tag.id_orig = id_node->id_orig;
-    entry_tag.component_type = comp_node->type;
-    entry_tag.opcode = op_node->opcode;
-    entry_tag.name = op_node->name;
-    entry_tag.name_tag = op_node->name_tag;
-    saved_entry_tags_.append(entry_tag);
+    save_entry_tag(op_node);
   }
 
   /* Make sure graph has no nodes left from previous state. */
@@ -502,8 +535,120 @@ void DepsgraphNodeBuilder::tag_previously_tagged_nodes()
   }
 }
 
+void DepsgraphNodeBuilder::restore_operation_times()
+{
+  for (const SavedOperationTime &operation_time : saved_operation_times_) {
+    IDNode *id_node = find_id_node(operation_time.id_orig);
+    if (id_node == nullptr) {
+      continue;
+    }
+    ComponentNode *comp_node = id_node->find_component(operation_time.component_type,
+                                                       operation_time.component_name.c_str());
+    if (comp_node == nullptr) {
+      continue;
+    }
+    OperationNode *op_node = comp_node->find_operation(
+        operation_time.opcode, operation_time.name.c_str(), operation_time.name_tag);
+    if (op_node == nullptr) {
+      continue;
+    }
+    op_node->stats.average_time = operation_time.average_time;
+  }
+}
+
 void DepsgraphNodeBuilder::end_build()
 {
+  restore_operation_times();
+  tag_previously_tagged_nodes();
+  update_invalid_cow_pointers();
+}
+
+void DepsgraphNodeBuilder::build_objects_incremental(Scene *scene,
+                                                     ViewLayer *view_layer,
+                                                     Span<Object *> objects)
+{
+  view_layer_index_ = 0;
+  scene_ = scene;
+  view_layer_ = view_layer;
+
+  struct ObjectState {
+    Object *object;
+    eDepsNode_LinkedState_Type linked_state;
+    bool is_directly_visible;
+  };
+  Vector<ObjectState> object_states;
+  Set<const IDNode *> removed_id_nodes;
+  for (Object *object : objects) {
+    IDNode *id_node = find_id_node(&object->id);
+    BLI_assert(id_node != nullptr);
+    object_states.append({object, id_node->linked_state, id_node->is_directly_visible});
+    removed_id_nodes.add_new(id_node);
+  }
+
+  auto is_removed_operation = [&](const OperationNode *op_node) {
+    return removed_id_nodes.contains(op_node->owner->owner);
+  };
+  /* Keep the copy-on-write data-blocks and entry tags, like for a full rebuild. */
+  Vector<OperationNode *> removed_entry_tags;
+  for (OperationNode *op_node : graph_->entry_tags) {
+    if (is_removed_operation(op_node)) {
+      save_entry_tag(op_node);
+      removed_entry_tags.append(op_node);
+    }
+  }
+  for (OperationNode *op_node : removed_entry_tags) {
+    graph_->entry_tags.remove(op_node);
+  }
+  graph_->operations.resize(std::remove_if(graph_->operations.begin(),
+                                           graph_->operations.end(),
+                                           is_removed_operation) -
+                            graph_->operations.begin());
+
+  for (const ObjectState &state : object_states) {
+    IDNode *id_node = find_id_node(&state.object->id);
+    save_id_info(id_node);
+    save_operation_times(id_node);
+    /* Free all relations from and to the operations of the ID, since they are not removed by the
+     * node destructors from the other side. */
+    for (ComponentNode *comp_node : id_node->components.values()) {
+      for (OperationNode *op_node : comp_node->operations) {
+        for (Relation *rel : Vector<Relation *>(op_node->inlinks)) {
+          rel->unlink();
+          delete rel;
+        }
+        for (Relation *rel : Vector<Relation *>(op_node->outlinks)) {
+          rel->unlink();
+          delete rel;
+        }
+      }
+    }
+    graph_->id_hash.remove(id_node->id_orig);
+    graph_->id_nodes.remove(graph_->id_nodes.first_index_of(id_node));
+    delete id_node;
+  }
+
+  /* All other IDs are kept as they are. */
+  for (IDNode *id_node : graph_->id_nodes) {
+    built_map_.tagBuild(id_node->id_orig);
+  }
+
+  for (const ObjectState &state : object_states) {
+    /* Find the base index like #build_view_layer does. */
+    int base_index = -1;
+    int index = 0;
+    LISTBASE_FOREACH (Base *, base, &view_layer->object_bases) {
+      if (need_pull_base_into_graph(base)) {
+        if (base->object == state.object) {
+          base_index = index;
+          break;
+        }
+        index++;
+      }
+    }
+    build_object(base_index, state.object, state.linked_state, state.is_directly_visible);
+  }
+
+  restore_operation_times();
   tag_previously_tagged_nodes();
   update_invalid_cow_pointers();
 }
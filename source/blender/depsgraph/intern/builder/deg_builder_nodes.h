@@ -86,6 +86,13 @@ class DepsgraphNodeBuilder : public DepsgraphBuilder {
   virtual void begin_build();
   virtual void end_build();
 
+  /**
+   * Rebuild the nodes of the given objects in an existing graph, keeping all other nodes and
+   * relations. The old nodes of the objects are removed along with all their relations, which
+   * have to be rebuilt afterwards. Their copy-on-write data-blocks are reused.
+   */
+  void build_objects_incremental(Scene *scene, ViewLayer *view_layer, Span<Object *> objects);
+
   /**
    * `id_cow_self` is the user of `id_pointer`,
    * see also `LibraryIDLinkCallbackData` struct definition.
@@ -267,6 +274,19 @@ class DepsgraphNodeBuilder : public DepsgraphBuilder {
   };
   Vector<SavedEntryTag> saved_entry_tags_;
 
+  /* Timing history of an operation from the previous state of the dependency graph. It is used to
+   * prioritize operations during evaluation, so it is kept for the new operation nodes. */
+  struct SavedOperationTime {
+    ID *id_orig;
+    NodeType component_type;
+    string component_name;
+    OperationCode opcode;
+    string name;
+    int name_tag;
+    double average_time;
+  };
+  Vector<SavedOperationTime> saved_operation_times_;
+
   struct BuilderWalkUserData {
     DepsgraphNodeBuilder *builder;
   };
@@ -279,7 +299,12 @@ class DepsgraphNodeBuilder : public DepsgraphBuilder {
                               bool is_reference,
                               void *user_data);
 
+  void save_id_info(IDNode *id_node);
+  void save_entry_tag(OperationNode *op_node);
+  void save_operation_times(IDNode *id_node);
+
   void tag_previously_tagged_nodes();
+  void restore_operation_times();
   /**
    * Check for IDs that need to be flushed (COW-updated)
    * because the depsgraph itself created or removed some of their evaluated dependencies.
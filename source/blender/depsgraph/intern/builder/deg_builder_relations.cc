@@ -234,7 +234,10 @@ bool object_have_geometry_component(const Object *object)
 DepsgraphRelationBuilder::DepsgraphRelationBuilder(Main *bmain,
                                                    Depsgraph *graph,
                                                    DepsgraphBuilderCache *cache)
-    : DepsgraphBuilder(bmain, graph, cache), scene_(nullptr), rna_node_query_(graph, this)
+    : DepsgraphBuilder(bmain, graph, cache),
+      scene_(nullptr),
+      rna_node_query_(graph, this),
+      is_incremental_build_(false)
 {
 }
 
@@ -340,6 +343,9 @@ Relation *DepsgraphRelationBuilder::add_time_relation(TimeSourceNode *timesrc,
                                                       int flags)
 {
   if (timesrc && node_to) {
+    if (is_incremental_build_) {
+      flags |= RELATION_CHECK_BEFORE_ADD;
+    }
     return graph_->add_new_relation(timesrc, node_to, description, flags);
   }
 
@@ -368,6 +374,9 @@ Relation *DepsgraphRelationBuilder::add_operation_relation(OperationNode *node_f
                                                            int flags)
 {
   if (node_from && node_to) {
+    if (is_incremental_build_) {
+      flags |= RELATION_CHECK_BEFORE_ADD;
+    }
     return graph_->add_new_relation(node_from, node_to, description, flags);
   }
 
@@ -482,6 +491,17 @@ void DepsgraphRelationBuilder::begin_build()
 {
 }
 
+void DepsgraphRelationBuilder::begin_incremental_build(Scene *scene, const Set<ID *> &ids)
+{
+  scene_ = scene;
+  for (IDNode *id_node : graph_->id_nodes) {
+    if (!ids.contains(id_node->id_orig)) {
+      built_map_.tagBuild(id_node->id_orig);
+    }
+  }
+  is_incremental_build_ = true;
+}
+
 void DepsgraphRelationBuilder::build_id(ID *id)
 {
   if (id == nullptr) {
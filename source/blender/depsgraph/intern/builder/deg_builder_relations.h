@@ -150,6 +150,13 @@ class DepsgraphRelationBuilder : public DepsgraphBuilder {
 
   void begin_build();
 
+  /**
+   * Only build relations of the given IDs in the following build calls, for an incremental update
+   * of the graph. All other IDs are considered built already, and relations which exist already
+   * are not added again.
+   */
+  void begin_incremental_build(Scene *scene, const Set<ID *> &ids);
+
   template<typename KeyFrom, typename KeyTo>
   Relation *add_relation(const KeyFrom &key_from,
                          const KeyTo &key_to,
@@ -365,6 +372,7 @@ class DepsgraphRelationBuilder : public DepsgraphBuilder {
   BuilderMap built_map_;
   RNANodeQuery rna_node_query_;
   BuilderStack stack_;
+  bool is_incremental_build_;
 };
 
 struct DepsNodeHandle {
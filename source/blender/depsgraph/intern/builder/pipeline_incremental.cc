@@ -0,0 +1,280 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#include "pipeline_incremental.h"
+
+#include <cstdio>
+
+#include "PIL_time.h"
+
+#include "BKE_global.h"
+
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
+
+#include "intern/builder/deg_builder.h"
+#include "intern/builder/deg_builder_cycle.h"
+#include "intern/builder/deg_builder_nodes.h"
+#include "intern/builder/deg_builder_relations.h"
+#include "intern/depsgraph.h"
+#include "intern/depsgraph_relation.h"
+#include "intern/node/deg_node_component.h"
+#include "intern/node/deg_node_id.h"
+#include "intern/node/deg_node_operation.h"
+#include "intern/node/deg_node_time.h"
+
+namespace blender::deg {
+
+IncrementalBuilderPipeline::IncrementalBuilderPipeline(::Depsgraph *graph)
+    : ViewLayerBuilderPipeline(graph)
+{
+}
+
+static IDNode *relation_node_id_node(Node *node)
+{
+  if (node->type == NodeType::OPERATION) {
+    return static_cast<OperationNode *>(node)->owner->owner;
+  }
+  /* The time source doesn't belong to an ID. */
+  return nullptr;
+}
+
+bool IncrementalBuilderPipeline::find_objects_to_rebuild(Vector<Object *> &r_objects) const
+{
+  if (deg_graph_->is_render_pipeline_depsgraph || deg_graph_->id_nodes.is_empty()) {
+    return false;
+  }
+  if (scene_->set != nullptr) {
+    /* Objects from set scenes are built with a different view layer. */
+    return false;
+  }
+  for (ID *id : deg_graph_->relations_tagged_ids) {
+    /* Don't access the ID before it is known to be in the graph, the graph would need a full
+     * update if it was freed. */
+    const IDNode *id_node = deg_graph_->find_id_node(id);
+    if (id_node == nullptr) {
+      /* The ID is not used by this graph. */
+      continue;
+    }
+    if (id_node->id_type != ID_OB) {
+      return false;
+    }
+    Object *object = reinterpret_cast<Object *>(id);
+    if (object->rigidbody_object != nullptr || object->rigidbody_constraint != nullptr) {
+      /* Some nodes of rigid body objects are built by the scene. */
+      return false;
+    }
+    r_objects.append(object);
+  }
+  return true;
+}
+
+bool IncrementalBuilderPipeline::build_incremental()
+{
+  double start_time = 0.0;
+  if (G.debug & (G_DEBUG_DEPSGRAPH_BUILD | G_DEBUG_DEPSGRAPH_TIME)) {
+    start_time = PIL_check_seconds_timer();
+  }
+
+  Vector<Object *> objects;
+  if (!find_objects_to_rebuild(objects)) {
+    return false;
+  }
+  deg_graph_->relations_tagged_ids.clear();
+  if (objects.is_empty()) {
+    return true;
+  }
+
+  /* Relations from and to the rebuilt objects are removed, so the relations of all IDs connected
+   * to them have to be built again as well. */
+  Set<ID *> ids_to_rebuild;
+  for (Object *object : objects) {
+    ids_to_rebuild.add(&object->id);
+    const IDNode *id_node = deg_graph_->find_id_node(&object->id);
+    for (const ComponentNode *comp_node : id_node->components.values()) {
+      for (const OperationNode *op_node : comp_node->operations) {
+        for (const Relation *rel : op_node->inlinks) {
+          if (const IDNode *id_node_from = relation_node_id_node(rel->from)) {
+            ids_to_rebuild.add(id_node_from->id_orig);
+          }
+        }
+        for (const Relation *rel : op_node->outlinks) {
+          if (const IDNode *id_node_to = relation_node_id_node(rel->to)) {
+            ids_to_rebuild.add(id_node_to->id_orig);
+          }
+        }
+      }
+    }
+  }
+
+  /* Consider the current state of the kept IDs as their previous state, like a full rebuild does
+   * for all IDs, so that only changes caused by this update are detected when finalizing. */
+  Set<const ID *> existing_ids;
+  for (IDNode *id_node : deg_graph_->id_nodes) {
+    id_node->previously_visible_components_mask = id_node->visible_components_mask;
+    id_node->previous_eval_flags = id_node->eval_flags;
+    id_node->previous_customdata_masks = id_node->customdata_masks;
+    existing_ids.add_new(id_node->id_orig);
+  }
+
+  unique_ptr<DepsgraphNodeBuilder> node_builder = construct_node_builder();
+  node_builder->build_objects_incremental(scene_, view_layer_, objects);
+
+  /* The copy-on-write and driver relations only depend on the nodes of a single ID, so they only
+   * have to be built for the rebuilt and the new IDs. */
+  Vector<IDNode *> new_id_nodes;
+  for (IDNode *id_node : deg_graph_->id_nodes) {
+    if (!existing_ids.contains(id_node->id_orig)) {
+      new_id_nodes.append(id_node);
+      ids_to_rebuild.add(id_node->id_orig);
+    }
+  }
+  for (Object *object : objects) {
+    new_id_nodes.append(deg_graph_->find_id_node(&object->id));
+  }
+
+  unique_ptr<DepsgraphRelationBuilder> relation_builder = construct_relation_builder();
+  relation_builder->begin_incremental_build(scene_, ids_to_rebuild);
+  if (ids_to_rebuild.contains(&scene_->id)) {
+    /* Relations from the view layer to the objects are built together with the scene. */
+    relation_builder->build_view_layer(scene_, view_layer_, DEG_ID_LINKED_DIRECTLY);
+  }
+  for (ID *id : ids_to_rebuild) {
+    relation_builder->build_id(id);
+  }
+  for (IDNode *id_node : new_id_nodes) {
+    relation_builder->build_copy_on_write_relations(id_node);
+    relation_builder->build_driver_relations(id_node);
+  }
+
+  deg_graph_detect_cycles(deg_graph_);
+  deg_graph_build_finalize(bmain_, deg_graph_);
+  DEG_graph_tag_on_visible_update(reinterpret_cast<::Depsgraph *>(deg_graph_), false);
+  for (Object *object : objects) {
+    deg_graph_->find_id_node(&object->id)->tag_update(deg_graph_, DEG_UPDATE_SOURCE_RELATIONS);
+  }
+
+  if (G.debug & (G_DEBUG_DEPSGRAPH_BUILD | G_DEBUG_DEPSGRAPH_TIME)) {
+    printf("Depsgraph relations of %d objects updated in %f seconds.\n",
+           int(objects.size()),
+           PIL_check_seconds_timer() - start_time);
+  }
+
+  if (G.debug & G_DEBUG_DEPSGRAPH_INCREMENTAL) {
+    return check_against_full_build();
+  }
+  return true;
+}
+
+/* -------------------------------------------------------------------- */
+/** \name Comparison With a Full Rebuild
+ * \{ */
+
+static string operation_identifier(const OperationNode &op_node)
+{
+  const ComponentNode &comp_node = *op_node.owner;
+  return comp_node.owner->name + "/" + nodeTypeAsString(comp_node.type) + "(" + comp_node.name +
+         ")/" + op_node.identifier() + "[" + to_string(op_node.name_tag) + "]";
+}
+
+static string relation_node_identifier(const Node &node)
+{
+  if (node.type == NodeType::OPERATION) {
+    return operation_identifier(static_cast<const OperationNode &>(node));
+  }
+  return node.identifier();
+}
+
+/**
+ * Gather identifiers of all operations and relations of the graph. Operations of IDs which are
+ * not in \a ids_filter are skipped, when it is given.
+ */
+static Set<string> graph_identifiers(const Depsgraph &graph, const Set<const ID *> *ids_filter)
+{
+  auto is_skipped = [&](const Node &node) {
+    const IDNode *id_node = relation_node_id_node(const_cast<Node *>(&node));
+    return ids_filter && id_node && !ids_filter->contains(id_node->id_orig);
+  };
+  Set<string> identifiers;
+  for (const OperationNode *op_node : graph.operations) {
+    if (is_skipped(*op_node)) {
+      continue;
+    }
+    identifiers.add(operation_identifier(*op_node));
+    for (const Relation *rel : op_node->outlinks) {
+      if (is_skipped(*rel->to)) {
+        continue;
+      }
+      identifiers.add(relation_node_identifier(*rel->from) + " -> " +
+                      relation_node_identifier(*rel->to) + " (" + rel->name + ")");
+    }
+  }
+  for (const Relation *rel : graph.time_source->outlinks) {
+    if (is_skipped(*rel->to)) {
+      continue;
+    }
+    identifiers.add(relation_node_identifier(*rel->from) + " -> " +
+                    relation_node_identifier(*rel->to) + " (" + rel->name + ")");
+  }
+  return identifiers;
+}
+
+static void print_missing_identifiers(const Set<string> &identifiers,
+                                      const Set<string> &other_identifiers,
+                                      const char *message)
+{
+  const int max_printed_num = 20;
+  int missing_num = 0;
+  for (const string &identifier : identifiers) {
+    if (other_identifiers.contains(identifier)) {
+      continue;
+    }
+    if (missing_num < max_printed_num) {
+      fprintf(stderr, "  %s: %s\n", message, identifier.c_str());
+    }
+    missing_num++;
+  }
+  if (missing_num > max_printed_num) {
+    fprintf(stderr, "  ... and %d more\n", missing_num - max_printed_num);
+  }
+}
+
+bool IncrementalBuilderPipeline::check_against_full_build() const
+{
+  ::Depsgraph *full_graph = DEG_graph_new(bmain_, scene_, view_layer_, deg_graph_->mode);
+  DEG_graph_build_from_view_layer(full_graph);
+  const Depsgraph &deg_full_graph = *reinterpret_cast<const Depsgraph *>(full_graph);
+
+  /* IDs which are not used anymore are only removed by a full rebuild. */
+  Set<const ID *> full_graph_ids;
+  for (const IDNode *id_node : deg_full_graph.id_nodes) {
+    full_graph_ids.add(id_node->id_orig);
+  }
+  const Set<string> full_identifiers = graph_identifiers(deg_full_graph, nullptr);
+  const Set<string> incremental_identifiers = graph_identifiers(*deg_graph_, &full_graph_ids);
+  DEG_graph_free(full_graph);
+
+  if (full_identifiers.size() == incremental_identifiers.size() &&
+      std::all_of(full_identifiers.begin(),
+                  full_identifiers.end(),
+                  [&](const string &identifier) {
+                    return incremental_identifiers.contains(identifier);
+                  })) {
+    return true;
+  }
+
+  fprintf(stderr, "Incremental depsgraph relations update differs from a full rebuild:\n");
+  print_missing_identifiers(full_identifiers, incremental_identifiers, "Missing");
+  print_missing_identifiers(incremental_identifiers, full_identifiers, "Unexpected");
+  return false;
+}
+
+/** \} */
+
+}  // namespace blender::deg
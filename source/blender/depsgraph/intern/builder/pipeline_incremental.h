@@ -0,0 +1,38 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#pragma once
+
+#include "pipeline_view_layer.h"
+
+struct Object;
+
+namespace blender {
+namespace deg {
+
+/* Updates the nodes and relations of a few objects in a graph which was built for a view layer,
+ * while keeping the rest of the graph as it is.
+ *
+ * The tagged objects get their nodes rebuilt. Relations are rebuilt for the tagged objects, for
+ * all IDs which were connected to them by a relation and for IDs which were newly pulled into
+ * the graph. IDs which are not used anymore are kept until the next full rebuild. */
+class IncrementalBuilderPipeline : public ViewLayerBuilderPipeline {
+ public:
+  IncrementalBuilderPipeline(::Depsgraph *graph);
+
+  /* Update the relations of the objects in #Depsgraph::relations_tagged_ids. Returns false when
+   * the graph needs a full rebuild instead, either because the change can't be handled
+   * incrementally, in which case the graph is not modified, or because the incremental update
+   * didn't match a full rebuild in the `--debug-depsgraph-incremental` check. */
+  bool build_incremental();
+
+ protected:
+  bool find_objects_to_rebuild(Vector<Object *> &r_objects) const;
+  bool check_against_full_build() const;
+};
+
+}  // namespace deg
+}  // namespace blender
@@ -0,0 +1,112 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#include "intern/builder/pipeline_incremental.h"
+
+#include "BLI_listbase.h"
+
+#include "BKE_modifier.h"
+
+#include "DNA_modifier_types.h"
+
+#include "intern/depsgraph_test_utils.hh"
+
+namespace blender::deg::tests {
+
+class TestableIncrementalBuilderPipeline : public IncrementalBuilderPipeline {
+ public:
+  using IncrementalBuilderPipeline::check_against_full_build;
+  using IncrementalBuilderPipeline::IncrementalBuilderPipeline;
+};
+
+class IncrementalBuildTest : public DepsgraphTest {
+ public:
+  /** Update the relations of the tagged objects and compare the result with a full build. */
+  void expect_incremental_update_matches_full_build()
+  {
+    TestableIncrementalBuilderPipeline builder(depsgraph);
+    ASSERT_TRUE(builder.build_incremental());
+    EXPECT_TRUE(graph().relations_tagged_ids.is_empty());
+    EXPECT_TRUE(builder.check_against_full_build());
+  }
+};
+
+static ArrayModifierData *add_array_modifier(Object *object, Object *offset_object)
+{
+  ModifierData *md = BKE_modifier_new(eModifierType_Array);
+  BLI_addtail(&object->modifiers, md);
+  ArrayModifierData *amd = reinterpret_cast<ArrayModifierData *>(md);
+  amd->offset_ob = offset_object;
+  amd->offset_type |= MOD_ARR_OFF_OBJ;
+  return amd;
+}
+
+TEST_F(IncrementalBuildTest, add_and_remove_modifier)
+{
+  Object *object = add_mesh_object("Object");
+  Object *offset_object = add_mesh_object("Offset");
+  add_mesh_object("Unrelated");
+  build_depsgraph();
+
+  /* The modifier adds a relation from another object. */
+  ArrayModifierData *amd = add_array_modifier(object, offset_object);
+  DEG_id_relations_tag_update(bmain, &object->id);
+  expect_incremental_update_matches_full_build();
+
+  /* Removing it removes the relation again. */
+  BLI_remlink(&object->modifiers, amd);
+  BKE_modifier_free(&amd->modifier);
+  DEG_id_relations_tag_update(bmain, &object->id);
+  expect_incremental_update_matches_full_build();
+}
+
+TEST_F(IncrementalBuildTest, pull_in_new_object)
+{
+  Object *object = add_mesh_object("Object");
+  build_depsgraph();
+
+  /* The offset object is not in the scene, it is only added to the graph through the modifier. */
+  Object *offset_object = add_mesh_object("Offset", false);
+  add_array_modifier(object, offset_object);
+  DEG_id_relations_tag_update(bmain, &object->id);
+  expect_incremental_update_matches_full_build();
+  EXPECT_NE(graph().find_id_node(&offset_object->id), nullptr);
+}
+
+TEST_F(IncrementalBuildTest, multiple_tagged_objects)
+{
+  Object *object_a = add_mesh_object("A");
+  Object *object_b = add_mesh_object("B");
+  Object *object_c = add_mesh_object("C");
+  build_depsgraph();
+
+  /* Objects depending on each other are both rebuilt. */
+  add_array_modifier(object_a, object_b);
+  add_array_modifier(object_b, object_c);
+  DEG_id_relations_tag_update(bmain, &object_a->id);
+  DEG_id_relations_tag_update(bmain, &object_b->id);
+  expect_incremental_update_matches_full_build();
+}
+
+TEST_F(IncrementalBuildTest, unsupported_changes)
+{
+  add_mesh_object("Object");
+  build_depsgraph();
+
+  /* Other ID types require a full rebuild. */
+  DEG_id_relations_tag_update(bmain, &scene->id);
+  EXPECT_TRUE(graph().need_update);
+  DEG_graph_relations_update(depsgraph);
+
+  /* Objects that are not in the graph are ignored. */
+  Object *other_object = add_mesh_object("Other", false);
+  DEG_id_relations_tag_update(bmain, &other_object->id);
+  TestableIncrementalBuilderPipeline builder(depsgraph);
+  EXPECT_TRUE(builder.build_incremental());
+  EXPECT_EQ(graph().find_id_node(&other_object->id), nullptr);
+}
+
+}  // namespace blender::deg::tests
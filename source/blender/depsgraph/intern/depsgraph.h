@@ -92,6 +92,10 @@ struct Depsgraph {
   /* Indicates whether relations needs to be updated. */
   bool need_update;
 
+  /* Original objects whose relations are to be updated without rebuilding the whole graph, see
+   * #DEG_id_relations_tag_update. Only used when #need_update is false. */
+  Set<ID *> relations_tagged_ids;
+
   /* Indicated whether IDs in this graph are to be tagged as if they first appear visible, with
    * an optional tag for their animation (time) update. */
   bool need_visibility_update;
@@ -34,6 +34,7 @@
 #include "builder/pipeline_all_objects.h"
 #include "builder/pipeline_compositor.h"
 #include "builder/pipeline_from_ids.h"
+#include "builder/pipeline_incremental.h"
 #include "builder/pipeline_render.h"
 #include "builder/pipeline_view_layer.h"
 
@@ -287,8 +288,14 @@ void DEG_graph_relations_update(Depsgraph *graph)
 {
   deg::Depsgraph *deg_graph = (deg::Depsgraph *)graph;
   if (!deg_graph->need_update) {
-    /* Graph is up to date, nothing to do. */
-    return;
+    if (deg_graph->relations_tagged_ids.is_empty()) {
+      /* Graph is up to date, nothing to do. */
+      return;
+    }
+    deg::IncrementalBuilderPipeline builder(graph);
+    if (builder.build_incremental()) {
+      return;
+    }
   }
   DEG_graph_build_from_view_layer(graph);
 }
@@ -300,3 +307,17 @@ void DEG_relations_tag_update(Main *bmain)
     DEG_graph_tag_relations_update(reinterpret_cast<Depsgraph *>(depsgraph));
   }
 }
+
+void DEG_id_relations_tag_update(Main *bmain, ID *id)
+{
+  if (GS(id->name) != ID_OB) {
+    DEG_relations_tag_update(bmain);
+    return;
+  }
+  DEG_GLOBAL_DEBUG_PRINTF(TAG, "%s: Tagging relations of %s for update.\n", __func__, id->name);
+  for (deg::Depsgraph *depsgraph : deg::get_all_registered_graphs(bmain)) {
+    if (!depsgraph->need_update) {
+      depsgraph->relations_tagged_ids.add(id);
+    }
+  }
+}
@@ -0,0 +1,102 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#pragma once
+
+#include "testing/testing.h"
+
+#include "CLG_log.h"
+
+#include "BKE_appdir.h"
+#include "BKE_collection.h"
+#include "BKE_idtype.h"
+#include "BKE_layer.h"
+#include "BKE_main.h"
+#include "BKE_mesh.h"
+#include "BKE_modifier.h"
+#include "BKE_object.h"
+#include "BKE_scene.h"
+
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
+
+#include "IMB_imbuf.h"
+
+#include "RNA_define.h"
+
+#include "intern/depsgraph.h"
+
+namespace blender::deg::tests {
+
+/**
+ * Fixture for tests which build a dependency graph of a scene in a new main database.
+ * The graph is only built when #build_depsgraph is called.
+ */
+class DepsgraphTest : public testing::Test {
+ public:
+  Main *bmain = nullptr;
+  Scene *scene = nullptr;
+  ::Depsgraph *depsgraph = nullptr;
+
+  static void SetUpTestSuite()
+  {
+    CLG_init();
+    BKE_idtype_init();
+    BKE_appdir_init();
+    IMB_init();
+    BKE_modifier_init();
+    DEG_register_node_types();
+    RNA_init();
+  }
+  static void TearDownTestSuite()
+  {
+    RNA_exit();
+    DEG_free_node_types();
+    IMB_exit();
+    BKE_appdir_exit();
+    CLG_exit();
+  }
+
+  void SetUp() override
+  {
+    bmain = BKE_main_new();
+    scene = BKE_scene_add(bmain, "Scene");
+  }
+  void TearDown() override
+  {
+    if (depsgraph != nullptr) {
+      DEG_graph_free(depsgraph);
+    }
+    BKE_main_free(bmain);
+  }
+
+  Object *add_mesh_object(const char *name, const bool link_to_scene = true)
+  {
+    Object *object = BKE_object_add_only_object(bmain, OB_MESH, name);
+    object->data = BKE_mesh_add(bmain, name);
+    if (link_to_scene) {
+      BKE_collection_object_add(bmain, scene->master_collection, object);
+    }
+    return object;
+  }
+
+  void build_depsgraph()
+  {
+    ViewLayer *view_layer = BKE_view_layer_default_view(scene);
+    depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_VIEWPORT);
+    DEG_graph_build_from_view_layer(depsgraph);
+  }
+
+  Depsgraph &graph()
+  {
+    return *reinterpret_cast<Depsgraph *>(depsgraph);
+  }
+};
+
+}  // namespace blender::deg::tests
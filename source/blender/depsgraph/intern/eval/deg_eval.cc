@@ -13,6 +13,7 @@
 
 #include "BLI_compiler_attrs.h"
 #include "BLI_gsqueue.h"
+#include "BLI_heap.h"
 #include "BLI_task.h"
 #include "BLI_utildefines.h"
 
@@ -57,11 +58,6 @@ void schedule_children(DepsgraphEvalState *state,
                        ScheduleFunction *schedule_function,
                        ScheduleFunctionArgs... schedule_function_args);
 
-void schedule_node_to_pool(OperationNode *node, const int UNUSED(thread_id), TaskPool *pool)
-{
-  BLI_task_pool_push(pool, deg_task_run_func, node, false, nullptr);
-}
-
 /* Denotes which part of dependency graph is being evaluated. */
 enum class EvaluationStage {
   /* Stage 1: Only  Copy-on-Write operations are to be evaluated, prior to anything else.
@@ -84,6 +80,12 @@ struct DepsgraphEvalState {
   bool do_stats;
   EvaluationStage stage;
   bool need_single_thread_pass;
+
+  /* Operations which are ready for threaded evaluation, ordered by their critical path time so
+   * that long chains of operations are started before short ones. Every task in the pool takes
+   * one operation from the heap. */
+  Heap *ready_operations;
+  SpinLock ready_operations_lock;
 };
 
 void evaluate_node(const DepsgraphEvalState *state, OperationNode *operation_node)
@@ -92,24 +94,38 @@ void evaluate_node(const DepsgraphEvalState *state, OperationNode *operation_nod
 
   /* Sanity checks. */
   BLI_assert_msg(!operation_node->is_noop(), "NOOP nodes should not actually be scheduled");
-  /* Perform operation. */
+  /* Perform operation. The time is always measured, it is used to prioritize operations in the
+   * following evaluations. */
+  const double start_time = PIL_check_seconds_timer();
+  operation_node->evaluate(depsgraph);
+  const double time = PIL_check_seconds_timer() - start_time;
+  deg_eval_stats_operation_add_time(operation_node, time);
   if (state->do_stats) {
-    const double start_time = PIL_check_seconds_timer();
-    operation_node->evaluate(depsgraph);
-    operation_node->stats.current_time += PIL_check_seconds_timer() - start_time;
-  }
-  else {
-    operation_node->evaluate(depsgraph);
+    operation_node->stats.current_time += time;
   }
 }
 
-void deg_task_run_func(TaskPool *pool, void *taskdata)
+void schedule_node_to_pool(OperationNode *node, const int UNUSED(thread_id), TaskPool *pool)
+{
+  DepsgraphEvalState *state = (DepsgraphEvalState *)BLI_task_pool_user_data(pool);
+  BLI_spin_lock(&state->ready_operations_lock);
+  BLI_heap_insert(state->ready_operations, -node->critical_path_time, node);
+  BLI_spin_unlock(&state->ready_operations_lock);
+  BLI_task_pool_push(pool, deg_task_run_func, nullptr, false, nullptr);
+}
+
+void deg_task_run_func(TaskPool *pool, void *UNUSED(taskdata))
 {
   void *userdata_v = BLI_task_pool_user_data(pool);
   DepsgraphEvalState *state = (DepsgraphEvalState *)userdata_v;
 
+  /* Take the most important ready operation, which is not necessarily the one this task was
+   * pushed for. */
+  BLI_spin_lock(&state->ready_operations_lock);
+  OperationNode *operation_node = (OperationNode *)BLI_heap_pop_min(state->ready_operations);
+  BLI_spin_unlock(&state->ready_operations_lock);
+
   /* Evaluate node. */
-  OperationNode *operation_node = reinterpret_cast<OperationNode *>(taskdata);
   evaluate_node(state, operation_node);
 
   /* Schedule children. */
@@ -166,10 +182,71 @@ void calculate_pending_parents(Depsgraph *graph)
   }
 }
 
+/* Whether the child of an operation which is to be evaluated waits for that operation. The child
+ * counts the relation in its #OperationNode::num_links_pending in that case, which is only
+ * non-zero for operations which are to be evaluated. */
+bool is_pending_child_relation(const Relation *rel)
+{
+  if (rel->to->type != NodeType::OPERATION || (rel->flag & RELATION_FLAG_CYCLIC) != 0) {
+    return false;
+  }
+  const OperationNode *child = (const OperationNode *)rel->to;
+  return child->num_links_pending != 0;
+}
+
+/* Calculate the critical path time of every operation which is to be evaluated, which is the
+ * longest estimated time of any chain of operations starting at that operation. Operations are
+ * visited children first, #Node::custom_flags counts the children which are not visited yet. */
+void calculate_critical_path_times(Depsgraph *graph)
+{
+  Vector<OperationNode *> stack;
+  for (OperationNode *node : graph->operations) {
+    node->critical_path_time = 0.0f;
+    node->custom_flags = 0;
+    if (!check_operation_node_visible(node) || (node->flag & DEPSOP_FLAG_NEEDS_UPDATE) == 0) {
+      continue;
+    }
+    for (const Relation *rel : node->outlinks) {
+      if (is_pending_child_relation(rel)) {
+        node->custom_flags++;
+      }
+    }
+    if (node->custom_flags == 0) {
+      stack.append(node);
+    }
+  }
+  while (!stack.is_empty()) {
+    OperationNode *node = stack.pop_last();
+    float children_time = 0.0f;
+    for (const Relation *rel : node->outlinks) {
+      if (is_pending_child_relation(rel)) {
+        const OperationNode *child = (const OperationNode *)rel->to;
+        children_time = std::max(children_time, child->critical_path_time);
+      }
+    }
+    node->critical_path_time = children_time + float(deg_eval_stats_operation_cost(node));
+    /* Same conditions as in #calculate_pending_parents_for_node. */
+    for (Relation *rel : node->inlinks) {
+      if (rel->from->type != NodeType::OPERATION || (rel->flag & RELATION_FLAG_CYCLIC) != 0) {
+        continue;
+      }
+      OperationNode *parent = (OperationNode *)rel->from;
+      if (!check_operation_node_visible(parent) ||
+          (parent->flag & DEPSOP_FLAG_NEEDS_UPDATE) == 0) {
+        continue;
+      }
+      BLI_assert(parent->custom_flags > 0);
+      if (--parent->custom_flags == 0) {
+        stack.append(parent);
+      }
+    }
+  }
+}
+
 void initialize_execution(DepsgraphEvalState *state, Depsgraph *graph)
 {
   const bool do_stats = state->do_stats;
-  calculate_pending_parents(graph);
+  deg_eval_calculate_critical_path_times(graph);
   /* Clear tags and other things which needs to be clear. */
   for (OperationNode *node : graph->operations) {
     if (do_stats) {
@@ -336,6 +413,12 @@ void depsgraph_ensure_view_layer(Depsgraph *graph)
 
 }  // namespace
 
+void deg_eval_calculate_critical_path_times(Depsgraph *graph)
+{
+  calculate_pending_parents(graph);
+  calculate_critical_path_times(graph);
+}
+
 static TaskPool *deg_evaluate_task_pool_create(DepsgraphEvalState *state)
 {
   if (G.debug & G_DEBUG_DEPSGRAPH_NO_THREADS) {
@@ -366,6 +449,8 @@ void deg_evaluate_on_refresh(Depsgraph *graph)
   state.graph = graph;
   state.do_stats = graph->debug.do_time_debug();
   state.need_single_thread_pass = false;
+  state.ready_operations = BLI_heap_new();
+  BLI_spin_init(&state.ready_operations_lock);
   /* Prepare all nodes for evaluation. */
   initialize_execution(&state, graph);
 
@@ -384,6 +469,9 @@ void deg_evaluate_on_refresh(Depsgraph *graph)
   BLI_task_pool_work_and_wait(task_pool);
   BLI_task_pool_free(task_pool);
 
+  BLI_heap_free(state.ready_operations, nullptr);
+  BLI_spin_end(&state.ready_operations_lock);
+
   if (state.need_single_thread_pass) {
     state.stage = EvaluationStage::SINGLE_THREADED_WORKAROUND;
     evaluate_graph_single_threaded(&state);
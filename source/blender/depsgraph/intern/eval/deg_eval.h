@@ -23,5 +23,11 @@ struct Depsgraph;
  */
 void deg_evaluate_on_refresh(Depsgraph *graph);
 
+/**
+ * Calculate the pending parents and the critical path time of every operation which is to be
+ * evaluated. Ready operations with the longest critical path are evaluated first.
+ */
+void deg_eval_calculate_critical_path_times(Depsgraph *graph);
+
 }  // namespace deg
 }  // namespace blender
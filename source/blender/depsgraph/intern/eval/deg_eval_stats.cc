@@ -7,6 +7,8 @@
 
 #include "intern/eval/deg_eval_stats.h"
 
+#include <algorithm>
+
 #include "BLI_utildefines.h"
 
 #include "intern/depsgraph.h"
@@ -38,4 +40,29 @@ void deg_eval_stats_aggregate(Depsgraph *graph)
   }
 }
 
+void deg_eval_stats_operation_add_time(OperationNode *op_node, const double time)
+{
+  /* Weight of the latest evaluation, so that the average follows changes in the scene within a
+   * few frames while smoothing out noise. */
+  const double weight = 0.25;
+  Node::Stats &stats = op_node->stats;
+  if (stats.average_time == 0.0) {
+    stats.average_time = time;
+  }
+  else {
+    stats.average_time += (time - stats.average_time) * weight;
+  }
+}
+
+double deg_eval_stats_operation_cost(const OperationNode *op_node)
+{
+  if (op_node->is_noop()) {
+    return 0.0;
+  }
+  /* Operations which were not evaluated yet still count, so that longer chains are preferred
+   * when there is no timing history. */
+  const double min_cost = 1e-6;
+  return std::max(op_node->stats.average_time, min_cost);
+}
+
 }  // namespace blender::deg
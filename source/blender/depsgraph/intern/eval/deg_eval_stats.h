@@ -11,9 +11,16 @@ namespace blender {
 namespace deg {
 
 struct Depsgraph;
+struct OperationNode;
 
 /* Aggregate operation timings to overall component and ID nodes timing. */
 void deg_eval_stats_aggregate(Depsgraph *graph);
 
+/* Add the time of an evaluation of the operation to its timing history. */
+void deg_eval_stats_operation_add_time(OperationNode *op_node, double time);
+
+/* Estimate the time needed to evaluate the operation from its timing history. */
+double deg_eval_stats_operation_cost(const OperationNode *op_node);
+
 }  // namespace deg
 }  // namespace blender
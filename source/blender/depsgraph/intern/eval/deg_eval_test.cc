@@ -0,0 +1,105 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#include "intern/eval/deg_eval.h"
+
+#include "intern/depsgraph_relation.h"
+#include "intern/depsgraph_test_utils.hh"
+#include "intern/eval/deg_eval_stats.h"
+#include "intern/node/deg_node_component.h"
+#include "intern/node/deg_node_id.h"
+#include "intern/node/deg_node_operation.h"
+
+namespace blender::deg::tests {
+
+class EvaluationScheduleTest : public DepsgraphTest {
+ public:
+  OperationNode *find_operation(Object *object, const NodeType type, const OperationCode opcode)
+  {
+    const IDNode *id_node = graph().find_id_node(&object->id);
+    const ComponentNode *comp_node = id_node->find_component(type);
+    return comp_node->find_operation(opcode, "", -1);
+  }
+
+  /** Tag all operations for update, so that the whole graph is scheduled. */
+  void tag_all_operations()
+  {
+    for (OperationNode *op_node : graph().operations) {
+      op_node->flag |= DEPSOP_FLAG_NEEDS_UPDATE;
+    }
+  }
+};
+
+TEST_F(EvaluationScheduleTest, critical_path_order)
+{
+  Object *slow_object = add_mesh_object("Slow");
+  Object *fast_object = add_mesh_object("Fast");
+  build_depsgraph();
+
+  OperationNode *slow_geometry = find_operation(
+      slow_object, NodeType::GEOMETRY, OperationCode::GEOMETRY_EVAL);
+  slow_geometry->stats.average_time = 1.0;
+  tag_all_operations();
+  deg_eval_calculate_critical_path_times(&graph());
+
+  /* An operation is never prioritized lower than the operations waiting for it. */
+  for (const OperationNode *op_node : graph().operations) {
+    const ComponentNode *comp_node = op_node->owner;
+    if (!comp_node->affects_directly_visible && comp_node->type != NodeType::COPY_ON_WRITE) {
+      /* Invisible operations are not evaluated. */
+      continue;
+    }
+    for (const Relation *rel : op_node->outlinks) {
+      if (rel->to->type != NodeType::OPERATION || (rel->flag & RELATION_FLAG_CYCLIC) != 0) {
+        continue;
+      }
+      const OperationNode *child = static_cast<const OperationNode *>(rel->to);
+      if (child->num_links_pending != 0) {
+        EXPECT_GE(op_node->critical_path_time, child->critical_path_time);
+      }
+    }
+  }
+
+  /* Both copy-on-write operations are ready at the start of the evaluation, the one leading to
+   * the slow geometry evaluation is taken first. */
+  const OperationNode *slow_cow = find_operation(
+      slow_object, NodeType::COPY_ON_WRITE, OperationCode::COPY_ON_WRITE);
+  const OperationNode *fast_cow = find_operation(
+      fast_object, NodeType::COPY_ON_WRITE, OperationCode::COPY_ON_WRITE);
+  EXPECT_GE(slow_cow->critical_path_time, slow_geometry->critical_path_time);
+  EXPECT_GE(slow_geometry->critical_path_time, 1.0f);
+  EXPECT_GT(slow_cow->critical_path_time, fast_cow->critical_path_time);
+
+  /* Without timing history an operation is still prioritized over the chain following it. */
+  slow_geometry->stats.average_time = 0.0;
+  deg_eval_calculate_critical_path_times(&graph());
+  EXPECT_GT(slow_cow->critical_path_time, slow_geometry->critical_path_time);
+}
+
+TEST_F(EvaluationScheduleTest, timing_history_survives_rebuild)
+{
+  Object *object = add_mesh_object("Object");
+  build_depsgraph();
+
+  deg_eval_stats_operation_add_time(
+      find_operation(object, NodeType::GEOMETRY, OperationCode::GEOMETRY_EVAL), 0.5);
+
+  /* Full rebuild of the relations. */
+  DEG_graph_tag_relations_update(depsgraph);
+  DEG_graph_relations_update(depsgraph);
+  EXPECT_EQ(find_operation(object, NodeType::GEOMETRY, OperationCode::GEOMETRY_EVAL)
+                ->stats.average_time,
+            0.5);
+
+  /* Incremental update of the relations of the object. */
+  DEG_id_relations_tag_update(bmain, &object->id);
+  DEG_graph_relations_update(depsgraph);
+  EXPECT_EQ(find_operation(object, NodeType::GEOMETRY, OperationCode::GEOMETRY_EVAL)
+                ->stats.average_time,
+            0.5);
+}
+
+}  // namespace blender::deg::tests
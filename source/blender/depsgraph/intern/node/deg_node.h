@@ -162,6 +162,9 @@ struct Node {
     void reset_current();
     /* Time spend on this node during current graph evaluation. */
     double current_time;
+    /* Running average of the evaluation time over previous graph evaluations, zero when the node
+     * was not evaluated yet. Only maintained for operations. */
+    double average_time;
   };
   /* Relationships between nodes
    * The reason why all depsgraph nodes are descended from this type (apart
@@ -1405,6 +1405,8 @@ static int bake(const BakeAPIRender *bkr,
     }
 
     highpoly = MEM_callocN(sizeof(BakeHighPolyData) * tot_highpoly, "bake high poly objects");
+    Object **highpoly_objects_eval = MEM_mallocN(sizeof(Object *) * tot_highpoly, __func__);
+    Mesh **highpoly_meshes = MEM_mallocN(sizeof(Mesh *) * tot_highpoly, __func__);
 
     /* populate highpoly array */
     for (link = selected_objects->first; link; link = link->next) {
@@ -1419,7 +1421,7 @@ static int bake(const BakeAPIRender *bkr,
       highpoly[i].ob_eval = DEG_get_evaluated_object(depsgraph, ob_iter);
       highpoly[i].ob_eval->visibility_flag &= ~OB_HIDE_RENDER;
       highpoly[i].ob_eval->base_flag |= (BASE_VISIBLE_DEPSGRAPH | BASE_ENABLED_RENDER);
-      highpoly[i].me = BKE_mesh_new_from_object(NULL, highpoly[i].ob_eval, false, false);
+      highpoly_objects_eval[i] = highpoly[i].ob_eval;
 
       /* Low-poly to high-poly transformation matrix. */
       copy_m4_m4(highpoly[i].obmat, highpoly[i].ob->obmat);
@@ -1432,6 +1434,16 @@ static int bake(const BakeAPIRender *bkr,
 
     BLI_assert(i == tot_highpoly);
 
+    /* Convert all high poly objects at once, instances of the same mesh are converted in
+     * parallel. */
+    BKE_mesh_new_from_objects(
+        NULL, highpoly_objects_eval, tot_highpoly, false, false, highpoly_meshes);
+    for (i = 0; i < tot_highpoly; i++) {
+      highpoly[i].me = highpoly_meshes[i];
+    }
+    MEM_freeN(highpoly_objects_eval);
+    MEM_freeN(highpoly_meshes);
+
     if (ob_cage != NULL) {
       ob_cage_eval->visibility_flag |= OB_HIDE_RENDER;
       ob_cage_eval->base_flag &= ~(BASE_VISIBLE_DEPSGRAPH | BASE_ENABLED_RENDER);
@@ -130,6 +130,28 @@ static void object_force_modifier_update_for_bind(Depsgraph *depsgraph, Object *
   }
 }
 
+/**
+ * Tag the relations of the object for update after adding or removing a modifier. Physics
+ * modifiers also change relations of other objects (colliders, effectors, particles), which
+ * requires rebuilding the whole graph.
+ */
+static void object_modifier_relations_tag_update(Main *bmain, Object *ob, const int type)
+{
+  if (ELEM(type,
+           eModifierType_Collision,
+           eModifierType_ParticleSystem,
+           eModifierType_Cloth,
+           eModifierType_Fluid,
+           eModifierType_Softbody,
+           eModifierType_DynamicPaint,
+           eModifierType_Surface)) {
+    DEG_relations_tag_update(bmain);
+  }
+  else {
+    DEG_id_relations_tag_update(bmain, &ob->id);
+  }
+}
+
 static void object_force_modifier_bind_simple_options(Depsgraph *depsgraph,
                                                       Object *object,
                                                       ModifierData *md)
@@ -227,7 +249,7 @@ ModifierData *ED_object_modifier_add(
   BKE_object_modifier_set_active(ob, new_md);
 
   DEG_id_tag_update(&ob->id, ID_RECALC_GEOMETRY);
-  DEG_relations_tag_update(bmain);
+  object_modifier_relations_tag_update(bmain, ob, type);
 
   return new_md;
 }
@@ -372,6 +394,8 @@ bool ED_object_modifier_remove(
     ReportList *reports, Main *bmain, Scene *scene, Object *ob, ModifierData *md)
 {
   bool sort_depsgraph = false;
+  /* The modifier is freed when it is removed. */
+  const int type = md->type;
 
   bool ok = object_modifier_remove(bmain, scene, ob, md, &sort_depsgraph);
 
@@ -381,7 +405,7 @@ bool ED_object_modifier_remove(
   }
 
   DEG_id_tag_update(&ob->id, ID_RECALC_GEOMETRY);
-  DEG_relations_tag_update(bmain);
+  object_modifier_relations_tag_update(bmain, ob, type);
 
   return true;
 }
@@ -1851,6 +1851,18 @@ static Vector<NodeExtraInfoRow> node_get_extra_info(const SpaceNode &snode, cons
   const geo_log::NodeLog *node_log = geo_log::ModifierLog::find_node_by_node_editor_context(snode,
                                                                                             node);
   if (node_log != nullptr) {
+    if (snode.overlay.flag & SN_OVERLAY_SHOW_TIMINGS &&
+        node_log->eliminated_field_operations() > 0) {
+      NodeExtraInfoRow row;
+      row.text = std::to_string(node_log->eliminated_field_operations()) +
+                 TIP_(node_log->eliminated_field_operations() == 1 ? " Operation Eliminated" :
+                                                                     " Operations Eliminated");
+      row.tooltip = TIP_(
+          "Field operations in the inputs of the node that are skipped when it evaluates them, "
+          "because they are computed already or only have constant inputs");
+      row.icon = ICON_PREVIEW_RANGE;
+      rows.append(std::move(row));
+    }
     for (const std::string &message : node_log->debug_messages()) {
       NodeExtraInfoRow row;
       row.text = message;
@@ -19,6 +19,8 @@
 #include "BKE_node.h"
 #include "BKE_screen.h"
 
+#include "DEG_depsgraph.h"
+
 #include "ED_node.h"
 #include "ED_render.h"
 #include "ED_screen.h"
@@ -32,6 +34,8 @@
 #include "RNA_enum_types.h"
 #include "RNA_prototypes.h"
 
+#include "NOD_geometry_nodes_eval_log.hh"
+
 #include "WM_api.h"
 #include "WM_types.h"
 
@@ -39,10 +43,38 @@
 
 using blender::float2;
 
+namespace geo_log = blender::nodes::geometry_nodes_eval_log;
+
 /* ******************** tree path ********************* */
 
+/**
+ * Geometry nodes only log socket values for the node groups that are displayed in an editor,
+ * so the object has to be reevaluated when the displayed group has no logged values yet.
+ * Otherwise the editor is redrawn from the existing log.
+ */
+static void node_tree_path_tag_geometry_update(SpaceNode *snode)
+{
+  if (snode->edittree == nullptr || snode->edittree->type != NTREE_GEOMETRY) {
+    return;
+  }
+  if (snode->id == nullptr || GS(snode->id->name) != ID_OB) {
+    return;
+  }
+  const geo_log::TreeLog *tree_log = geo_log::ModifierLog::find_tree_by_node_editor_context(
+      *snode);
+  if (tree_log != nullptr && tree_log->has_socket_values()) {
+    return;
+  }
+  DEG_id_tag_update(snode->id, ID_RECALC_GEOMETRY);
+}
+
 void ED_node_tree_start(SpaceNode *snode, bNodeTree *ntree, ID *id, ID *from)
 {
+  /* This is also called when the context is updated before drawing, so only tag an update when
+   * the displayed tree actually changes. */
+  const bool displayed_tree_changed = snode->edittree != ntree || snode->id != id ||
+                                      BLI_listbase_count_at_most(&snode->treepath, 2) != 1;
+
   LISTBASE_FOREACH_MUTABLE (bNodeTreePath *, path, &snode->treepath) {
     MEM_freeN(path);
   }
@@ -76,6 +108,9 @@ void ED_node_tree_start(SpaceNode *snode, bNodeTree *ntree, ID *id, ID *from)
   snode->from = from;
 
   ED_node_set_active_viewer_key(snode);
+  if (displayed_tree_changed) {
+    node_tree_path_tag_geometry_update(snode);
+  }
 
   WM_main_add_notifier(NC_SCENE | ND_NODES, nullptr);
 }
@@ -111,6 +146,7 @@ void ED_node_tree_push(SpaceNode *snode, bNodeTree *ntree, bNode *gnode)
   snode->edittree = ntree;
 
   ED_node_set_active_viewer_key(snode);
+  node_tree_path_tag_geometry_update(snode);
 
   WM_main_add_notifier(NC_SCENE | ND_NODES, nullptr);
 }
@@ -132,6 +168,7 @@ void ED_node_tree_pop(SpaceNode *snode)
   snode->edittree = path->nodetree;
 
   ED_node_set_active_viewer_key(snode);
+  node_tree_path_tag_geometry_update(snode);
 
   /* listener updates the View2D center from edittree */
   WM_main_add_notifier(NC_SCENE | ND_NODES, nullptr);
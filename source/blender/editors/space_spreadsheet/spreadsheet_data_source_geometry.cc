@@ -137,7 +137,7 @@ std::unique_ptr<ColumnValues> GeometryDataSource::get_column_values(
                                                return references[reference_handles[index]];
                                              }));
     }
-    Span<float4x4> transforms = instances.instance_transforms();
+    const VArray<float4x4> transforms = instances.instance_transforms();
     if (STREQ(column_id.name, "Rotation")) {
       return std::make_unique<ColumnValues>(
           column_id.name, VArray<float3>::ForFunc(domain_num, [transforms](int64_t index) {
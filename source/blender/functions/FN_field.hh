@@ -55,12 +55,30 @@ enum class FieldNodeType {
   Constant,
 };
 
+/**
+ * Statistics about the optimizations that were applied to field trees before they were evaluated.
+ */
+struct FieldOptimizationStats {
+  /** Operations that were skipped, because an equivalent operation is evaluated already. */
+  int deduplicated_operations = 0;
+  /** Operations that were replaced by a constant, because all their inputs are constant. */
+  int folded_operations = 0;
+
+  int eliminated_operations() const
+  {
+    return deduplicated_operations + folded_operations;
+  }
+};
+
 /**
  * A node in a field-tree. It has at least one output that can be referenced by fields.
  */
 class FieldNode {
  private:
   FieldNodeType node_type_;
+  /** See #last_optimization_stats. Accessed atomically, because fields are shared by threads. */
+  mutable int32_t last_deduplicated_operations_ = 0;
+  mutable int32_t last_folded_operations_ = 0;
 
  protected:
   /**
@@ -84,6 +102,14 @@ class FieldNode {
 
   virtual uint64_t hash() const;
   virtual bool is_equal_to(const FieldNode &other) const;
+
+  /**
+   * Optimizations that were applied when this node was last evaluated as the first field of a
+   * #evaluate_fields call. They include all fields that were evaluated together with it. This
+   * allows retrieving them after the evaluation without optimizing the field tree again.
+   */
+  FieldOptimizationStats last_optimization_stats() const;
+  void set_last_optimization_stats(const FieldOptimizationStats &stats) const;
 };
 
 /**
@@ -325,6 +351,7 @@ class FieldEvaluator : NonMovable, NonCopyable {
 
   Field<bool> selection_field_;
   IndexMask selection_mask_;
+  FieldOptimizationStats *optimization_stats_ = nullptr;
 
  public:
   /** Takes #mask by pointer because the mask has to live longer than the evaluator. */
@@ -357,6 +384,12 @@ class FieldEvaluator : NonMovable, NonCopyable {
     selection_field_ = std::move(selection);
   }
 
+  /** Add the optimizations that are applied to the evaluated fields to #stats. */
+  void set_optimization_stats(FieldOptimizationStats *stats)
+  {
+    optimization_stats_ = stats;
+  }
+
   /**
    * \param field: Field to add to the evaluator.
    * \param dst: Mutable virtual array that the evaluated result for this field is be written into.
@@ -453,6 +486,8 @@ class FieldEvaluator : NonMovable, NonCopyable {
  *   instead of into newly created ones. That allows making the computed data live longer than
  *   #scope and is more efficient when the data will be written into those virtual arrays
  *   later anyway.
+ * \param r_optimization_stats: If provided, the optimizations that were applied to the field tree
+ *   are added to it.
  * \return The computed virtual arrays for each provided field. If #dst_varrays is passed, the
  *   provided virtual arrays are returned.
  */
@@ -460,7 +495,8 @@ Vector<GVArray> evaluate_fields(ResourceScope &scope,
                                 Span<GFieldRef> fields_to_evaluate,
                                 IndexMask mask,
                                 const FieldContext &context,
-                                Span<GVMutableArray> dst_varrays = {});
+                                Span<GVMutableArray> dst_varrays = {},
+                                FieldOptimizationStats *r_optimization_stats = nullptr);
 
 /* -------------------------------------------------------------------- */
 /** \name Utility functions for simple field creation and evaluation
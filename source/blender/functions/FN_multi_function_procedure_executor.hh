@@ -8,16 +8,26 @@
 
 #include "FN_multi_function_procedure.hh"
 
+#include <memory>
+
 namespace blender::fn {
 
+struct MFCompiledProcedure;
+
 /** A multi-function that executes a procedure internally. */
 class MFProcedureExecutor : public MultiFunction {
  private:
   MFSignature signature_;
   const MFProcedure &procedure_;
+  /**
+   * Procedures without control flow are prepared for faster execution when the executor is
+   * created. This is null when the procedure has to be interpreted.
+   */
+  std::unique_ptr<MFCompiledProcedure> compiled_procedure_;
 
  public:
   MFProcedureExecutor(const MFProcedure &procedure);
+  ~MFProcedureExecutor();
 
   void call(IndexMask mask, MFParams params, MFContext context) const override;
 
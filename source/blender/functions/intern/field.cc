@@ -1,10 +1,18 @@
 /* SPDX-License-Identifier: GPL-2.0-or-later */
 
+#include <algorithm>
+
+#include "MEM_guardedalloc.h"
+
+#include "atomic_ops.h"
+
+#include "BLI_enumerable_thread_specific.hh"
 #include "BLI_index_mask_ops.hh"
 #include "BLI_map.hh"
 #include "BLI_multi_value_map.hh"
 #include "BLI_set.hh"
 #include "BLI_stack.hh"
+#include "BLI_task.hh"
 #include "BLI_vector_set.hh"
 
 #include "FN_field.hh"
@@ -16,6 +24,245 @@
 
 namespace blender::fn {
 
+/* --------------------------------------------------------------------
+ * Field Tree Optimization.
+ */
+
+/**
+ * Field trees are not modified when they are optimized. Instead, fields can be replaced with
+ * equivalent fields that are cheaper to evaluate. All traversals of the field tree during
+ * evaluation have to look up the replacement of every field they encounter.
+ */
+struct FieldTreeOptimization {
+  /** Fields that are not in the map are used unchanged. */
+  Map<GFieldRef, GFieldRef> replacements;
+  int deduplicated_operations = 0;
+  int folded_operations = 0;
+
+  GFieldRef get(const GFieldRef field) const
+  {
+    return replacements.lookup_default(field, field);
+  }
+};
+
+/**
+ * Identifies operations that compute the same values, because they call an equivalent function
+ * with the same (already optimized) inputs.
+ */
+struct OperationKey {
+  const MultiFunction *fn;
+  Vector<GFieldRef, 4> inputs;
+
+  uint64_t hash() const
+  {
+    uint64_t hash = fn->hash();
+    for (const GFieldRef &input : inputs) {
+      hash = hash * 33 ^ input.hash();
+    }
+    return hash;
+  }
+
+  friend bool operator==(const OperationKey &a, const OperationKey &b)
+  {
+    if (a.fn != b.fn && !a.fn->equals(*b.fn)) {
+      return false;
+    }
+    return a.inputs.as_span() == b.inputs.as_span();
+  }
+};
+
+/** Identifies constants with the same type and value. */
+struct ConstantKey {
+  const FieldConstant *constant;
+
+  uint64_t hash() const
+  {
+    return constant->type().hash(constant->value().get());
+  }
+
+  friend bool operator==(const ConstantKey &a, const ConstantKey &b)
+  {
+    return &a.constant->type() == &b.constant->type() &&
+           a.constant->type().is_equal(a.constant->value().get(), b.constant->value().get());
+  }
+};
+
+static bool operation_can_be_folded(const FieldOperation &operation, Span<GFieldRef> inputs)
+{
+  for (const GFieldRef &input : inputs) {
+    if (input.node().node_type() != FieldNodeType::Constant) {
+      return false;
+    }
+  }
+  const MultiFunction &fn = operation.multi_function();
+  if (fn.depends_on_context()) {
+    /* The result may be different for every evaluation. */
+    return false;
+  }
+  for (const int param_index : fn.param_indices()) {
+    const MFParamType param_type = fn.param_type(param_index);
+    if (param_type.data_type().category() != MFDataType::Single ||
+        param_type.interface_type() == MFParamType::Mutable) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Calls the function of an operation whose inputs are all constant once and creates a new
+ * constant for every output.
+ */
+static Vector<const FieldConstant *> fold_operation(ResourceScope &scope,
+                                                   const FieldOperation &operation,
+                                                   Span<GFieldRef> inputs)
+{
+  const MultiFunction &fn = operation.multi_function();
+  MFParamsBuilder params{fn, 1};
+  MFContextBuilder context;
+  Vector<GMutablePointer> outputs;
+  int input_index = 0;
+  for (const int param_index : fn.param_indices()) {
+    const MFParamType param_type = fn.param_type(param_index);
+    if (param_type.interface_type() == MFParamType::Input) {
+      const FieldConstant &constant = static_cast<const FieldConstant &>(
+          inputs[input_index].node());
+      params.add_readonly_single_input(constant.value());
+      input_index++;
+    }
+    else {
+      const CPPType &type = param_type.data_type().single_type();
+      void *buffer = scope.linear_allocator().allocate(type.size(), type.alignment());
+      params.add_uninitialized_single_output(GMutableSpan{type, buffer, 1});
+      outputs.append({type, buffer});
+    }
+  }
+
+  fn.call(IndexRange(1), params, context);
+
+  Vector<const FieldConstant *> constants;
+  for (GMutablePointer output : outputs) {
+    constants.append(&scope.construct<FieldConstant>(*output.type(), output.get()));
+    output.destruct();
+  }
+  return constants;
+}
+
+/**
+ * Finds fields that can be replaced with cheaper equivalents:
+ * - Operations that only have constant inputs are evaluated once and replaced with constants.
+ * - Operations that call the same function with the same inputs as another operation, and
+ *   constants that have the same value as another constant, are replaced with that other field.
+ *   That is done bottom up, so that entire identical sub-trees are evaluated only once.
+ *
+ * New constants are owned by #scope.
+ */
+static FieldTreeOptimization optimize_field_tree(ResourceScope &scope,
+                                                 Span<GFieldRef> entry_fields)
+{
+  FieldTreeOptimization optimization;
+  Map<OperationKey, const FieldOperation *> operation_by_key;
+  Map<ConstantKey, const FieldConstant *> constant_by_key;
+
+  /* Find an equal constant that has been found before, if possible. */
+  auto deduplicate_constant = [&](const FieldConstant &constant) -> const FieldConstant & {
+    if (!constant.type().is_hashable() || !constant.type().is_equality_comparable()) {
+      return constant;
+    }
+    return *constant_by_key.lookup_or_add(ConstantKey{&constant}, &constant);
+  };
+
+  /* Utility struct that is used to do depth first search traversal of the tree below. */
+  struct NodeWithIndex {
+    const FieldNode *node;
+    int current_input_index = 0;
+  };
+
+  Set<const FieldNode *> handled_nodes;
+  Stack<NodeWithIndex> nodes_to_check;
+  for (const GFieldRef &field : entry_fields) {
+    if (handled_nodes.add(&field.node())) {
+      nodes_to_check.push({&field.node()});
+    }
+  }
+
+  while (!nodes_to_check.is_empty()) {
+    NodeWithIndex &node_with_index = nodes_to_check.peek();
+    const FieldNode &node = *node_with_index.node;
+    switch (node.node_type()) {
+      case FieldNodeType::Input: {
+        /* Equal inputs are deduplicated during evaluation already. */
+        nodes_to_check.pop();
+        break;
+      }
+      case FieldNodeType::Constant: {
+        const FieldConstant &constant = static_cast<const FieldConstant &>(node);
+        const FieldConstant &first_constant = deduplicate_constant(constant);
+        if (&first_constant != &constant) {
+          optimization.replacements.add_new({constant, 0}, {first_constant, 0});
+        }
+        nodes_to_check.pop();
+        break;
+      }
+      case FieldNodeType::Operation: {
+        const FieldOperation &operation = static_cast<const FieldOperation &>(node);
+        const Span<GField> operation_inputs = operation.inputs();
+        if (node_with_index.current_input_index < operation_inputs.size()) {
+          /* Optimize all inputs first. */
+          const FieldNode &input_node =
+              operation_inputs[node_with_index.current_input_index].node();
+          node_with_index.current_input_index++;
+          if (handled_nodes.add(&input_node)) {
+            nodes_to_check.push({&input_node});
+          }
+          break;
+        }
+        nodes_to_check.pop();
+
+        OperationKey key;
+        key.fn = &operation.multi_function();
+        for (const GField &input : operation_inputs) {
+          key.inputs.append(optimization.get(input));
+        }
+
+        if (operation_can_be_folded(operation, key.inputs)) {
+          const Vector<const FieldConstant *> constants = fold_operation(
+              scope, operation, key.inputs);
+          for (const int output_index : constants.index_range()) {
+            const FieldConstant &constant = deduplicate_constant(*constants[output_index]);
+            optimization.replacements.add_new({operation, output_index}, {constant, 0});
+          }
+          optimization.folded_operations++;
+          break;
+        }
+
+        const FieldOperation *first_operation = operation_by_key.lookup_or_add(std::move(key),
+                                                                               &operation);
+        if (first_operation != &operation) {
+          const int outputs_num = operation.multi_function().param_amount() -
+                                  operation_inputs.size();
+          for (const int output_index : IndexRange(outputs_num)) {
+            optimization.replacements.add_new({operation, output_index},
+                                              {*first_operation, output_index});
+          }
+          optimization.deduplicated_operations++;
+        }
+        break;
+      }
+    }
+  }
+
+  return optimization;
+}
+
+static void add_optimization_stats(const FieldTreeOptimization &optimization,
+                                   FieldOptimizationStats &r_stats)
+{
+  r_stats.deduplicated_operations += optimization.deduplicated_operations;
+  r_stats.folded_operations += optimization.folded_operations;
+}
+
+
 /* --------------------------------------------------------------------
  * Field Evaluation.
  */
@@ -32,14 +279,18 @@ struct FieldTreeInfo {
    * the tree is constructed. This set contains every different input only once.
    */
   VectorSet<std::reference_wrapper<const FieldInput>> deduplicated_field_inputs;
+  /** Fields in the tree that are replaced. The maps above only contain the replacements. */
+  FieldTreeOptimization optimization;
 };
 
 /**
  * Collects some information from the field tree that is required by later steps.
  */
-static FieldTreeInfo preprocess_field_tree(Span<GFieldRef> entry_fields)
+static FieldTreeInfo preprocess_field_tree(Span<GFieldRef> entry_fields,
+                                           FieldTreeOptimization optimization)
 {
   FieldTreeInfo field_tree_info;
+  field_tree_info.optimization = std::move(optimization);
 
   Stack<GFieldRef> fields_to_check;
   Set<GFieldRef> handled_fields;
@@ -61,7 +312,9 @@ static FieldTreeInfo preprocess_field_tree(Span<GFieldRef> entry_fields)
       }
       case FieldNodeType::Operation: {
         const FieldOperation &operation = static_cast<const FieldOperation &>(field_node);
-        for (const GFieldRef operation_input : operation.inputs()) {
+        for (const GField &operation_input_field : operation.inputs()) {
+          const GFieldRef operation_input = field_tree_info.optimization.get(
+              operation_input_field);
           field_tree_info.field_users.add(operation_input, field);
           if (handled_fields.add(operation_input)) {
             fields_to_check.push(operation_input);
@@ -189,7 +442,8 @@ static void build_multi_function_procedure_for_fields(MFProcedure &procedure,
           if (field_with_index.current_input_index < operation_inputs.size()) {
             /* Not all inputs are handled yet. Push the next input field to the stack and increment
              * the input index. */
-            fields_to_check.push({operation_inputs[field_with_index.current_input_index]});
+            fields_to_check.push({field_tree_info.optimization.get(
+                operation_inputs[field_with_index.current_input_index])});
             field_with_index.current_input_index++;
           }
           else {
@@ -204,7 +458,8 @@ static void build_multi_function_procedure_for_fields(MFProcedure &procedure,
               const MFParamType param_type = multi_function.param_type(param_index);
               const MFParamType::InterfaceType interface_type = param_type.interface_type();
               if (interface_type == MFParamType::Input) {
-                const GField &input_field = operation_inputs[param_input_index];
+                const GFieldRef input_field = field_tree_info.optimization.get(
+                    operation_inputs[param_input_index]);
                 variables[param_index] = variable_by_field.lookup(input_field);
                 param_input_index++;
               }
@@ -275,11 +530,133 @@ static void build_multi_function_procedure_for_fields(MFProcedure &procedure,
   BLI_assert(procedure.validate());
 }
 
+/**
+ * Number of indices that are evaluated together when outputs are written to destinations that
+ * are not spans. The buffers for those outputs should stay in the CPU cache.
+ */
+static constexpr int64_t chunk_size_for_virtual_destinations = 4096;
+
+/**
+ * Evaluates the procedure for chunks of the mask in parallel. Outputs that have a destination
+ * which is not a span are computed into small buffers that are reused by every thread and copied
+ * to the destination right after each chunk, while the values are still in the cache. That
+ * avoids allocating and filling an array for the entire mask for them.
+ *
+ * Chunks that are not contiguous use compressed buffers for all parameters, so that the buffers
+ * never have to be larger than the chunk, no matter how far apart its indices are.
+ *
+ * \param output_spans: Buffers for the entire mask, for outputs that are not chunked.
+ * \param chunked_outputs: Destination for outputs that are computed in chunks, otherwise empty.
+ */
+static void evaluate_procedure_in_chunks(const MFProcedureExecutor &procedure_executor,
+                                         const IndexMask mask,
+                                         const Span<GVArray> inputs,
+                                         const Span<GMutableSpan> output_spans,
+                                         MutableSpan<GVMutableArray> chunked_outputs)
+{
+  /** Buffer for every parameter of the procedure, allocated when it is used for the first time. */
+  struct ChunkBuffers {
+    Vector<void *> buffers;
+    int64_t capacity = 0;
+
+    ~ChunkBuffers()
+    {
+      this->free();
+    }
+
+    void free()
+    {
+      for (void *&buffer : buffers) {
+        MEM_SAFE_FREE(buffer);
+      }
+    }
+
+    void ensure(const int64_t params_num, const int64_t size)
+    {
+      if (capacity < size) {
+        this->free();
+        capacity = size;
+      }
+      buffers.resize(params_num, nullptr);
+    }
+
+    void *get(const int param_index, const CPPType &type)
+    {
+      void *&buffer = buffers[param_index];
+      if (buffer == nullptr) {
+        buffer = MEM_mallocN_aligned(type.size() * capacity, type.alignment(), __func__);
+      }
+      return buffer;
+    }
+  };
+  threading::EnumerableThreadSpecific<ChunkBuffers> chunk_buffers_by_thread;
+
+  threading::parallel_for(
+      mask.index_range(), chunk_size_for_virtual_destinations, [&](const IndexRange range) {
+        const IndexMask chunk_mask = mask.slice(range);
+        const int64_t size = chunk_mask.size();
+        /* Contiguous chunks read the inputs and write the span outputs directly. */
+        const bool is_range = chunk_mask.is_range();
+        const IndexRange chunk_range = is_range ? chunk_mask.as_range() : IndexRange();
+
+        ChunkBuffers &chunk_buffers = chunk_buffers_by_thread.local();
+        chunk_buffers.ensure(inputs.size() + output_spans.size(), size);
+
+        MFParamsBuilder mf_params{procedure_executor, size};
+        MFContextBuilder mf_context;
+        for (const int i : inputs.index_range()) {
+          const GVArray &varray = inputs[i];
+          if (is_range) {
+            mf_params.add_readonly_single_input(varray.slice(chunk_range));
+            continue;
+          }
+          void *buffer = chunk_buffers.get(i, varray.type());
+          varray.materialize_compressed_to_uninitialized(chunk_mask, buffer);
+          mf_params.add_readonly_single_input(GSpan(varray.type(), buffer, size));
+        }
+        for (const int i : output_spans.index_range()) {
+          if (is_range && !chunked_outputs[i]) {
+            mf_params.add_uninitialized_single_output(output_spans[i].slice(chunk_range));
+            continue;
+          }
+          const CPPType &type = output_spans[i].type();
+          void *buffer = chunk_buffers.get(inputs.size() + i, type);
+          mf_params.add_uninitialized_single_output({type, buffer, size});
+        }
+
+        procedure_executor.call(IndexRange(size), mf_params, mf_context);
+
+        if (!is_range) {
+          for (const int i : inputs.index_range()) {
+            inputs[i].type().destruct_n(chunk_buffers.buffers[i], size);
+          }
+        }
+        for (const int i : output_spans.index_range()) {
+          if (is_range && !chunked_outputs[i]) {
+            continue;
+          }
+          const CPPType &type = output_spans[i].type();
+          void *buffer = chunk_buffers.buffers[inputs.size() + i];
+          GVMutableArray &dst_varray = chunked_outputs[i];
+          for (const int64_t j : IndexRange(size)) {
+            void *value = POINTER_OFFSET(buffer, type.size() * j);
+            if (dst_varray) {
+              dst_varray.set_by_relocate(chunk_mask[j], value);
+            }
+            else {
+              type.relocate_construct(value, output_spans[i][chunk_mask[j]]);
+            }
+          }
+        }
+      });
+}
+
 Vector<GVArray> evaluate_fields(ResourceScope &scope,
                                 Span<GFieldRef> fields_to_evaluate,
                                 IndexMask mask,
                                 const FieldContext &context,
-                                Span<GVMutableArray> dst_varrays)
+                                Span<GVMutableArray> dst_varrays,
+                                FieldOptimizationStats *r_optimization_stats)
 {
   Vector<GVArray> r_varrays(fields_to_evaluate.size());
   Array<bool> is_output_written_to_dst(fields_to_evaluate.size(), false);
@@ -306,8 +683,33 @@ Vector<GVArray> evaluate_fields(ResourceScope &scope,
     return varray;
   };
 
+  /* Replace parts of the field tree with equivalent fields that are cheaper to evaluate. */
+  FieldTreeOptimization optimization = optimize_field_tree(scope, fields_to_evaluate);
+  if (r_optimization_stats != nullptr) {
+    add_optimization_stats(optimization, *r_optimization_stats);
+  }
+  /* Remember the optimizations on the evaluated fields, so that callers which can't pass stats
+   * into the evaluation can retrieve them afterwards. They are only stored on the first field, so
+   * that fields evaluated together are not counted multiple times. */
+  if (!fields_to_evaluate.is_empty()) {
+    FieldOptimizationStats optimization_stats;
+    add_optimization_stats(optimization, optimization_stats);
+    const FieldNode &first_node = fields_to_evaluate.first().node();
+    for (const GFieldRef &field : fields_to_evaluate.drop_front(1)) {
+      if (&field.node() != &first_node) {
+        field.node().set_last_optimization_stats({});
+      }
+    }
+    first_node.set_last_optimization_stats(optimization_stats);
+  }
+  Vector<GFieldRef> optimized_fields;
+  for (const GFieldRef &field : fields_to_evaluate) {
+    optimized_fields.append(optimization.get(field));
+  }
+
   /* Traverse the field tree and prepare some data that is used in later steps. */
-  FieldTreeInfo field_tree_info = preprocess_field_tree(fields_to_evaluate);
+  FieldTreeInfo field_tree_info = preprocess_field_tree(optimized_fields,
+                                                        std::move(optimization));
 
   /* Get inputs that will be passed into the field when evaluated. */
   Vector<GVArray> field_context_inputs = get_field_context_inputs(
@@ -315,7 +717,7 @@ Vector<GVArray> evaluate_fields(ResourceScope &scope,
 
   /* Finish fields that don't need any processing directly. */
   for (const int out_index : fields_to_evaluate.index_range()) {
-    const GFieldRef &field = fields_to_evaluate[out_index];
+    const GFieldRef &field = optimized_fields[out_index];
     const FieldNode &field_node = field.node();
     switch (field_node.node_type()) {
       case FieldNodeType::Input: {
@@ -351,7 +753,7 @@ Vector<GVArray> evaluate_fields(ResourceScope &scope,
       /* Already done. */
       continue;
     }
-    GFieldRef field = fields_to_evaluate[i];
+    GFieldRef field = optimized_fields[i];
     if (varying_fields.contains(field)) {
       varying_fields_to_evaluate.append(field);
       varying_field_indices.append(i);
@@ -370,13 +772,10 @@ Vector<GVArray> evaluate_fields(ResourceScope &scope,
         procedure, scope, field_tree_info, varying_fields_to_evaluate);
     MFProcedureExecutor procedure_executor{procedure};
 
-    MFParamsBuilder mf_params{procedure_executor, &mask};
-    MFContextBuilder mf_context;
-
-    /* Provide inputs to the procedure executor. */
-    for (const GVArray &varray : field_context_inputs) {
-      mf_params.add_readonly_single_input(varray);
-    }
+    /* Output spans for the entire mask, or empty when the output is written to a destination that
+     * is not a span in chunks. */
+    Vector<GMutableSpan> output_spans;
+    Vector<GVMutableArray> chunked_outputs;
 
     for (const int i : varying_fields_to_evaluate.index_range()) {
       const GFieldRef &field = varying_fields_to_evaluate[i];
@@ -385,8 +784,16 @@ Vector<GVArray> evaluate_fields(ResourceScope &scope,
 
       /* Try to get an existing virtual array that the result should be written into. */
       GVMutableArray dst_varray = get_dst_varray(out_index);
+      if (dst_varray && !dst_varray.is_span()) {
+        /* Compute the result in chunks and write it into the destination directly. */
+        output_spans.append(GMutableSpan(type));
+        chunked_outputs.append(dst_varray);
+        r_varrays[out_index] = dst_varray;
+        is_output_written_to_dst[out_index] = true;
+        continue;
+      }
       void *buffer;
-      if (!dst_varray || !dst_varray.is_span()) {
+      if (!dst_varray) {
         /* Allocate a new buffer for the computed result. */
         buffer = scope.linear_allocator().allocate(type.size() * array_size, type.alignment());
 
@@ -405,13 +812,32 @@ Vector<GVArray> evaluate_fields(ResourceScope &scope,
         r_varrays[out_index] = dst_varray;
         is_output_written_to_dst[out_index] = true;
       }
+      output_spans.append({type, buffer, array_size});
+      chunked_outputs.append({});
+    }
 
-      /* Pass output buffer to the procedure executor. */
-      const GMutableSpan span{type, buffer, array_size};
-      mf_params.add_uninitialized_single_output(span);
+    const bool has_chunked_outputs = std::any_of(
+        chunked_outputs.begin(), chunked_outputs.end(), [](const GVMutableArray &varray) {
+          return bool(varray);
+        });
+    if (has_chunked_outputs) {
+      evaluate_procedure_in_chunks(
+          procedure_executor, mask, field_context_inputs, output_spans, chunked_outputs);
     }
+    else {
+      MFParamsBuilder mf_params{procedure_executor, &mask};
+      MFContextBuilder mf_context;
 
-    procedure_executor.call_auto(mask, mf_params, mf_context);
+      /* Provide inputs and output buffers to the procedure executor. */
+      for (const GVArray &varray : field_context_inputs) {
+        mf_params.add_readonly_single_input(varray);
+      }
+      for (const GMutableSpan &span : output_spans) {
+        mf_params.add_uninitialized_single_output(span);
+      }
+
+      procedure_executor.call_auto(mask, mf_params, mf_context);
+    }
   }
 
   /* Evaluate constant fields if necessary. */
@@ -570,6 +996,20 @@ bool IndexFieldInput::is_equal_to(const fn::FieldNode &other) const
 /* Avoid generating the destructor in every translation unit. */
 FieldNode::~FieldNode() = default;
 
+FieldOptimizationStats FieldNode::last_optimization_stats() const
+{
+  FieldOptimizationStats stats;
+  stats.deduplicated_operations = atomic_load_int32(&last_deduplicated_operations_);
+  stats.folded_operations = atomic_load_int32(&last_folded_operations_);
+  return stats;
+}
+
+void FieldNode::set_last_optimization_stats(const FieldOptimizationStats &stats) const
+{
+  atomic_store_int32(&last_deduplicated_operations_, stats.deduplicated_operations);
+  atomic_store_int32(&last_folded_operations_, stats.folded_operations);
+}
+
 /* --------------------------------------------------------------------
  * FieldOperation.
  */
@@ -751,11 +1191,13 @@ int FieldEvaluator::add(GField field)
 static IndexMask evaluate_selection(const Field<bool> &selection_field,
                                     const FieldContext &context,
                                     IndexMask full_mask,
-                                    ResourceScope &scope)
+                                    ResourceScope &scope,
+                                    FieldOptimizationStats *optimization_stats)
 {
   if (selection_field) {
     VArray<bool> selection =
-        evaluate_fields(scope, {selection_field}, full_mask, context)[0].typed<bool>();
+        evaluate_fields(scope, {selection_field}, full_mask, context, {}, optimization_stats)[0]
+            .typed<bool>();
     if (selection.is_single()) {
       if (selection.get_internal_single()) {
         return full_mask;
@@ -771,13 +1213,15 @@ void FieldEvaluator::evaluate()
 {
   BLI_assert_msg(!is_evaluated_, "Cannot evaluate fields twice.");
 
-  selection_mask_ = evaluate_selection(selection_field_, context_, mask_, scope_);
+  selection_mask_ = evaluate_selection(
+      selection_field_, context_, mask_, scope_, optimization_stats_);
 
   Array<GFieldRef> fields(fields_to_evaluate_.size());
   for (const int i : fields_to_evaluate_.index_range()) {
     fields[i] = fields_to_evaluate_[i];
   }
-  evaluated_varrays_ = evaluate_fields(scope_, fields, selection_mask_, context_, dst_varrays_);
+  evaluated_varrays_ = evaluate_fields(
+      scope_, fields, selection_mask_, context_, dst_varrays_, optimization_stats_);
   BLI_assert(fields_to_evaluate_.size() == evaluated_varrays_.size());
   for (const int i : fields_to_evaluate_.index_range()) {
     OutputPointerInfo &info = output_pointer_infos_[i];
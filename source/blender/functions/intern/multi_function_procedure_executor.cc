@@ -2,10 +2,16 @@
 
 #include "FN_multi_function_procedure_executor.hh"
 
+#include "BLI_array.hh"
+#include "BLI_map.hh"
 #include "BLI_stack.hh"
 
+#include <algorithm>
+
 namespace blender::fn {
 
+static std::unique_ptr<MFCompiledProcedure> try_compile_procedure(const MFProcedure &procedure);
+
 MFProcedureExecutor::MFProcedureExecutor(const MFProcedure &procedure) : procedure_(procedure)
 {
   MFSignatureBuilder signature("Procedure Executor");
@@ -16,6 +22,8 @@ MFProcedureExecutor::MFProcedureExecutor(const MFProcedure &procedure) : procedu
 
   signature_ = signature.build();
   this->set_signature(&signature_);
+
+  compiled_procedure_ = try_compile_procedure(procedure);
 }
 
 using IndicesSplitVectors = std::array<Vector<int64_t>, 2>;
@@ -1156,10 +1164,317 @@ class InstructionScheduler {
   }
 };
 
+/* -------------------------------------------------------------------- */
+/** \name Compiled Procedure
+ *
+ * Most procedures built for fields are a linear sequence of function calls on single values
+ * without any control flow. Those are "compiled" into a flat list of steps when the executor is
+ * created and executed with much less overhead than the general interpreter above: there is no
+ * scheduling and no per-variable state, every variable gets a chunk-sized buffer and the
+ * parameters of every step are built once per call, and all steps are executed for one chunk of
+ * indices before continuing with the next. That way intermediate values stay in the CPU cache
+ * instead of being materialized for the whole mask.
+ * \{ */
+
+struct MFCompiledProcedure {
+  struct Slot {
+    const CPPType *type;
+    /** Index of the procedure parameter that this slot corresponds to, or -1. */
+    int param_index = -1;
+    MFParamType::InterfaceType interface_type = MFParamType::Input;
+  };
+
+  struct Step {
+    /** The called function, or null if this step destructs a variable. */
+    const MultiFunction *fn = nullptr;
+    /** Slot index for every function parameter, -1 for ignored outputs. */
+    Vector<int> param_slots;
+    int destruct_slot = -1;
+  };
+
+  Vector<Slot> slots;
+  Vector<Step> steps;
+  /** Number of indices that are processed at once, chosen to keep all buffers in the cache. */
+  int64_t chunk_size;
+  /** All functions can be evaluated only once when all inputs are single values. */
+  bool can_evaluate_as_one = true;
+};
+
+static std::unique_ptr<MFCompiledProcedure> try_compile_procedure(const MFProcedure &procedure)
+{
+  auto compiled = std::make_unique<MFCompiledProcedure>();
+  Map<const MFVariable *, int> slot_by_variable;
+
+  for (const int param_index : procedure.params().index_range()) {
+    const ConstMFParameter &param = procedure.params()[param_index];
+    const MFDataType data_type = param.variable->data_type();
+    if (data_type.is_vector() || param.type == MFParamType::Mutable) {
+      return {};
+    }
+    if (!slot_by_variable.add(param.variable, compiled->slots.size())) {
+      /* The same variable is used for multiple parameters. */
+      return {};
+    }
+    compiled->slots.append({&data_type.single_type(), param_index, param.type});
+  }
+
+  auto get_slot = [&](const MFVariable &variable) {
+    return slot_by_variable.lookup_or_add_cb(&variable, [&]() {
+      compiled->slots.append({&variable.data_type().single_type()});
+      return int(compiled->slots.size() - 1);
+    });
+  };
+
+  const MFInstruction *instruction = procedure.entry();
+  while (instruction != nullptr) {
+    switch (instruction->type()) {
+      case MFInstructionType::Call: {
+        const MFCallInstruction &call = static_cast<const MFCallInstruction &>(*instruction);
+        const MultiFunction &fn = call.fn();
+        if (fn.depends_on_context()) {
+          compiled->can_evaluate_as_one = false;
+        }
+        MFCompiledProcedure::Step step;
+        step.fn = &fn;
+        for (const int param_index : fn.param_indices()) {
+          const MFParamType param_type = fn.param_type(param_index);
+          const MFVariable *variable = call.params()[param_index];
+          if (param_type.data_type().is_vector()) {
+            return {};
+          }
+          if (variable == nullptr) {
+            step.param_slots.append(-1);
+            continue;
+          }
+          const int slot_index = get_slot(*variable);
+          const MFCompiledProcedure::Slot &slot = compiled->slots[slot_index];
+          if (slot.param_index != -1 && slot.interface_type == MFParamType::Input &&
+              param_type.interface_type() != MFParamType::Input) {
+            /* Procedure inputs are read-only. */
+            return {};
+          }
+          step.param_slots.append(slot_index);
+        }
+        compiled->steps.append(std::move(step));
+        instruction = call.next();
+        break;
+      }
+      case MFInstructionType::Destruct: {
+        const MFDestructInstruction &destruct = static_cast<const MFDestructInstruction &>(
+            *instruction);
+        MFCompiledProcedure::Step step;
+        step.destruct_slot = get_slot(*destruct.variable());
+        compiled->steps.append(std::move(step));
+        instruction = destruct.next();
+        break;
+      }
+      case MFInstructionType::Dummy: {
+        instruction = static_cast<const MFDummyInstruction &>(*instruction).next();
+        break;
+      }
+      case MFInstructionType::Return: {
+        instruction = nullptr;
+        break;
+      }
+      case MFInstructionType::Branch: {
+        return {};
+      }
+    }
+  }
+
+  int64_t bytes_per_index = 0;
+  for (const MFCompiledProcedure::Slot &slot : compiled->slots) {
+    bytes_per_index += slot.type->size();
+  }
+  const int64_t cache_size = 64 * 1024;
+  compiled->chunk_size = std::clamp<int64_t>(cache_size / std::max<int64_t>(bytes_per_index, 1),
+                                             32,
+                                             4096);
+  return compiled;
+}
+
+/**
+ * Every slot uses the same buffer for all chunks, so the parameters of every step only have to be
+ * built once per call. Procedure inputs that are single values are passed to the functions
+ * directly and don't have a buffer.
+ */
+struct MFCompiledProcedureCall {
+  Array<void *> buffers;
+  Array<destruct_ptr<MFParamsBuilder>> step_params;
+};
+
+static void prepare_compiled_call(const MFCompiledProcedure &compiled,
+                                  const int64_t chunk_size,
+                                  MFParams &params,
+                                  LinearAllocator<> &allocator,
+                                  MFCompiledProcedureCall &call)
+{
+  call.buffers.reinitialize(compiled.slots.size());
+  Array<GVArray, 16> single_inputs(compiled.slots.size());
+  for (const int slot_index : compiled.slots.index_range()) {
+    const MFCompiledProcedure::Slot &slot = compiled.slots[slot_index];
+    call.buffers[slot_index] = nullptr;
+    if (slot.param_index != -1 && slot.interface_type == MFParamType::Input) {
+      const GVArray &varray = params.readonly_single_input(slot.param_index);
+      if (varray.is_single()) {
+        single_inputs[slot_index] = varray;
+        continue;
+      }
+    }
+    call.buffers[slot_index] = allocator.allocate(slot.type->size() * chunk_size,
+                                                  slot.type->alignment());
+  }
+
+  call.step_params.reinitialize(compiled.steps.size());
+  for (const int step_index : compiled.steps.index_range()) {
+    const MFCompiledProcedure::Step &step = compiled.steps[step_index];
+    if (step.fn == nullptr) {
+      continue;
+    }
+    const MultiFunction &fn = *step.fn;
+    destruct_ptr<MFParamsBuilder> fn_params = allocator.construct<MFParamsBuilder>(fn,
+                                                                                   chunk_size);
+    for (const int param_index : fn.param_indices()) {
+      const int slot_index = step.param_slots[param_index];
+      if (slot_index == -1) {
+        fn_params->add_ignored_single_output();
+        continue;
+      }
+      const MFCompiledProcedure::Slot &slot = compiled.slots[slot_index];
+      const GMutableSpan span{*slot.type, call.buffers[slot_index], chunk_size};
+      switch (fn.param_type(param_index).interface_type()) {
+        case MFParamType::Input: {
+          if (span.data() == nullptr) {
+            fn_params->add_readonly_single_input(single_inputs[slot_index]);
+          }
+          else {
+            fn_params->add_readonly_single_input(GSpan(span));
+          }
+          break;
+        }
+        case MFParamType::Mutable: {
+          fn_params->add_single_mutable(span);
+          break;
+        }
+        case MFParamType::Output: {
+          fn_params->add_uninitialized_single_output(span);
+          break;
+        }
+      }
+    }
+    call.step_params[step_index] = std::move(fn_params);
+  }
+}
+
+static void execute_compiled_chunk(const MFCompiledProcedure &compiled,
+                                   const MFCompiledProcedureCall &call,
+                                   const IndexMask chunk_mask,
+                                   MFParams &params,
+                                   const MFContext &context,
+                                   const bool evaluate_as_one)
+{
+  const int64_t size = evaluate_as_one ? 1 : chunk_mask.size();
+
+  for (const int slot_index : compiled.slots.index_range()) {
+    const MFCompiledProcedure::Slot &slot = compiled.slots[slot_index];
+    if (slot.param_index != -1 && slot.interface_type == MFParamType::Input &&
+        call.buffers[slot_index] != nullptr) {
+      const GVArray &varray = params.readonly_single_input(slot.param_index);
+      varray.materialize_compressed_to_uninitialized(chunk_mask, call.buffers[slot_index]);
+    }
+  }
+
+  for (const int step_index : compiled.steps.index_range()) {
+    const MFCompiledProcedure::Step &step = compiled.steps[step_index];
+    if (step.fn == nullptr) {
+      const MFCompiledProcedure::Slot &slot = compiled.slots[step.destruct_slot];
+      if (slot.interface_type != MFParamType::Input || slot.param_index == -1) {
+        slot.type->destruct_n(call.buffers[step.destruct_slot], size);
+      }
+      continue;
+    }
+    step.fn->call(IndexRange(size), *call.step_params[step_index], context);
+  }
+
+  /* Move the outputs to their destination and destruct the copied inputs. */
+  for (const int slot_index : compiled.slots.index_range()) {
+    const MFCompiledProcedure::Slot &slot = compiled.slots[slot_index];
+    void *buffer = call.buffers[slot_index];
+    if (slot.param_index == -1 || buffer == nullptr) {
+      continue;
+    }
+    const CPPType &type = *slot.type;
+    if (slot.interface_type == MFParamType::Input) {
+      type.destruct_n(buffer, size);
+      continue;
+    }
+    const GMutableSpan output = params.uninitialized_single_output_if_required(slot.param_index);
+    if (output.is_empty()) {
+      type.destruct_n(buffer, size);
+    }
+    else if (evaluate_as_one) {
+      type.fill_construct_indices(buffer, output.data(), chunk_mask);
+      type.destruct(buffer);
+    }
+    else if (chunk_mask.is_range()) {
+      type.relocate_construct_n(buffer, output[chunk_mask[0]], size);
+    }
+    else {
+      for (const int64_t i : chunk_mask.index_range()) {
+        type.relocate_construct(POINTER_OFFSET(buffer, type.size() * i),
+                                output[chunk_mask[i]]);
+      }
+    }
+  }
+}
+
+static void execute_compiled_procedure(const MFCompiledProcedure &compiled,
+                                       const IndexMask full_mask,
+                                       MFParams &params,
+                                       const MFContext &context)
+{
+  if (full_mask.is_empty()) {
+    return;
+  }
+  bool evaluate_as_one = compiled.can_evaluate_as_one;
+  for (const MFCompiledProcedure::Slot &slot : compiled.slots) {
+    if (slot.param_index != -1 && slot.interface_type == MFParamType::Input) {
+      if (!params.readonly_single_input(slot.param_index).is_single()) {
+        evaluate_as_one = false;
+        break;
+      }
+    }
+  }
+
+  const int64_t chunk_size = evaluate_as_one ? 1 :
+                                               std::min(compiled.chunk_size, full_mask.size());
+  LinearAllocator<> allocator;
+  MFCompiledProcedureCall call;
+  prepare_compiled_call(compiled, chunk_size, params, allocator, call);
+
+  if (evaluate_as_one) {
+    execute_compiled_chunk(compiled, call, full_mask, params, context, true);
+    return;
+  }
+  for (int64_t start = 0; start < full_mask.size(); start += chunk_size) {
+    const IndexRange chunk_range{start, std::min(chunk_size, full_mask.size() - start)};
+    execute_compiled_chunk(compiled, call, full_mask.slice(chunk_range), params, context, false);
+  }
+}
+
+/** \} */
+
+MFProcedureExecutor::~MFProcedureExecutor() = default;
+
 void MFProcedureExecutor::call(IndexMask full_mask, MFParams params, MFContext context) const
 {
   BLI_assert(procedure_.validate());
 
+  if (compiled_procedure_) {
+    execute_compiled_procedure(*compiled_procedure_, full_mask, params, context);
+    return;
+  }
+
   LinearAllocator<> linear_allocator;
 
   VariableStates variable_states{linear_allocator, full_mask};
@@ -1238,7 +1553,8 @@ void MFProcedureExecutor::call(IndexMask full_mask, MFParams params, MFContext c
 MultiFunction::ExecutionHints MFProcedureExecutor::get_execution_hints() const
 {
   ExecutionHints hints;
-  hints.allocates_array = true;
+  /* The compiled procedure only allocates buffers for a single chunk. */
+  hints.allocates_array = !compiled_procedure_;
   hints.min_grain_size = 10000;
   return hints;
 }
@@ -3,10 +3,14 @@
 #include "testing/testing.h"
 
 #include "BLI_cpp_type.hh"
+#include "BLI_timeit.hh"
+
 #include "FN_field.hh"
 #include "FN_multi_function_builder.hh"
 #include "FN_multi_function_test_common.hh"
 
+#define DO_PERF_TESTS 0
+
 namespace blender::fn::tests {
 
 TEST(field, ConstantFunction)
@@ -289,4 +293,263 @@ TEST(field, IgnoredOutput)
   EXPECT_EQ(results.get(3), 5);
 }
 
+TEST(field, DeduplicateOperations)
+{
+  int calls_num = 0;
+  const CustomMF_SI_SO<int, int> multiply_fn{"multiply", [&](int a) {
+                                               calls_num++;
+                                               return a * 2;
+                                             }};
+
+  /* Separate operation and constant nodes that compute the same values. */
+  GField index_field{std::make_shared<IndexFieldInput>()};
+  auto make_field = [&]() {
+    GField double_field{
+        std::make_shared<FieldOperation>(multiply_fn, Vector<GField>{index_field})};
+    std::unique_ptr<MultiFunction> add_fn = std::make_unique<CustomMF_SI_SI_SO<int, int, int>>(
+        "add", [](int a, int b) { return a + b; });
+    return GField{std::make_shared<FieldOperation>(
+        FieldOperation(std::move(add_fn), {double_field, make_constant_field<int>(5)}))};
+  };
+  GField field_1 = make_field();
+  GField field_2 = make_field();
+
+  Array<int> result_1(10);
+  Array<int> result_2(10);
+
+  FieldOptimizationStats stats;
+  FieldContext context;
+  FieldEvaluator evaluator{context, 10};
+  evaluator.set_optimization_stats(&stats);
+  evaluator.add_with_destination(field_1, result_1.as_mutable_span());
+  evaluator.add_with_destination(field_2, result_2.as_mutable_span());
+  evaluator.evaluate();
+  for (const int i : IndexRange(10)) {
+    EXPECT_EQ(result_1[i], i * 2 + 5);
+    EXPECT_EQ(result_2[i], i * 2 + 5);
+  }
+  EXPECT_EQ(calls_num, 10);
+  /* The add operations have different functions, so only the multiply operation is skipped. */
+  EXPECT_EQ(stats.deduplicated_operations, 1);
+  EXPECT_EQ(stats.folded_operations, 0);
+  /* Fields that are evaluated together only remember the stats once. */
+  EXPECT_EQ(field_1.node().last_optimization_stats().deduplicated_operations, 1);
+  EXPECT_EQ(field_2.node().last_optimization_stats().deduplicated_operations, 0);
+}
+
+TEST(field, FoldConstantOperations)
+{
+  int calls_num = 0;
+  std::unique_ptr<MultiFunction> add_fn = std::make_unique<CustomMF_SI_SI_SO<int, int, int>>(
+      "add", [&](int a, int b) {
+        calls_num++;
+        return a + b;
+      });
+  GField constant_field{std::make_shared<FieldOperation>(FieldOperation(
+      std::move(add_fn), {make_constant_field<int>(3), make_constant_field<int>(4)}))};
+
+  GField index_field{std::make_shared<IndexFieldInput>()};
+  std::unique_ptr<MultiFunction> multiply_fn = std::make_unique<CustomMF_SI_SI_SO<int, int, int>>(
+      "multiply", [](int a, int b) { return a * b; });
+  GField result_field{std::make_shared<FieldOperation>(
+      FieldOperation(std::move(multiply_fn), {index_field, constant_field}))};
+
+  Array<int> result(10);
+
+  FieldOptimizationStats stats;
+  FieldContext context;
+  FieldEvaluator evaluator{context, 10};
+  evaluator.set_optimization_stats(&stats);
+  evaluator.add_with_destination(result_field, result.as_mutable_span());
+  evaluator.evaluate();
+  for (const int i : IndexRange(10)) {
+    EXPECT_EQ(result[i], i * 7);
+  }
+  EXPECT_EQ(calls_num, 1);
+  EXPECT_EQ(stats.folded_operations, 1);
+  EXPECT_EQ(stats.eliminated_operations(), 1);
+
+  /* The stats are also remembered on the evaluated field. */
+  EXPECT_EQ(result_field.node().last_optimization_stats().folded_operations, 1);
+  EXPECT_EQ(constant_field.node().last_optimization_stats().eliminated_operations(), 0);
+}
+
+/** Adds the number of times it was called, like a function that uses data from the context. */
+class AddCallCountFunction : public MultiFunction {
+ private:
+  mutable int calls_num_ = 0;
+
+ public:
+  AddCallCountFunction()
+  {
+    static MFSignature signature = create_signature();
+    this->set_signature(&signature);
+  }
+
+  static MFSignature create_signature()
+  {
+    MFSignatureBuilder signature("Add Call Count");
+    signature.single_input<int>("Value");
+    signature.single_output<int>("Result");
+    signature.depends_on_context();
+    return signature.build();
+  }
+
+  void call(IndexMask mask, MFParams params, MFContext UNUSED(context)) const override
+  {
+    const VArray<int> &values = params.readonly_single_input<int>(0, "Value");
+    MutableSpan<int> result = params.uninitialized_single_output<int>(1, "Result");
+    calls_num_++;
+    for (const int64_t i : mask) {
+      result[i] = values[i] + calls_num_;
+    }
+  }
+};
+
+TEST(field, DontFoldContextDependentOperations)
+{
+  const AddCallCountFunction fn;
+  GField field{std::make_shared<FieldOperation>(fn, Vector<GField>{make_constant_field<int>(10)})};
+
+  FieldOptimizationStats stats;
+
+  /* The function is called again for every evaluation. */
+  FieldContext context;
+  Array<int> result(2);
+  for (const int expected : {11, 12}) {
+    FieldEvaluator evaluator{context, 2};
+    evaluator.set_optimization_stats(&stats);
+    evaluator.add_with_destination(field, result.as_mutable_span());
+    evaluator.evaluate();
+    EXPECT_EQ(result[0], expected);
+    EXPECT_EQ(result[1], expected);
+  }
+  EXPECT_EQ(stats.eliminated_operations(), 0);
+}
+
+struct IndexAndValue {
+  int index;
+  int value;
+};
+
+static int get_value(const IndexAndValue &item)
+{
+  return item.value;
+}
+
+static void set_value(IndexAndValue &item, int value)
+{
+  item.value = value;
+}
+
+static VMutableArray<int> values_varray(MutableSpan<IndexAndValue> items)
+{
+  return VMutableArray<int>::ForDerivedSpan<IndexAndValue, get_value, set_value>(items);
+}
+
+static GField create_index_times_two_plus_one_field()
+{
+  GField index_field{std::make_shared<IndexFieldInput>()};
+  std::unique_ptr<MultiFunction> double_fn = std::make_unique<CustomMF_SI_SO<int, int>>(
+      "double", [](int a) { return a * 2; });
+  GField double_field{std::make_shared<FieldOperation>(
+                          FieldOperation(std::move(double_fn), {index_field})),
+                      0};
+  std::unique_ptr<MultiFunction> add_one_fn = std::make_unique<CustomMF_SI_SO<int, int>>(
+      "add_one", [](int a) { return a + 1; });
+  return GField{std::make_shared<FieldOperation>(
+                    FieldOperation(std::move(add_one_fn), {double_field})),
+                0};
+}
+
+TEST(field, VirtualArrayDestination)
+{
+  /* Large enough to be evaluated in multiple chunks. */
+  const int size = 20000;
+  GField result_field = create_index_times_two_plus_one_field();
+  GField index_field{std::make_shared<IndexFieldInput>()};
+
+  Array<IndexAndValue> items(size, {-1, -1});
+  Array<int> indices(size, -1);
+
+  FieldContext context;
+  FieldEvaluator evaluator{context, size};
+  evaluator.add_with_destination(result_field, values_varray(items));
+  evaluator.add_with_destination(index_field, indices.as_mutable_span());
+  evaluator.evaluate();
+  for (const int i : IndexRange(size)) {
+    EXPECT_EQ(items[i].value, i * 2 + 1);
+    EXPECT_EQ(items[i].index, -1);
+    EXPECT_EQ(indices[i], i);
+  }
+
+  /* Only write the selected elements. */
+  Vector<int64_t> mask_indices;
+  for (const int i : IndexRange(size)) {
+    if (i % 3 == 0 || (i > 5000 && i < 9000)) {
+      mask_indices.append(i);
+    }
+  }
+  const IndexMask mask{mask_indices};
+  items.fill({-1, -1});
+
+  FieldEvaluator evaluator_2{context, &mask};
+  evaluator_2.add_with_destination(result_field, values_varray(items));
+  evaluator_2.evaluate();
+  for (const int i : IndexRange(size)) {
+    if (i % 3 == 0 || (i > 5000 && i < 9000)) {
+      EXPECT_EQ(items[i].value, i * 2 + 1);
+    }
+    else {
+      EXPECT_EQ(items[i].value, -1);
+    }
+  }
+}
+
+TEST(field, VirtualArrayDestinationSparseMask)
+{
+  /* Few selected indices that are far apart, so that chunks are not contiguous. */
+  const int size = 200000;
+  Vector<int64_t> mask_indices;
+  for (int i = 7; i < size; i += 997) {
+    mask_indices.append(i);
+  }
+  const IndexMask mask{mask_indices};
+  GField result_field = create_index_times_two_plus_one_field();
+  GField index_field{std::make_shared<IndexFieldInput>()};
+
+  Array<IndexAndValue> items(size, {-1, -1});
+  Array<int> indices(size, -1);
+
+  FieldContext context;
+  FieldEvaluator evaluator{context, &mask};
+  evaluator.add_with_destination(result_field, values_varray(items));
+  evaluator.add_with_destination(index_field, indices.as_mutable_span());
+  evaluator.evaluate();
+  for (const int i : IndexRange(size)) {
+    const bool selected = i % 997 == 7;
+    EXPECT_EQ(items[i].value, selected ? i * 2 + 1 : -1);
+    EXPECT_EQ(indices[i], selected ? i : -1);
+  }
+}
+
+#if DO_PERF_TESTS
+
+TEST(field, VirtualArrayDestinationPerformance)
+{
+  const int size = 10'000'000;
+  GField result_field = create_index_times_two_plus_one_field();
+  Array<IndexAndValue> items(size, {0, 0});
+
+  FieldContext context;
+  for (int i = 0; i < 5; i++) {
+    SCOPED_TIMER("evaluate into virtual array");
+    FieldEvaluator evaluator{context, size};
+    evaluator.add_with_destination(result_field, values_varray(items));
+    evaluator.evaluate();
+  }
+}
+
+#endif
+
 }  // namespace blender::fn::tests
@@ -408,4 +408,118 @@ TEST(multi_function_procedure, OutputBufferReplaced)
   EXPECT_EQ(output[2], output_value);
 }
 
+TEST(multi_function_procedure, ChunkedExecution)
+{
+  /**
+   * procedure(int a, int b, int *out1, int *out2) {
+   *   int c = a + b;
+   *   out1 = c + 10;
+   *   out2 = c + a;
+   * }
+   */
+
+  CustomMF_SI_SI_SO<int, int, int> add_fn{"add", [](int a, int b) { return a + b; }};
+  CustomMF_SI_SO<int, int> add_10_fn{"add_10", [](int a) { return a + 10; }};
+
+  MFProcedure procedure;
+  MFProcedureBuilder builder{procedure};
+
+  MFVariable *var_a = &builder.add_single_input_parameter<int>();
+  MFVariable *var_b = &builder.add_single_input_parameter<int>();
+  auto [var_c] = builder.add_call<1>(add_fn, {var_a, var_b});
+  auto [var_out1] = builder.add_call<1>(add_10_fn, {var_c});
+  auto [var_out2] = builder.add_call<1>(add_fn, {var_c, var_a});
+  builder.add_destruct({var_a, var_b, var_c});
+  builder.add_return();
+  builder.add_output_parameter(*var_out1);
+  builder.add_output_parameter(*var_out2);
+
+  EXPECT_TRUE(procedure.validate());
+
+  MFProcedureExecutor procedure_fn{procedure};
+
+  /* Use enough elements for multiple chunks, with a contiguous and a non-contiguous mask. */
+  const int size = 20000;
+  Array<int> inputs_a(size);
+  Array<int> inputs_b(size);
+  for (const int i : IndexRange(size)) {
+    inputs_a[i] = i;
+    inputs_b[i] = i * 3;
+  }
+  Vector<int64_t> sparse_indices;
+  for (int64_t i = 5; i < size; i += 3) {
+    sparse_indices.append(i);
+  }
+
+  for (const IndexMask mask : {IndexMask(size), IndexMask(sparse_indices)}) {
+    Array<int> results1(size, -1);
+    Array<int> results2(size, -1);
+
+    MFParamsBuilder params{procedure_fn, size};
+    params.add_readonly_single_input(inputs_a.as_span());
+    params.add_readonly_single_input(inputs_b.as_span());
+    params.add_uninitialized_single_output(results1.as_mutable_span());
+    params.add_uninitialized_single_output(results2.as_mutable_span());
+
+    MFContextBuilder context;
+    procedure_fn.call(mask, params, context);
+
+    int masked_num = 0;
+    for (const int i : IndexRange(size)) {
+      const bool in_mask = mask.is_range() || (i >= 5 && (i - 5) % 3 == 0);
+      masked_num += in_mask;
+      EXPECT_EQ(results1[i], in_mask ? i * 4 + 10 : -1);
+      EXPECT_EQ(results2[i], in_mask ? i * 5 : -1);
+    }
+    EXPECT_EQ(masked_num, mask.size());
+  }
+}
+
+TEST(multi_function_procedure, ChunkedExecutionIgnoredOutput)
+{
+  /**
+   * procedure(int a, int *out1, int *out2) {
+   *   out1 = a + 10;
+   *   out2 = out1 + 10;
+   * }
+   */
+
+  CustomMF_SI_SO<int, int> add_10_fn{"add_10", [](int a) { return a + 10; }};
+
+  MFProcedure procedure;
+  MFProcedureBuilder builder{procedure};
+
+  MFVariable *var_a = &builder.add_single_input_parameter<int>();
+  auto [var_out1] = builder.add_call<1>(add_10_fn, {var_a});
+  auto [var_out2] = builder.add_call<1>(add_10_fn, {var_out1});
+  builder.add_destruct(*var_a);
+  builder.add_return();
+  builder.add_output_parameter(*var_out1);
+  builder.add_output_parameter(*var_out2);
+
+  EXPECT_TRUE(procedure.validate());
+
+  MFProcedureExecutor procedure_fn{procedure};
+
+  const int size = 10000;
+  Array<int> inputs(size);
+  for (const int i : IndexRange(size)) {
+    inputs[i] = i;
+  }
+  Array<int> results(size, -1);
+
+  MFParamsBuilder params{procedure_fn, size};
+  params.add_readonly_single_input(inputs.as_span());
+  params.add_ignored_single_output();
+  params.add_uninitialized_single_output(results.as_mutable_span());
+
+  MFContextBuilder context;
+  procedure_fn.call(IndexRange(1, size - 1), params, context);
+
+  EXPECT_EQ(results[0], -1);
+  for (const int i : IndexRange(1, size - 1)) {
+    EXPECT_EQ(results[i], i + 20);
+  }
+}
+
 }  // namespace blender::fn::tests
@@ -0,0 +1,111 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#pragma once
+
+#include "BLI_float4x4.hh"
+#include "BLI_vector.hh"
+
+#include "BKE_bvhutils.h"
+#include "BKE_geometry_set.hh"
+
+/** \file
+ * \ingroup geo
+ */
+
+namespace blender::geometry {
+
+/**
+ * A two level acceleration structure for the meshes and point clouds in a geometry set,
+ * including all of its nested instances, which doesn't require realizing the instances.
+ *
+ * The bottom level has a BVH tree for every unique mesh or point cloud, shared by all of its
+ * instances. The top level is a BVH tree over the bounds of every instance. That way memory usage
+ * is proportional to the number of unique geometries rather than to the realized geometry.
+ */
+class InstancesBVH : NonCopyable, NonMovable {
+ public:
+  /** A mesh or point cloud that can be referenced by any number of instances. */
+  struct Source {
+    /** Keeps the referenced data alive. */
+    GeometrySet geometry_set;
+    const Mesh *mesh = nullptr;
+    const PointCloud *pointcloud = nullptr;
+    BVHTreeFromMesh mesh_bvh = {};
+    BVHTreeFromPointCloud pointcloud_bvh = {};
+  };
+
+  struct Instance {
+    int source;
+    float4x4 transform;
+    float4x4 transform_inverse;
+    /**
+     * An upper bound for how much the instance transform can scale distances from world space to
+     * local space, used to limit the search distance in the bottom level trees.
+     */
+    float local_scale_max;
+  };
+
+  struct RayHit {
+    /** Index of the hit instance, or -1 when nothing was hit. */
+    int instance = -1;
+    /** Index of the hit element in the source geometry of the instance. */
+    int index = -1;
+    float dist;
+    float3 co;
+    /** The hit position in the local space of the instance. */
+    float3 local_co;
+    float3 no;
+  };
+
+  struct Nearest {
+    /** Index of the nearest instance, or -1 when no element is closer than #dist_sq. */
+    int instance = -1;
+    /** Index of the nearest element in the source geometry of the instance. */
+    int index = -1;
+    float dist_sq = FLT_MAX;
+    float3 co;
+  };
+
+ private:
+  Vector<Source> sources_;
+  Vector<Instance> instances_;
+  BVHTree *tree_ = nullptr;
+
+ public:
+  /**
+   * \param mesh_tree_type: The elements of meshes to build bottom level trees for.
+   * \param use_pointclouds: Also add point clouds, treating their points as elements.
+   */
+  InstancesBVH(const GeometrySet &geometry_set, BVHCacheType mesh_tree_type, bool use_pointclouds);
+  ~InstancesBVH();
+
+  bool is_empty() const
+  {
+    return tree_ == nullptr;
+  }
+
+  Span<Source> sources() const
+  {
+    return sources_;
+  }
+
+  Span<Instance> instances() const
+  {
+    return instances_;
+  }
+
+  /**
+   * Find the first mesh element hit by the ray. Point clouds are ignored.
+   * \param direction: Must be normalized.
+   */
+  RayHit raycast(const float3 &origin, const float3 &direction, float length) const;
+
+  /**
+   * Find the nearest element to the position, if it is closer than the distance already stored in
+   * \a r_nearest. For instances with non-uniform scale the element is found in their local space,
+   * so it may not be the exact nearest element in world space.
+   */
+  void find_nearest(const float3 &position, Nearest &r_nearest) const;
+};
+
+}  // namespace blender::geometry
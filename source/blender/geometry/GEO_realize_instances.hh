@@ -19,6 +19,11 @@ struct RealizeInstancesOptions {
    * instances. Otherwise, instance attributes are ignored.
    */
   bool realize_instance_attributes = true;
+  /**
+   * Components of these types are skipped, they are not realized and are not part of the output.
+   * This avoids copying instanced data that is not used afterwards. Instances can't be ignored.
+   */
+  blender::Vector<GeometryComponentType> ignored_component_types;
 };
 
 /**
@@ -0,0 +1,307 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "BLI_map.hh"
+#include "BLI_math_vector.hh"
+
+#include "DNA_mesh_types.h"
+#include "DNA_pointcloud_types.h"
+
+#include "BKE_geometry_set_instances.hh"
+#include "BKE_mesh.h"
+#include "BKE_pointcloud.h"
+
+#include "GEO_instances_bvh.hh"
+
+namespace blender::geometry {
+
+static float local_scale_max_for_transform(const float4x4 &transform_inverse)
+{
+  /* The Frobenius norm is an upper bound for the largest singular value. */
+  float length_sq = 0.0f;
+  for (const int i : IndexRange(3)) {
+    for (const int j : IndexRange(3)) {
+      length_sq += transform_inverse.values[i][j] * transform_inverse.values[i][j];
+    }
+  }
+  return std::sqrt(length_sq);
+}
+
+InstancesBVH::InstancesBVH(const GeometrySet &geometry_set,
+                           const BVHCacheType mesh_tree_type,
+                           const bool use_pointclouds)
+{
+  Vector<bke::GeometryInstanceGroup> instance_groups;
+  bke::geometry_set_gather_instances(geometry_set, instance_groups);
+
+  /* Map from the mesh or point cloud to its source index, or -1 if it doesn't have a tree. */
+  Map<const void *, int> source_indices;
+  Vector<float3> bounds_min;
+  Vector<float3> bounds_max;
+
+  auto add_mesh_source = [&](const GeometrySet &group_geometry, const Mesh &mesh) {
+    Source source;
+    float3 min(FLT_MAX);
+    float3 max(-FLT_MAX);
+    if (!BKE_mesh_minmax(&mesh, min, max)) {
+      return -1;
+    }
+    const int tree_type = mesh_tree_type == BVHTREE_FROM_LOOPTRI ? 4 : 2;
+    BKE_bvhtree_from_mesh_get(&source.mesh_bvh, &mesh, mesh_tree_type, tree_type);
+    if (source.mesh_bvh.tree == nullptr) {
+      free_bvhtree_from_mesh(&source.mesh_bvh);
+      return -1;
+    }
+    source.geometry_set = group_geometry;
+    source.mesh = &mesh;
+    bounds_min.append(min);
+    bounds_max.append(max);
+    sources_.append(std::move(source));
+    return int(sources_.size() - 1);
+  };
+
+  auto add_pointcloud_source = [&](const GeometrySet &group_geometry,
+                                   const PointCloud &pointcloud) {
+    Source source;
+    float3 min(FLT_MAX);
+    float3 max(-FLT_MAX);
+    if (!BKE_pointcloud_minmax(&pointcloud, min, max)) {
+      return -1;
+    }
+    BKE_bvhtree_from_pointcloud_get(&source.pointcloud_bvh, &pointcloud, 2);
+    if (source.pointcloud_bvh.tree == nullptr) {
+      free_bvhtree_from_pointcloud(&source.pointcloud_bvh);
+      return -1;
+    }
+    source.geometry_set = group_geometry;
+    source.pointcloud = &pointcloud;
+    bounds_min.append(min);
+    bounds_max.append(max);
+    sources_.append(std::move(source));
+    return int(sources_.size() - 1);
+  };
+
+  auto add_instances = [&](const int source_index, const Span<float4x4> transforms) {
+    if (source_index == -1) {
+      return;
+    }
+    for (const float4x4 &transform : transforms) {
+      const float4x4 transform_inverse = transform.inverted();
+      instances_.append({source_index,
+                         transform,
+                         transform_inverse,
+                         local_scale_max_for_transform(transform_inverse)});
+    }
+  };
+
+  for (const bke::GeometryInstanceGroup &group : instance_groups) {
+    const GeometrySet &group_geometry = group.geometry_set;
+    if (const Mesh *mesh = group_geometry.get_mesh_for_read()) {
+      const int source_index = source_indices.lookup_or_add_cb(
+          mesh, [&]() { return add_mesh_source(group_geometry, *mesh); });
+      add_instances(source_index, group.transforms);
+    }
+    if (!use_pointclouds) {
+      continue;
+    }
+    if (const PointCloud *pointcloud = group_geometry.get_pointcloud_for_read()) {
+      const int source_index = source_indices.lookup_or_add_cb(
+          pointcloud, [&]() { return add_pointcloud_source(group_geometry, *pointcloud); });
+      add_instances(source_index, group.transforms);
+    }
+  }
+
+  if (instances_.is_empty()) {
+    return;
+  }
+
+  tree_ = BLI_bvhtree_new(instances_.size(), 0.0f, 4, 6);
+  for (const int i : instances_.index_range()) {
+    const Instance &instance = instances_[i];
+    const float3 &min = bounds_min[instance.source];
+    const float3 &max = bounds_max[instance.source];
+    float corners[8][3];
+    for (const int corner : IndexRange(8)) {
+      const float3 local_corner((corner & 1) ? max.x : min.x,
+                                (corner & 2) ? max.y : min.y,
+                                (corner & 4) ? max.z : min.z);
+      copy_v3_v3(corners[corner], instance.transform * local_corner);
+    }
+    BLI_bvhtree_insert(tree_, i, &corners[0][0], 8);
+  }
+  BLI_bvhtree_balance(tree_);
+}
+
+InstancesBVH::~InstancesBVH()
+{
+  if (tree_ != nullptr) {
+    BLI_bvhtree_free(tree_);
+  }
+  for (Source &source : sources_) {
+    if (source.mesh != nullptr) {
+      free_bvhtree_from_mesh(&source.mesh_bvh);
+    }
+    if (source.pointcloud != nullptr) {
+      free_bvhtree_from_pointcloud(&source.pointcloud_bvh);
+    }
+  }
+}
+
+namespace {
+struct RaycastData {
+  const InstancesBVH *bvh;
+  InstancesBVH::RayHit *result;
+};
+struct NearestData {
+  const InstancesBVH *bvh;
+  InstancesBVH::Nearest *result;
+};
+}  // namespace
+
+InstancesBVH::RayHit InstancesBVH::raycast(const float3 &origin,
+                                           const float3 &direction,
+                                           const float length) const
+{
+  RayHit result;
+  result.dist = length;
+  if (tree_ == nullptr) {
+    return result;
+  }
+
+  BVHTreeRayHit hit;
+  hit.index = -1;
+  hit.dist = length;
+
+  RaycastData data{this, &result};
+  BLI_bvhtree_ray_cast(
+      tree_,
+      origin,
+      direction,
+      0.0f,
+      &hit,
+      [](void *userdata, int index, const BVHTreeRay *ray, BVHTreeRayHit *hit) {
+        const RaycastData &data = *static_cast<RaycastData *>(userdata);
+        const Instance &instance = data.bvh->instances_[index];
+        const Source &source = data.bvh->sources_[instance.source];
+        if (source.mesh == nullptr) {
+          return;
+        }
+
+        const float3 local_origin = instance.transform_inverse * float3(ray->origin);
+        float3 local_direction = instance.transform_inverse.ref_3x3() * float3(ray->direction);
+        /* Distances along the ray are scaled by this factor in the local space. */
+        const float local_scale = math::length(local_direction);
+        if (local_scale == 0.0f) {
+          return;
+        }
+        local_direction /= local_scale;
+
+        BVHTreeRayHit local_hit;
+        local_hit.index = -1;
+        local_hit.dist = hit->dist * local_scale;
+        if (BLI_bvhtree_ray_cast(source.mesh_bvh.tree,
+                                 local_origin,
+                                 local_direction,
+                                 0.0f,
+                                 &local_hit,
+                                 source.mesh_bvh.raycast_callback,
+                                 const_cast<BVHTreeFromMesh *>(&source.mesh_bvh)) == -1) {
+          return;
+        }
+        const float dist = local_hit.dist / local_scale;
+        if (dist >= hit->dist) {
+          return;
+        }
+
+        const float3 normal = math::normalize(instance.transform_inverse.transposed().ref_3x3() *
+                                              float3(local_hit.no));
+        hit->index = index;
+        hit->dist = dist;
+        copy_v3_v3(hit->co, instance.transform * float3(local_hit.co));
+        copy_v3_v3(hit->no, normal);
+        data.result->index = local_hit.index;
+        data.result->local_co = local_hit.co;
+      },
+      &data);
+
+  if (hit.index != -1) {
+    result.instance = hit.index;
+    result.dist = hit.dist;
+    result.co = hit.co;
+    result.no = hit.no;
+  }
+  else {
+    result.index = -1;
+  }
+  return result;
+}
+
+void InstancesBVH::find_nearest(const float3 &position, Nearest &r_nearest) const
+{
+  if (tree_ == nullptr) {
+    return;
+  }
+
+  BVHTreeNearest nearest;
+  nearest.index = -1;
+  nearest.dist_sq = r_nearest.dist_sq;
+  copy_v3_v3(nearest.co, r_nearest.co);
+
+  NearestData data{this, &r_nearest};
+  BLI_bvhtree_find_nearest(
+      tree_,
+      position,
+      &nearest,
+      [](void *userdata, int index, const float co[3], BVHTreeNearest *nearest) {
+        const NearestData &data = *static_cast<NearestData *>(userdata);
+        const Instance &instance = data.bvh->instances_[index];
+        const Source &source = data.bvh->sources_[instance.source];
+        const float3 local_position = instance.transform_inverse * float3(co);
+
+        BVHTreeNearest local_nearest;
+        local_nearest.index = -1;
+        if (nearest->dist_sq == FLT_MAX) {
+          local_nearest.dist_sq = FLT_MAX;
+        }
+        else {
+          const float local_dist = std::sqrt(nearest->dist_sq) * instance.local_scale_max;
+          local_nearest.dist_sq = local_dist * local_dist;
+        }
+
+        if (source.mesh != nullptr) {
+          BLI_bvhtree_find_nearest(source.mesh_bvh.tree,
+                                   local_position,
+                                   &local_nearest,
+                                   source.mesh_bvh.nearest_callback,
+                                   const_cast<BVHTreeFromMesh *>(&source.mesh_bvh));
+        }
+        else {
+          BLI_bvhtree_find_nearest(source.pointcloud_bvh.tree,
+                                   local_position,
+                                   &local_nearest,
+                                   source.pointcloud_bvh.nearest_callback,
+                                   const_cast<BVHTreeFromPointCloud *>(&source.pointcloud_bvh));
+        }
+        if (local_nearest.index == -1) {
+          return;
+        }
+
+        const float3 world_co = instance.transform * float3(local_nearest.co);
+        const float dist_sq = math::distance_squared(world_co, float3(co));
+        if (dist_sq >= nearest->dist_sq) {
+          return;
+        }
+        nearest->index = index;
+        nearest->dist_sq = dist_sq;
+        copy_v3_v3(nearest->co, world_co);
+        data.result->index = local_nearest.index;
+      },
+      &data);
+
+  if (nearest.index != -1) {
+    r_nearest.instance = nearest.index;
+    r_nearest.dist_sq = nearest.dist_sq;
+    r_nearest.co = nearest.co;
+  }
+}
+
+}  // namespace blender::geometry
@@ -0,0 +1,234 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "testing/testing.h"
+
+#include "CLG_log.h"
+
+#include "BLI_float4x4.hh"
+#include "BLI_math_geom.h"
+#include "BLI_math_vector.hh"
+#include "BLI_rand.hh"
+
+#include "BKE_geometry_set.hh"
+#include "BKE_idtype.h"
+#include "BKE_mesh_runtime.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "GEO_instances_bvh.hh"
+#include "GEO_mesh_primitive_cuboid.hh"
+
+namespace blender::geometry::tests {
+
+class InstancesBVHTest : public testing::Test {
+ public:
+  static void SetUpTestSuite()
+  {
+    CLG_init();
+    BKE_idtype_init();
+  }
+  static void TearDownTestSuite()
+  {
+    CLG_exit();
+  }
+};
+
+/**
+ * Instances of a subdivided box with translation, rotation and uniform scale, far enough apart
+ * that their bounds don't overlap.
+ */
+static Vector<float4x4> instance_transforms()
+{
+  return {
+      float4x4::from_location({4.0f, -1.0f, 0.5f}),
+      float4x4::from_loc_eul_scale({-3.0f, 2.0f, 1.0f}, {0.3f, -0.8f, 1.2f}, float3(1.0f)),
+      float4x4::from_loc_eul_scale({0.5f, 5.0f, -3.0f}, {1.1f, 0.4f, -0.6f}, float3(2.5f)),
+      float4x4::from_loc_eul_scale({-1.0f, -4.0f, -2.0f}, float3(0.0f), float3(0.5f)),
+  };
+}
+
+static GeometrySet create_instanced_mesh(const Span<float4x4> transforms)
+{
+  Mesh *mesh = create_cuboid_mesh({1.0f, 2.0f, 0.5f}, 3, 4, 2);
+  GeometrySet geometry_set;
+  InstancesComponent &component = geometry_set.get_component_for_write<InstancesComponent>();
+  const int handle = component.add_reference(GeometrySet::create_with_mesh(mesh));
+  for (const float4x4 &transform : transforms) {
+    component.add_instance(handle, transform);
+  }
+  return geometry_set;
+}
+
+/** The triangles of every instance in world space, to compare against without any BVH tree. */
+struct WorldTriangles {
+  struct Triangle {
+    int instance;
+    int looptri;
+    float3 verts[3];
+  };
+  Vector<Triangle> triangles;
+
+  WorldTriangles(const Mesh &mesh, const Span<float4x4> transforms)
+  {
+    const Span<MLoopTri> looptris(BKE_mesh_runtime_looptri_ensure(&mesh),
+                                  BKE_mesh_runtime_looptri_len(&mesh));
+    for (const int instance : transforms.index_range()) {
+      for (const int looptri : looptris.index_range()) {
+        Triangle triangle;
+        triangle.instance = instance;
+        triangle.looptri = looptri;
+        for (const int i : IndexRange(3)) {
+          const float3 co = mesh.mvert[mesh.mloop[looptris[looptri].tri[i]].v].co;
+          triangle.verts[i] = transforms[instance] * co;
+        }
+        triangles.append(triangle);
+      }
+    }
+  }
+
+  const Triangle *raycast(const float3 &origin, const float3 &direction, float &r_dist) const
+  {
+    const Triangle *result = nullptr;
+    for (const Triangle &triangle : triangles) {
+      float dist;
+      if (isect_ray_tri_v3(origin,
+                           direction,
+                           triangle.verts[0],
+                           triangle.verts[1],
+                           triangle.verts[2],
+                           &dist,
+                           nullptr) &&
+          dist < r_dist) {
+        r_dist = dist;
+        result = &triangle;
+      }
+    }
+    return result;
+  }
+
+  const Triangle *find_nearest(const float3 &position, float &r_dist_sq, float3 &r_co) const
+  {
+    const Triangle *result = nullptr;
+    for (const Triangle &triangle : triangles) {
+      float3 co;
+      closest_on_tri_to_point_v3(
+          co, position, triangle.verts[0], triangle.verts[1], triangle.verts[2]);
+      const float dist_sq = math::distance_squared(co, position);
+      if (dist_sq < r_dist_sq) {
+        r_dist_sq = dist_sq;
+        r_co = co;
+        result = &triangle;
+      }
+    }
+    return result;
+  }
+};
+
+static float3 random_position(RandomNumberGenerator &rng, const float extent)
+{
+  return (float3(rng.get_float(), rng.get_float(), rng.get_float()) * 2.0f - float3(1.0f)) *
+         extent;
+}
+
+TEST_F(InstancesBVHTest, raycast)
+{
+  const Vector<float4x4> transforms = instance_transforms();
+  const GeometrySet geometry_set = create_instanced_mesh(transforms);
+  const InstancesBVH bvh(geometry_set, BVHTREE_FROM_LOOPTRI, false);
+  ASSERT_EQ(bvh.sources().size(), 1);
+  ASSERT_EQ(bvh.instances().size(), transforms.size());
+  const WorldTriangles world(*bvh.sources().first().mesh, transforms);
+
+  RandomNumberGenerator rng(23);
+  int hits_num = 0;
+  for ([[maybe_unused]] const int i : IndexRange(500)) {
+    /* Aim at points around the instances, so that most rays hit something. */
+    const float3 origin = random_position(rng, 10.0f);
+    const float3 target = transforms[rng.get_int32(transforms.size())].translation() +
+                          random_position(rng, 1.5f);
+    const float3 direction = math::normalize(target - origin);
+    const float length = rng.get_float() < 0.2f ? 5.0f : 100.0f;
+
+    float expected_dist = length;
+    const WorldTriangles::Triangle *expected = world.raycast(origin, direction, expected_dist);
+    const InstancesBVH::RayHit hit = bvh.raycast(origin, direction, length);
+    if (expected == nullptr) {
+      EXPECT_EQ(hit.instance, -1);
+      continue;
+    }
+    hits_num++;
+    ASSERT_EQ(hit.instance, expected->instance);
+    EXPECT_EQ(hit.index, expected->looptri);
+    EXPECT_NEAR(hit.dist, expected_dist, 1e-4f);
+    const float3 expected_co = origin + direction * expected_dist;
+    EXPECT_V3_NEAR(hit.co, expected_co, 1e-4f);
+    const float3 expected_local_co = transforms[hit.instance].inverted() * expected_co;
+    EXPECT_V3_NEAR(hit.local_co, expected_local_co, 1e-4f);
+
+    float3 expected_normal;
+    normal_tri_v3(expected_normal, UNPACK3(expected->verts));
+    EXPECT_V3_NEAR(hit.no, expected_normal, 1e-4f);
+  }
+  /* Make sure both hits and misses are tested. */
+  EXPECT_GT(hits_num, 50);
+  EXPECT_LT(hits_num, 450);
+}
+
+TEST_F(InstancesBVHTest, find_nearest)
+{
+  const Vector<float4x4> transforms = instance_transforms();
+  const GeometrySet geometry_set = create_instanced_mesh(transforms);
+  const InstancesBVH bvh(geometry_set, BVHTREE_FROM_LOOPTRI, false);
+  const WorldTriangles world(*bvh.sources().first().mesh, transforms);
+
+  RandomNumberGenerator rng(5);
+  for ([[maybe_unused]] const int i : IndexRange(500)) {
+    const float3 position = random_position(rng, 8.0f);
+
+    float expected_dist_sq = FLT_MAX;
+    float3 expected_co;
+    const WorldTriangles::Triangle *expected = world.find_nearest(
+        position, expected_dist_sq, expected_co);
+    ASSERT_NE(expected, nullptr);
+
+    InstancesBVH::Nearest nearest;
+    bvh.find_nearest(position, nearest);
+    ASSERT_EQ(nearest.instance, expected->instance);
+    /* The nearest point can be on an edge shared by multiple triangles, so the element index is
+     * only compared through the position. */
+    EXPECT_NEAR(nearest.dist_sq, expected_dist_sq, 1e-4f * std::max(expected_dist_sq, 1.0f));
+    EXPECT_V3_NEAR(nearest.co, expected_co, 1e-4f);
+  }
+}
+
+TEST_F(InstancesBVHTest, find_nearest_limited_distance)
+{
+  const Vector<float4x4> transforms = instance_transforms();
+  const GeometrySet geometry_set = create_instanced_mesh(transforms);
+  const InstancesBVH bvh(geometry_set, BVHTREE_FROM_LOOPTRI, false);
+  const WorldTriangles world(*bvh.sources().first().mesh, transforms);
+
+  RandomNumberGenerator rng(8);
+  for ([[maybe_unused]] const int i : IndexRange(200)) {
+    const float3 position = random_position(rng, 8.0f);
+
+    float expected_dist_sq = FLT_MAX;
+    float3 expected_co;
+    world.find_nearest(position, expected_dist_sq, expected_co);
+
+    /* Nothing is found when the nearest element is further away than the initial distance. */
+    InstancesBVH::Nearest nearest;
+    nearest.dist_sq = expected_dist_sq * 0.9f;
+    bvh.find_nearest(position, nearest);
+    EXPECT_EQ(nearest.instance, -1);
+    EXPECT_EQ(nearest.dist_sq, expected_dist_sq * 0.9f);
+
+    nearest.dist_sq = expected_dist_sq * 1.1f + 1e-4f;
+    bvh.find_nearest(position, nearest);
+    EXPECT_NE(nearest.instance, -1);
+    EXPECT_V3_NEAR(nearest.co, expected_co, 1e-4f);
+  }
+}
+
+}  // namespace blender::geometry::tests
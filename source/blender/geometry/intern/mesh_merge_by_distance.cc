@@ -1215,15 +1215,47 @@ static void weld_mesh_context_create(const Mesh &mesh,
 /** \name CustomData
  * \{ */
 
-static void customdata_weld(
-    const CustomData *source, CustomData *dest, const int *src_indices, int count, int dest_index)
+/**
+ * Groups of elements welded into a single one, collected while building the result so that the
+ * layers with interpolation callbacks can be interpolated at once with #CustomData_interp_batch.
+ */
+struct WeldInterpBatch {
+  Vector<int> src_offsets = {0};
+  Vector<int> src_indices;
+  Vector<int> dest_indices;
+
+  void add(const int *group, const int count, const int dest_index)
+  {
+    src_indices.extend(Span<int>(group, count));
+    src_offsets.append(src_indices.size());
+    dest_indices.append(dest_index);
+  }
+
+  void interp(const CustomData *source, CustomData *dest) const
+  {
+    CustomData_interp_batch(source,
+                            dest,
+                            src_offsets.data(),
+                            src_indices.data(),
+                            nullptr,
+                            dest_indices.data(),
+                            dest_indices.size());
+  }
+};
+
+static void customdata_weld(const CustomData *source,
+                            CustomData *dest,
+                            const int *src_indices,
+                            int count,
+                            int dest_index,
+                            WeldInterpBatch &interp_batch)
 {
   if (count == 1) {
     CustomData_copy_data(source, dest, src_indices[0], dest_index, 1);
     return;
   }
 
-  CustomData_interp(source, dest, (const int *)src_indices, nullptr, nullptr, count, dest_index);
+  interp_batch.add(src_indices, count, dest_index);
 
   int src_i, dest_i;
   int j;
@@ -1280,8 +1312,7 @@ static void customdata_weld(
         }
       }
       else if (CustomData_layer_has_interp(dest, dest_i)) {
-        /* Already calculated.
-         * TODO: Optimize by exposing `typeInfo->interp`. */
+        /* Interpolated by the caller, see #WeldInterpBatch. */
       }
       else if (CustomData_layer_has_math(dest, dest_i)) {
         const int size = CustomData_sizeof(type);
@@ -1339,7 +1370,7 @@ static void customdata_weld(
       me->flag = flag;
     }
     else if (CustomData_layer_has_interp(dest, dest_i)) {
-      /* Already calculated. */
+      /* Interpolated by the caller. */
     }
     else if (CustomData_layer_has_math(dest, dest_i)) {
       const int size = CustomData_sizeof(type);
@@ -1384,6 +1415,7 @@ static Mesh *create_merged_mesh(const Mesh &mesh,
    * #vert_dest_map. This map will be used to adjust the edges, polys and loops. */
   MutableSpan<int> vert_final = vert_dest_map;
 
+  WeldInterpBatch vert_interp_batch;
   int dest_index = 0;
   for (int i = 0; i < totvert; i++) {
     int source_index = i;
@@ -1406,13 +1438,15 @@ static Mesh *create_merged_mesh(const Mesh &mesh,
                       &result->vdata,
                       &weld_mesh.vert_groups_buffer[wgroup->ofs],
                       wgroup->len,
-                      dest_index);
+                      dest_index,
+                      vert_interp_batch);
       vert_final[i] = dest_index;
       dest_index++;
     }
   }
 
   BLI_assert(dest_index == result_nverts);
+  vert_interp_batch.interp(&mesh.vdata, &result->vdata);
 
   /* Edges. */
 
@@ -1420,6 +1454,7 @@ static Mesh *create_merged_mesh(const Mesh &mesh,
    * #edge_groups_map. This map will be used to adjust the polys and loops. */
   MutableSpan<int> edge_final = weld_mesh.edge_groups_map;
 
+  WeldInterpBatch edge_interp_batch;
   dest_index = 0;
   for (int i = 0; i < totedge; i++) {
     const int source_index = i;
@@ -1447,7 +1482,8 @@ static Mesh *create_merged_mesh(const Mesh &mesh,
                       &result->edata,
                       &weld_mesh.edge_groups_buffer[wegrp->group.ofs],
                       wegrp->group.len,
-                      dest_index);
+                      dest_index,
+                      edge_interp_batch);
       MEdge *me = &result->medge[dest_index];
       me->v1 = vert_final[wegrp->v1];
       me->v2 = vert_final[wegrp->v2];
@@ -1461,6 +1497,7 @@ static Mesh *create_merged_mesh(const Mesh &mesh,
   }
 
   BLI_assert(dest_index == result_nedges);
+  edge_interp_batch.interp(&mesh.edata, &result->edata);
 
   /* Polys/Loops. */
 
@@ -1469,6 +1506,7 @@ static Mesh *create_merged_mesh(const Mesh &mesh,
   int r_i = 0;
   int loop_cur = 0;
   Array<int, 64> group_buffer(weld_mesh.max_poly_len);
+  WeldInterpBatch loop_interp_batch;
   for (const int i : mpoly.index_range()) {
     const MPoly &mp = mpoly[i];
     const int loop_start = loop_cur;
@@ -1494,8 +1532,12 @@ static Mesh *create_merged_mesh(const Mesh &mesh,
         continue;
       }
       while (weld_iter_loop_of_poly_next(iter)) {
-        customdata_weld(
-            &mesh.ldata, &result->ldata, group_buffer.data(), iter.group_len, loop_cur);
+        customdata_weld(&mesh.ldata,
+                        &result->ldata,
+                        group_buffer.data(),
+                        iter.group_len,
+                        loop_cur,
+                        loop_interp_batch);
         int v = vert_final[iter.v];
         int e = edge_final[iter.e];
         r_ml->v = v;
@@ -1530,7 +1572,12 @@ static Mesh *create_merged_mesh(const Mesh &mesh,
       continue;
     }
     while (weld_iter_loop_of_poly_next(iter)) {
-      customdata_weld(&mesh.ldata, &result->ldata, group_buffer.data(), iter.group_len, loop_cur);
+      customdata_weld(&mesh.ldata,
+                      &result->ldata,
+                      group_buffer.data(),
+                      iter.group_len,
+                      loop_cur,
+                      loop_interp_batch);
       int v = vert_final[iter.v];
       int e = edge_final[iter.e];
       r_ml->v = v;
@@ -1551,6 +1598,7 @@ static Mesh *create_merged_mesh(const Mesh &mesh,
 
   BLI_assert((int)r_i == result_npolys);
   BLI_assert(loop_cur == result_nloops);
+  loop_interp_batch.interp(&mesh.ldata, &result->ldata);
 
   return result;
 }
@@ -198,11 +198,104 @@ struct GatherTasks {
   UserCounter<VolumeComponent> first_volume;
 };
 
-/** Current offsets while during the gather operation. */
+/**
+ * Current offsets while during the gather operation. Also used to store the number of elements
+ * that are created for some geometry, including all nested instances.
+ */
 struct GatherOffsets {
   int pointcloud_offset = 0;
   MeshElementStartIndices mesh_offsets;
   CurvesElementStartIndices curves_offsets;
+
+  GatherOffsets &operator+=(const GatherOffsets &other)
+  {
+    pointcloud_offset += other.pointcloud_offset;
+    mesh_offsets.vertex += other.mesh_offsets.vertex;
+    mesh_offsets.edge += other.mesh_offsets.edge;
+    mesh_offsets.poly += other.mesh_offsets.poly;
+    mesh_offsets.loop += other.mesh_offsets.loop;
+    curves_offsets.point += other.curves_offsets.point;
+    curves_offsets.curve += other.curves_offsets.curve;
+    return *this;
+  }
+};
+
+/**
+ * Instances are gathered in chunks of this size in parallel. The tasks of every chunk are
+ * executed as soon as the chunk is gathered, so this also limits how many tasks exist at once.
+ */
+static constexpr int instances_chunk_size = 256;
+
+/** Number of elements that the instances in an instances component are realized to. */
+struct InstancesSizes {
+  /** Sizes of the geometry of every instance reference. */
+  Array<GatherOffsets> reference_sizes;
+  /**
+   * Offsets of every chunk of #instances_chunk_size instances, relative to the start of the
+   * component. The last element contains the sizes for all instances.
+   */
+  Array<GatherOffsets> chunk_offsets;
+
+  const GatherOffsets &total() const
+  {
+    return this->chunk_offsets.last();
+  }
+};
+
+/**
+ * Sizes of all instances components that are realized. They are computed in a separate pass
+ * before any task is gathered, so that the output geometry can be allocated in advance and
+ * instances can be gathered in parallel.
+ */
+struct AllInstancesSizes {
+  Map<const InstancesComponent *, std::unique_ptr<InstancesSizes>> sizes;
+  /**
+   * Some instance references create a new geometry set whenever they are accessed, e.g. empties
+   * that instance a collection. Those are kept alive, so that the address of a component is not
+   * reused for another component while the sizes are used. Components that are created again
+   * later just don't have known sizes.
+   */
+  Vector<GeometrySet> geometry_sets;
+};
+
+/** Output point cloud that the realize tasks write into. */
+struct PointCloudOutput {
+  PointCloud *pointcloud = nullptr;
+  Vector<OutputAttribute> attributes;
+  Vector<GMutableSpan> attribute_spans;
+  OutputAttribute_Typed<int> ids;
+  MutableSpan<int> ids_span;
+};
+
+/** Output mesh that the realize tasks write into. */
+struct MeshOutput {
+  Mesh *mesh = nullptr;
+  Vector<OutputAttribute> attributes;
+  Vector<GMutableSpan> attribute_spans;
+  OutputAttribute_Typed<int> vertex_ids;
+  MutableSpan<int> vertex_ids_span;
+};
+
+/** Output curves that the realize tasks write into. */
+struct CurvesOutput {
+  bke::CurvesGeometry *curves = nullptr;
+  Vector<OutputAttribute> attributes;
+  Vector<GMutableSpan> attribute_spans;
+  OutputAttribute_Typed<int> point_ids;
+  MutableSpan<int> point_ids_span;
+  OutputAttribute_Typed<float3> handle_left;
+  OutputAttribute_Typed<float3> handle_right;
+  MutableSpan<float3> handle_left_span;
+  MutableSpan<float3> handle_right_span;
+  OutputAttribute_Typed<float> radius;
+  MutableSpan<float> radius_span;
+};
+
+/** The realized geometry. It is allocated before the tasks are gathered. */
+struct RealizeOutputs {
+  PointCloudOutput pointcloud;
+  MeshOutput mesh;
+  CurvesOutput curves;
 };
 
 struct GatherTasksInfo {
@@ -212,15 +305,20 @@ struct GatherTasksInfo {
   const AllCurvesInfo &curves;
   bool create_id_attribute_on_any_component = false;
 
+  const RealizeInstancesOptions &options;
+  const AllInstancesSizes &instances_sizes;
+  RealizeOutputs &outputs;
+
   /**
    * Under some circumstances, temporary arrays need to be allocated during the gather operation.
    * For example, when an instance attribute has to be realized as a different data type. This
-   * array owns all the temporary arrays so that they can live until all processing is done.
-   * Use #std::unique_ptr to avoid depending on whether #GArray has an inline buffer or not.
+   * array owns all the temporary arrays so that they can live until the gathered tasks are
+   * executed. Use #std::unique_ptr to avoid depending on whether #GArray has an inline buffer or
+   * not.
    */
   Vector<std::unique_ptr<GArray<>>> &r_temporary_arrays;
 
-  /** All gathered tasks. */
+  /** Gathered tasks that have not been executed yet. */
   GatherTasks r_tasks;
   /** Current offsets while gathering tasks. */
   GatherOffsets r_offsets;
@@ -333,15 +431,22 @@ static void create_result_ids(const RealizeInstancesOptions &options,
   }
 }
 
+static bool component_type_is_ignored(const RealizeInstancesOptions &options,
+                                      const GeometryComponentType type)
+{
+  return options.ignored_component_types.contains(type);
+}
+
 /* -------------------------------------------------------------------- */
 /** \name Gather Realize Tasks
  * \{ */
 
-/* Forward declaration. */
+/* Forward declarations. */
 static void gather_realize_tasks_recursive(GatherTasksInfo &gather_info,
                                            const GeometrySet &geometry_set,
                                            const float4x4 &base_transform,
                                            const InstanceContext &base_instance_context);
+static void execute_realize_tasks(GatherTasksInfo &gather_info);
 
 /**
  * Checks which of the #ordered_attributes exist on the #instances_component. For each attribute
@@ -436,7 +541,7 @@ static void gather_realize_tasks_for_instances(GatherTasksInfo &gather_info,
 {
   const Span<InstanceReference> references = instances_component.references();
   const Span<int> handles = instances_component.instance_reference_handles();
-  const Span<float4x4> transforms = instances_component.instance_transforms();
+  const VArray<float4x4> transforms = instances_component.instance_transforms();
 
   Span<int> stored_instance_ids;
   if (gather_info.create_id_attribute_on_any_component) {
@@ -447,7 +552,6 @@ static void gather_realize_tasks_for_instances(GatherTasksInfo &gather_info,
   }
 
   /* Prepare attribute fallbacks. */
-  InstanceContext instance_context = base_instance_context;
   Vector<std::pair<int, GSpan>> pointcloud_attributes_to_override = prepare_attribute_fallbacks(
       gather_info, instances_component, gather_info.pointclouds.attributes);
   Vector<std::pair<int, GSpan>> mesh_attributes_to_override = prepare_attribute_fallbacks(
@@ -455,47 +559,95 @@ static void gather_realize_tasks_for_instances(GatherTasksInfo &gather_info,
   Vector<std::pair<int, GSpan>> curve_attributes_to_override = prepare_attribute_fallbacks(
       gather_info, instances_component, gather_info.curves.attributes);
 
-  for (const int i : transforms.index_range()) {
-    const int handle = handles[i];
-    const float4x4 &transform = transforms[i];
-    const InstanceReference &reference = references[handle];
-    const float4x4 new_base_transform = base_transform * transform;
+  auto gather_instances = [&](GatherTasksInfo &local_gather_info,
+                              const IndexRange instances_range) {
+    InstanceContext instance_context = base_instance_context;
+    for (const int i : instances_range) {
+      const int handle = handles[i];
+      const float4x4 transform = transforms[i];
+      const InstanceReference &reference = references[handle];
+      const float4x4 new_base_transform = base_transform * transform;
+
+      /* Update attribute fallbacks for the current instance. */
+      for (const std::pair<int, GSpan> &pair : pointcloud_attributes_to_override) {
+        instance_context.pointclouds.array[pair.first] = pair.second[i];
+      }
+      for (const std::pair<int, GSpan> &pair : mesh_attributes_to_override) {
+        instance_context.meshes.array[pair.first] = pair.second[i];
+      }
+      for (const std::pair<int, GSpan> &pair : curve_attributes_to_override) {
+        instance_context.curves.array[pair.first] = pair.second[i];
+      }
 
-    /* Update attribute fallbacks for the current instance. */
-    for (const std::pair<int, GSpan> &pair : pointcloud_attributes_to_override) {
-      instance_context.pointclouds.array[pair.first] = pair.second[i];
-    }
-    for (const std::pair<int, GSpan> &pair : mesh_attributes_to_override) {
-      instance_context.meshes.array[pair.first] = pair.second[i];
+      uint32_t local_instance_id = 0;
+      if (gather_info.create_id_attribute_on_any_component) {
+        if (stored_instance_ids.is_empty()) {
+          local_instance_id = (uint32_t)i;
+        }
+        else {
+          local_instance_id = (uint32_t)stored_instance_ids[i];
+        }
+      }
+      const uint32_t instance_id = noise::hash(base_instance_context.id, local_instance_id);
+
+      /* Add realize tasks for all referenced geometry sets recursively. */
+      foreach_geometry_in_reference(reference,
+                                    new_base_transform,
+                                    instance_id,
+                                    [&](const GeometrySet &instance_geometry_set,
+                                        const float4x4 &transform,
+                                        const uint32_t id) {
+                                      instance_context.id = id;
+                                      gather_realize_tasks_recursive(local_gather_info,
+                                                                     instance_geometry_set,
+                                                                     transform,
+                                                                     instance_context);
+                                    });
     }
-    for (const std::pair<int, GSpan> &pair : curve_attributes_to_override) {
-      instance_context.curves.array[pair.first] = pair.second[i];
+  };
+
+  const std::unique_ptr<InstancesSizes> *sizes_ptr = gather_info.instances_sizes.sizes.lookup_ptr(
+      &instances_component);
+  const int chunks_num = sizes_ptr ? (*sizes_ptr)->chunk_offsets.size() - 1 : 0;
+  if (chunks_num <= 1) {
+    gather_instances(gather_info, transforms.index_range());
+    return;
+  }
+  const InstancesSizes &sizes = **sizes_ptr;
+
+  /* The start offsets of every chunk are known in advance, so chunks can be gathered in parallel
+   * and their tasks can be executed directly. */
+  Array<UserCounter<VolumeComponent>> first_volume_by_chunk(chunks_num);
+  threading::parallel_for(IndexRange(chunks_num), 1, [&](const IndexRange chunk_range) {
+    for (const int chunk_index : chunk_range) {
+      const int chunk_start = chunk_index * instances_chunk_size;
+      const IndexRange instances_range(
+          chunk_start, std::min<int>(instances_chunk_size, transforms.size() - chunk_start));
+      Vector<std::unique_ptr<GArray<>>> chunk_temporary_arrays;
+      GatherTasksInfo chunk_gather_info = {gather_info.pointclouds,
+                                           gather_info.meshes,
+                                           gather_info.curves,
+                                           gather_info.create_id_attribute_on_any_component,
+                                           gather_info.options,
+                                           gather_info.instances_sizes,
+                                           gather_info.outputs,
+                                           chunk_temporary_arrays};
+      chunk_gather_info.r_offsets = gather_info.r_offsets;
+      chunk_gather_info.r_offsets += sizes.chunk_offsets[chunk_index];
+      gather_instances(chunk_gather_info, instances_range);
+      execute_realize_tasks(chunk_gather_info);
+      first_volume_by_chunk[chunk_index] = std::move(chunk_gather_info.r_tasks.first_volume);
     }
+  });
 
-    uint32_t local_instance_id = 0;
-    if (gather_info.create_id_attribute_on_any_component) {
-      if (stored_instance_ids.is_empty()) {
-        local_instance_id = (uint32_t)i;
-      }
-      else {
-        local_instance_id = (uint32_t)stored_instance_ids[i];
+  gather_info.r_offsets += sizes.total();
+  if (!gather_info.r_tasks.first_volume) {
+    for (UserCounter<VolumeComponent> &first_volume : first_volume_by_chunk) {
+      if (first_volume) {
+        gather_info.r_tasks.first_volume = std::move(first_volume);
+        break;
       }
     }
-    const uint32_t instance_id = noise::hash(base_instance_context.id, local_instance_id);
-
-    /* Add realize tasks for all referenced geometry sets recursively. */
-    foreach_geometry_in_reference(reference,
-                                  new_base_transform,
-                                  instance_id,
-                                  [&](const GeometrySet &instance_geometry_set,
-                                      const float4x4 &transform,
-                                      const uint32_t id) {
-                                    instance_context.id = id;
-                                    gather_realize_tasks_recursive(gather_info,
-                                                                   instance_geometry_set,
-                                                                   transform,
-                                                                   instance_context);
-                                  });
   }
 }
 
@@ -509,6 +661,9 @@ static void gather_realize_tasks_recursive(GatherTasksInfo &gather_info,
 {
   for (const GeometryComponent *component : geometry_set.get_components_for_read()) {
     const GeometryComponentType type = component->type();
+    if (component_type_is_ignored(gather_info.options, type)) {
+      continue;
+    }
     switch (type) {
       case GEO_COMPONENT_TYPE_MESH: {
         const MeshComponent &mesh_component = *static_cast<const MeshComponent *>(component);
@@ -582,6 +737,179 @@ static void gather_realize_tasks_recursive(GatherTasksInfo &gather_info,
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Count Realized Elements
+ * \{ */
+
+static const InstancesSizes &count_realized_instances(
+    const InstancesComponent &instances_component,
+    const RealizeInstancesOptions &options,
+    AllInstancesSizes &r_instances_sizes);
+
+/**
+ * Compute how many elements are created when the #geometry_set is realized. The sizes of all
+ * nested instances components are stored in #r_instances_sizes.
+ */
+static GatherOffsets count_realized_elements(const GeometrySet &geometry_set,
+                                             const RealizeInstancesOptions &options,
+                                             AllInstancesSizes &r_instances_sizes)
+{
+  GatherOffsets sizes;
+  for (const GeometryComponent *component : geometry_set.get_components_for_read()) {
+    if (component_type_is_ignored(options, component->type())) {
+      continue;
+    }
+    switch (component->type()) {
+      case GEO_COMPONENT_TYPE_MESH: {
+        const Mesh *mesh = static_cast<const MeshComponent *>(component)->get_for_read();
+        if (mesh != nullptr && mesh->totvert > 0) {
+          sizes.mesh_offsets.vertex += mesh->totvert;
+          sizes.mesh_offsets.edge += mesh->totedge;
+          sizes.mesh_offsets.loop += mesh->totloop;
+          sizes.mesh_offsets.poly += mesh->totpoly;
+        }
+        break;
+      }
+      case GEO_COMPONENT_TYPE_POINT_CLOUD: {
+        const PointCloud *pointcloud =
+            static_cast<const PointCloudComponent *>(component)->get_for_read();
+        if (pointcloud != nullptr && pointcloud->totpoint > 0) {
+          sizes.pointcloud_offset += pointcloud->totpoint;
+        }
+        break;
+      }
+      case GEO_COMPONENT_TYPE_CURVE: {
+        const Curves *curves = static_cast<const CurveComponent *>(component)->get_for_read();
+        if (curves != nullptr && curves->geometry.curve_num > 0) {
+          sizes.curves_offsets.point += curves->geometry.point_num;
+          sizes.curves_offsets.curve += curves->geometry.curve_num;
+        }
+        break;
+      }
+      case GEO_COMPONENT_TYPE_INSTANCES: {
+        sizes += count_realized_instances(*static_cast<const InstancesComponent *>(component),
+                                          options,
+                                          r_instances_sizes)
+                     .total();
+        break;
+      }
+      case GEO_COMPONENT_TYPE_VOLUME: {
+        break;
+      }
+    }
+  }
+  return sizes;
+}
+
+static const InstancesSizes &count_realized_instances(
+    const InstancesComponent &instances_component,
+    const RealizeInstancesOptions &options,
+    AllInstancesSizes &r_instances_sizes)
+{
+  if (const std::unique_ptr<InstancesSizes> *sizes = r_instances_sizes.sizes.lookup_ptr(
+          &instances_component)) {
+    /* The same instances component can be referenced many times. */
+    return **sizes;
+  }
+
+  std::unique_ptr<InstancesSizes> sizes = std::make_unique<InstancesSizes>();
+
+  /* Count every reference only once, instead of doing that for every instance. */
+  const Span<InstanceReference> references = instances_component.references();
+  sizes->reference_sizes.reinitialize(references.size());
+  for (const int reference_index : references.index_range()) {
+    foreach_geometry_in_reference(references[reference_index],
+                                  float4x4::identity(),
+                                  0,
+                                  [&](const GeometrySet &geometry_set,
+                                      const float4x4 &UNUSED(transform),
+                                      const uint32_t UNUSED(id)) {
+                                    sizes->reference_sizes[reference_index] +=
+                                        count_realized_elements(
+                                            geometry_set, options, r_instances_sizes);
+                                    r_instances_sizes.geometry_sets.append(geometry_set);
+                                  });
+  }
+
+  /* Sum up the sizes of every chunk in parallel and accumulate them afterwards. */
+  const Span<int> handles = instances_component.instance_reference_handles();
+  const int chunks_num = (handles.size() + instances_chunk_size - 1) / instances_chunk_size;
+  sizes->chunk_offsets.reinitialize(chunks_num + 1);
+  MutableSpan<GatherOffsets> chunk_offsets = sizes->chunk_offsets;
+  threading::parallel_for(IndexRange(chunks_num), 64, [&](const IndexRange chunk_range) {
+    for (const int chunk_index : chunk_range) {
+      const int chunk_start = chunk_index * instances_chunk_size;
+      const IndexRange instances_range(
+          chunk_start, std::min<int>(instances_chunk_size, handles.size() - chunk_start));
+      GatherOffsets chunk_sizes;
+      for (const int i : instances_range) {
+        chunk_sizes += sizes->reference_sizes[handles[i]];
+      }
+      chunk_offsets[chunk_index] = chunk_sizes;
+    }
+  });
+  GatherOffsets offset;
+  for (GatherOffsets &chunk_offset : chunk_offsets.drop_back(1)) {
+    const GatherOffsets chunk_sizes = chunk_offset;
+    chunk_offset = offset;
+    offset += chunk_sizes;
+  }
+  chunk_offsets.last() = offset;
+
+  const InstancesSizes &result = *sizes;
+  r_instances_sizes.sizes.add_new(&instances_component, std::move(sizes));
+  return result;
+}
+
+/**
+ * Find the first mesh that is realized. The output mesh gets the parameters of that mesh.
+ */
+static const Mesh *find_first_realized_mesh(const GeometrySet &geometry_set,
+                                            const AllInstancesSizes &instances_sizes)
+{
+  for (const GeometryComponent *component : geometry_set.get_components_for_read()) {
+    if (component->type() == GEO_COMPONENT_TYPE_MESH) {
+      const Mesh *mesh = static_cast<const MeshComponent *>(component)->get_for_read();
+      if (mesh != nullptr && mesh->totvert > 0) {
+        return mesh;
+      }
+    }
+    else if (component->type() == GEO_COMPONENT_TYPE_INSTANCES) {
+      const InstancesComponent &instances_component = *static_cast<const InstancesComponent *>(
+          component);
+      const std::unique_ptr<InstancesSizes> *sizes = instances_sizes.sizes.lookup_ptr(
+          &instances_component);
+      if (sizes != nullptr && (*sizes)->total().mesh_offsets.vertex == 0) {
+        continue;
+      }
+      const Span<InstanceReference> references = instances_component.references();
+      for (const int handle : instances_component.instance_reference_handles()) {
+        if (sizes != nullptr && (*sizes)->reference_sizes[handle].mesh_offsets.vertex == 0) {
+          continue;
+        }
+        const Mesh *first_mesh = nullptr;
+        foreach_geometry_in_reference(references[handle],
+                                      float4x4::identity(),
+                                      0,
+                                      [&](const GeometrySet &instance_geometry_set,
+                                          const float4x4 &UNUSED(transform),
+                                          const uint32_t UNUSED(id)) {
+                                        if (first_mesh == nullptr) {
+                                          first_mesh = find_first_realized_mesh(
+                                              instance_geometry_set, instances_sizes);
+                                        }
+                                      });
+        if (first_mesh != nullptr) {
+          return first_mesh;
+        }
+      }
+    }
+  }
+  return nullptr;
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Point Cloud
  * \{ */
@@ -628,6 +956,9 @@ static AllPointCloudsInfo preprocess_pointclouds(const GeometrySet &geometry_set
                                                  const RealizeInstancesOptions &options)
 {
   AllPointCloudsInfo info;
+  if (component_type_is_ignored(options, GEO_COMPONENT_TYPE_POINT_CLOUD)) {
+    return info;
+  }
   info.attributes = gather_generic_pointcloud_attributes_to_propagate(
       geometry_set, options, info.create_id_attribute);
 
@@ -695,61 +1026,63 @@ static void execute_realize_pointcloud_task(const RealizeInstancesOptions &optio
       dst_attribute_spans);
 }
 
-static void execute_realize_pointcloud_tasks(const RealizeInstancesOptions &options,
-                                             const AllPointCloudsInfo &all_pointclouds_info,
-                                             const Span<RealizePointCloudTask> tasks,
-                                             const OrderedAttributes &ordered_attributes,
-                                             GeometrySet &r_realized_geometry)
+static void prepare_pointcloud_output(const AllPointCloudsInfo &all_pointclouds_info,
+                                      const int tot_points,
+                                      GeometrySet &r_realized_geometry,
+                                      PointCloudOutput &r_output)
 {
-  if (tasks.is_empty()) {
-    return;
-  }
-
-  const RealizePointCloudTask &last_task = tasks.last();
-  const PointCloud &last_pointcloud = *last_task.pointcloud_info->pointcloud;
-  const int tot_points = last_task.start_index + last_pointcloud.totpoint;
+  const OrderedAttributes &ordered_attributes = all_pointclouds_info.attributes;
 
   /* Allocate new point cloud. */
   PointCloud *dst_pointcloud = BKE_pointcloud_new_nomain(tot_points);
   PointCloudComponent &dst_component =
       r_realized_geometry.get_component_for_write<PointCloudComponent>();
   dst_component.replace(dst_pointcloud);
+  r_output.pointcloud = dst_pointcloud;
 
   /* Prepare id attribute. */
-  OutputAttribute_Typed<int> point_ids;
-  MutableSpan<int> point_ids_span;
   if (all_pointclouds_info.create_id_attribute) {
-    point_ids = dst_component.attribute_try_get_for_output_only<int>("id", ATTR_DOMAIN_POINT);
-    point_ids_span = point_ids.as_span();
+    r_output.ids = dst_component.attribute_try_get_for_output_only<int>("id", ATTR_DOMAIN_POINT);
+    r_output.ids_span = r_output.ids.as_span();
   }
 
   /* Prepare generic output attributes. */
-  Vector<OutputAttribute> dst_attributes;
-  Vector<GMutableSpan> dst_attribute_spans;
   for (const int attribute_index : ordered_attributes.index_range()) {
     const AttributeIDRef &attribute_id = ordered_attributes.ids[attribute_index];
     const CustomDataType data_type = ordered_attributes.kinds[attribute_index].data_type;
     OutputAttribute dst_attribute = dst_component.attribute_try_get_for_output_only(
         attribute_id, ATTR_DOMAIN_POINT, data_type);
-    dst_attribute_spans.append(dst_attribute.as_span());
-    dst_attributes.append(std::move(dst_attribute));
+    r_output.attribute_spans.append(dst_attribute.as_span());
+    r_output.attributes.append(std::move(dst_attribute));
   }
+}
 
-  /* Actually execute all tasks. */
+static void execute_realize_pointcloud_tasks(const RealizeInstancesOptions &options,
+                                             const AllPointCloudsInfo &all_pointclouds_info,
+                                             const Span<RealizePointCloudTask> tasks,
+                                             PointCloudOutput &output)
+{
   threading::parallel_for(tasks.index_range(), 100, [&](const IndexRange task_range) {
     for (const int task_index : task_range) {
       const RealizePointCloudTask &task = tasks[task_index];
-      execute_realize_pointcloud_task(
-          options, task, ordered_attributes, *dst_pointcloud, dst_attribute_spans, point_ids_span);
+      execute_realize_pointcloud_task(options,
+                                      task,
+                                      all_pointclouds_info.attributes,
+                                      *output.pointcloud,
+                                      output.attribute_spans,
+                                      output.ids_span);
     }
   });
+}
 
+static void finish_pointcloud_output(PointCloudOutput &output)
+{
   /* Save modified attributes. */
-  for (OutputAttribute &dst_attribute : dst_attributes) {
+  for (OutputAttribute &dst_attribute : output.attributes) {
     dst_attribute.save();
   }
-  if (point_ids) {
-    point_ids.save();
+  if (output.ids) {
+    output.ids.save();
   }
 }
 
@@ -805,6 +1138,9 @@ static AllMeshesInfo preprocess_meshes(const GeometrySet &geometry_set,
                                        const RealizeInstancesOptions &options)
 {
   AllMeshesInfo info;
+  if (component_type_is_ignored(options, GEO_COMPONENT_TYPE_MESH)) {
+    return info;
+  }
   info.attributes = gather_generic_mesh_attributes_to_propagate(
       geometry_set, options, info.create_id_attribute);
 
@@ -945,31 +1281,22 @@ static void execute_realize_mesh_task(const RealizeInstancesOptions &options,
       dst_attribute_spans);
 }
 
-static void execute_realize_mesh_tasks(const RealizeInstancesOptions &options,
-                                       const AllMeshesInfo &all_meshes_info,
-                                       const Span<RealizeMeshTask> tasks,
-                                       const OrderedAttributes &ordered_attributes,
-                                       const VectorSet<Material *> &ordered_materials,
-                                       GeometrySet &r_realized_geometry)
+static void prepare_mesh_output(const AllMeshesInfo &all_meshes_info,
+                                const MeshElementStartIndices &tot_elements,
+                                const Mesh &first_mesh,
+                                GeometrySet &r_realized_geometry,
+                                MeshOutput &r_output)
 {
-  if (tasks.is_empty()) {
-    return;
-  }
+  const OrderedAttributes &ordered_attributes = all_meshes_info.attributes;
+  const VectorSet<Material *> &ordered_materials = all_meshes_info.materials;
 
-  const RealizeMeshTask &last_task = tasks.last();
-  const Mesh &last_mesh = *last_task.mesh_info->mesh;
-  const int tot_vertices = last_task.start_indices.vertex + last_mesh.totvert;
-  const int tot_edges = last_task.start_indices.edge + last_mesh.totedge;
-  const int tot_loops = last_task.start_indices.loop + last_mesh.totloop;
-  const int tot_poly = last_task.start_indices.poly + last_mesh.totpoly;
-
-  Mesh *dst_mesh = BKE_mesh_new_nomain(tot_vertices, tot_edges, 0, tot_loops, tot_poly);
+  Mesh *dst_mesh = BKE_mesh_new_nomain(
+      tot_elements.vertex, tot_elements.edge, 0, tot_elements.loop, tot_elements.poly);
   MeshComponent &dst_component = r_realized_geometry.get_component_for_write<MeshComponent>();
   dst_component.replace(dst_mesh);
+  r_output.mesh = dst_mesh;
 
   /* Copy settings from the first input geometry set with a mesh. */
-  const RealizeMeshTask &first_task = tasks.first();
-  const Mesh &first_mesh = *first_task.mesh_info->mesh;
   BKE_mesh_copy_parameters_for_eval(dst_mesh, &first_mesh);
 
   /* Add materials. */
@@ -979,41 +1306,50 @@ static void execute_realize_mesh_tasks(const RealizeInstancesOptions &options,
   }
 
   /* Prepare id attribute. */
-  OutputAttribute_Typed<int> vertex_ids;
-  MutableSpan<int> vertex_ids_span;
   if (all_meshes_info.create_id_attribute) {
-    vertex_ids = dst_component.attribute_try_get_for_output_only<int>("id", ATTR_DOMAIN_POINT);
-    vertex_ids_span = vertex_ids.as_span();
+    r_output.vertex_ids = dst_component.attribute_try_get_for_output_only<int>("id",
+                                                                               ATTR_DOMAIN_POINT);
+    r_output.vertex_ids_span = r_output.vertex_ids.as_span();
   }
 
   /* Prepare generic output attributes. */
-  Vector<OutputAttribute> dst_attributes;
-  Vector<GMutableSpan> dst_attribute_spans;
   for (const int attribute_index : ordered_attributes.index_range()) {
     const AttributeIDRef &attribute_id = ordered_attributes.ids[attribute_index];
     const AttributeDomain domain = ordered_attributes.kinds[attribute_index].domain;
     const CustomDataType data_type = ordered_attributes.kinds[attribute_index].data_type;
     OutputAttribute dst_attribute = dst_component.attribute_try_get_for_output_only(
         attribute_id, domain, data_type);
-    dst_attribute_spans.append(dst_attribute.as_span());
-    dst_attributes.append(std::move(dst_attribute));
+    r_output.attribute_spans.append(dst_attribute.as_span());
+    r_output.attributes.append(std::move(dst_attribute));
   }
+}
 
-  /* Actually execute all tasks. */
+static void execute_realize_mesh_tasks(const RealizeInstancesOptions &options,
+                                       const AllMeshesInfo &all_meshes_info,
+                                       const Span<RealizeMeshTask> tasks,
+                                       MeshOutput &output)
+{
   threading::parallel_for(tasks.index_range(), 100, [&](const IndexRange task_range) {
     for (const int task_index : task_range) {
       const RealizeMeshTask &task = tasks[task_index];
-      execute_realize_mesh_task(
-          options, task, ordered_attributes, *dst_mesh, dst_attribute_spans, vertex_ids_span);
+      execute_realize_mesh_task(options,
+                                task,
+                                all_meshes_info.attributes,
+                                *output.mesh,
+                                output.attribute_spans,
+                                output.vertex_ids_span);
     }
   });
+}
 
+static void finish_mesh_output(MeshOutput &output)
+{
   /* Save modified attributes. */
-  for (OutputAttribute &dst_attribute : dst_attributes) {
+  for (OutputAttribute &dst_attribute : output.attributes) {
     dst_attribute.save();
   }
-  if (vertex_ids) {
-    vertex_ids.save();
+  if (output.vertex_ids) {
+    output.vertex_ids.save();
   }
 }
 
@@ -1068,6 +1404,9 @@ static AllCurvesInfo preprocess_curves(const GeometrySet &geometry_set,
                                        const RealizeInstancesOptions &options)
 {
   AllCurvesInfo info;
+  if (component_type_is_ignored(options, GEO_COMPONENT_TYPE_CURVE)) {
+    return info;
+  }
   info.attributes = gather_generic_curve_attributes_to_propagate(
       geometry_set, options, info.create_id_attribute);
 
@@ -1203,101 +1542,94 @@ static void execute_realize_curve_task(const RealizeInstancesOptions &options,
       dst_attribute_spans);
 }
 
-static void execute_realize_curve_tasks(const RealizeInstancesOptions &options,
-                                        const AllCurvesInfo &all_curves_info,
-                                        const Span<RealizeCurveTask> tasks,
-                                        const OrderedAttributes &ordered_attributes,
-                                        GeometrySet &r_realized_geometry)
+static void prepare_curves_output(const AllCurvesInfo &all_curves_info,
+                                  const CurvesElementStartIndices &tot_elements,
+                                  GeometrySet &r_realized_geometry,
+                                  CurvesOutput &r_output)
 {
-  if (tasks.is_empty()) {
-    return;
-  }
-
-  const RealizeCurveTask &last_task = tasks.last();
-  const Curves &last_curves = *last_task.curve_info->curves;
-  const int points_num = last_task.start_indices.point + last_curves.geometry.point_num;
-  const int curves_num = last_task.start_indices.curve + last_curves.geometry.curve_num;
+  const OrderedAttributes &ordered_attributes = all_curves_info.attributes;
 
   /* Allocate new curves data-block. */
-  Curves *dst_curves_id = bke::curves_new_nomain(points_num, curves_num);
+  Curves *dst_curves_id = bke::curves_new_nomain(tot_elements.point, tot_elements.curve);
   bke::CurvesGeometry &dst_curves = bke::CurvesGeometry::wrap(dst_curves_id->geometry);
-  dst_curves.offsets_for_write().last() = points_num;
+  dst_curves.offsets_for_write().last() = tot_elements.point;
   CurveComponent &dst_component = r_realized_geometry.get_component_for_write<CurveComponent>();
   dst_component.replace(dst_curves_id);
+  r_output.curves = &dst_curves;
 
   /* Prepare id attribute. */
-  OutputAttribute_Typed<int> point_ids;
-  MutableSpan<int> point_ids_span;
   if (all_curves_info.create_id_attribute) {
-    point_ids = dst_component.attribute_try_get_for_output_only<int>("id", ATTR_DOMAIN_POINT);
-    point_ids_span = point_ids.as_span();
+    r_output.point_ids = dst_component.attribute_try_get_for_output_only<int>("id",
+                                                                              ATTR_DOMAIN_POINT);
+    r_output.point_ids_span = r_output.point_ids.as_span();
   }
 
   /* Prepare generic output attributes. */
-  Vector<OutputAttribute> dst_attributes;
-  Vector<GMutableSpan> dst_attribute_spans;
   for (const int attribute_index : ordered_attributes.index_range()) {
     const AttributeIDRef &attribute_id = ordered_attributes.ids[attribute_index];
     const AttributeDomain domain = ordered_attributes.kinds[attribute_index].domain;
     const CustomDataType data_type = ordered_attributes.kinds[attribute_index].data_type;
     OutputAttribute dst_attribute = dst_component.attribute_try_get_for_output_only(
         attribute_id, domain, data_type);
-    dst_attribute_spans.append(dst_attribute.as_span());
-    dst_attributes.append(std::move(dst_attribute));
+    r_output.attribute_spans.append(dst_attribute.as_span());
+    r_output.attributes.append(std::move(dst_attribute));
   }
 
   /* Prepare handle position attributes if necessary. */
-  OutputAttribute_Typed<float3> handle_left;
-  OutputAttribute_Typed<float3> handle_right;
-  MutableSpan<float3> handle_left_span;
-  MutableSpan<float3> handle_right_span;
   if (all_curves_info.create_handle_postion_attributes) {
-    handle_left = dst_component.attribute_try_get_for_output_only<float3>("handle_left",
-                                                                          ATTR_DOMAIN_POINT);
-    handle_right = dst_component.attribute_try_get_for_output_only<float3>("handle_right",
-                                                                           ATTR_DOMAIN_POINT);
-    handle_left_span = handle_left.as_span();
-    handle_right_span = handle_right.as_span();
+    r_output.handle_left = dst_component.attribute_try_get_for_output_only<float3>(
+        "handle_left", ATTR_DOMAIN_POINT);
+    r_output.handle_right = dst_component.attribute_try_get_for_output_only<float3>(
+        "handle_right", ATTR_DOMAIN_POINT);
+    r_output.handle_left_span = r_output.handle_left.as_span();
+    r_output.handle_right_span = r_output.handle_right.as_span();
   }
 
   /* Prepare radius attribute if necessary. */
-  OutputAttribute_Typed<float> radius;
-  MutableSpan<float> radius_span;
   if (all_curves_info.create_radius_attribute) {
-    radius = dst_component.attribute_try_get_for_output_only<float>("radius", ATTR_DOMAIN_POINT);
-    radius_span = radius.as_span();
+    r_output.radius = dst_component.attribute_try_get_for_output_only<float>("radius",
+                                                                             ATTR_DOMAIN_POINT);
+    r_output.radius_span = r_output.radius.as_span();
   }
+}
 
-  /* Actually execute all tasks. */
+static void execute_realize_curve_tasks(const RealizeInstancesOptions &options,
+                                        const AllCurvesInfo &all_curves_info,
+                                        const Span<RealizeCurveTask> tasks,
+                                        CurvesOutput &output)
+{
   threading::parallel_for(tasks.index_range(), 100, [&](const IndexRange task_range) {
     for (const int task_index : task_range) {
       const RealizeCurveTask &task = tasks[task_index];
       execute_realize_curve_task(options,
                                  all_curves_info,
                                  task,
-                                 ordered_attributes,
-                                 dst_curves,
-                                 dst_attribute_spans,
-                                 point_ids_span,
-                                 handle_left_span,
-                                 handle_right_span,
-                                 radius_span);
+                                 all_curves_info.attributes,
+                                 *output.curves,
+                                 output.attribute_spans,
+                                 output.point_ids_span,
+                                 output.handle_left_span,
+                                 output.handle_right_span,
+                                 output.radius_span);
     }
   });
+}
 
+static void finish_curves_output(CurvesOutput &output)
+{
   /* Save modified attributes. */
-  for (OutputAttribute &dst_attribute : dst_attributes) {
+  for (OutputAttribute &dst_attribute : output.attributes) {
     dst_attribute.save();
   }
-  if (point_ids) {
-    point_ids.save();
+  if (output.point_ids) {
+    output.point_ids.save();
   }
-  if (radius) {
-    radius.save();
+  if (output.radius) {
+    output.radius.save();
   }
-  if (all_curves_info.create_handle_postion_attributes) {
-    handle_left.save();
-    handle_right.save();
+  if (output.handle_left) {
+    output.handle_left.save();
+    output.handle_right.save();
   }
 }
 
@@ -1307,6 +1639,32 @@ static void execute_realize_curve_tasks(const RealizeInstancesOptions &options,
 /** \name Realize Instances
  * \{ */
 
+/**
+ * Execute the tasks that have been gathered so far and remove them, so that they don't have to be
+ * kept in memory until all instances are gathered.
+ */
+static void execute_realize_tasks(GatherTasksInfo &gather_info)
+{
+  GatherTasks &tasks = gather_info.r_tasks;
+  if (!tasks.pointcloud_tasks.is_empty()) {
+    execute_realize_pointcloud_tasks(gather_info.options,
+                                     gather_info.pointclouds,
+                                     tasks.pointcloud_tasks,
+                                     gather_info.outputs.pointcloud);
+    tasks.pointcloud_tasks.clear();
+  }
+  if (!tasks.mesh_tasks.is_empty()) {
+    execute_realize_mesh_tasks(
+        gather_info.options, gather_info.meshes, tasks.mesh_tasks, gather_info.outputs.mesh);
+    tasks.mesh_tasks.clear();
+  }
+  if (!tasks.curve_tasks.is_empty()) {
+    execute_realize_curve_tasks(
+        gather_info.options, gather_info.curves, tasks.curve_tasks, gather_info.outputs.curves);
+    tasks.curve_tasks.clear();
+  }
+}
+
 static void remove_id_attribute_from_instances(GeometrySet &geometry_set)
 {
   geometry_set.modify_geometry_sets([&](GeometrySet &sub_geometry) {
@@ -1321,14 +1679,17 @@ GeometrySet realize_instances(GeometrySet geometry_set, const RealizeInstancesOp
 {
   /* The algorithm works in three steps:
    * 1. Preprocess each unique geometry that is instanced (e.g. each `Mesh`).
-   * 2. Gather "tasks" that need to be executed to realize the instances. Each task corresponds to
-   *    instances of the previously preprocessed geometry.
-   * 3. Execute all tasks in parallel.
+   * 2. Count how many elements every instances component is realized to and allocate the output
+   *    geometry.
+   * 3. Gather "tasks" that need to be executed to realize the instances. Each task corresponds to
+   *    instances of the previously preprocessed geometry. Large instances components are gathered
+   *    in parallel chunks, and the tasks of every chunk are executed right away.
    */
 
   if (!geometry_set.has_instances()) {
     return geometry_set;
   }
+  BLI_assert(!options.ignored_component_types.contains(GEO_COMPONENT_TYPE_INSTANCES));
 
   if (options.keep_original_ids) {
     remove_id_attribute_from_instances(geometry_set);
@@ -1338,6 +1699,31 @@ GeometrySet realize_instances(GeometrySet geometry_set, const RealizeInstancesOp
   AllMeshesInfo all_meshes_info = preprocess_meshes(geometry_set, options);
   AllCurvesInfo all_curves_info = preprocess_curves(geometry_set, options);
 
+  /* Allocate the output geometry, so that tasks can be executed right after they are gathered. */
+  AllInstancesSizes instances_sizes;
+  const GatherOffsets tot_elements = count_realized_elements(
+      geometry_set, options, instances_sizes);
+  GeometrySet new_geometry_set;
+  RealizeOutputs outputs;
+  if (tot_elements.pointcloud_offset > 0) {
+    prepare_pointcloud_output(all_pointclouds_info,
+                              tot_elements.pointcloud_offset,
+                              new_geometry_set,
+                              outputs.pointcloud);
+  }
+  if (tot_elements.mesh_offsets.vertex > 0) {
+    const Mesh *first_mesh = find_first_realized_mesh(geometry_set, instances_sizes);
+    prepare_mesh_output(all_meshes_info,
+                        tot_elements.mesh_offsets,
+                        *first_mesh,
+                        new_geometry_set,
+                        outputs.mesh);
+  }
+  if (tot_elements.curves_offsets.curve > 0) {
+    prepare_curves_output(
+        all_curves_info, tot_elements.curves_offsets, new_geometry_set, outputs.curves);
+  }
+
   Vector<std::unique_ptr<GArray<>>> temporary_arrays;
   const bool create_id_attribute = all_pointclouds_info.create_id_attribute ||
                                    all_meshes_info.create_id_attribute ||
@@ -1346,28 +1732,24 @@ GeometrySet realize_instances(GeometrySet geometry_set, const RealizeInstancesOp
                                  all_meshes_info,
                                  all_curves_info,
                                  create_id_attribute,
+                                 options,
+                                 instances_sizes,
+                                 outputs,
                                  temporary_arrays};
   const float4x4 transform = float4x4::identity();
   InstanceContext attribute_fallbacks(gather_info);
   gather_realize_tasks_recursive(gather_info, geometry_set, transform, attribute_fallbacks);
+  execute_realize_tasks(gather_info);
 
-  GeometrySet new_geometry_set;
-  execute_realize_pointcloud_tasks(options,
-                                   all_pointclouds_info,
-                                   gather_info.r_tasks.pointcloud_tasks,
-                                   all_pointclouds_info.attributes,
-                                   new_geometry_set);
-  execute_realize_mesh_tasks(options,
-                             all_meshes_info,
-                             gather_info.r_tasks.mesh_tasks,
-                             all_meshes_info.attributes,
-                             all_meshes_info.materials,
-                             new_geometry_set);
-  execute_realize_curve_tasks(options,
-                              all_curves_info,
-                              gather_info.r_tasks.curve_tasks,
-                              all_curves_info.attributes,
-                              new_geometry_set);
+  if (outputs.pointcloud.pointcloud != nullptr) {
+    finish_pointcloud_output(outputs.pointcloud);
+  }
+  if (outputs.mesh.mesh != nullptr) {
+    finish_mesh_output(outputs.mesh);
+  }
+  if (outputs.curves.curves != nullptr) {
+    finish_curves_output(outputs.curves);
+  }
 
   if (gather_info.r_tasks.first_volume) {
     new_geometry_set.add(*gather_info.r_tasks.first_volume);
@@ -31,6 +31,7 @@ struct MPoly;
 struct MVert;
 struct Material;
 struct Mesh;
+struct MeshTopologyMap;
 struct SubdivCCG;
 
 #
@@ -78,6 +79,13 @@ typedef struct Mesh_Runtime {
   /** Needed to ensure some thread-safety during render data pre-processing. */
   void *render_mutex;
 
+  /**
+   * Protects the lazily computed topology maps below. Kept separate from the other mutexes
+   * because the maps are needed by normal calculation, which may run with #eval_mutex or
+   * #normals_mutex already locked.
+   */
+  void *topology_mutex;
+
   /** Lazily initialized SoA data from the #edit_mesh field in #Mesh. */
   struct EditMeshData *edit_data;
 
@@ -147,12 +155,28 @@ typedef struct Mesh_Runtime {
   char poly_normals_dirty;
   float (*vert_normals)[3];
   float (*poly_normals)[3];
+  /**
+   * A #BLI_bitmap of vertices that moved since the normals above were calculated, set by
+   * #BKE_mesh_normals_tag_dirty_verts. When not null, the normals are dirty but only have to be
+   * recalculated for the faces around these vertices.
+   */
+  uint32_t *normals_dirty_verts;
 
   /**
    * A #BLI_bitmap containing tags for the center vertices of subdivided polygons, set by the
    * subdivision surface modifier and used by drawing code instead of polygon center face dots.
    */
   uint32_t *subsurf_face_dot_tags;
+
+  /**
+   * Caches for lazily computed connectivity maps, see #BKE_mesh_runtime_vert_edge_map_ensure and
+   * related functions. They only depend on topology, so unlike the normals they are not cleared
+   * when positions change, only with the other caches in #BKE_mesh_runtime_clear_geometry.
+   */
+  struct MeshTopologyMap *vert_to_edge_map;
+  struct MeshTopologyMap *vert_to_loop_map;
+  struct MeshTopologyMap *vert_to_poly_map;
+  struct MeshTopologyMap *edge_to_poly_map;
 } Mesh_Runtime;
 
 typedef struct Mesh {
@@ -2298,9 +2298,16 @@ typedef struct NodesModifierData {
    * This can be used to help the user to debug a node tree.
    */
   void *runtime_eval_log;
-  void *_pad1;
+  char flag;
+  char _pad1[7];
 } NodesModifierData;
 
+/** #NodesModifierData.flag */
+enum {
+  /** Store the transforms of output instances compactly, see #InstancesComponent. */
+  NODES_MODIFIER_COMPACT_INSTANCES = (1 << 0),
+};
+
 typedef struct MeshToVolumeModifierData {
   ModifierData modifier;
 
@@ -200,7 +200,14 @@ typedef struct Object_Runtime {
   struct CurveCache *curve_cache;
 
   unsigned short local_collections_bits;
-  short _pad2[3];
+  /**
+   * Bit-mask of the #BVHCacheType requested from the previous evaluated mesh, these trees are
+   * built in parallel right after evaluating the mesh again.
+   */
+  short bvh_prebuild_types;
+  short _pad2[2];
+  /** The tree type (number of axes) of every prebuilt tree, indexed by #BVHCacheType. */
+  char bvh_prebuild_tree_types[8];
 
   float (*crazyspace_deform_imats)[3][3];
   float (*crazyspace_deform_cos)[3];
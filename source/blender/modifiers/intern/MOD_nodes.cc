@@ -6,15 +6,19 @@
  */
 
 #include <cstring>
+#include <fstream>
 #include <iostream>
 #include <string>
 
 #include "MEM_guardedalloc.h"
 
+#include "CLG_log.h"
+
 #include "BLI_array.hh"
 #include "BLI_listbase.h"
 #include "BLI_math_vec_types.hh"
 #include "BLI_multi_value_map.hh"
+#include "BLI_path_util.h"
 #include "BLI_set.hh"
 #include "BLI_string.h"
 #include "BLI_string_search.h"
@@ -34,6 +38,7 @@
 #include "DNA_space_types.h"
 #include "DNA_windowmanager_types.h"
 
+#include "BKE_appdir.h"
 #include "BKE_attribute_math.hh"
 #include "BKE_customdata.h"
 #include "BKE_geometry_fields.hh"
@@ -370,6 +375,26 @@ static bool isDisabled(const struct Scene *UNUSED(scene),
 }
 
 static bool logging_enabled(const ModifierEvalContext *ctx)
+{
+  if (!DEG_is_active(ctx->depsgraph)) {
+    return false;
+  }
+  if ((ctx->flag & MOD_APPLY_ORCO) != 0) {
+    return false;
+  }
+  if (G.background) {
+    /* There is no user interface that could display the logged data. */
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Only keep node outputs for the active depsgraph, which is evaluated again after every change. A
+ * render only evaluates the modifier once. This is independent of logging, which is also disabled
+ * in background mode where scripts may still change and evaluate the scene repeatedly.
+ */
+static bool output_cache_enabled(const ModifierEvalContext *ctx)
 {
   if (!DEG_is_active(ctx->depsgraph)) {
     return false;
@@ -906,6 +931,71 @@ static void find_sockets_to_preview(NodesModifierData *nmd,
   }
 }
 
+static Vector<SpaceNode *> find_node_editors(Main *bmain)
+{
+  wmWindowManager *wm = (wmWindowManager *)bmain->wm.first;
+  if (wm == nullptr) {
+    return {};
+  }
+  Vector<SpaceNode *> node_editors;
+  LISTBASE_FOREACH (wmWindow *, window, &wm->windows) {
+    bScreen *screen = BKE_workspace_active_screen_get(window->workspace_hook);
+    LISTBASE_FOREACH (ScrArea *, area, &screen->areabase) {
+      SpaceLink *sl = (SpaceLink *)area->spacedata.first;
+      if (sl->spacetype == SPACE_NODE) {
+        node_editors.append((SpaceNode *)sl);
+      }
+    }
+  }
+  return node_editors;
+}
+
+/**
+ * Find the tree contexts that are displayed in a node editor. Only those need socket values for
+ * socket inspection and attribute search, logging values everywhere else would be wasted work.
+ */
+static void find_tree_contexts_to_log_values(NodesModifierData *nmd,
+                                             const ModifierEvalContext *ctx,
+                                             const DerivedNodeTree &tree,
+                                             Set<const DTreeContext *> &r_contexts)
+{
+  Main *bmain = DEG_get_bmain(ctx->depsgraph);
+  const Object *object_orig = DEG_get_original_object(ctx->object);
+  const NodesModifierData *nmd_orig = (const NodesModifierData *)BKE_modifier_get_original(
+      ctx->object, &nmd->modifier);
+
+  for (SpaceNode *snode : find_node_editors(bmain)) {
+    if (snode->id != &object_orig->id || snode->nodetree != nmd_orig->node_group) {
+      continue;
+    }
+    Vector<bNodeTreePath *> tree_path = snode->treepath;
+    if (tree_path.is_empty()) {
+      continue;
+    }
+    const DTreeContext *context = &tree.root_context();
+    for (bNodeTreePath *path : tree_path.as_span().drop_front(1)) {
+      const NodeRef *group_node = nullptr;
+      for (const NodeRef *node_ref : context->tree().nodes()) {
+        if (node_ref->name() == path->node_name) {
+          group_node = node_ref;
+          break;
+        }
+      }
+      if (group_node == nullptr) {
+        context = nullptr;
+        break;
+      }
+      context = context->child_context(*group_node);
+      if (context == nullptr) {
+        break;
+      }
+    }
+    if (context != nullptr) {
+      r_contexts.add(context);
+    }
+  }
+}
+
 static void clear_runtime_data(NodesModifierData *nmd)
 {
   if (nmd->runtime_eval_log != nullptr) {
@@ -1064,6 +1154,58 @@ static void store_output_attributes(GeometrySet &geometry,
   store_computed_output_attributes(geometry, attributes_to_store);
 }
 
+static CLG_LogRef LOG = {"modifier.geometry_nodes"};
+
+/**
+ * Write the profile of the evaluation into the session's temporary directory, so that it can be
+ * inspected with `chrome://tracing` or Perfetto. Enabled with `--debug-geometry-nodes-profile`.
+ */
+static void write_profile(const geo_log::ModifierLog &modifier_log,
+                          const NodesModifierData &nmd,
+                          const ModifierEvalContext *ctx)
+{
+  char filename[FILE_MAX];
+  BLI_snprintf(filename,
+               sizeof(filename),
+               "geometry_nodes_profile_%s_%s_%d.json",
+               ctx->object->id.name + 2,
+               nmd.modifier.name,
+               int(DEG_get_ctime(ctx->depsgraph)));
+  BLI_filename_make_safe(filename);
+  char filepath[FILE_MAX];
+  BLI_path_join(filepath, sizeof(filepath), BKE_tempdir_session(), filename, nullptr);
+
+  std::ofstream stream(filepath);
+  if (!stream) {
+    CLOG_ERROR(&LOG, "Could not write geometry nodes profile to %s", filepath);
+    return;
+  }
+  modifier_log.write_chrome_trace(stream);
+  CLOG_INFO(&LOG, 0, "Wrote geometry nodes profile to %s", filepath);
+}
+
+/**
+ * Store the transforms of the instances more compactly, since they are usually only read
+ * afterwards to create the render instances.
+ */
+static void compact_instance_transforms(GeometrySet &geometry_set)
+{
+  const InstancesComponent &instances = *geometry_set.get_component_for_read<InstancesComponent>();
+  if (instances.is_mutable()) {
+    geometry_set.get_component_for_write<InstancesComponent>().compact_transforms();
+    return;
+  }
+  /* The component may be shared with the logger or the output cache, copying it would copy all
+   * transforms first. */
+  InstancesComponent *compact_instances = instances.copy_with_compact_transforms();
+  if (compact_instances == nullptr) {
+    return;
+  }
+  geometry_set.remove<InstancesComponent>();
+  geometry_set.add(*compact_instances);
+  compact_instances->user_remove();
+}
+
 /**
  * Evaluate a node group to compute the output geometry.
  */
@@ -1117,11 +1259,18 @@ static GeometrySet compute_geometry(const DerivedNodeTree &tree,
 
   blender::modifiers::geometry_nodes::GeometryNodesEvaluationParams eval_params;
 
-  if (logging_enabled(ctx)) {
+  const bool use_logging = logging_enabled(ctx);
+  const bool use_profiling = G.debug & G_DEBUG_GEOMETRY_NODES_PROFILE;
+  if (use_logging || use_profiling) {
     Set<DSocket> preview_sockets;
-    find_sockets_to_preview(nmd, ctx, tree, preview_sockets);
-    eval_params.force_compute_sockets.extend(preview_sockets.begin(), preview_sockets.end());
-    geo_logger.emplace(std::move(preview_sockets));
+    Set<const DTreeContext *> value_contexts;
+    if (use_logging) {
+      find_sockets_to_preview(nmd, ctx, tree, preview_sockets);
+      eval_params.force_compute_sockets.extend(preview_sockets.begin(), preview_sockets.end());
+      find_tree_contexts_to_log_values(nmd, ctx, tree, value_contexts);
+    }
+    geo_logger.emplace(std::move(preview_sockets), use_profiling);
+    geo_logger->log_values_only_in(std::move(value_contexts));
 
     geo_logger->log_input_geometry(input_geometry_set);
   }
@@ -1136,16 +1285,33 @@ static GeometrySet compute_geometry(const DerivedNodeTree &tree,
   eval_params.depsgraph = ctx->depsgraph;
   eval_params.self_object = ctx->object;
   eval_params.geo_logger = geo_logger.has_value() ? &*geo_logger : nullptr;
+  if (output_cache_enabled(ctx)) {
+    /* The runtime data of the evaluated modifier is kept when the depsgraph updates it. */
+    if (nmd->modifier.runtime == nullptr) {
+      nmd->modifier.runtime = new blender::modifiers::geometry_nodes::NodeOutputCache();
+    }
+    eval_params.output_cache = static_cast<blender::modifiers::geometry_nodes::NodeOutputCache *>(
+        nmd->modifier.runtime);
+  }
   blender::modifiers::geometry_nodes::evaluate_geometry_nodes(eval_params);
 
   GeometrySet output_geometry_set = std::move(*eval_params.r_output_values[0].get<GeometrySet>());
 
   if (geo_logger.has_value()) {
     geo_logger->log_output_geometry(output_geometry_set);
-    NodesModifierData *nmd_orig = (NodesModifierData *)BKE_modifier_get_original(ctx->object,
-                                                                                 &nmd->modifier);
-    clear_runtime_data(nmd_orig);
-    nmd_orig->runtime_eval_log = new geo_log::ModifierLog(*geo_logger);
+    geo_log::ModifierLog *modifier_log = new geo_log::ModifierLog(*geo_logger);
+    if (use_profiling) {
+      write_profile(*modifier_log, *nmd, ctx);
+    }
+    if (use_logging) {
+      NodesModifierData *nmd_orig = (NodesModifierData *)BKE_modifier_get_original(
+          ctx->object, &nmd->modifier);
+      clear_runtime_data(nmd_orig);
+      nmd_orig->runtime_eval_log = modifier_log;
+    }
+    else {
+      delete modifier_log;
+    }
   }
 
   store_output_attributes(output_geometry_set, *nmd, output_node, eval_params.r_output_values);
@@ -1214,8 +1380,11 @@ static void modifyGeometry(ModifierData *md,
 
   check_property_socket_sync(ctx->object, md);
 
-  NodeTreeRefMap tree_refs;
-  DerivedNodeTree tree{*nmd->node_group, tree_refs};
+  /* Building the derived tree can be expensive for large nested node groups, so it is shared with
+   * other evaluations of the same node tree. */
+  const std::shared_ptr<const CachedDerivedNodeTree> cached_tree =
+      blender::nodes::get_cached_derived_node_tree(*nmd->node_group);
+  const DerivedNodeTree &tree = cached_tree->tree();
 
   if (tree.has_link_cycles()) {
     BKE_modifier_set_error(ctx->object, md, "Node group has cycles");
@@ -1260,6 +1429,10 @@ static void modifyGeometry(ModifierData *md,
   geometry_set = compute_geometry(
       tree, input_nodes, output_node, std::move(geometry_set), nmd, ctx);
 
+  if (nmd->flag & NODES_MODIFIER_COMPACT_INSTANCES && geometry_set.has_instances()) {
+    compact_instance_transforms(geometry_set);
+  }
+
   if (geometry_set.has_mesh()) {
     /* Add #CD_ORIGINDEX layers if they don't exist already. This is required because the
      * #eModifierTypeFlag_SupportsMapping flag is set. If the layers did not exist before, it is
@@ -1614,6 +1787,8 @@ static void panel_draw(const bContext *C, Panel *panel)
     }
   }
 
+  uiItemR(layout, ptr, "use_compact_instances", 0, nullptr, ICON_NONE);
+
   /* Draw node warnings. */
   if (nmd->runtime_eval_log != nullptr) {
     const geo_log::ModifierLog &log = *static_cast<geo_log::ModifierLog *>(nmd->runtime_eval_log);
@@ -1784,6 +1959,11 @@ static void copyData(const ModifierData *md, ModifierData *target, const int fla
   }
 }
 
+static void freeRuntimeData(void *runtime_data)
+{
+  delete static_cast<blender::modifiers::geometry_nodes::NodeOutputCache *>(runtime_data);
+}
+
 static void freeData(ModifierData *md)
 {
   NodesModifierData *nmd = reinterpret_cast<NodesModifierData *>(md);
@@ -1793,6 +1973,8 @@ static void freeData(ModifierData *md)
   }
 
   clear_runtime_data(nmd);
+  freeRuntimeData(md->runtime);
+  md->runtime = nullptr;
 }
 
 static void requiredDataMask(Object *UNUSED(ob),
@@ -1836,7 +2018,7 @@ ModifierTypeInfo modifierType_Nodes = {
     /* dependsOnNormals */ nullptr,
     /* foreachIDLink */ foreachIDLink,
     /* foreachTexLink */ foreachTexLink,
-    /* freeRuntimeData */ nullptr,
+    /* freeRuntimeData */ freeRuntimeData,
     /* panelRegister */ panelRegister,
     /* blendWrite */ blendWrite,
     /* blendRead */ blendRead,
@@ -2,10 +2,23 @@
 
 #include "MOD_nodes_evaluator.hh"
 
+#include "MEM_guardedalloc.h"
+
+#include "BKE_curves.hh"
+#include "BKE_customdata.h"
+#include "BKE_geometry_set.hh"
 #include "BKE_type_conversions.hh"
 
+#include "DNA_curves_types.h"
+#include "DNA_genfile.h"
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_pointcloud_types.h"
+#include "DNA_sdna_types.h"
+
 #include "NOD_geometry_exec.hh"
 #include "NOD_socket_declarations.hh"
+#include "NOD_socket_declarations_geometry.hh"
 
 #include "DEG_depsgraph_query.h"
 
@@ -23,6 +36,7 @@
 #include "BLI_vector_set.hh"
 
 #include <chrono>
+#include <optional>
 
 namespace blender::modifiers::geometry_nodes {
 
@@ -42,6 +56,20 @@ enum class ValueUsage : uint8_t {
   Unused,
 };
 
+/** Bit mask of #GeometryComponentType values. */
+using ComponentTypeMask = uint8_t;
+static constexpr ComponentTypeMask all_component_types = (1 << GEO_COMPONENT_TYPE_ENUM_SIZE) - 1;
+
+static ComponentTypeMask component_type_bit(const GeometryComponentType type)
+{
+  return ComponentTypeMask(1 << type);
+}
+
+static const nodes::decl::Geometry *geometry_socket_declaration(const DSocket socket)
+{
+  return dynamic_cast<const nodes::decl::Geometry *>(socket->bsocket()->runtime->declaration);
+}
+
 struct SingleInputValue {
   /**
    * Points either to null or to a value of the type of input.
@@ -175,6 +203,12 @@ struct OutputState {
    * the output is not needed anymore.
    */
   int potential_users = 0;
+
+  /**
+   * The geometry component types that linked nodes may use. Nodes don't have to compute the other
+   * components. This is only relevant for geometry outputs and does not change during evaluation.
+   */
+  ComponentTypeMask required_components = all_component_types;
 };
 
 enum class NodeScheduleState {
@@ -247,6 +281,26 @@ struct NodeState {
    * not run twice at the same time accidentally.
    */
   NodeScheduleState schedule_state = NodeScheduleState::NotScheduled;
+
+  /**
+   * Identifies the node across evaluations of the same modifier, independent of its inputs. Only
+   * set when the evaluator has a #NodeOutputCache.
+   */
+  uint64_t cache_node_id = 0;
+
+  /**
+   * Identifies the output values of this node across evaluations. It stays empty when the outputs
+   * depend on something that can't be hashed. Only computed when necessary, before the evaluation
+   * starts.
+   */
+  std::optional<uint64_t> cache_key;
+  bool cache_key_computed = false;
+
+  /**
+   * True when outputs of this node should be loaded from and stored in the cache. This can be
+   * checked without a lock, because it does not change during the evaluation.
+   */
+  bool use_output_cache = false;
 };
 
 /**
@@ -400,6 +454,334 @@ static bool node_supports_laziness(const DNode node)
   return node->typeinfo()->geometry_node_execute_supports_laziness;
 }
 
+static bool node_has_geometry_input(const DNode node)
+{
+  for (const InputSocketRef *socket : node->inputs()) {
+    if (socket->is_available() && socket->typeinfo()->type == SOCK_GEOMETRY) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/* -------------------------------------------------------------------- */
+/** \name Output Cache Keys
+ *
+ * Hashes used to find values in the #NodeOutputCache. They have to be stable between evaluations,
+ * so they are computed from names and data instead of pointers to runtime structs.
+ * \{ */
+
+static uint64_t combine_hashes(const uint64_t a, const uint64_t b)
+{
+  /* The order of the hashes matters, the result is mixed with the splitmix64 finalizer. */
+  uint64_t x = a ^ (b + 0x9e3779b97f4a7c15ull + (a << 6) + (a >> 2));
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+  return x ^ (x >> 31);
+}
+
+static uint64_t hash_bytes_chunk(const uint8_t *data, const int64_t size)
+{
+  uint64_t hash = uint64_t(size);
+  int64_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    uint64_t word;
+    memcpy(&word, data + i, 8);
+    hash = ((hash << 5) | (hash >> 59)) ^ word;
+    hash *= 0x517cc1b727220a95ull;
+  }
+  uint64_t tail = 0;
+  memcpy(&tail, data + i, size_t(size - i));
+  return combine_hashes(hash, tail);
+}
+
+static uint64_t hash_bytes(const void *data, const int64_t size)
+{
+  if (size == 0) {
+    return 0;
+  }
+  const uint8_t *bytes = static_cast<const uint8_t *>(data);
+  const int64_t chunk_size = 1 << 16;
+  const int64_t chunks_num = (size + chunk_size - 1) / chunk_size;
+  if (chunks_num <= 1) {
+    return hash_bytes_chunk(bytes, size);
+  }
+  /* Hash large arrays in parallel, the chunk hashes are combined in a fixed order. */
+  Array<uint64_t> chunk_hashes(chunks_num);
+  threading::parallel_for(IndexRange(chunks_num), 8, [&](const IndexRange range) {
+    for (const int64_t chunk : range) {
+      const int64_t start = chunk * chunk_size;
+      chunk_hashes[chunk] = hash_bytes_chunk(bytes + start, std::min(chunk_size, size - start));
+    }
+  });
+  return hash_bytes_chunk(reinterpret_cast<const uint8_t *>(chunk_hashes.data()),
+                          chunk_hashes.size() * int64_t(sizeof(uint64_t)));
+}
+
+static std::optional<uint64_t> hash_custom_data(const CustomData &data, const int size)
+{
+  uint64_t hash = uint64_t(size);
+  for (const CustomDataLayer &layer : Span(data.layers, data.totlayer)) {
+    hash = combine_hashes(hash, uint64_t(layer.type));
+    hash = combine_hashes(hash, get_default_hash(StringRef(layer.name)));
+    hash = combine_hashes(hash, get_default_hash(layer.anonymous_id));
+    if (layer.data == nullptr) {
+      continue;
+    }
+    if (ELEM(layer.type, CD_MDISPS, CD_GRID_PAINT_MASK)) {
+      /* These layers point to more data that is not worth hashing here. */
+      return std::nullopt;
+    }
+    if (layer.type == CD_MDEFORMVERT) {
+      for (const MDeformVert &dvert : Span(static_cast<const MDeformVert *>(layer.data), size)) {
+        hash = combine_hashes(hash, hash_bytes(dvert.dw, sizeof(MDeformWeight) * dvert.totweight));
+      }
+      continue;
+    }
+    const int64_t layer_size = int64_t(CustomData_sizeof(layer.type)) * size;
+    hash = combine_hashes(hash, hash_bytes(layer.data, layer_size));
+  }
+  return hash;
+}
+
+static std::optional<uint64_t> hash_mesh(const Mesh &mesh)
+{
+  uint64_t hash = hash_bytes(mesh.mat, sizeof(Material *) * mesh.totcol);
+  LISTBASE_FOREACH (const bDeformGroup *, group, &mesh.vertex_group_names) {
+    hash = combine_hashes(hash, get_default_hash(StringRef(group->name)));
+  }
+  const std::array<std::optional<uint64_t>, 4> domain_hashes = {
+      hash_custom_data(mesh.vdata, mesh.totvert),
+      hash_custom_data(mesh.edata, mesh.totedge),
+      hash_custom_data(mesh.ldata, mesh.totloop),
+      hash_custom_data(mesh.pdata, mesh.totpoly)};
+  for (const std::optional<uint64_t> &domain_hash : domain_hashes) {
+    if (!domain_hash) {
+      return std::nullopt;
+    }
+    hash = combine_hashes(hash, *domain_hash);
+  }
+  return hash;
+}
+
+static std::optional<uint64_t> hash_pointcloud(const PointCloud &pointcloud)
+{
+  const std::optional<uint64_t> hash = hash_custom_data(pointcloud.pdata, pointcloud.totpoint);
+  if (!hash) {
+    return std::nullopt;
+  }
+  return combine_hashes(*hash, hash_bytes(pointcloud.mat, sizeof(Material *) * pointcloud.totcol));
+}
+
+static std::optional<uint64_t> hash_curves(const Curves &curves_id)
+{
+  const bke::CurvesGeometry &curves = bke::CurvesGeometry::wrap(curves_id.geometry);
+  const std::optional<uint64_t> point_hash = hash_custom_data(curves.point_data,
+                                                              curves.points_num());
+  const std::optional<uint64_t> curve_hash = hash_custom_data(curves.curve_data,
+                                                              curves.curves_num());
+  if (!point_hash || !curve_hash) {
+    return std::nullopt;
+  }
+  const Span<int> offsets = curves.offsets();
+  uint64_t hash = combine_hashes(*point_hash, *curve_hash);
+  hash = combine_hashes(hash, hash_bytes(offsets.data(), offsets.size_in_bytes()));
+  return combine_hashes(hash, hash_bytes(curves_id.mat, sizeof(Material *) * curves_id.totcol));
+}
+
+/**
+ * Hashes the data of a geometry. Instances and volumes are not supported, because they reference
+ * data that can't be hashed cheaply.
+ */
+static std::optional<uint64_t> hash_geometry_set(const GeometrySet &geometry)
+{
+  if (geometry.has_instances() || geometry.has_volume()) {
+    return std::nullopt;
+  }
+  uint64_t hash = 0;
+  const std::array<std::optional<uint64_t>, 3> component_hashes = {
+      geometry.has_mesh() ? hash_mesh(*geometry.get_mesh_for_read()) : 0,
+      geometry.has_pointcloud() ? hash_pointcloud(*geometry.get_pointcloud_for_read()) : 0,
+      geometry.has_curves() ? hash_curves(*geometry.get_curves_for_read()) : 0};
+  for (const std::optional<uint64_t> &component_hash : component_hashes) {
+    if (!component_hash) {
+      return std::nullopt;
+    }
+    hash = combine_hashes(hash, *component_hash);
+  }
+  return hash;
+}
+
+static std::optional<uint64_t> hash_socket_value(const CPPType &type, const void *value)
+{
+  if (const ValueOrFieldCPPType *value_or_field_type = dynamic_cast<const ValueOrFieldCPPType *>(
+          &type)) {
+    /* Fields are compared by pointer, so their hash is not stable between evaluations. */
+    if (value_or_field_type->is_field(value)) {
+      return std::nullopt;
+    }
+    const CPPType &base_type = value_or_field_type->base_type();
+    if (!base_type.is_hashable()) {
+      return std::nullopt;
+    }
+    return base_type.hash(value_or_field_type->get_value_ptr(value));
+  }
+  if (type.is<GeometrySet>()) {
+    return hash_geometry_set(*static_cast<const GeometrySet *>(value));
+  }
+  if (type.is_hashable()) {
+    return type.hash(value);
+  }
+  return std::nullopt;
+}
+
+static std::optional<uint64_t> hash_unlinked_input_value(const SocketRef &socket)
+{
+  const CPPType *type = get_socket_cpp_type(socket);
+  if (type == nullptr) {
+    return std::nullopt;
+  }
+  BUFFER_FOR_CPP_TYPE_VALUE(*type, buffer);
+  if (get_implicit_socket_input(socket, buffer)) {
+    /* Implicit inputs only depend on the node, which is part of the key already. */
+    type->destruct(buffer);
+    return 0;
+  }
+  socket.typeinfo()->get_geometry_nodes_cpp_value(*socket.bsocket(), buffer);
+  const std::optional<uint64_t> hash = hash_socket_value(*type, buffer);
+  type->destruct(buffer);
+  return hash;
+}
+
+/**
+ * Hashes the node and the path of group nodes it is in. The result does not depend on the values
+ * of the node inputs.
+ */
+static uint64_t compute_cache_node_id(const DNode node)
+{
+  uint64_t hash = combine_hashes(get_default_hash(node->idname()), get_default_hash(node->name()));
+  for (const DTreeContext *context = node.context(); context != nullptr;
+       context = context->parent_context()) {
+    hash = combine_hashes(hash, context->tree().btree()->id.session_uuid);
+    if (const NodeRef *parent_node = context->parent_node()) {
+      hash = combine_hashes(hash, get_default_hash(parent_node->name()));
+    }
+  }
+  return hash;
+}
+
+static std::optional<uint64_t> hash_dna_struct_data(const SDNA &sdna,
+                                                    const int struct_nr,
+                                                    const char *data)
+{
+  const SDNA_Struct &struct_info = *sdna.structs[struct_nr];
+  uint64_t hash = uint64_t(struct_nr);
+  /* DNA structs don't have implicit padding, so the members follow each other directly. */
+  for (const int i : IndexRange(struct_info.members_len)) {
+    const SDNA_StructMember &member = struct_info.members[i];
+    const char *member_name = sdna.names[member.name];
+    const int array_len = sdna.names_array_len[member.name];
+    const int member_size = DNA_elem_size_nr(&sdna, member.type, member.name);
+    if (ELEM(member_name[0], '*', '(')) {
+      const bool is_string = member_name[1] != '*' && STREQ(sdna.types[member.type], "char");
+      for (const int j : IndexRange(array_len)) {
+        const void *pointer;
+        memcpy(&pointer, data + j * sizeof(void *), sizeof(void *));
+        if (pointer == nullptr) {
+          hash = combine_hashes(hash, 0);
+        }
+        else if (is_string) {
+          const StringRef string = static_cast<const char *>(pointer);
+          hash = combine_hashes(hash, get_default_hash(string));
+        }
+        else {
+          return std::nullopt;
+        }
+      }
+    }
+    else if (const int member_struct_nr = DNA_struct_find_nr(&sdna, sdna.types[member.type]);
+             member_struct_nr != -1) {
+      const int struct_size = sdna.types_size[member.type];
+      for (const int j : IndexRange(array_len)) {
+        const std::optional<uint64_t> member_hash = hash_dna_struct_data(
+            sdna, member_struct_nr, data + j * struct_size);
+        if (!member_hash) {
+          return std::nullopt;
+        }
+        hash = combine_hashes(hash, *member_hash);
+      }
+    }
+    else {
+      hash = combine_hashes(hash, hash_bytes(data, member_size));
+    }
+    data += member_size;
+  }
+  return hash;
+}
+
+std::optional<uint64_t> hash_dna_struct(const char *struct_name, const void *data)
+{
+  const SDNA &sdna = *DNA_sdna_current_get();
+  const int struct_nr = DNA_struct_find_nr(&sdna, struct_name);
+  if (struct_nr == -1) {
+    return std::nullopt;
+  }
+  return hash_dna_struct_data(sdna, struct_nr, static_cast<const char *>(data));
+}
+
+static std::optional<uint64_t> hash_node_settings(const bNode &bnode)
+{
+  const uint64_t hash = get_default_hash_4(
+      bnode.custom1, bnode.custom2, bnode.custom3, bnode.custom4);
+  if (bnode.storage == nullptr) {
+    return hash;
+  }
+  /* The storage is hashed by its members, e.g. the string of the string input node is part of
+   * the storage. Nodes whose storage points to other data (like curve mappings) aren't cached. */
+  const std::optional<uint64_t> storage_hash = hash_dna_struct(bnode.typeinfo->storagename,
+                                                               bnode.storage);
+  if (!storage_hash) {
+    return std::nullopt;
+  }
+  return combine_hashes(hash, *storage_hash);
+}
+
+/**
+ * Nodes that read data from outside of the node tree can't be cached, because their outputs may
+ * change when nothing in the node tree changed.
+ */
+static bool node_outputs_can_be_cached(const DNode node)
+{
+  const bNode &bnode = *node->bnode();
+  if (bnode.id != nullptr) {
+    return false;
+  }
+  if (ELEM(bnode.type, GEO_NODE_INPUT_SCENE_TIME, GEO_NODE_IS_VIEWPORT, GEO_NODE_VIEWER)) {
+    return false;
+  }
+  auto socket_references_data_block = [](const SocketRef *socket) {
+    return ELEM(socket->typeinfo()->type, SOCK_OBJECT, SOCK_COLLECTION, SOCK_TEXTURE, SOCK_IMAGE);
+  };
+  for (const InputSocketRef *socket : node->inputs()) {
+    if (socket->is_available() && socket_references_data_block(socket)) {
+      return false;
+    }
+  }
+  for (const OutputSocketRef *socket : node->outputs()) {
+    if (socket->is_available() && socket_references_data_block(socket)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static uint64_t cache_key_for_output(const uint64_t node_key, const int output_index)
+{
+  return combine_hashes(node_key, uint64_t(output_index));
+}
+
+/** \} */
+
 struct NodeTaskRunState {
   /** The node that should be run on the same thread after the current node finished. */
   DNode next_node_to_run;
@@ -413,6 +795,11 @@ class NodeParamsProvider : public nodes::GeoNodeExecParamsProvider {
   NodeTaskRunState *run_state_;
 
  public:
+  /** When not null, the sizes of all output geometries are accumulated here for profiling. */
+  geo_log::GeometryDomainSizes *output_domain_sizes = nullptr;
+  /** When not null, the fields that are passed to the node are gathered here. */
+  Vector<GField> *input_fields = nullptr;
+
   NodeParamsProvider(GeometryNodesEvaluator &evaluator,
                      DNode dnode,
                      NodeState &node_state,
@@ -430,6 +817,8 @@ class NodeParamsProvider : public nodes::GeoNodeExecParamsProvider {
 
   bool lazy_require_input(StringRef identifier) override;
   bool lazy_output_is_required(StringRef identifier) const override;
+  bool output_component_is_required(StringRef identifier,
+                                    GeometryComponentType component_type) const override;
 
   void set_default_remaining_outputs() override;
 };
@@ -465,6 +854,9 @@ class GeometryNodesEvaluator {
   GeometryNodesEvaluationParams &params_;
   const blender::bke::DataTypeConversions &conversions_;
 
+  /** Hashes of group input values, used to compute cache keys. */
+  Map<DOutputSocket, std::optional<uint64_t>> group_input_hashes_;
+
   friend NodeParamsProvider;
 
  public:
@@ -480,6 +872,10 @@ class GeometryNodesEvaluator {
     task_pool_ = BLI_task_pool_create(this, TASK_PRIORITY_HIGH);
 
     this->create_states_for_reachable_nodes();
+    if (params_.output_cache != nullptr) {
+      params_.output_cache->begin_evaluation();
+      this->prepare_output_cache();
+    }
     this->forward_group_inputs();
     this->schedule_initial_nodes();
 
@@ -489,6 +885,10 @@ class GeometryNodesEvaluator {
 
     this->extract_group_outputs();
     this->destruct_node_states();
+
+    if (params_.output_cache != nullptr) {
+      params_.output_cache->end_evaluation();
+    }
   }
 
   void create_states_for_reachable_nodes()
@@ -541,6 +941,95 @@ class GeometryNodesEvaluator {
         node_state.inputs[socket->index()].force_compute = true;
       }
     }
+
+    this->compute_required_components();
+  }
+
+  /**
+   * Propagates the geometry component types that are used from the group outputs back to the
+   * geometry outputs of all nodes. Most nodes use all components of their geometry inputs, but
+   * inputs declared with #decl::GeometryBuilder::propagates_components only use what the geometry
+   * outputs of their node require. Logged sockets always require all components, so that the
+   * logged geometry is complete.
+   */
+  void compute_required_components()
+  {
+    Map<DInputSocket, ComponentTypeMask> input_components;
+    for (const NodeWithState &item : node_states_) {
+      for (const int i : item.node->outputs().index_range()) {
+        const DOutputSocket socket = item.node.output(i);
+        if (!socket->is_available() ||
+            get_socket_cpp_type(socket) != &CPPType::get<GeometrySet>()) {
+          continue;
+        }
+        item.state->outputs[i].required_components = this->required_components_for_output(
+            socket, input_components);
+      }
+    }
+  }
+
+  bool socket_value_is_logged(const DSocket socket) const
+  {
+    return params_.geo_logger != nullptr && params_.geo_logger->should_log_value(socket);
+  }
+
+  ComponentTypeMask required_components_for_output(
+      const DOutputSocket socket, Map<DInputSocket, ComponentTypeMask> &input_components)
+  {
+    if (this->socket_value_is_logged(socket)) {
+      return all_component_types;
+    }
+    ComponentTypeMask components = 0;
+    socket.foreach_target_socket(
+        [&](const DInputSocket target_socket,
+            const DOutputSocket::TargetSocketPathInfo &UNUSED(path_info)) {
+          if (!node_states_.contains_as(target_socket.node())) {
+            return;
+          }
+          if (const ComponentTypeMask *cached = input_components.lookup_ptr(target_socket)) {
+            components |= *cached;
+            return;
+          }
+          /* Don't use #Map::lookup_or_add_cb, because the map is modified recursively. */
+          const ComponentTypeMask input_mask = this->required_components_for_input(
+              target_socket, input_components);
+          input_components.add(target_socket, input_mask);
+          components |= input_mask;
+        });
+    return components;
+  }
+
+  ComponentTypeMask required_components_for_input(
+      const DInputSocket socket, Map<DInputSocket, ComponentTypeMask> &input_components)
+  {
+    const DNode node = socket.node();
+    const NodeState &node_state = *node_states_.lookup_key_as(node).state;
+    if (node_state.inputs[socket->index()].force_compute || this->socket_value_is_logged(socket)) {
+      return all_component_types;
+    }
+    const nodes::decl::Geometry *geometry_declaration = geometry_socket_declaration(socket);
+    if (geometry_declaration == nullptr || !geometry_declaration->propagates_components()) {
+      return all_component_types;
+    }
+    ComponentTypeMask components = 0;
+    for (const OutputSocketRef *output_ref : node->outputs()) {
+      const DOutputSocket output{node.context(), output_ref};
+      if (!output->is_available() || get_socket_cpp_type(output) != &CPPType::get<GeometrySet>()) {
+        continue;
+      }
+      ComponentTypeMask output_components = this->required_components_for_output(
+          output, input_components);
+      /* E.g. the outputs of Separate Components only contain a single type. */
+      const nodes::decl::Geometry *output_declaration = geometry_socket_declaration(output);
+      if (output_declaration != nullptr) {
+        if (const std::optional<GeometryComponentType> type =
+                output_declaration->propagated_component_type()) {
+          output_components &= component_type_bit(*type);
+        }
+      }
+      components |= output_components;
+    }
+    return components;
   }
 
   void initialize_node_state(const DNode node, NodeState &node_state, LinearAllocator<> &allocator)
@@ -616,6 +1105,190 @@ class GeometryNodesEvaluator {
     }
   }
 
+  /**
+   * Decides which nodes use the output cache. Only nodes that were expensive in a previous
+   * evaluation do, keys of other nodes are only computed when they are needed for those.
+   */
+  void prepare_output_cache()
+  {
+    NodeOutputCache &cache = *params_.output_cache;
+    for (const NodeWithState &item : node_states_) {
+      item.state->cache_node_id = compute_cache_node_id(item.node);
+    }
+    for (const NodeWithState &item : node_states_) {
+      if (item.node->is_group_input_node() || item.node->is_group_output_node()) {
+        continue;
+      }
+      if (!cache.node_is_expensive(item.state->cache_node_id)) {
+        continue;
+      }
+      item.state->use_output_cache = this->get_cache_key(item.node, *item.state).has_value();
+    }
+  }
+
+  std::optional<uint64_t> get_cache_key(const DNode node, NodeState &node_state)
+  {
+    if (node_state.cache_key_computed) {
+      return node_state.cache_key;
+    }
+    node_state.cache_key_computed = true;
+    if (!node_outputs_can_be_cached(node)) {
+      return std::nullopt;
+    }
+    const std::optional<uint64_t> settings_hash = hash_node_settings(*node->bnode());
+    if (!settings_hash) {
+      return std::nullopt;
+    }
+    uint64_t key = combine_hashes(node_state.cache_node_id, *settings_hash);
+    for (const int i : node->inputs().index_range()) {
+      if (node_state.inputs[i].type == nullptr) {
+        continue;
+      }
+      const std::optional<uint64_t> input_hash = this->hash_input_socket(node.input(i));
+      if (!input_hash) {
+        return std::nullopt;
+      }
+      key = combine_hashes(key, *input_hash);
+    }
+    /* Geometry outputs may contain fewer components when not all are required. */
+    for (const OutputState &output_state : node_state.outputs) {
+      key = combine_hashes(key, get_default_hash(output_state.required_components));
+    }
+    node_state.cache_key = key;
+    return key;
+  }
+
+  std::optional<uint64_t> hash_input_socket(const DInputSocket socket)
+  {
+    /* The type is part of the hash, because it changes when implicit conversions are done. */
+    uint64_t hash = get_default_hash(get_socket_cpp_type(socket));
+    bool is_hashable = true;
+    bool has_origin = false;
+    socket.foreach_origin_socket([&](const DSocket origin) {
+      has_origin = true;
+      if (!is_hashable) {
+        return;
+      }
+      const std::optional<uint64_t> origin_hash = this->hash_origin_socket(origin);
+      if (origin_hash) {
+        hash = combine_hashes(hash, *origin_hash);
+      }
+      else {
+        is_hashable = false;
+      }
+    });
+    if (!has_origin) {
+      const std::optional<uint64_t> value_hash = hash_unlinked_input_value(*socket.socket_ref());
+      if (!value_hash) {
+        return std::nullopt;
+      }
+      return combine_hashes(hash, *value_hash);
+    }
+    if (!is_hashable) {
+      return std::nullopt;
+    }
+    return hash;
+  }
+
+  std::optional<uint64_t> hash_origin_socket(const DSocket origin)
+  {
+    if (origin->is_input()) {
+      return hash_unlinked_input_value(*origin.socket_ref());
+    }
+    const DOutputSocket origin_output{origin};
+    const DNode origin_node = origin_output.node();
+    if (origin_node->is_group_input_node()) {
+      return group_input_hashes_.lookup_or_add_cb(
+          origin_output, [&]() -> std::optional<uint64_t> {
+            const GMutablePointer *value = params_.input_values.lookup_ptr(origin_output);
+            if (value == nullptr) {
+              return std::nullopt;
+            }
+            return hash_socket_value(*value->type(), value->get());
+          });
+    }
+    const NodeWithState *origin_with_state = node_states_.lookup_key_ptr_as(origin_node);
+    if (origin_with_state == nullptr) {
+      return std::nullopt;
+    }
+    const std::optional<uint64_t> origin_key = this->get_cache_key(origin_node,
+                                                                   *origin_with_state->state);
+    if (!origin_key) {
+      return std::nullopt;
+    }
+    return cache_key_for_output(*origin_key, origin->index());
+  }
+
+  /**
+   * Forwards cached values for all outputs of the node that may be used, but only if all of them
+   * are cached. The node is not executed then and its inputs are not computed at all.
+   */
+  void load_outputs_from_cache(const DNode node,
+                               NodeState &node_state,
+                               NodeTaskRunState *run_state)
+  {
+    Vector<int, 16> output_indices;
+    {
+      std::lock_guard lock{node_state.mutex};
+      if (node_state.node_has_finished) {
+        return;
+      }
+      for (const int i : node_state.outputs.index_range()) {
+        const OutputState &output_state = node_state.outputs[i];
+        if (!output_state.has_been_computed && output_state.output_usage != ValueUsage::Unused) {
+          output_indices.append(i);
+        }
+      }
+    }
+    if (output_indices.is_empty()) {
+      return;
+    }
+
+    NodeOutputCache &cache = *params_.output_cache;
+    /* The node is not executed, so what it logged when it was executed is logged again. The node
+     * has to be executed when that is not known. */
+    std::optional<NodeOutputCache::NodeLog> node_log;
+    if (params_.geo_logger != nullptr) {
+      node_log.emplace();
+      if (!cache.try_copy_node_log(*node_state.cache_key, *node_log)) {
+        return;
+      }
+    }
+    LinearAllocator<> &allocator = local_allocators_.local();
+    Vector<GMutablePointer, 16> values;
+    for (const int output_index : output_indices) {
+      const CPPType &type = *get_socket_cpp_type(node.output(output_index));
+      void *buffer = allocator.allocate(type.size(), type.alignment());
+      if (!cache.try_copy_value(
+              cache_key_for_output(*node_state.cache_key, output_index), type, buffer)) {
+        for (GMutablePointer value : values) {
+          value.destruct();
+        }
+        return;
+      }
+      values.append({type, buffer});
+    }
+
+    if (node_log) {
+      geo_log::LocalGeoLogger &local_logger = params_.geo_logger->local();
+      for (geo_log::NodeWarning &warning : node_log->warnings) {
+        local_logger.log_node_warning(node, warning.type, std::move(warning.message));
+      }
+      for (geo_log::UsedNamedAttribute &attribute : node_log->used_named_attributes) {
+        local_logger.log_used_named_attribute(node, std::move(attribute.name), attribute.usage);
+      }
+      local_logger.log_execution_time(node, std::chrono::microseconds(0));
+      local_logger.log_debug_message(node, "Outputs loaded from the cache");
+    }
+
+    /* Like in #NodeParamsProvider::set_output, only the thread running the node writes to
+     * `has_been_computed`. */
+    for (const int i : output_indices.index_range()) {
+      this->forward_output(node.output(output_indices[i]), values[i], run_state);
+      node_state.outputs[output_indices[i]].has_been_computed = true;
+    }
+  }
+
   void destruct_node_states()
   {
     threading::parallel_for(
@@ -762,6 +1435,10 @@ class GeometryNodesEvaluator {
 
     NodeState &node_state = *node_states_.lookup_key_as(node).state;
 
+    if (node_state.use_output_cache) {
+      this->load_outputs_from_cache(node, node_state, run_state);
+    }
+
     const bool do_execute_node = this->node_task_preprocessing(node, node_state, run_state);
 
     /* Only execute the node if all prerequisites are met. There has to be an output that is
@@ -982,13 +1659,70 @@ class GeometryNodesEvaluator {
 
     NodeParamsProvider params_provider{*this, node, node_state, run_state};
     GeoNodeExecParams params{params_provider};
+    /* Fields are evaluated on geometries, so the optimizations of the input fields are attributed
+     * to the nodes that have a geometry input. */
+    Vector<GField> input_fields;
+    if (params_.geo_logger != nullptr && node_has_geometry_input(node)) {
+      params_provider.input_fields = &input_fields;
+    }
+    std::optional<geo_log::NodeExecutionProfiler> profiler;
+    if (params_.geo_logger != nullptr && params_.geo_logger->profiling_enabled()) {
+      profiler.emplace(*params_.geo_logger);
+      params_provider.output_domain_sizes = &profiler->output_sizes;
+    }
+    /* Remember where the log of the node starts, so that it can be stored with cached outputs.
+     * Nodes log on the thread that executes them. */
+    geo_log::LocalGeoLogger *local_logger = params_.geo_logger == nullptr ?
+                                                nullptr :
+                                                &params_.geo_logger->local();
+    const int64_t warnings_start = local_logger ? local_logger->node_warnings().size() : 0;
+    const int64_t used_named_attributes_start =
+        local_logger ? local_logger->used_named_attributes().size() : 0;
     Clock::time_point begin = Clock::now();
     bnode.typeinfo->geometry_node_execute(params);
     Clock::time_point end = Clock::now();
+    if (profiler) {
+      profiler->finish(node);
+    }
+    if (node_state.use_output_cache && local_logger != nullptr) {
+      NodeOutputCache::NodeLog node_log;
+      for (const geo_log::NodeWithWarning &item :
+           local_logger->node_warnings().drop_front(warnings_start)) {
+        if (item.node == node) {
+          node_log.warnings.append(item.warning);
+        }
+      }
+      for (const geo_log::NodeWithUsedNamedAttribute &item :
+           local_logger->used_named_attributes().drop_front(used_named_attributes_start)) {
+        if (item.node == node) {
+          node_log.used_named_attributes.append(item.attribute);
+        }
+      }
+      params_.output_cache->store_node_log(*node_state.cache_key, std::move(node_log));
+    }
     const std::chrono::microseconds duration =
         std::chrono::duration_cast<std::chrono::microseconds>(end - begin);
     if (params_.geo_logger != nullptr) {
-      params_.geo_logger->local().log_execution_time(node, duration);
+      geo_log::LocalGeoLogger &local_logger = params_.geo_logger->local();
+      local_logger.log_execution_time(node, duration);
+      if (!input_fields.is_empty()) {
+        /* Use the optimizations that were applied when the node evaluated its input fields,
+         * instead of optimizing the field trees again. */
+        int eliminated_operations = 0;
+        Set<const fn::FieldNode *> handled_field_nodes;
+        for (const GField &field : input_fields) {
+          if (handled_field_nodes.add(&field.node())) {
+            eliminated_operations +=
+                field.node().last_optimization_stats().eliminated_operations();
+          }
+        }
+        if (eliminated_operations > 0) {
+          local_logger.log_eliminated_field_operations(node, eliminated_operations);
+        }
+      }
+    }
+    if (params_.output_cache != nullptr) {
+      params_.output_cache->log_node_duration(node_state.cache_node_id, duration);
     }
   }
 
@@ -1670,7 +2404,7 @@ class GeometryNodesEvaluator {
 
   void log_socket_value(DSocket socket, InputState &input_state, Span<void *> values)
   {
-    if (params_.geo_logger == nullptr) {
+    if (params_.geo_logger == nullptr || !params_.geo_logger->should_log_value(socket)) {
       return;
     }
 
@@ -1779,6 +2513,15 @@ bool NodeParamsProvider::can_set_output(StringRef identifier) const
   return !output_state.has_been_computed;
 }
 
+static void gather_input_field(const GPointer value, Vector<GField> &r_fields)
+{
+  if (const ValueOrFieldCPPType *type = dynamic_cast<const ValueOrFieldCPPType *>(value.type())) {
+    if (type->is_field(value.get())) {
+      r_fields.append(*type->get_field_ptr(value.get()));
+    }
+  }
+}
+
 GMutablePointer NodeParamsProvider::extract_input(StringRef identifier)
 {
   const DInputSocket socket = this->dnode.input_by_identifier(identifier);
@@ -1790,6 +2533,9 @@ GMutablePointer NodeParamsProvider::extract_input(StringRef identifier)
   SingleInputValue &single_value = *input_state.value.single;
   void *value = single_value.value;
   single_value.value = nullptr;
+  if (this->input_fields != nullptr) {
+    gather_input_field({*input_state.type, value}, *this->input_fields);
+  }
   return {*input_state.type, value};
 }
 
@@ -1807,6 +2553,9 @@ Vector<GMutablePointer> NodeParamsProvider::extract_multi_input(StringRef identi
   for (void *&value : multi_value.values) {
     BLI_assert(value != nullptr);
     ret_values.append({*input_state.type, value});
+    if (this->input_fields != nullptr) {
+      gather_input_field({*input_state.type, value}, *this->input_fields);
+    }
     value = nullptr;
   }
   return ret_values;
@@ -1837,6 +2586,13 @@ void NodeParamsProvider::set_output(StringRef identifier, GMutablePointer value)
 
   OutputState &output_state = node_state_.outputs[socket->index()];
   BLI_assert(!output_state.has_been_computed);
+  if (node_state_.use_output_cache) {
+    evaluator_.params_.output_cache->store_value(
+        cache_key_for_output(*node_state_.cache_key, socket->index()), value);
+  }
+  if (output_domain_sizes != nullptr && value.type()->is<GeometrySet>()) {
+    output_domain_sizes->add_geometry(*value.get<GeometrySet>());
+  }
   evaluator_.forward_output(socket, value, run_state_);
   output_state.has_been_computed = true;
 }
@@ -1896,6 +2652,16 @@ bool NodeParamsProvider::lazy_output_is_required(StringRef identifier) const
   return output_state.output_usage_for_execution == ValueUsage::Required;
 }
 
+bool NodeParamsProvider::output_component_is_required(
+    StringRef identifier, const GeometryComponentType component_type) const
+{
+  const DOutputSocket socket = this->dnode.output_by_identifier(identifier);
+  BLI_assert(socket);
+
+  const OutputState &output_state = node_state_.outputs[socket->index()];
+  return output_state.required_components & component_type_bit(component_type);
+}
+
 void NodeParamsProvider::set_default_remaining_outputs()
 {
   LinearAllocator<> &allocator = evaluator_.local_allocators_.local();
@@ -1919,6 +2685,205 @@ void NodeParamsProvider::set_default_remaining_outputs()
   }
 }
 
+static int64_t custom_data_memory_size(const CustomData &data, const int size)
+{
+  int64_t memory_size = 0;
+  for (const CustomDataLayer &layer : Span(data.layers, data.totlayer)) {
+    if (layer.data != nullptr) {
+      memory_size += int64_t(CustomData_sizeof(layer.type)) * size;
+    }
+  }
+  return memory_size;
+}
+
+/**
+ * Estimates the memory used by a cached value. Geometry components are often shared with the
+ * evaluated geometry, so the cache doesn't necessarily keep all of that memory alive on its own.
+ * Volume grids are not taken into account.
+ */
+static int64_t estimate_value_memory_size(const GPointer value)
+{
+  int64_t memory_size = value.type()->size();
+  if (!value.type()->is<GeometrySet>()) {
+    return memory_size;
+  }
+  const GeometrySet &geometry = *value.get<GeometrySet>();
+  if (const Mesh *mesh = geometry.get_mesh_for_read()) {
+    memory_size += custom_data_memory_size(mesh->vdata, mesh->totvert);
+    memory_size += custom_data_memory_size(mesh->edata, mesh->totedge);
+    memory_size += custom_data_memory_size(mesh->ldata, mesh->totloop);
+    memory_size += custom_data_memory_size(mesh->pdata, mesh->totpoly);
+  }
+  if (const PointCloud *pointcloud = geometry.get_pointcloud_for_read()) {
+    memory_size += custom_data_memory_size(pointcloud->pdata, pointcloud->totpoint);
+  }
+  if (const Curves *curves_id = geometry.get_curves_for_read()) {
+    const bke::CurvesGeometry &curves = bke::CurvesGeometry::wrap(curves_id->geometry);
+    memory_size += custom_data_memory_size(curves.point_data, curves.points_num());
+    memory_size += custom_data_memory_size(curves.curve_data, curves.curves_num());
+    memory_size += curves.offsets().size_in_bytes();
+  }
+  if (geometry.has_instances()) {
+    const InstancesComponent &instances = *geometry.get_component_for_read<InstancesComponent>();
+    memory_size += int64_t(instances.instances_num()) * int64_t(sizeof(float4x4) + sizeof(int));
+  }
+  return memory_size;
+}
+
+NodeOutputCache::NodeOutputCache(const int64_t memory_budget) : memory_budget_(memory_budget)
+{
+}
+
+NodeOutputCache::~NodeOutputCache()
+{
+  for (CachedValue &cached : values_.values()) {
+    cached.value.destruct();
+    MEM_freeN(cached.value.get());
+  }
+}
+
+void NodeOutputCache::begin_evaluation()
+{
+  std::lock_guard lock{mutex_};
+  evaluation_++;
+}
+
+void NodeOutputCache::end_evaluation()
+{
+  std::lock_guard lock{mutex_};
+  Vector<uint64_t> unused_keys;
+  for (auto item : values_.items()) {
+    if (item.value.last_used_evaluation != evaluation_) {
+      unused_keys.append(item.key);
+    }
+  }
+  for (const uint64_t key : unused_keys) {
+    this->remove_value(key);
+  }
+  unused_keys.clear();
+  for (auto item : node_logs_.items()) {
+    if (item.value.last_used_evaluation != evaluation_) {
+      unused_keys.append(item.key);
+    }
+  }
+  for (const uint64_t key : unused_keys) {
+    node_logs_.remove(key);
+  }
+  unused_keys.clear();
+  for (auto item : durations_.items()) {
+    if (item.value.last_used_evaluation != evaluation_) {
+      unused_keys.append(item.key);
+    }
+  }
+  for (const uint64_t key : unused_keys) {
+    durations_.remove(key);
+  }
+}
+
+bool NodeOutputCache::node_is_expensive(const uint64_t node_id)
+{
+  std::lock_guard lock{mutex_};
+  NodeDuration *node_duration = durations_.lookup_ptr(node_id);
+  if (node_duration == nullptr) {
+    return false;
+  }
+  node_duration->last_used_evaluation = evaluation_;
+  return node_duration->duration >= min_duration_to_cache;
+}
+
+void NodeOutputCache::log_node_duration(const uint64_t node_id,
+                                        const std::chrono::microseconds duration)
+{
+  std::lock_guard lock{mutex_};
+  durations_.add_overwrite(node_id, {duration, evaluation_});
+}
+
+bool NodeOutputCache::try_copy_value(const uint64_t key, const CPPType &type, void *r_value)
+{
+  std::lock_guard lock{mutex_};
+  CachedValue *cached = values_.lookup_ptr(key);
+  if (cached == nullptr || *cached->value.type() != type) {
+    return false;
+  }
+  /* Geometries share their components with the cached copy, so nodes that modify them make a
+   * copy instead of changing the cached data. */
+  type.copy_construct(cached->value.get(), r_value);
+  cached->last_used_evaluation = evaluation_;
+  cached->last_use = ++use_counter_;
+  return true;
+}
+
+void NodeOutputCache::store_value(const uint64_t key, const GPointer value)
+{
+  const int64_t memory_size = estimate_value_memory_size(value);
+  if (memory_size > memory_budget_) {
+    return;
+  }
+  const CPPType &type = *value.type();
+  void *buffer = MEM_mallocN_aligned(type.size(), type.alignment(), __func__);
+  type.copy_construct(value.get(), buffer);
+
+  std::lock_guard lock{mutex_};
+  this->remove_value(key);
+  values_.add_new(key, {{type, buffer}, memory_size, evaluation_, ++use_counter_});
+  memory_size_ += memory_size;
+
+  /* Remove the least recently used values until the cache fits into its budget again. */
+  while (memory_size_ > memory_budget_) {
+    uint64_t least_recently_used_key = key;
+    uint64_t least_recent_use = UINT64_MAX;
+    for (auto item : values_.items()) {
+      if (item.value.last_use < least_recent_use) {
+        least_recently_used_key = item.key;
+        least_recent_use = item.value.last_use;
+      }
+    }
+    this->remove_value(least_recently_used_key);
+  }
+}
+
+bool NodeOutputCache::try_copy_node_log(const uint64_t node_key, NodeLog &r_log)
+{
+  std::lock_guard lock{mutex_};
+  CachedNodeLog *cached = node_logs_.lookup_ptr(node_key);
+  if (cached == nullptr) {
+    return false;
+  }
+  r_log = cached->log;
+  cached->last_used_evaluation = evaluation_;
+  return true;
+}
+
+void NodeOutputCache::store_node_log(const uint64_t node_key, NodeLog log)
+{
+  std::lock_guard lock{mutex_};
+  CachedNodeLog *cached = node_logs_.lookup_ptr(node_key);
+  if (cached != nullptr && cached->last_stored_evaluation == evaluation_) {
+    /* Nodes that support laziness can be executed more than once in the same evaluation. */
+    cached->log.warnings.extend(log.warnings);
+    cached->log.used_named_attributes.extend(log.used_named_attributes);
+    return;
+  }
+  node_logs_.add_overwrite(node_key, {std::move(log), evaluation_, evaluation_});
+}
+
+int64_t NodeOutputCache::memory_size()
+{
+  std::lock_guard lock{mutex_};
+  return memory_size_;
+}
+
+void NodeOutputCache::remove_value(const uint64_t key)
+{
+  std::optional<CachedValue> cached = values_.pop_try(key);
+  if (!cached) {
+    return;
+  }
+  cached->value.destruct();
+  MEM_freeN(cached->value.get());
+  memory_size_ -= cached->memory_size;
+}
+
 void evaluate_geometry_nodes(GeometryNodesEvaluationParams &params)
 {
   GeometryNodesEvaluator evaluator{params};
@@ -4,6 +4,12 @@
 
 #include "BLI_generic_pointer.hh"
 #include "BLI_map.hh"
+#include "BLI_utility_mixins.hh"
+#include "BLI_vector.hh"
+
+#include <chrono>
+#include <mutex>
+#include <optional>
 
 #include "NOD_derived_node_tree.hh"
 #include "NOD_geometry_nodes_eval_log.hh"
@@ -19,6 +25,100 @@ namespace blender::modifiers::geometry_nodes {
 
 using namespace nodes::derived_node_tree_types;
 
+/**
+ * Keeps output values of expensive nodes alive between evaluations of the same modifier, so that
+ * they don't have to be computed again when only nodes further downstream changed.
+ *
+ * Values are identified by a key that combines the node, its settings and hashes of everything
+ * its inputs depend on (unlinked socket values, group inputs and the input geometry). Nodes that
+ * depend on data outside of the node tree (objects, collections, images, the scene time, ...)
+ * don't get a key, and neither does anything that depends on them.
+ *
+ * Only outputs of nodes that took a noticeable amount of time in a previous evaluation are stored.
+ * Entries that were not used in the most recent evaluation are removed afterwards, and the least
+ * recently used values are removed when the cache grows larger than its memory budget.
+ */
+class NodeOutputCache : NonCopyable, NonMovable {
+ public:
+  /** Nodes that run for less time than this are cheaper to compute again than to cache. */
+  static constexpr std::chrono::microseconds min_duration_to_cache{1000};
+  static constexpr int64_t default_memory_budget = 512 * 1024 * 1024;
+
+  /** Information the node logged when its outputs were computed, logged again on cache hits. */
+  struct NodeLog {
+    Vector<geo_log::NodeWarning> warnings;
+    Vector<geo_log::UsedNamedAttribute> used_named_attributes;
+  };
+
+ private:
+  struct CachedValue {
+    GMutablePointer value;
+    int64_t memory_size;
+    int last_used_evaluation;
+    uint64_t last_use;
+  };
+  struct CachedNodeLog {
+    NodeLog log;
+    int last_used_evaluation;
+    int last_stored_evaluation;
+  };
+  struct NodeDuration {
+    std::chrono::microseconds duration;
+    int last_used_evaluation;
+  };
+
+  std::mutex mutex_;
+  int64_t memory_budget_;
+  int64_t memory_size_ = 0;
+  int evaluation_ = 0;
+  /** Incremented for every access, to find the least recently used values. */
+  uint64_t use_counter_ = 0;
+  Map<uint64_t, CachedValue> values_;
+  Map<uint64_t, CachedNodeLog> node_logs_;
+  Map<uint64_t, NodeDuration> durations_;
+
+ public:
+  NodeOutputCache(int64_t memory_budget = default_memory_budget);
+  ~NodeOutputCache();
+
+  /** Called before and after every evaluation, unused entries are removed at the end. */
+  void begin_evaluation();
+  void end_evaluation();
+
+  /**
+   * True when the node took long enough in a previous evaluation for its outputs to be cached.
+   * \param node_id: Identifies the node independent of its input values.
+   */
+  bool node_is_expensive(uint64_t node_id);
+  void log_node_duration(uint64_t node_id, std::chrono::microseconds duration);
+
+  /** Copy-constructs a cached value into \a r_value if there is one with the given key. */
+  bool try_copy_value(uint64_t key, const CPPType &type, void *r_value);
+  /** Values that are larger than the memory budget on their own are not stored. */
+  void store_value(uint64_t key, GPointer value);
+
+  /**
+   * The log of a node is stored when its outputs are cached, so that it can be logged again
+   * when the outputs are loaded from the cache. Logs stored during the same evaluation are
+   * combined.
+   */
+  bool try_copy_node_log(uint64_t node_key, NodeLog &r_log);
+  void store_node_log(uint64_t node_key, NodeLog log);
+
+  /** Estimated memory used by the cached values. */
+  int64_t memory_size();
+
+ private:
+  void remove_value(uint64_t key);
+};
+
+/**
+ * Hashes the data of a DNA struct member by member, so that pointers are not hashed by their
+ * address. Strings are hashed by their content, other pointers are only supported when they are
+ * null. Returns nothing for unsupported data.
+ */
+std::optional<uint64_t> hash_dna_struct(const char *struct_name, const void *data);
+
 struct GeometryNodesEvaluationParams {
   blender::LinearAllocator<> allocator;
 
@@ -35,6 +135,8 @@ struct GeometryNodesEvaluationParams {
   Depsgraph *depsgraph;
   Object *self_object;
   geo_log::GeoLogger *geo_logger;
+  /** Persistent cache owned by the modifier, may be null. */
+  NodeOutputCache *output_cache = nullptr;
 
   Vector<GMutablePointer> r_output_values;
 };
@@ -0,0 +1,314 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "testing/testing.h"
+
+#include "CLG_log.h"
+
+#include "BLI_math_vector.h"
+
+#include "RNA_define.h"
+
+#include "BKE_geometry_set.hh"
+#include "BKE_idtype.h"
+#include "BKE_main.h"
+#include "BKE_mesh.h"
+#include "BKE_node.h"
+#include "BKE_node_tree_update.h"
+#include "BKE_pointcloud.h"
+
+#include "DNA_color_types.h"
+#include "DNA_genfile.h"
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_modifier_types.h"
+#include "DNA_node_types.h"
+#include "DNA_pointcloud_types.h"
+
+#include "MOD_nodes_evaluator.hh"
+
+namespace blender::modifiers::geometry_nodes::tests {
+
+static int copy_int(NodeOutputCache &cache, const uint64_t key)
+{
+  int value = -1;
+  cache.try_copy_value(key, CPPType::get<int>(), &value);
+  return value;
+}
+
+static void store_int(NodeOutputCache &cache, const uint64_t key, int value)
+{
+  cache.store_value(key, {CPPType::get<int>(), &value});
+}
+
+TEST(node_output_cache, hit_and_miss)
+{
+  NodeOutputCache cache;
+  cache.begin_evaluation();
+  store_int(cache, 1, 42);
+  int value = 0;
+  EXPECT_TRUE(cache.try_copy_value(1, CPPType::get<int>(), &value));
+  EXPECT_EQ(value, 42);
+  EXPECT_FALSE(cache.try_copy_value(2, CPPType::get<int>(), &value));
+  /* Values of a different type are not used. */
+  float float_value;
+  EXPECT_FALSE(cache.try_copy_value(1, CPPType::get<float>(), &float_value));
+  cache.end_evaluation();
+
+  /* Values are kept for the next evaluation. */
+  cache.begin_evaluation();
+  EXPECT_EQ(copy_int(cache, 1), 42);
+  store_int(cache, 1, 7);
+  EXPECT_EQ(copy_int(cache, 1), 7);
+  cache.end_evaluation();
+}
+
+TEST(node_output_cache, unused_values_are_removed)
+{
+  NodeOutputCache cache;
+  cache.begin_evaluation();
+  store_int(cache, 1, 10);
+  store_int(cache, 2, 20);
+  cache.end_evaluation();
+  EXPECT_EQ(cache.memory_size(), 2 * int64_t(sizeof(int)));
+
+  cache.begin_evaluation();
+  EXPECT_EQ(copy_int(cache, 1), 10);
+  cache.end_evaluation();
+  EXPECT_EQ(cache.memory_size(), int64_t(sizeof(int)));
+
+  cache.begin_evaluation();
+  EXPECT_EQ(copy_int(cache, 1), 10);
+  EXPECT_EQ(copy_int(cache, 2), -1);
+  cache.end_evaluation();
+}
+
+TEST(node_output_cache, expensive_nodes)
+{
+  NodeOutputCache cache;
+  cache.begin_evaluation();
+  EXPECT_FALSE(cache.node_is_expensive(1));
+  cache.log_node_duration(1, NodeOutputCache::min_duration_to_cache * 2);
+  cache.log_node_duration(2, NodeOutputCache::min_duration_to_cache / 2);
+  cache.end_evaluation();
+
+  cache.begin_evaluation();
+  EXPECT_TRUE(cache.node_is_expensive(1));
+  EXPECT_FALSE(cache.node_is_expensive(2));
+  cache.end_evaluation();
+}
+
+TEST(node_output_cache, memory_budget)
+{
+  NodeOutputCache cache(2 * sizeof(int));
+  cache.begin_evaluation();
+  store_int(cache, 1, 10);
+  store_int(cache, 2, 20);
+  EXPECT_EQ(copy_int(cache, 1), 10);
+  /* The least recently used value is removed to stay within the budget. */
+  store_int(cache, 3, 30);
+  EXPECT_EQ(cache.memory_size(), 2 * int64_t(sizeof(int)));
+  EXPECT_EQ(copy_int(cache, 1), 10);
+  EXPECT_EQ(copy_int(cache, 2), -1);
+  EXPECT_EQ(copy_int(cache, 3), 30);
+  cache.end_evaluation();
+
+  /* Values larger than the budget are not stored at all. */
+  NodeOutputCache small_cache(1);
+  small_cache.begin_evaluation();
+  store_int(small_cache, 1, 10);
+  EXPECT_EQ(copy_int(small_cache, 1), -1);
+  EXPECT_EQ(small_cache.memory_size(), 0);
+  small_cache.end_evaluation();
+}
+
+TEST(node_output_cache, node_log)
+{
+  NodeOutputCache cache;
+  cache.begin_evaluation();
+  NodeOutputCache::NodeLog log;
+  log.warnings.append({geo_log::NodeWarningType::Warning, "First"});
+  cache.store_node_log(1, log);
+  /* Logs of the same evaluation are combined. */
+  cache.store_node_log(1, log);
+  NodeOutputCache::NodeLog stored_log;
+  EXPECT_TRUE(cache.try_copy_node_log(1, stored_log));
+  EXPECT_EQ(stored_log.warnings.size(), 2);
+  EXPECT_FALSE(cache.try_copy_node_log(2, stored_log));
+  cache.end_evaluation();
+
+  /* A later evaluation replaces the log. */
+  cache.begin_evaluation();
+  cache.store_node_log(1, log);
+  EXPECT_TRUE(cache.try_copy_node_log(1, stored_log));
+  EXPECT_EQ(stored_log.warnings.size(), 1);
+  EXPECT_EQ(stored_log.warnings[0].message, "First");
+  cache.end_evaluation();
+}
+
+class NodeStorageHashTest : public testing::Test {
+ public:
+  static void SetUpTestSuite()
+  {
+    DNA_sdna_current_init();
+  }
+  static void TearDownTestSuite()
+  {
+    DNA_sdna_current_free();
+  }
+};
+
+TEST_F(NodeStorageHashTest, strings_are_hashed_by_content)
+{
+  char string_a[] = "Text";
+  char string_b[] = "Text";
+  char string_c[] = "Other";
+  NodeInputString storage_a{string_a};
+  NodeInputString storage_b{string_b};
+  NodeInputString storage_c{string_c};
+  NodeInputString storage_null{nullptr};
+
+  const std::optional<uint64_t> hash_a = hash_dna_struct("NodeInputString", &storage_a);
+  ASSERT_TRUE(hash_a.has_value());
+  EXPECT_EQ(hash_dna_struct("NodeInputString", &storage_b), hash_a);
+  EXPECT_NE(hash_dna_struct("NodeInputString", &storage_c), hash_a);
+  EXPECT_TRUE(hash_dna_struct("NodeInputString", &storage_null).has_value());
+}
+
+TEST_F(NodeStorageHashTest, pointers_to_other_data)
+{
+  CurveMapping mapping{};
+  EXPECT_TRUE(hash_dna_struct("CurveMapping", &mapping).has_value());
+
+  /* Nested structs are checked for pointers as well. */
+  CurveMapPoint point{};
+  mapping.cm[1].curve = &point;
+  EXPECT_FALSE(hash_dna_struct("CurveMapping", &mapping).has_value());
+
+  EXPECT_FALSE(hash_dna_struct("NotADNAStruct", &mapping).has_value());
+}
+
+class RequiredComponentsTest : public testing::Test {
+ public:
+  static void SetUpTestSuite()
+  {
+    CLG_init();
+    BKE_idtype_init();
+    RNA_init();
+    BKE_node_system_init();
+  }
+  static void TearDownTestSuite()
+  {
+    BKE_node_system_exit();
+    RNA_exit();
+    CLG_exit();
+  }
+};
+
+/**
+ * Evaluates a tree with a single geometry input and output. When \a prune_components is false,
+ * every node has to compute all component types, because the input of \a force_compute_node
+ * requires them.
+ */
+static GeometrySet evaluate_tree(bNodeTree &btree,
+                                 const bNode &force_compute_node,
+                                 const GeometrySet &input_geometry,
+                                 const bool prune_components)
+{
+  std::shared_ptr<const CachedDerivedNodeTree> cached_tree = nodes::get_cached_derived_node_tree(
+      btree);
+  const DerivedNodeTree &tree = cached_tree->tree();
+  const DTreeContext *root_context = &tree.root_context();
+  const NodeTreeRef &tree_ref = root_context->tree();
+  nodes::NodeMultiFunctions mf_by_node{tree};
+  NodesModifierData nmd{};
+
+  GeometryNodesEvaluationParams params;
+  const NodeRef &input_node = *tree_ref.nodes_by_type("NodeGroupInput").first();
+  const NodeRef &output_node = *tree_ref.nodes_by_type("NodeGroupOutput").first();
+  params.input_values.add_new(
+      {root_context, &input_node.output(0)},
+      params.allocator.construct<GeometrySet>(input_geometry).release());
+  params.output_sockets.append({root_context, &output_node.input(0)});
+  if (!prune_components) {
+    for (const NodeRef *node_ref : tree_ref.nodes()) {
+      if (node_ref->bnode() == &force_compute_node) {
+        params.force_compute_sockets.append(DInputSocket{root_context, &node_ref->input(0)});
+      }
+    }
+  }
+  params.mf_by_node = &mf_by_node;
+  params.modifier_ = &nmd;
+  params.depsgraph = nullptr;
+  params.self_object = nullptr;
+  params.geo_logger = nullptr;
+  evaluate_geometry_nodes(params);
+
+  GeometrySet result = std::move(*params.r_output_values[0].get<GeometrySet>());
+  for (GMutablePointer value : params.r_output_values) {
+    value.destruct();
+  }
+  return result;
+}
+
+TEST_F(RequiredComponentsTest, pruning_keeps_group_output)
+{
+  /* Group Input -> Realize Instances -> Separate Components (Mesh) -> Group Output. */
+  Main *bmain = BKE_main_new();
+  bNodeTree *btree = ntreeAddTree(bmain, "Tree", "GeometryNodeTree");
+  ntreeAddSocketInterface(btree, SOCK_IN, "NodeSocketGeometry", "Geometry");
+  ntreeAddSocketInterface(btree, SOCK_OUT, "NodeSocketGeometry", "Geometry");
+  bNode *input_node = nodeAddNode(nullptr, btree, "NodeGroupInput");
+  bNode *output_node = nodeAddNode(nullptr, btree, "NodeGroupOutput");
+  bNode *realize_node = nodeAddNode(nullptr, btree, "GeometryNodeRealizeInstances");
+  bNode *separate_node = nodeAddNode(nullptr, btree, "GeometryNodeSeparateComponents");
+  BKE_ntree_update_main_tree(bmain, btree, nullptr);
+  nodeAddLink(btree,
+              input_node,
+              static_cast<bNodeSocket *>(input_node->outputs.first),
+              realize_node,
+              nodeFindSocket(realize_node, SOCK_IN, "Geometry"));
+  nodeAddLink(btree,
+              realize_node,
+              nodeFindSocket(realize_node, SOCK_OUT, "Geometry"),
+              separate_node,
+              nodeFindSocket(separate_node, SOCK_IN, "Geometry"));
+  nodeAddLink(btree,
+              separate_node,
+              nodeFindSocket(separate_node, SOCK_OUT, "Mesh"),
+              output_node,
+              static_cast<bNodeSocket *>(output_node->inputs.first));
+  BKE_ntree_update_main_tree(bmain, btree, nullptr);
+
+  /* Two instances of a geometry with a mesh and a point cloud. */
+  Mesh *mesh = BKE_mesh_new_nomain(3, 0, 0, 0, 0);
+  for (const int i : IndexRange(mesh->totvert)) {
+    copy_v3_fl3(mesh->mvert[i].co, float(i), 0.0f, 0.0f);
+  }
+  GeometrySet instance_geometry = GeometrySet::create_with_mesh(mesh);
+  instance_geometry.replace_pointcloud(BKE_pointcloud_new_nomain(2));
+  GeometrySet input_geometry;
+  InstancesComponent &instances = input_geometry.get_component_for_write<InstancesComponent>();
+  const int handle = instances.add_reference(InstanceReference{instance_geometry});
+  instances.add_instance(handle, float4x4::identity());
+  instances.add_instance(handle, float4x4::from_location({0.0f, 0.0f, 1.0f}));
+
+  const GeometrySet pruned = evaluate_tree(*btree, *separate_node, input_geometry, true);
+  const GeometrySet full = evaluate_tree(*btree, *separate_node, input_geometry, false);
+
+  EXPECT_FALSE(pruned.has_pointcloud());
+  EXPECT_FALSE(full.has_pointcloud());
+  EXPECT_FALSE(pruned.has_instances());
+  const Mesh *pruned_mesh = pruned.get_mesh_for_read();
+  const Mesh *full_mesh = full.get_mesh_for_read();
+  ASSERT_NE(pruned_mesh, nullptr);
+  ASSERT_NE(full_mesh, nullptr);
+  ASSERT_EQ(pruned_mesh->totvert, 6);
+  ASSERT_EQ(full_mesh->totvert, 6);
+  for (const int i : IndexRange(pruned_mesh->totvert)) {
+    EXPECT_EQ(float3(pruned_mesh->mvert[i].co), float3(full_mesh->mvert[i].co));
+  }
+
+  BKE_main_free(bmain);
+}
+
+}  // namespace blender::modifiers::geometry_nodes::tests
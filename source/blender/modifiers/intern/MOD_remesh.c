@@ -145,7 +145,13 @@ static Mesh *modifyMesh(ModifierData *md, const ModifierEvalContext *UNUSED(ctx)
     if (rmd->voxel_size == 0.0f) {
       return NULL;
     }
-    result = BKE_mesh_remesh_voxel(mesh, rmd->voxel_size, rmd->adaptivity, 0.0f);
+    /* The level set is cached in the runtime data, so changing only the adaptivity or smooth
+     * shading doesn't convert the input mesh to a volume again. */
+    result = BKE_mesh_remesh_voxel_cached(mesh,
+                                          rmd->voxel_size,
+                                          rmd->adaptivity,
+                                          0.0f,
+                                          (struct RemeshVoxelCache **)&md->runtime);
     if (result == NULL) {
       return NULL;
     }
@@ -220,6 +226,19 @@ static Mesh *modifyMesh(ModifierData *UNUSED(md),
 
 #endif /* !WITH_MOD_REMESH */
 
+static void freeRuntimeData(void *runtime_data)
+{
+  if (runtime_data != NULL) {
+    BKE_mesh_remesh_voxel_cache_free((struct RemeshVoxelCache *)runtime_data);
+  }
+}
+
+static void freeData(ModifierData *md)
+{
+  freeRuntimeData(md->runtime);
+  md->runtime = NULL;
+}
+
 static void panel_draw(const bContext *UNUSED(C), Panel *panel)
 {
   uiLayout *layout = panel->layout;
@@ -288,14 +307,14 @@ ModifierTypeInfo modifierType_Remesh = {
 
     /* initData */ initData,
     /* requiredDataMask */ NULL,
-    /* freeData */ NULL,
+    /* freeData */ freeData,
     /* isDisabled */ NULL,
     /* updateDepsgraph */ NULL,
     /* dependsOnTime */ NULL,
     /* dependsOnNormals */ NULL,
     /* foreachIDLink */ NULL,
     /* foreachTexLink */ NULL,
-    /* freeRuntimeData */ NULL,
+    /* freeRuntimeData */ freeRuntimeData,
     /* panelRegister */ panelRegister,
     /* blendWrite */ NULL,
     /* blendRead */ NULL,
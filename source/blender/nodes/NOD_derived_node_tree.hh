@@ -11,6 +11,8 @@
  * "instanced" multiple times when it is in a node group that is used multiple times.
  */
 
+#include <memory>
+
 #include "BLI_function_ref.hh"
 #include "BLI_vector_set.hh"
 
@@ -214,8 +216,42 @@ class DerivedNodeTree {
                                          FunctionRef<void(DNode)> callback) const;
 };
 
+/**
+ * A derived node tree that owns the node tree refs it uses. It is cached on the root node tree and
+ * can be reused until one of the used node trees changes.
+ */
+class CachedDerivedNodeTree : NonCopyable, NonMovable {
+ private:
+  NodeTreeRefMap tree_refs_;
+  DerivedNodeTree tree_;
+  /**
+   * The update counters of all used node trees at construction time. Node groups come after the
+   * node tree that first uses them, so they are only accessed while they are known to exist.
+   */
+  Vector<std::pair<const bNodeTree *, uint64_t>> update_counters_;
+
+ public:
+  CachedDerivedNodeTree(bNodeTree &btree);
+
+  const DerivedNodeTree &tree() const
+  {
+    return tree_;
+  }
+
+  /** \return True when none of the used node trees changed since construction. */
+  bool is_up_to_date() const;
+};
+
+/**
+ * Get a derived node tree for the given root node tree. It is reused from previous calls when
+ * possible. This is thread-safe. The returned pointer keeps the derived tree alive, even if it is
+ * removed from the cache in the meantime.
+ */
+std::shared_ptr<const CachedDerivedNodeTree> get_cached_derived_node_tree(bNodeTree &btree);
+
 namespace derived_node_tree_types {
 using namespace node_tree_ref_types;
+using nodes::CachedDerivedNodeTree;
 using nodes::DerivedNodeTree;
 using nodes::DInputSocket;
 using nodes::DNode;
@@ -99,6 +99,8 @@ class GeoNodeExecParamsProvider {
   virtual bool output_is_required(StringRef identifier) const = 0;
   virtual bool lazy_require_input(StringRef identifier) = 0;
   virtual bool lazy_output_is_required(StringRef identifier) const = 0;
+  virtual bool output_component_is_required(StringRef identifier,
+                                            GeometryComponentType component_type) const = 0;
 
   virtual void set_default_remaining_outputs() = 0;
 };
@@ -274,6 +276,16 @@ class GeoNodeExecParams {
     return provider_->lazy_output_is_required(identifier);
   }
 
+  /**
+   * Returns false when no node linked to the geometry output uses the given component type, so
+   * the node does not have to compute it. The geometry may still contain the component.
+   */
+  bool output_component_is_required(StringRef identifier,
+                                    const GeometryComponentType component_type) const
+  {
+    return provider_->output_component_is_required(identifier, component_type);
+  }
+
   /**
    * Get the node that is currently being executed.
    */
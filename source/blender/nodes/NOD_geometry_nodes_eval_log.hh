@@ -29,6 +29,8 @@
 #include "FN_field.hh"
 
 #include <chrono>
+#include <iosfwd>
+#include <optional>
 
 struct SpaceNode;
 struct SpaceSpreadsheet;
@@ -160,6 +162,50 @@ struct NodeWithExecutionTime {
   std::chrono::microseconds exec_time;
 };
 
+struct NodeWithEliminatedFieldOperations {
+  DNode node;
+  int amount;
+};
+
+/** Number of elements in each domain of some geometry. */
+struct GeometryDomainSizes {
+  /** Mesh vertices, point cloud points and curve control points. */
+  int64_t points = 0;
+  int64_t edges = 0;
+  int64_t faces = 0;
+  int64_t face_corners = 0;
+  int64_t curves = 0;
+  int64_t instances = 0;
+
+  void add_geometry(const GeometrySet &geometry_set);
+};
+
+/**
+ * Detailed measurements of a single node execution. Those are only recorded when profiling is
+ * enabled, see #GeoLogger::profiling_enabled.
+ */
+struct NodeExecutionProfile {
+  /** Wall clock time range of the execution, relative to the creation of the #GeoLogger. */
+  std::chrono::nanoseconds begin;
+  std::chrono::nanoseconds end;
+  /** Index of the thread that executed the node. */
+  int thread_id;
+  /**
+   * CPU time of the entire process during the execution, summed over all threads. This includes
+   * work that the node spawned on other threads, but also other nodes executed at the same time.
+   */
+  std::chrono::microseconds cpu_time;
+  /** Change of the allocated memory during the execution. Same caveat as for #cpu_time. */
+  int64_t memory_delta;
+  /** Sizes of all geometries that the node outputs. */
+  GeometryDomainSizes output_sizes;
+};
+
+struct NodeWithExecutionProfile {
+  DNode node;
+  NodeExecutionProfile profile;
+};
+
 struct NodeWithDebugMessage {
   DNode node;
   std::string message;
@@ -191,6 +237,7 @@ struct NodeWithUsedNamedAttribute {
 
 class GeoLogger;
 class ModifierLog;
+class NodeExecutionProfiler;
 
 /** Every thread has its own local logger to avoid having to communicate between threads during
  * evaluation. After evaluation the individual logs are combined. */
@@ -204,6 +251,8 @@ class LocalGeoLogger {
   Vector<ValueOfSockets> values_;
   Vector<NodeWithWarning> node_warnings_;
   Vector<NodeWithExecutionTime> node_exec_times_;
+  Vector<NodeWithExecutionProfile> node_profiles_;
+  Vector<NodeWithEliminatedFieldOperations> node_eliminated_field_operations_;
   Vector<NodeWithDebugMessage> node_debug_messages_;
   Vector<NodeWithUsedNamedAttribute> used_named_attributes_;
 
@@ -219,12 +268,27 @@ class LocalGeoLogger {
   void log_multi_value_socket(DSocket socket, Span<GPointer> values);
   void log_node_warning(DNode node, NodeWarningType type, std::string message);
   void log_execution_time(DNode node, std::chrono::microseconds exec_time);
+  void log_execution_profile(DNode node, const NodeExecutionProfile &profile);
+  /**
+   * Log how many operations are removed from the input fields of the node when they are
+   * evaluated, because they are duplicates or constant.
+   */
+  void log_eliminated_field_operations(DNode node, int amount);
   void log_used_named_attribute(DNode node, std::string attribute_name, NamedAttributeUsage usage);
   /**
    * Log a message that will be displayed in the node editor next to the node.
    * This should only be used for debugging purposes and not to display information to users.
    */
   void log_debug_message(DNode node, std::string message);
+
+  Span<NodeWithWarning> node_warnings() const
+  {
+    return node_warnings_;
+  }
+  Span<NodeWithUsedNamedAttribute> used_named_attributes() const
+  {
+    return used_named_attributes_;
+  }
 };
 
 /** The root logger class. */
@@ -236,20 +300,58 @@ class GeoLogger {
    * slowdowns.
    */
   Set<DSocket> log_full_sockets_;
+  /**
+   * When set, socket values are only logged for sockets in these tree contexts, or when they are
+   * in #log_full_sockets_. Values are the most expensive part of logging and are only displayed
+   * for the contexts that are open in an editor.
+   */
+  std::optional<Set<const DTreeContext *>> value_contexts_;
   threading::EnumerableThreadSpecific<LocalGeoLogger> threadlocals_;
 
   /* These are only optional since they don't have a default constructor. */
   std::unique_ptr<GeometryValueLog> input_geometry_log_;
   std::unique_ptr<GeometryValueLog> output_geometry_log_;
 
+  bool profiling_enabled_;
+  std::chrono::steady_clock::time_point start_time_;
+
   friend LocalGeoLogger;
   friend ModifierLog;
+  friend NodeExecutionProfiler;
 
  public:
-  GeoLogger(Set<DSocket> log_full_sockets)
+  GeoLogger(Set<DSocket> log_full_sockets, const bool profiling_enabled = false)
       : log_full_sockets_(std::move(log_full_sockets)),
-        threadlocals_([this]() { return LocalGeoLogger(*this); })
+        threadlocals_([this]() { return LocalGeoLogger(*this); }),
+        profiling_enabled_(profiling_enabled),
+        start_time_(std::chrono::steady_clock::now())
+  {
+  }
+
+  /**
+   * When true, every node execution should be measured with a #NodeExecutionProfiler. That has
+   * a small overhead for every node.
+   */
+  bool profiling_enabled() const
   {
+    return profiling_enabled_;
+  }
+
+  /**
+   * Only log socket values for the given tree contexts. Other data like warnings and execution
+   * times is still logged for all nodes, because it is aggregated in group nodes and the modifier.
+   */
+  void log_values_only_in(Set<const DTreeContext *> contexts)
+  {
+    value_contexts_ = std::move(contexts);
+  }
+
+  bool should_log_value(const DSocket socket) const
+  {
+    if (!value_contexts_.has_value()) {
+      return true;
+    }
+    return value_contexts_->contains(socket.context()) || log_full_sockets_.contains(socket);
   }
 
   void log_input_geometry(const GeometrySet &geometry)
@@ -278,6 +380,25 @@ class GeoLogger {
   }
 };
 
+/**
+ * Measures a single node execution for #NodeExecutionProfile. Construct it right before the node
+ * is executed and call #finish afterwards.
+ */
+class NodeExecutionProfiler {
+ private:
+  GeoLogger &logger_;
+  std::chrono::steady_clock::time_point begin_;
+  std::chrono::microseconds cpu_time_begin_;
+  int64_t memory_begin_;
+
+ public:
+  /** Sizes of the geometries that the node outputs, has to be filled by the caller. */
+  GeometryDomainSizes output_sizes;
+
+  NodeExecutionProfiler(GeoLogger &logger);
+  void finish(DNode node);
+};
+
 /** Contains information that has been logged for one specific socket. */
 class SocketLog {
  private:
@@ -301,6 +422,7 @@ class NodeLog {
   Vector<std::string, 0> debug_messages_;
   Vector<UsedNamedAttribute, 0> used_named_attributes_;
   std::chrono::microseconds exec_time_;
+  int eliminated_field_operations_ = 0;
 
   friend ModifierLog;
 
@@ -339,9 +461,22 @@ class NodeLog {
     return exec_time_;
   }
 
+  int eliminated_field_operations() const
+  {
+    return eliminated_field_operations_;
+  }
+
   Vector<const GeometryAttributeInfo *> lookup_available_attributes() const;
 };
 
+/** A profiled node execution that does not reference the evaluated node tree anymore. */
+struct NodeProfileLog {
+  std::string node_name;
+  /** Names of the group nodes that contain the node, separated by slashes. */
+  std::string tree_path;
+  NodeExecutionProfile profile;
+};
+
 /** Contains information that has been logged for one specific tree. */
 class TreeLog {
  private:
@@ -355,6 +490,11 @@ class TreeLog {
   const NodeLog *lookup_node_log(const bNode &node) const;
   const TreeLog *lookup_child_log(StringRef node_name) const;
   void foreach_node_log(FunctionRef<void(const NodeLog &)> fn) const;
+  /**
+   * True when a value has been logged for any socket in this tree, ignoring nested groups.
+   * Values are only logged for tree contexts that are displayed, see #GeoLogger.
+   */
+  bool has_socket_values() const;
 };
 
 /** Contains information about an entire geometry nodes evaluation. */
@@ -369,9 +509,23 @@ class ModifierLog {
   std::unique_ptr<GeometryValueLog> input_geometry_log_;
   std::unique_ptr<GeometryValueLog> output_geometry_log_;
 
+  /** Only contains data when profiling was enabled. Sorted by start time. */
+  Vector<NodeProfileLog> node_profiles_;
+
  public:
   ModifierLog(GeoLogger &logger);
 
+  Span<NodeProfileLog> node_profiles() const
+  {
+    return node_profiles_;
+  }
+
+  /**
+   * Write all node profiles in the Chrome trace event format, which can be opened in
+   * `chrome://tracing` or Perfetto.
+   */
+  void write_chrome_trace(std::ostream &stream) const;
+
   const TreeLog &root_tree() const
   {
     return *root_tree_logs_;
@@ -401,6 +555,7 @@ class ModifierLog {
                                   const DTreeContext &tree_context);
   NodeLog &lookup_or_add_node_log(LogByTreeContext &log_by_tree_context, DNode node);
   SocketLog &lookup_or_add_socket_log(LogByTreeContext &log_by_tree_context, DSocket socket);
+  static std::string tree_path_for_profile(const DTreeContext &tree_context);
 };
 
 }  // namespace blender::nodes::geometry_nodes_eval_log
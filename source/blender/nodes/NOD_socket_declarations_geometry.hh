@@ -2,6 +2,8 @@
 
 #pragma once
 
+#include <optional>
+
 #include "BKE_geometry_set.hh"
 
 #include "NOD_socket_declarations.hh"
@@ -15,6 +17,8 @@ class Geometry : public SocketDeclaration {
   blender::Vector<GeometryComponentType> supported_types_;
   bool only_realized_data_ = false;
   bool only_instances_ = false;
+  bool propagates_components_ = false;
+  std::optional<GeometryComponentType> propagated_component_type_;
 
   friend GeometryBuilder;
 
@@ -28,6 +32,8 @@ class Geometry : public SocketDeclaration {
   Span<GeometryComponentType> supported_types() const;
   bool only_realized_data() const;
   bool only_instances() const;
+  bool propagates_components() const;
+  std::optional<GeometryComponentType> propagated_component_type() const;
 };
 
 class GeometryBuilder : public SocketDeclarationBuilder<Geometry> {
@@ -36,6 +42,16 @@ class GeometryBuilder : public SocketDeclarationBuilder<Geometry> {
   GeometryBuilder &supported_type(blender::Vector<GeometryComponentType> supported_types);
   GeometryBuilder &only_realized_data(bool value = true);
   GeometryBuilder &only_instances(bool value = true);
+  /**
+   * The components of this input are only passed on to the geometry outputs of the node (possibly
+   * modified), so the node does not need components that are not required by its outputs.
+   */
+  GeometryBuilder &propagates_components(bool value = true);
+  /**
+   * This output only contains components of the given type from the inputs that propagate their
+   * components, so only that type is required from those inputs for this output.
+   */
+  GeometryBuilder &propagated_component_type(GeometryComponentType type);
 };
 
 }  // namespace blender::nodes::decl
@@ -76,6 +76,20 @@ void separate_geometry(GeometrySet &geometry_set,
                        bool invert,
                        bool &r_is_error);
 
+/**
+ * Remove points that are closer than the minimum distance to another point. A point is kept
+ * when there is no kept point with a lower index close to it in the same or an earlier phase.
+ *
+ * The points are sorted into a grid with a cell size of the minimum distance. The cells are split
+ * into eight phases based on the parity of their coordinates. Cells in the same phase are never
+ * neighbors, so points in different cells of the same phase can't be closer than the minimum
+ * distance, and all cells of a phase can be processed in parallel. Since the result only depends
+ * on the grid, it is the same for any number of threads.
+ */
+void update_elimination_mask_for_close_points(Span<float3> positions,
+                                              float minimum_distance,
+                                              MutableSpan<bool> elimination_mask);
+
 std::optional<CustomDataType> node_data_type_to_custom_data_type(eNodeSocketDatatype type);
 std::optional<CustomDataType> node_socket_to_custom_data_type(const bNodeSocket &socket);
 
@@ -15,7 +15,7 @@ NODE_STORAGE_FUNCS(NodeGeometryAttributeCapture)
 
 static void node_declare(NodeDeclarationBuilder &b)
 {
-  b.add_input<decl::Geometry>(N_("Geometry"));
+  b.add_input<decl::Geometry>(N_("Geometry")).propagates_components();
   b.add_input<decl::Vector>(N_("Value")).supports_field();
   b.add_input<decl::Float>(N_("Value"), "Value_001").supports_field();
   b.add_input<decl::Color>(N_("Value"), "Value_002").supports_field();
@@ -49,6 +49,22 @@ static void node_geo_exec(GeoNodeExecParams params)
   GeometrySet profile_set = params.extract_input<GeometrySet>("Profile Curve");
   const bool fill_caps = params.extract_input<bool>("Fill Caps");
 
+  const bool mesh_required = params.output_component_is_required("Mesh",
+                                                                 GEO_COMPONENT_TYPE_MESH);
+  const bool instances_required = params.output_component_is_required(
+      "Mesh", GEO_COMPONENT_TYPE_INSTANCES);
+  if (!mesh_required && !instances_required) {
+    params.set_default_remaining_outputs();
+    return;
+  }
+  /* Don't convert curves whose meshes are not used. */
+  if (!instances_required) {
+    curve_set.remove<InstancesComponent>();
+  }
+  if (!mesh_required) {
+    curve_set.remove<CurveComponent>();
+  }
+
   bool has_curves = false;
   curve_set.modify_geometry_sets([&](GeometrySet &geometry_set) {
     if (geometry_set.has_curves()) {
@@ -1,6 +1,5 @@
 /* SPDX-License-Identifier: GPL-2.0-or-later */
 
-#include "BLI_kdtree.h"
 #include "BLI_noise.hh"
 #include "BLI_rand.hh"
 #include "BLI_task.hh"
@@ -22,6 +21,93 @@
 
 #include "node_geometry_util.hh"
 
+namespace blender::nodes {
+
+/**
+ * Convert a position in units of the grid cell size to a cell coordinate. Values are clamped, so
+ * that the conversion and the coordinates of neighbor cells never overflow. Points outside of that
+ * range share the outermost cells, which only means that they are compared with more points.
+ * Points that are close to each other still end up in the same or in neighboring cells. NaN
+ * values end up in the lowest cell.
+ */
+static int grid_cell_coordinate(const float value)
+{
+  const float limit = float(1 << 30);
+  const float clamped = value >= -limit ? std::min(value, limit) : -limit;
+  return int(std::floor(clamped));
+}
+
+void update_elimination_mask_for_close_points(const Span<float3> positions,
+                                              const float minimum_distance,
+                                              MutableSpan<bool> elimination_mask)
+{
+  if (minimum_distance <= 0.0f) {
+    return;
+  }
+
+  const float cell_size_inv = 1.0f / minimum_distance;
+  auto cell_of_position = [&](const float3 &position) {
+    return int3(grid_cell_coordinate(position.x * cell_size_inv),
+                grid_cell_coordinate(position.y * cell_size_inv),
+                grid_cell_coordinate(position.z * cell_size_inv));
+  };
+
+  /* Points are added in index order, so they are processed in that order within every cell. */
+  Map<int3, Vector<int>> point_indices_by_cell;
+  for (const int i : positions.index_range()) {
+    if (!elimination_mask[i]) {
+      point_indices_by_cell.lookup_or_add_default(cell_of_position(positions[i])).append(i);
+    }
+  }
+
+  std::array<Vector<int3>, 8> cells_by_phase;
+  for (const int3 &cell : point_indices_by_cell.keys()) {
+    const int phase = (cell.x & 1) | ((cell.y & 1) << 1) | ((cell.z & 1) << 2);
+    cells_by_phase[phase].append(cell);
+  }
+
+  Array<bool> is_kept(positions.size(), false);
+  const float minimum_distance_sq = minimum_distance * minimum_distance;
+
+  auto is_close_to_kept_point = [&](const int3 &cell, const float3 &position) {
+    for (const int z : IndexRange(3)) {
+      for (const int y : IndexRange(3)) {
+        for (const int x : IndexRange(3)) {
+          const Vector<int> *neighbor_indices = point_indices_by_cell.lookup_ptr(
+              cell + int3(x - 1, y - 1, z - 1));
+          if (neighbor_indices == nullptr) {
+            continue;
+          }
+          for (const int neighbor : *neighbor_indices) {
+            if (is_kept[neighbor] &&
+                math::distance_squared(position, positions[neighbor]) < minimum_distance_sq) {
+              return true;
+            }
+          }
+        }
+      }
+    }
+    return false;
+  };
+
+  for (const Span<int3> cells : cells_by_phase) {
+    threading::parallel_for(cells.index_range(), 64, [&](const IndexRange range) {
+      for (const int3 &cell : cells.slice(range)) {
+        for (const int i : point_indices_by_cell.lookup(cell)) {
+          if (is_close_to_kept_point(cell, positions[i])) {
+            elimination_mask[i] = true;
+          }
+          else {
+            is_kept[i] = true;
+          }
+        }
+      }
+    });
+  }
+}
+
+}  // namespace blender::nodes
+
 namespace blender::nodes::node_geo_distribute_points_on_faces_cc {
 
 static void node_declare(NodeDeclarationBuilder &b)
@@ -97,6 +183,12 @@ static float3 normal_to_euler_rotation(const float3 normal)
   return rotation;
 }
 
+/**
+ * Every triangle uses its own random number generator, seeded only by the triangle index and the
+ * user seed. That way the triangles can be sampled in parallel and the result does not depend on
+ * the number of threads. The generator is used in the same order when counting the points and
+ * when sampling them, so both passes agree on the number of points in each triangle.
+ */
 static void sample_mesh_surface(const Mesh &mesh,
                                 const float base_density,
                                 const Span<float> density_factors,
@@ -108,17 +200,14 @@ static void sample_mesh_surface(const Mesh &mesh,
   const Span<MLoopTri> looptris{BKE_mesh_runtime_looptri_ensure(&mesh),
                                 BKE_mesh_runtime_looptri_len(&mesh)};
 
-  for (const int looptri_index : looptris.index_range()) {
+  auto looptri_point_amount = [&](const int looptri_index, RandomNumberGenerator &rng) {
     const MLoopTri &looptri = looptris[looptri_index];
     const int v0_loop = looptri.tri[0];
     const int v1_loop = looptri.tri[1];
     const int v2_loop = looptri.tri[2];
-    const int v0_index = mesh.mloop[v0_loop].v;
-    const int v1_index = mesh.mloop[v1_loop].v;
-    const int v2_index = mesh.mloop[v2_loop].v;
-    const float3 v0_pos = float3(mesh.mvert[v0_index].co);
-    const float3 v1_pos = float3(mesh.mvert[v1_index].co);
-    const float3 v2_pos = float3(mesh.mvert[v2_index].co);
+    const float3 v0_pos = float3(mesh.mvert[mesh.mloop[v0_loop].v].co);
+    const float3 v1_pos = float3(mesh.mvert[mesh.mloop[v1_loop].v].co);
+    const float3 v2_pos = float3(mesh.mvert[mesh.mloop[v2_loop].v].co);
 
     float looptri_density_factor = 1.0f;
     if (!density_factors.is_empty()) {
@@ -129,70 +218,53 @@ static void sample_mesh_surface(const Mesh &mesh,
     }
     const float area = area_tri_v3(v0_pos, v1_pos, v2_pos);
 
-    const int looptri_seed = noise::hash(looptri_index, seed);
-    RandomNumberGenerator looptri_rng(looptri_seed);
-
-    const int point_amount = looptri_rng.round_probabilistic(area * base_density *
-                                                             looptri_density_factor);
+    return rng.round_probabilistic(area * base_density * looptri_density_factor);
+  };
 
-    for (int i = 0; i < point_amount; i++) {
-      const float3 bary_coord = looptri_rng.get_barycentric_coordinates();
-      float3 point_pos;
-      interp_v3_v3v3v3(point_pos, v0_pos, v1_pos, v2_pos, bary_coord);
-      r_positions.append(point_pos);
-      r_bary_coords.append(bary_coord);
-      r_looptri_indices.append(looptri_index);
+  /* Count the points in every triangle first, so that every triangle can write its points into
+   * a known range of the result. */
+  Array<int> offsets(looptris.size() + 1);
+  threading::parallel_for(looptris.index_range(), 1024, [&](const IndexRange range) {
+    for (const int looptri_index : range) {
+      RandomNumberGenerator looptri_rng(noise::hash(looptri_index, seed));
+      offsets[looptri_index] = looptri_point_amount(looptri_index, looptri_rng);
     }
+  });
+  int offset = 0;
+  for (const int looptri_index : looptris.index_range()) {
+    const int point_amount = offsets[looptri_index];
+    offsets[looptri_index] = offset;
+    offset += point_amount;
   }
-}
-
-BLI_NOINLINE static KDTree_3d *build_kdtree(Span<float3> positions)
-{
-  KDTree_3d *kdtree = BLI_kdtree_3d_new(positions.size());
-
-  int i_point = 0;
-  for (const float3 position : positions) {
-    BLI_kdtree_3d_insert(kdtree, i_point, position);
-    i_point++;
-  }
-
-  BLI_kdtree_3d_balance(kdtree);
-  return kdtree;
-}
-
-BLI_NOINLINE static void update_elimination_mask_for_close_points(
-    Span<float3> positions, const float minimum_distance, MutableSpan<bool> elimination_mask)
-{
-  if (minimum_distance <= 0.0f) {
-    return;
-  }
-
-  KDTree_3d *kdtree = build_kdtree(positions);
-  BLI_SCOPED_DEFER([&]() { BLI_kdtree_3d_free(kdtree); });
-
-  for (const int i : positions.index_range()) {
-    if (elimination_mask[i]) {
-      continue;
+  offsets.last() = offset;
+
+  r_positions.resize(offset);
+  r_bary_coords.resize(offset);
+  r_looptri_indices.resize(offset);
+  MutableSpan<float3> positions = r_positions;
+  MutableSpan<float3> bary_coords = r_bary_coords;
+  MutableSpan<int> looptri_indices = r_looptri_indices;
+
+  threading::parallel_for(looptris.index_range(), 1024, [&](const IndexRange range) {
+    for (const int looptri_index : range) {
+      RandomNumberGenerator looptri_rng(noise::hash(looptri_index, seed));
+      /* Advance the generator in the same way as when counting the points. */
+      looptri_point_amount(looptri_index, looptri_rng);
+
+      const MLoopTri &looptri = looptris[looptri_index];
+      const float3 v0_pos = float3(mesh.mvert[mesh.mloop[looptri.tri[0]].v].co);
+      const float3 v1_pos = float3(mesh.mvert[mesh.mloop[looptri.tri[1]].v].co);
+      const float3 v2_pos = float3(mesh.mvert[mesh.mloop[looptri.tri[2]].v].co);
+
+      for (const int i : IndexRange(offsets[looptri_index],
+                                    offsets[looptri_index + 1] - offsets[looptri_index])) {
+        const float3 bary_coord = looptri_rng.get_barycentric_coordinates();
+        interp_v3_v3v3v3(positions[i], v0_pos, v1_pos, v2_pos, bary_coord);
+        bary_coords[i] = bary_coord;
+        looptri_indices[i] = looptri_index;
+      }
     }
-
-    struct CallbackData {
-      int index;
-      MutableSpan<bool> elimination_mask;
-    } callback_data = {i, elimination_mask};
-
-    BLI_kdtree_3d_range_search_cb(
-        kdtree,
-        positions[i],
-        minimum_distance,
-        [](void *user_data, int index, const float *UNUSED(co), float UNUSED(dist_sq)) {
-          CallbackData &callback_data = *static_cast<CallbackData *>(user_data);
-          if (index != callback_data.index) {
-            callback_data.elimination_mask[index] = true;
-          }
-          return true;
-        },
-        &callback_data);
-  }
+  });
 }
 
 BLI_NOINLINE static void update_elimination_mask_based_on_density_factors(
@@ -204,30 +276,33 @@ BLI_NOINLINE static void update_elimination_mask_based_on_density_factors(
 {
   const Span<MLoopTri> looptris{BKE_mesh_runtime_looptri_ensure(&mesh),
                                 BKE_mesh_runtime_looptri_len(&mesh)};
-  for (const int i : bary_coords.index_range()) {
-    if (elimination_mask[i]) {
-      continue;
-    }
+  threading::parallel_for(bary_coords.index_range(), 2048, [&](const IndexRange range) {
+    for (const int i : range) {
+      if (elimination_mask[i]) {
+        continue;
+      }
 
-    const MLoopTri &looptri = looptris[looptri_indices[i]];
-    const float3 bary_coord = bary_coords[i];
+      const MLoopTri &looptri = looptris[looptri_indices[i]];
+      const float3 bary_coord = bary_coords[i];
 
-    const int v0_loop = looptri.tri[0];
-    const int v1_loop = looptri.tri[1];
-    const int v2_loop = looptri.tri[2];
+      const int v0_loop = looptri.tri[0];
+      const int v1_loop = looptri.tri[1];
+      const int v2_loop = looptri.tri[2];
 
-    const float v0_density_factor = std::max(0.0f, density_factors[v0_loop]);
-    const float v1_density_factor = std::max(0.0f, density_factors[v1_loop]);
-    const float v2_density_factor = std::max(0.0f, density_factors[v2_loop]);
+      const float v0_density_factor = std::max(0.0f, density_factors[v0_loop]);
+      const float v1_density_factor = std::max(0.0f, density_factors[v1_loop]);
+      const float v2_density_factor = std::max(0.0f, density_factors[v2_loop]);
 
-    const float probablity = v0_density_factor * bary_coord.x + v1_density_factor * bary_coord.y +
-                             v2_density_factor * bary_coord.z;
+      const float probablity = v0_density_factor * bary_coord.x +
+                               v1_density_factor * bary_coord.y +
+                               v2_density_factor * bary_coord.z;
 
-    const float hash = noise::hash_float_to_float(bary_coord);
-    if (hash > probablity) {
-      elimination_mask[i] = true;
+      const float hash = noise::hash_float_to_float(bary_coord);
+      if (hash > probablity) {
+        elimination_mask[i] = true;
+      }
     }
-  }
+  });
 }
 
 BLI_NOINLINE static void eliminate_points_based_on_mask(const Span<bool> elimination_mask,
@@ -251,35 +326,30 @@ BLI_NOINLINE static void interpolate_attribute(const Mesh &mesh,
                                                const GVArray &source_data,
                                                GMutableSpan output_data)
 {
-  switch (source_domain) {
-    case ATTR_DOMAIN_POINT: {
-      bke::mesh_surface_sample::sample_point_attribute(mesh,
-                                                       looptri_indices,
-                                                       bary_coords,
-                                                       source_data,
-                                                       IndexMask(output_data.size()),
-                                                       output_data);
-      break;
-    }
-    case ATTR_DOMAIN_CORNER: {
-      bke::mesh_surface_sample::sample_corner_attribute(mesh,
-                                                        looptri_indices,
-                                                        bary_coords,
-                                                        source_data,
-                                                        IndexMask(output_data.size()),
-                                                        output_data);
-      break;
-    }
-    case ATTR_DOMAIN_FACE: {
-      bke::mesh_surface_sample::sample_face_attribute(
-          mesh, looptri_indices, source_data, IndexMask(output_data.size()), output_data);
-      break;
-    }
-    default: {
-      /* Not supported currently. */
-      return;
+  threading::parallel_for(IndexRange(output_data.size()), 4096, [&](const IndexRange range) {
+    const IndexMask mask(range);
+    switch (source_domain) {
+      case ATTR_DOMAIN_POINT: {
+        bke::mesh_surface_sample::sample_point_attribute(
+            mesh, looptri_indices, bary_coords, source_data, mask, output_data);
+        break;
+      }
+      case ATTR_DOMAIN_CORNER: {
+        bke::mesh_surface_sample::sample_corner_attribute(
+            mesh, looptri_indices, bary_coords, source_data, mask, output_data);
+        break;
+      }
+      case ATTR_DOMAIN_FACE: {
+        bke::mesh_surface_sample::sample_face_attribute(
+            mesh, looptri_indices, source_data, mask, output_data);
+        break;
+      }
+      default: {
+        /* Not supported currently. */
+        return;
+      }
     }
-  }
+  });
 }
 
 BLI_NOINLINE static void propagate_existing_attributes(
@@ -356,31 +426,33 @@ BLI_NOINLINE static void compute_attribute_outputs(const MeshComponent &mesh_com
   const Span<MLoopTri> looptris{BKE_mesh_runtime_looptri_ensure(&mesh),
                                 BKE_mesh_runtime_looptri_len(&mesh)};
 
-  for (const int i : bary_coords.index_range()) {
-    const int looptri_index = looptri_indices[i];
-    const MLoopTri &looptri = looptris[looptri_index];
-    const float3 &bary_coord = bary_coords[i];
-
-    const int v0_index = mesh.mloop[looptri.tri[0]].v;
-    const int v1_index = mesh.mloop[looptri.tri[1]].v;
-    const int v2_index = mesh.mloop[looptri.tri[2]].v;
-    const float3 v0_pos = float3(mesh.mvert[v0_index].co);
-    const float3 v1_pos = float3(mesh.mvert[v1_index].co);
-    const float3 v2_pos = float3(mesh.mvert[v2_index].co);
-
-    ids[i] = noise::hash(noise::hash_float(bary_coord), looptri_index);
-
-    float3 normal;
-    if (!normals.is_empty() || !rotations.is_empty()) {
-      normal_tri_v3(normal, v0_pos, v1_pos, v2_pos);
-    }
-    if (!normals.is_empty()) {
-      normals[i] = normal;
-    }
-    if (!rotations.is_empty()) {
-      rotations[i] = normal_to_euler_rotation(normal);
+  threading::parallel_for(bary_coords.index_range(), 2048, [&](const IndexRange range) {
+    for (const int i : range) {
+      const int looptri_index = looptri_indices[i];
+      const MLoopTri &looptri = looptris[looptri_index];
+      const float3 &bary_coord = bary_coords[i];
+
+      const int v0_index = mesh.mloop[looptri.tri[0]].v;
+      const int v1_index = mesh.mloop[looptri.tri[1]].v;
+      const int v2_index = mesh.mloop[looptri.tri[2]].v;
+      const float3 v0_pos = float3(mesh.mvert[v0_index].co);
+      const float3 v1_pos = float3(mesh.mvert[v1_index].co);
+      const float3 v2_pos = float3(mesh.mvert[v2_index].co);
+
+      ids[i] = noise::hash(noise::hash_float(bary_coord), looptri_index);
+
+      float3 normal;
+      if (!normals.is_empty() || !rotations.is_empty()) {
+        normal_tri_v3(normal, v0_pos, v1_pos, v2_pos);
+      }
+      if (!normals.is_empty()) {
+        normals[i] = normal;
+      }
+      if (!rotations.is_empty()) {
+        rotations[i] = normal_to_euler_rotation(normal);
+      }
     }
-  }
+  });
 
   id_attribute.save();
 
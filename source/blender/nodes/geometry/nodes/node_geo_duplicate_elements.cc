@@ -1071,7 +1071,7 @@ static void duplicate_instances(GeometrySet &geometry_set,
     const int old_handle = src_instances.instance_reference_handles()[i_selection];
     const InstanceReference reference = src_instances.references()[old_handle];
     const int new_handle = dst_instances.add_reference(reference);
-    const float4x4 transform = src_instances.instance_transforms()[i_selection];
+    const float4x4 transform = src_instances.instance_transform(i_selection);
     dst_instances.instance_transforms().slice(range).fill(transform);
     dst_instances.instance_reference_handles().slice(range).fill(new_handle);
   }
@@ -1,9 +1,13 @@
 /* SPDX-License-Identifier: GPL-2.0-or-later */
 
+#include "BLI_task.hh"
+
 #include "DNA_mesh_types.h"
 #include "DNA_meshdata_types.h"
 
 #include "BKE_mesh.h"
+#include "BKE_mesh_mapping.h"
+#include "BKE_mesh_runtime.h"
 
 #include "node_geometry_util.hh"
 
@@ -35,10 +39,14 @@ class EdgeNeighborCountFieldInput final : public GeometryFieldInput {
         return {};
       }
 
-      Array<int> face_count(mesh->totedge, 0);
-      for (const int i : IndexRange(mesh->totloop)) {
-        face_count[mesh->mloop[i].e]++;
-      }
+      /* Copy the counts, the cached map can be freed while the virtual array is still used. */
+      const MeshTopologyMap &edge_to_poly_map = *BKE_mesh_runtime_edge_poly_map_ensure(mesh);
+      Array<int> face_count(mesh->totedge);
+      threading::parallel_for(face_count.index_range(), 4096, [&](const IndexRange range) {
+        for (const int i : range) {
+          face_count[i] = edge_to_poly_map.offsets[i + 1] - edge_to_poly_map.offsets[i];
+        }
+      });
 
       return mesh_component.attribute_try_adapt_domain<int>(
           VArray<int>::ForContainer(std::move(face_count)), ATTR_DOMAIN_EDGE, domain);
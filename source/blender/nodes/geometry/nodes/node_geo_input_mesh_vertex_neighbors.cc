@@ -1,9 +1,13 @@
 /* SPDX-License-Identifier: GPL-2.0-or-later */
 
+#include "BLI_task.hh"
+
 #include "DNA_mesh_types.h"
 #include "DNA_meshdata_types.h"
 
 #include "BKE_mesh.h"
+#include "BKE_mesh_mapping.h"
+#include "BKE_mesh_runtime.h"
 
 #include "node_geometry_util.hh"
 
@@ -29,12 +33,15 @@ static VArray<int> construct_vertex_count_gvarray(const MeshComponent &component
   }
 
   if (domain == ATTR_DOMAIN_POINT) {
-    Array<int> vertices(mesh->totvert, 0);
-    for (const int i : IndexRange(mesh->totedge)) {
-      vertices[mesh->medge[i].v1]++;
-      vertices[mesh->medge[i].v2]++;
-    }
-    return VArray<int>::ForContainer(std::move(vertices));
+    /* Copy the counts, the cached map can be freed while the virtual array is still used. */
+    const MeshTopologyMap &vert_to_edge_map = *BKE_mesh_runtime_vert_edge_map_ensure(mesh);
+    Array<int> counts(mesh->totvert);
+    threading::parallel_for(counts.index_range(), 4096, [&](const IndexRange range) {
+      for (const int i : range) {
+        counts[i] = vert_to_edge_map.offsets[i + 1] - vert_to_edge_map.offsets[i];
+      }
+    });
+    return VArray<int>::ForContainer(std::move(counts));
   }
   return {};
 }
@@ -78,12 +85,15 @@ static VArray<int> construct_face_count_gvarray(const MeshComponent &component,
   }
 
   if (domain == ATTR_DOMAIN_POINT) {
-    Array<int> vertices(mesh->totvert, 0);
-    for (const int i : IndexRange(mesh->totloop)) {
-      int vertex = mesh->mloop[i].v;
-      vertices[vertex]++;
-    }
-    return VArray<int>::ForContainer(std::move(vertices));
+    /* Copy the counts, the cached map can be freed while the virtual array is still used. */
+    const MeshTopologyMap &vert_to_poly_map = *BKE_mesh_runtime_vert_poly_map_ensure(mesh);
+    Array<int> counts(mesh->totvert);
+    threading::parallel_for(counts.index_range(), 4096, [&](const IndexRange range) {
+      for (const int i : range) {
+        counts[i] = vert_to_poly_map.offsets[i + 1] - vert_to_poly_map.offsets[i];
+      }
+    });
+    return VArray<int>::ForContainer(std::move(counts));
   }
   return {};
 }
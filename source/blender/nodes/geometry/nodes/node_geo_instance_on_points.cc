@@ -130,8 +130,7 @@ static void add_instances_from_component(
             dst_handle = handle_mapping[src_handle];
 
             /* Take transforms of the source instance into account. */
-            mul_m4_m4_post(dst_transform.values,
-                           src_instances->instance_transforms()[index].values);
+            mul_m4_m4_post(dst_transform.values, src_instances->instance_transform(index).values);
           }
         }
       }
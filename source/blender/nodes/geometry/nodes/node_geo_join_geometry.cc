@@ -8,7 +8,7 @@ namespace blender::nodes::node_geo_join_geometry_cc {
 
 static void node_declare(NodeDeclarationBuilder &b)
 {
-  b.add_input<decl::Geometry>(N_("Geometry")).multi_input();
+  b.add_input<decl::Geometry>(N_("Geometry")).multi_input().propagates_components();
   b.add_output<decl::Geometry>(N_("Geometry"));
 }
 
@@ -112,13 +112,13 @@ static void join_components(Span<const InstancesComponent *> src_components, Geo
       handle_map[src_handle] = dst_component.add_reference(src_references[src_handle]);
     }
 
-    Span<float4x4> src_transforms = src_component->instance_transforms();
+    const VArray<float4x4> src_transforms = src_component->instance_transforms();
     Span<int> src_reference_handles = src_component->instance_reference_handles();
 
     for (const int i : src_transforms.index_range()) {
       const int src_handle = src_reference_handles[i];
       const int dst_handle = handle_map[src_handle];
-      const float4x4 &transform = src_transforms[i];
+      const float4x4 transform = src_transforms[i];
       dst_component.add_instance(dst_handle, transform);
     }
   }
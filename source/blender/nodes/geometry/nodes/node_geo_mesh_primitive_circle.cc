@@ -180,6 +180,11 @@ static Mesh *create_circle_mesh(const float radius,
 
 static void node_geo_exec(GeoNodeExecParams params)
 {
+  if (!params.output_component_is_required("Mesh", GEO_COMPONENT_TYPE_MESH)) {
+    params.set_default_remaining_outputs();
+    return;
+  }
+
   const NodeGeometryMeshCircle &storage = node_storage(params.node());
   const GeometryNodeMeshCircleFillType fill = (GeometryNodeMeshCircleFillType)storage.fill_type;
 
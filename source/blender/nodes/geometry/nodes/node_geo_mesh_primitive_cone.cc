@@ -780,6 +780,11 @@ static void node_layout(uiLayout *layout, bContext *UNUSED(C), PointerRNA *ptr)
 
 static void node_geo_exec(GeoNodeExecParams params)
 {
+  if (!params.output_component_is_required("Mesh", GEO_COMPONENT_TYPE_MESH)) {
+    params.set_default_remaining_outputs();
+    return;
+  }
+
   const NodeGeometryMeshCone &storage = node_storage(params.node());
   const GeometryNodeMeshCircleFillType fill = (GeometryNodeMeshCircleFillType)storage.fill_type;
 
@@ -94,6 +94,11 @@ static Mesh *create_cube_mesh(const float3 size,
 
 static void node_geo_exec(GeoNodeExecParams params)
 {
+  if (!params.output_component_is_required("Mesh", GEO_COMPONENT_TYPE_MESH)) {
+    params.set_default_remaining_outputs();
+    return;
+  }
+
   const float3 size = params.extract_input<float3>("Size");
   const int verts_x = params.extract_input<int>("Vertices X");
   const int verts_y = params.extract_input<int>("Vertices Y");
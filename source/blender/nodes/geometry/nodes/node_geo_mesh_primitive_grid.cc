@@ -180,6 +180,11 @@ static void node_declare(NodeDeclarationBuilder &b)
 
 static void node_geo_exec(GeoNodeExecParams params)
 {
+  if (!params.output_component_is_required("Mesh", GEO_COMPONENT_TYPE_MESH)) {
+    params.set_default_remaining_outputs();
+    return;
+  }
+
   const float size_x = params.extract_input<float>("Size X");
   const float size_y = params.extract_input<float>("Size Y");
   const int verts_x = params.extract_input<int>("Vertices X");
@@ -128,6 +128,11 @@ static void node_gather_link_searches(GatherLinkSearchOpParams &params)
 
 static void node_geo_exec(GeoNodeExecParams params)
 {
+  if (!params.output_component_is_required("Mesh", GEO_COMPONENT_TYPE_MESH)) {
+    params.set_default_remaining_outputs();
+    return;
+  }
+
   const NodeGeometryMeshLine &storage = node_storage(params.node());
   const GeometryNodeMeshLineMode mode = (GeometryNodeMeshLineMode)storage.mode;
   const GeometryNodeMeshLineCountMode count_mode = (GeometryNodeMeshLineCountMode)
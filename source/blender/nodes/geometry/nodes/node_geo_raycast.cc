@@ -1,11 +1,15 @@
 /* SPDX-License-Identifier: GPL-2.0-or-later */
 
+#include "BLI_task.hh"
+
 #include "DNA_mesh_types.h"
 
 #include "BKE_attribute_math.hh"
 #include "BKE_bvhutils.h"
 #include "BKE_mesh_sample.hh"
 
+#include "GEO_instances_bvh.hh"
+
 #include "UI_interface.h"
 #include "UI_resources.h"
 
@@ -22,7 +26,6 @@ NODE_STORAGE_FUNCS(NodeGeometryRaycast)
 static void node_declare(NodeDeclarationBuilder &b)
 {
   b.add_input<decl::Geometry>(N_("Target Geometry"))
-      .only_realized_data()
       .supported_type(GEO_COMPONENT_TYPE_MESH);
 
   b.add_input<decl::Vector>(N_("Attribute")).hide_value().supports_field();
@@ -127,79 +130,77 @@ static eAttributeMapMode get_map_mode(GeometryNodeRaycastMapMode map_mode)
   }
 }
 
-static void raycast_to_mesh(IndexMask mask,
-                            const Mesh &mesh,
-                            const VArray<float3> &ray_origins,
-                            const VArray<float3> &ray_directions,
-                            const VArray<float> &ray_lengths,
-                            const MutableSpan<bool> r_hit,
-                            const MutableSpan<int> r_hit_indices,
-                            const MutableSpan<float3> r_hit_positions,
-                            const MutableSpan<float3> r_hit_normals,
-                            const MutableSpan<float> r_hit_distances,
-                            int &hit_count)
+static void raycast_to_instances(IndexMask mask,
+                                 const geometry::InstancesBVH &bvh,
+                                 const VArray<float3> &ray_origins,
+                                 const VArray<float3> &ray_directions,
+                                 const VArray<float> &ray_lengths,
+                                 const MutableSpan<bool> r_hit,
+                                 const MutableSpan<int> r_hit_instances,
+                                 const MutableSpan<int> r_hit_indices,
+                                 const MutableSpan<float3> r_hit_positions,
+                                 const MutableSpan<float3> r_local_hit_positions,
+                                 const MutableSpan<float3> r_hit_normals,
+                                 const MutableSpan<float> r_hit_distances)
 {
-  BVHTreeFromMesh tree_data;
-  BKE_bvhtree_from_mesh_get(&tree_data, &mesh, BVHTREE_FROM_LOOPTRI, 4);
-  BLI_SCOPED_DEFER([&]() { free_bvhtree_from_mesh(&tree_data); });
-
-  if (tree_data.tree == nullptr) {
-    return;
-  }
-  /* We shouldn't be rebuilding the BVH tree when calling this function in parallel. */
-  BLI_assert(tree_data.cached);
-
-  for (const int i : mask) {
-    const float ray_length = ray_lengths[i];
-    const float3 ray_origin = ray_origins[i];
-    const float3 ray_direction = math::normalize(ray_directions[i]);
-
-    BVHTreeRayHit hit;
-    hit.index = -1;
-    hit.dist = ray_length;
-    if (BLI_bvhtree_ray_cast(tree_data.tree,
-                             ray_origin,
-                             ray_direction,
-                             0.0f,
-                             &hit,
-                             tree_data.raycast_callback,
-                             &tree_data) != -1) {
-      hit_count++;
-      if (!r_hit.is_empty()) {
-        r_hit[i] = hit.index >= 0;
-      }
-      if (!r_hit_indices.is_empty()) {
-        /* The caller must be able to handle invalid indices anyway, so don't clamp this value. */
-        r_hit_indices[i] = hit.index;
-      }
-      if (!r_hit_positions.is_empty()) {
-        r_hit_positions[i] = hit.co;
-      }
-      if (!r_hit_normals.is_empty()) {
-        r_hit_normals[i] = hit.no;
-      }
-      if (!r_hit_distances.is_empty()) {
-        r_hit_distances[i] = hit.dist;
-      }
-    }
-    else {
-      if (!r_hit.is_empty()) {
-        r_hit[i] = false;
-      }
-      if (!r_hit_indices.is_empty()) {
-        r_hit_indices[i] = -1;
-      }
-      if (!r_hit_positions.is_empty()) {
-        r_hit_positions[i] = float3(0.0f, 0.0f, 0.0f);
-      }
-      if (!r_hit_normals.is_empty()) {
-        r_hit_normals[i] = float3(0.0f, 0.0f, 0.0f);
+  threading::parallel_for(mask.index_range(), 256, [&](const IndexRange range) {
+    for (const int i : mask.slice(range)) {
+      const float ray_length = ray_lengths[i];
+      const float3 ray_origin = ray_origins[i];
+      const float3 ray_direction = math::normalize(ray_directions[i]);
+
+      const geometry::InstancesBVH::RayHit hit = bvh.raycast(
+          ray_origin, ray_direction, ray_length);
+      if (hit.instance != -1) {
+        if (!r_hit.is_empty()) {
+          r_hit[i] = hit.index >= 0;
+        }
+        if (!r_hit_instances.is_empty()) {
+          r_hit_instances[i] = hit.instance;
+        }
+        if (!r_hit_indices.is_empty()) {
+          /* The caller must be able to handle invalid indices anyway, so don't clamp this
+           * value. */
+          r_hit_indices[i] = hit.index;
+        }
+        if (!r_hit_positions.is_empty()) {
+          r_hit_positions[i] = hit.co;
+        }
+        if (!r_local_hit_positions.is_empty()) {
+          r_local_hit_positions[i] = hit.local_co;
+        }
+        if (!r_hit_normals.is_empty()) {
+          r_hit_normals[i] = hit.no;
+        }
+        if (!r_hit_distances.is_empty()) {
+          r_hit_distances[i] = hit.dist;
+        }
       }
-      if (!r_hit_distances.is_empty()) {
-        r_hit_distances[i] = ray_length;
+      else {
+        if (!r_hit.is_empty()) {
+          r_hit[i] = false;
+        }
+        if (!r_hit_instances.is_empty()) {
+          r_hit_instances[i] = -1;
+        }
+        if (!r_hit_indices.is_empty()) {
+          r_hit_indices[i] = -1;
+        }
+        if (!r_hit_positions.is_empty()) {
+          r_hit_positions[i] = float3(0.0f, 0.0f, 0.0f);
+        }
+        if (!r_local_hit_positions.is_empty()) {
+          r_local_hit_positions[i] = float3(0.0f, 0.0f, 0.0f);
+        }
+        if (!r_hit_normals.is_empty()) {
+          r_hit_normals[i] = float3(0.0f, 0.0f, 0.0f);
+        }
+        if (!r_hit_distances.is_empty()) {
+          r_hit_distances[i] = ray_length;
+        }
       }
     }
-  }
+  });
 }
 
 class RaycastFunction : public fn::MultiFunction {
@@ -207,10 +208,18 @@ class RaycastFunction : public fn::MultiFunction {
   GeometrySet target_;
   GeometryNodeRaycastMapMode mapping_;
 
-  /** The field for data evaluated on the target geometry. */
-  std::optional<GeometryComponentFieldContext> target_context_;
-  std::unique_ptr<FieldEvaluator> target_evaluator_;
-  const GVArray *target_data_ = nullptr;
+  /** Instances are not realized, every unique mesh has a single tree. */
+  std::unique_ptr<geometry::InstancesBVH> bvh_;
+
+  /** The field for data evaluated on every unique mesh in the target geometry. */
+  struct SourceData {
+    MeshComponent component;
+    std::optional<GeometryComponentFieldContext> context;
+    std::unique_ptr<FieldEvaluator> evaluator;
+    const GVArray *data = nullptr;
+  };
+  Array<SourceData> source_data_;
+  const CPPType *target_data_type_ = nullptr;
 
   /* Always evaluate the target domain data on the face corner domain because it contains the most
    * information. Eventually this could be exposed as an option or determined automatically from
@@ -224,6 +233,7 @@ class RaycastFunction : public fn::MultiFunction {
       : target_(std::move(target)), mapping_((GeometryNodeRaycastMapMode)mapping)
   {
     target_.ensure_owns_direct_data();
+    bvh_ = std::make_unique<geometry::InstancesBVH>(target_, BVHTREE_FROM_LOOPTRI, false);
     this->evaluate_target_field(std::move(src_field));
     signature_ = create_signature();
     this->set_signature(&signature_);
@@ -239,69 +249,68 @@ class RaycastFunction : public fn::MultiFunction {
     signature.single_output<float3>("Hit Position");
     signature.single_output<float3>("Hit Normal");
     signature.single_output<float>("Distance");
-    if (target_data_) {
-      signature.single_output("Attribute", target_data_->type());
+    if (target_data_type_) {
+      signature.single_output("Attribute", *target_data_type_);
     }
     return signature.build();
   }
 
   void call(IndexMask mask, fn::MFParams params, fn::MFContext UNUSED(context)) const override
   {
-    /* Hit positions are always necessary for retrieving the attribute from the target if that
-     * output is required, so always retrieve a span from the evaluator in that case (it's
-     * expected that the evaluator is more likely to have a spare buffer that could be used). */
-    MutableSpan<float3> hit_positions =
-        (target_data_) ? params.uninitialized_single_output<float3>(4, "Hit Position") :
-                         params.uninitialized_single_output_if_required<float3>(4, "Hit Position");
+    const bool transfer_attribute = target_data_type_ != nullptr &&
+                                    params.single_output_is_required(7, "Attribute");
 
+    /* The local hit positions are necessary for retrieving the attribute from the target. */
+    Array<int> hit_instances;
     Array<int> hit_indices;
-    if (target_data_) {
+    Array<float3> local_hit_positions;
+    if (transfer_attribute) {
+      hit_instances.reinitialize(mask.min_array_size());
       hit_indices.reinitialize(mask.min_array_size());
+      local_hit_positions.reinitialize(mask.min_array_size());
     }
 
-    BLI_assert(target_.has_mesh());
-    const Mesh &mesh = *target_.get_mesh_for_read();
-
-    int hit_count = 0;
-    raycast_to_mesh(mask,
-                    mesh,
-                    params.readonly_single_input<float3>(0, "Source Position"),
-                    params.readonly_single_input<float3>(1, "Ray Direction"),
-                    params.readonly_single_input<float>(2, "Ray Length"),
-                    params.uninitialized_single_output_if_required<bool>(3, "Is Hit"),
-                    hit_indices,
-                    hit_positions,
-                    params.uninitialized_single_output_if_required<float3>(5, "Hit Normal"),
-                    params.uninitialized_single_output_if_required<float>(6, "Distance"),
-                    hit_count);
-
-    if (target_data_) {
-      IndexMask hit_mask;
-      Vector<int64_t> hit_mask_indices;
-      if (hit_count < mask.size()) {
-        /* Not all rays hit the target. Create a corrected mask to avoid transferring attribute
-         * data to invalid indices. An alternative would be handling -1 indices in a separate case
-         * in #MeshAttributeInterpolator, but since it already has an IndexMask in its constructor,
-         * it's simpler to use that. */
-        hit_mask_indices.reserve(hit_count);
-        for (const int64_t i : mask) {
-          if (hit_indices[i] != -1) {
-            hit_mask_indices.append(i);
-          }
-          hit_mask = IndexMask(hit_mask_indices);
-        }
-      }
-      else {
-        hit_mask = mask;
-      }
+    raycast_to_instances(
+        mask,
+        *bvh_,
+        params.readonly_single_input<float3>(0, "Source Position"),
+        params.readonly_single_input<float3>(1, "Ray Direction"),
+        params.readonly_single_input<float>(2, "Ray Length"),
+        params.uninitialized_single_output_if_required<bool>(3, "Is Hit"),
+        hit_instances,
+        hit_indices,
+        params.uninitialized_single_output_if_required<float3>(4, "Hit Position"),
+        local_hit_positions,
+        params.uninitialized_single_output_if_required<float3>(5, "Hit Normal"),
+        params.uninitialized_single_output_if_required<float>(6, "Distance"));
+
+    if (!transfer_attribute) {
+      return;
+    }
 
-      GMutableSpan result = params.uninitialized_single_output_if_required(7, "Attribute");
-      if (!result.is_empty()) {
-        MeshAttributeInterpolator interp(&mesh, hit_mask, hit_positions, hit_indices);
-        result.type().value_initialize_indices(result.data(), mask);
-        interp.sample_data(*target_data_, domain_, get_map_mode(mapping_), result);
+    GMutableSpan result = params.uninitialized_single_output(7, "Attribute");
+    result.type().value_initialize_indices(result.data(), mask);
+
+    /* Transfer the attribute separately for every mesh that was hit, using the positions in the
+     * local space of the instances. Rays that didn't hit anything are skipped, which is simpler
+     * than handling -1 indices in #MeshAttributeInterpolator. */
+    const Span<geometry::InstancesBVH::Instance> instances = bvh_->instances();
+    Array<Vector<int64_t>> hit_mask_indices(source_data_.size());
+    for (const int64_t i : mask) {
+      if (hit_indices[i] != -1) {
+        hit_mask_indices[instances[hit_instances[i]].source].append(i);
       }
     }
+    for (const int source_index : source_data_.index_range()) {
+      const Span<int64_t> indices = hit_mask_indices[source_index];
+      if (indices.is_empty()) {
+        continue;
+      }
+      const Mesh *mesh = bvh_->sources()[source_index].mesh;
+      MeshAttributeInterpolator interp(mesh, IndexMask(indices), local_hit_positions, hit_indices);
+      interp.sample_data(
+          *source_data_[source_index].data, domain_, get_map_mode(mapping_), result);
+    }
   }
 
  private:
@@ -310,13 +319,20 @@ class RaycastFunction : public fn::MultiFunction {
     if (!src_field) {
       return;
     }
-    const MeshComponent &mesh_component = *target_.get_component_for_read<MeshComponent>();
-    target_context_.emplace(GeometryComponentFieldContext{mesh_component, domain_});
-    const int domain_num = mesh_component.attribute_domain_num(domain_);
-    target_evaluator_ = std::make_unique<FieldEvaluator>(*target_context_, domain_num);
-    target_evaluator_->add(std::move(src_field));
-    target_evaluator_->evaluate();
-    target_data_ = &target_evaluator_->get_evaluated(0);
+    target_data_type_ = &src_field.cpp_type();
+    const Span<geometry::InstancesBVH::Source> sources = bvh_->sources();
+    source_data_.reinitialize(sources.size());
+    for (const int i : sources.index_range()) {
+      SourceData &source_data = source_data_[i];
+      source_data.component.replace(const_cast<Mesh *>(sources[i].mesh),
+                                    GeometryOwnershipType::ReadOnly);
+      source_data.context.emplace(GeometryComponentFieldContext{source_data.component, domain_});
+      const int domain_num = source_data.component.attribute_domain_num(domain_);
+      source_data.evaluator = std::make_unique<FieldEvaluator>(*source_data.context, domain_num);
+      source_data.evaluator->add(src_field);
+      source_data.evaluator->evaluate();
+      source_data.data = &source_data.evaluator->get_evaluated(0);
+    }
   }
 };
 
@@ -394,12 +410,12 @@ static void node_geo_exec(GeoNodeExecParams params)
     return;
   }
 
-  if (!target.has_mesh()) {
+  if (!target.has_mesh() && !target.has_instances()) {
     params.set_default_remaining_outputs();
     return;
   }
 
-  if (target.get_mesh_for_read()->totpoly == 0) {
+  if (!target.has_instances() && target.get_mesh_for_read()->totpoly == 0) {
     params.error_message_add(NodeWarningType::Error, TIP_("The target mesh must have faces"));
     params.set_default_remaining_outputs();
     return;
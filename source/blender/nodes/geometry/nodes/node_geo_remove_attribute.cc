@@ -8,7 +8,7 @@ namespace blender::nodes::node_geo_remove_attribute_cc {
 
 static void node_declare(NodeDeclarationBuilder &b)
 {
-  b.add_input<decl::Geometry>(N_("Geometry"));
+  b.add_input<decl::Geometry>(N_("Geometry")).propagates_components();
   b.add_input<decl::String>(N_("Name")).is_attribute_name();
   b.add_output<decl::Geometry>(N_("Geometry"));
 }
@@ -6,12 +6,14 @@ namespace blender::nodes::node_geo_separate_components_cc {
 
 static void node_declare(NodeDeclarationBuilder &b)
 {
-  b.add_input<decl::Geometry>(N_("Geometry"));
-  b.add_output<decl::Geometry>(N_("Mesh"));
-  b.add_output<decl::Geometry>(N_("Point Cloud"));
-  b.add_output<decl::Geometry>(N_("Curve"));
-  b.add_output<decl::Geometry>(N_("Volume"));
-  b.add_output<decl::Geometry>(N_("Instances"));
+  b.add_input<decl::Geometry>(N_("Geometry")).propagates_components();
+  b.add_output<decl::Geometry>(N_("Mesh")).propagated_component_type(GEO_COMPONENT_TYPE_MESH);
+  b.add_output<decl::Geometry>(N_("Point Cloud"))
+      .propagated_component_type(GEO_COMPONENT_TYPE_POINT_CLOUD);
+  b.add_output<decl::Geometry>(N_("Curve")).propagated_component_type(GEO_COMPONENT_TYPE_CURVE);
+  b.add_output<decl::Geometry>(N_("Volume")).propagated_component_type(GEO_COMPONENT_TYPE_VOLUME);
+  b.add_output<decl::Geometry>(N_("Instances"))
+      .propagated_component_type(GEO_COMPONENT_TYPE_INSTANCES);
 }
 
 static void node_geo_exec(GeoNodeExecParams params)
@@ -24,19 +26,19 @@ static void node_geo_exec(GeoNodeExecParams params)
   GeometrySet curves;
   GeometrySet instances;
 
-  if (geometry_set.has<MeshComponent>()) {
+  if (geometry_set.has<MeshComponent>() && params.output_is_required("Mesh")) {
     meshes.add(*geometry_set.get_component_for_read<MeshComponent>());
   }
-  if (geometry_set.has<PointCloudComponent>()) {
+  if (geometry_set.has<PointCloudComponent>() && params.output_is_required("Point Cloud")) {
     point_clouds.add(*geometry_set.get_component_for_read<PointCloudComponent>());
   }
-  if (geometry_set.has<CurveComponent>()) {
+  if (geometry_set.has<CurveComponent>() && params.output_is_required("Curve")) {
     curves.add(*geometry_set.get_component_for_read<CurveComponent>());
   }
-  if (geometry_set.has<VolumeComponent>()) {
+  if (geometry_set.has<VolumeComponent>() && params.output_is_required("Volume")) {
     volumes.add(*geometry_set.get_component_for_read<VolumeComponent>());
   }
-  if (geometry_set.has<InstancesComponent>()) {
+  if (geometry_set.has<InstancesComponent>() && params.output_is_required("Instances")) {
     instances.add(*geometry_set.get_component_for_read<InstancesComponent>());
   }
 
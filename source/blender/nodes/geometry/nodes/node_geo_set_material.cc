@@ -21,7 +21,8 @@ static void node_declare(NodeDeclarationBuilder &b)
       .supported_type({GEO_COMPONENT_TYPE_MESH,
                        GEO_COMPONENT_TYPE_VOLUME,
                        GEO_COMPONENT_TYPE_POINT_CLOUD,
-                       GEO_COMPONENT_TYPE_CURVE});
+                       GEO_COMPONENT_TYPE_CURVE})
+      .propagates_components();
   b.add_input<decl::Bool>(N_("Selection")).default_value(true).hide_value().supports_field();
   b.add_input<decl::Material>(N_("Material")).hide_label();
   b.add_output<decl::Geometry>(N_("Geometry"));
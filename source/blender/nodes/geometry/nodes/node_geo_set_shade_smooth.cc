@@ -6,7 +6,9 @@ namespace blender::nodes::node_geo_set_shade_smooth_cc {
 
 static void node_declare(NodeDeclarationBuilder &b)
 {
-  b.add_input<decl::Geometry>(N_("Geometry")).supported_type(GEO_COMPONENT_TYPE_MESH);
+  b.add_input<decl::Geometry>(N_("Geometry"))
+      .supported_type(GEO_COMPONENT_TYPE_MESH)
+      .propagates_components();
   b.add_input<decl::Bool>(N_("Selection")).default_value(true).hide_value().supports_field();
   b.add_input<decl::Bool>(N_("Shade Smooth")).supports_field().default_value(true);
   b.add_output<decl::Geometry>(N_("Geometry"));
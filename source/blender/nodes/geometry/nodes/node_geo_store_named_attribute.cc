@@ -15,7 +15,7 @@ NODE_STORAGE_FUNCS(NodeGeometryStoreNamedAttribute)
 
 static void node_declare(NodeDeclarationBuilder &b)
 {
-  b.add_input<decl::Geometry>(N_("Geometry"));
+  b.add_input<decl::Geometry>(N_("Geometry")).propagates_components();
   b.add_input<decl::String>(N_("Name")).is_attribute_name();
   b.add_input<decl::Vector>(N_("Value"), "Value_Vector").supports_field();
   b.add_input<decl::Float>(N_("Value"), "Value_Float").supports_field();
@@ -177,7 +177,7 @@ namespace blender::nodes::node_geo_transform_cc {
 
 static void node_declare(NodeDeclarationBuilder &b)
 {
-  b.add_input<decl::Geometry>(N_("Geometry"));
+  b.add_input<decl::Geometry>(N_("Geometry")).propagates_components();
   b.add_input<decl::Vector>(N_("Translation")).subtype(PROP_TRANSLATION);
   b.add_input<decl::Vector>(N_("Rotation")).subtype(PROP_EULER);
   b.add_input<decl::Vector>(N_("Scale")).default_value({1, 1, 1}).subtype(PROP_XYZ);
@@ -0,0 +1,94 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "testing/testing.h"
+
+#include "BLI_array.hh"
+#include "BLI_rand.hh"
+#include "BLI_task.hh"
+
+#include "node_geometry_util.hh"
+
+namespace blender::nodes::tests {
+
+static Array<bool> eliminate_close_points(const Span<float3> positions,
+                                          const float minimum_distance,
+                                          const Span<bool> initial_mask)
+{
+  Array<bool> elimination_mask(initial_mask);
+  update_elimination_mask_for_close_points(positions, minimum_distance, elimination_mask);
+  return elimination_mask;
+}
+
+TEST(distribute_points_on_faces, eliminate_close_points)
+{
+  const float minimum_distance = 0.5f;
+  RandomNumberGenerator rng(0);
+  Array<float3> positions(3000);
+  for (float3 &position : positions) {
+    position = float3(rng.get_float(), rng.get_float(), rng.get_float()) * 10.0f;
+  }
+  Array<bool> initial_mask(positions.size());
+  for (const int i : positions.index_range()) {
+    initial_mask[i] = i % 7 == 0;
+  }
+
+  const Array<bool> mask = eliminate_close_points(positions, minimum_distance, initial_mask);
+  for (const int i : positions.index_range()) {
+    if (initial_mask[i]) {
+      EXPECT_TRUE(mask[i]);
+      continue;
+    }
+    /* Kept points are never close to each other, every removed point is close to a kept one. */
+    bool is_close_to_kept_point = false;
+    for (const int j : positions.index_range()) {
+      if (i != j && !mask[j] && math::distance(positions[i], positions[j]) < minimum_distance) {
+        is_close_to_kept_point = true;
+        break;
+      }
+    }
+    EXPECT_EQ(mask[i], is_close_to_kept_point);
+  }
+}
+
+TEST(distribute_points_on_faces, eliminate_close_points_thread_count)
+{
+  RandomNumberGenerator rng(0);
+  Array<float3> positions(100000);
+  for (float3 &position : positions) {
+    position = float3(rng.get_float(), rng.get_float(), rng.get_float()) * 20.0f;
+  }
+  const Array<bool> initial_mask(positions.size(), false);
+
+  const Array<bool> mask = eliminate_close_points(positions, 0.2f, initial_mask);
+#ifdef WITH_TBB
+  Array<bool> single_thread_mask;
+  tbb::task_arena arena(1);
+  arena.execute([&]() {
+    single_thread_mask = eliminate_close_points(positions, 0.2f, initial_mask);
+  });
+  EXPECT_EQ(single_thread_mask.as_span(), mask.as_span());
+#endif
+  /* The same result is computed again. */
+  EXPECT_EQ(eliminate_close_points(positions, 0.2f, initial_mask).as_span(), mask.as_span());
+}
+
+TEST(distribute_points_on_faces, eliminate_close_points_far_away)
+{
+  /* Positions that can't be represented as integer cell coordinates. */
+  const Array<float3> positions = {float3(1e20f),
+                                   float3(1e20f),
+                                   float3(-1e20f),
+                                   float3(0.0f, 0.0f, 3e9f),
+                                   float3(0.0f),
+                                   float3(0.1f)};
+  const Array<bool> initial_mask(positions.size(), false);
+  const Array<bool> mask = eliminate_close_points(positions, 1.0f, initial_mask);
+  EXPECT_FALSE(mask[0]);
+  EXPECT_TRUE(mask[1]);
+  EXPECT_FALSE(mask[2]);
+  EXPECT_FALSE(mask[3]);
+  EXPECT_FALSE(mask[4]);
+  EXPECT_TRUE(mask[5]);
+}
+
+}  // namespace blender::nodes::tests
@@ -4,6 +4,8 @@
 
 #include "BLI_dot_export.hh"
 
+#include "BKE_node_runtime.hh"
+
 namespace blender::nodes {
 
 DerivedNodeTree::DerivedNodeTree(bNodeTree &btree, NodeTreeRefMap &node_tree_refs)
@@ -41,6 +43,35 @@ DTreeContext &DerivedNodeTree::construct_context_recursively(DTreeContext *paren
   return context;
 }
 
+CachedDerivedNodeTree::CachedDerivedNodeTree(bNodeTree &btree) : tree_(btree, tree_refs_)
+{
+  for (const NodeTreeRef *tree_ref : tree_.used_node_tree_refs()) {
+    const bNodeTree *used_btree = tree_ref->btree();
+    update_counters_.append({used_btree, used_btree->runtime->update_counter});
+  }
+}
+
+bool CachedDerivedNodeTree::is_up_to_date() const
+{
+  for (const std::pair<const bNodeTree *, uint64_t> &item : update_counters_) {
+    /* Stop at the first change, because later node groups may not exist anymore then. */
+    if (item.first->runtime->update_counter != item.second) {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::shared_ptr<const CachedDerivedNodeTree> get_cached_derived_node_tree(bNodeTree &btree)
+{
+  bke::bNodeTreeRuntime &runtime = *btree.runtime;
+  std::lock_guard lock{runtime.derived_node_tree_cache_mutex};
+  if (!runtime.derived_node_tree_cache || !runtime.derived_node_tree_cache->is_up_to_date()) {
+    runtime.derived_node_tree_cache = std::make_shared<const CachedDerivedNodeTree>(btree);
+  }
+  return runtime.derived_node_tree_cache;
+}
+
 DerivedNodeTree::~DerivedNodeTree()
 {
   /* Has to be destructed manually, because the context info is allocated in a linear allocator. */
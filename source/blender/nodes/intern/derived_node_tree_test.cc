@@ -0,0 +1,79 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "testing/testing.h"
+
+#include "CLG_log.h"
+
+#include "RNA_define.h"
+
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_main.h"
+#include "BKE_node.h"
+#include "BKE_node_tree_update.h"
+
+#include "DNA_node_types.h"
+
+#include "NOD_derived_node_tree.hh"
+
+namespace blender::nodes::tests {
+
+class DerivedNodeTreeCacheTest : public testing::Test {
+ public:
+  static void SetUpTestSuite()
+  {
+    CLG_init();
+    BKE_idtype_init();
+    RNA_init();
+    BKE_node_system_init();
+  }
+  static void TearDownTestSuite()
+  {
+    BKE_node_system_exit();
+    RNA_exit();
+    CLG_exit();
+  }
+};
+
+TEST_F(DerivedNodeTreeCacheTest, reuse_and_invalidation)
+{
+  Main *bmain = BKE_main_new();
+  bNodeTree *group = ntreeAddTree(bmain, "Group", "GeometryNodeTree");
+  bNodeTree *tree = ntreeAddTree(bmain, "Tree", "GeometryNodeTree");
+  bNode *group_node = nodeAddNode(nullptr, tree, "GeometryNodeGroup");
+  group_node->id = &group->id;
+  id_us_plus(&group->id);
+
+  std::shared_ptr<const CachedDerivedNodeTree> cached_tree = get_cached_derived_node_tree(*tree);
+  ASSERT_TRUE(cached_tree);
+  EXPECT_EQ(cached_tree->tree().used_node_tree_refs().size(), 2);
+  EXPECT_TRUE(cached_tree->is_up_to_date());
+
+  /* Nothing changed, so the same derived tree is used again. */
+  EXPECT_EQ(get_cached_derived_node_tree(*tree), cached_tree);
+
+  /* Changing a node group that is used by the tree invalidates the cache. */
+  BKE_ntree_update_tag_all(group);
+  EXPECT_FALSE(cached_tree->is_up_to_date());
+  std::shared_ptr<const CachedDerivedNodeTree> rebuilt_tree = get_cached_derived_node_tree(*tree);
+  EXPECT_NE(rebuilt_tree, cached_tree);
+  EXPECT_TRUE(rebuilt_tree->is_up_to_date());
+  /* The old derived tree stays valid for evaluations that still use it. */
+  EXPECT_EQ(cached_tree->tree().used_node_tree_refs().size(), 2);
+
+  /* Changing the root tree invalidates the cache as well. */
+  BKE_ntree_update_tag_all(tree);
+  EXPECT_NE(get_cached_derived_node_tree(*tree), rebuilt_tree);
+
+  /* Other trees have their own cache. */
+  std::shared_ptr<const CachedDerivedNodeTree> group_tree = get_cached_derived_node_tree(*group);
+  EXPECT_EQ(group_tree->tree().used_node_tree_refs().size(), 1);
+  EXPECT_EQ(get_cached_derived_node_tree(*tree)->tree().used_node_tree_refs().size(), 2);
+
+  cached_tree.reset();
+  rebuilt_tree.reset();
+  group_tree.reset();
+  BKE_main_free(bmain);
+}
+
+}  // namespace blender::nodes::tests
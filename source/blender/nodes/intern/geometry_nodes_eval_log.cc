@@ -2,16 +2,32 @@
 
 #include "NOD_geometry_nodes_eval_log.hh"
 
+#include "BKE_curves.hh"
 #include "BKE_geometry_set_instances.hh"
 
+#include "DNA_mesh_types.h"
+#include "DNA_pointcloud_types.h"
+
 #include "DNA_modifier_types.h"
 #include "DNA_space_types.h"
 
 #include "FN_field_cpp_type.hh"
 
+#include "BLI_string.h"
+
 #include "BLT_translation.h"
 
+#include "MEM_guardedalloc.h"
+
+#include <atomic>
 #include <chrono>
+#include <ostream>
+
+#ifdef WIN32
+#  include <windows.h>
+#else
+#  include <time.h>
+#endif
 
 namespace blender::nodes::geometry_nodes_eval_log {
 
@@ -58,6 +74,19 @@ ModifierLog::ModifierLog(GeoLogger &logger)
       node_log.exec_time_ = node_with_exec_time.exec_time;
     }
 
+    for (NodeWithExecutionProfile &node_with_profile : local_logger.node_profiles_) {
+      node_profiles_.append({node_with_profile.node->name(),
+                             tree_path_for_profile(*node_with_profile.node.context()),
+                             node_with_profile.profile});
+    }
+
+    for (NodeWithEliminatedFieldOperations &node_with_eliminated_operations :
+         local_logger.node_eliminated_field_operations_) {
+      NodeLog &node_log = this->lookup_or_add_node_log(log_by_tree_context,
+                                                       node_with_eliminated_operations.node);
+      node_log.eliminated_field_operations_ += node_with_eliminated_operations.amount;
+    }
+
     for (NodeWithDebugMessage &debug_message : local_logger.node_debug_messages_) {
       NodeLog &node_log = this->lookup_or_add_node_log(log_by_tree_context, debug_message.node);
       node_log.debug_messages_.append(debug_message.message);
@@ -70,6 +99,82 @@ ModifierLog::ModifierLog(GeoLogger &logger)
       node_log.used_named_attributes_.append(std::move(node_with_attribute_name.attribute));
     }
   }
+
+  std::sort(node_profiles_.begin(),
+            node_profiles_.end(),
+            [](const NodeProfileLog &a, const NodeProfileLog &b) {
+              return a.profile.begin < b.profile.begin;
+            });
+}
+
+static void write_json_string(std::ostream &stream, const StringRef str)
+{
+  stream << '"';
+  for (const char c : str) {
+    switch (c) {
+      case '"':
+        stream << "\\\"";
+        break;
+      case '\\':
+        stream << "\\\\";
+        break;
+      case '\n':
+        stream << "\\n";
+        break;
+      default:
+        if (uint8_t(c) < 0x20) {
+          char buffer[8];
+          BLI_snprintf(buffer, sizeof(buffer), "\\u%04x", int(c));
+          stream << buffer;
+        }
+        else {
+          stream << c;
+        }
+        break;
+    }
+  }
+  stream << '"';
+}
+
+void ModifierLog::write_chrome_trace(std::ostream &stream) const
+{
+  using namespace std::chrono;
+  stream << "{\"traceEvents\":[";
+  for (const int i : node_profiles_.index_range()) {
+    const NodeProfileLog &node_profile = node_profiles_[i];
+    const NodeExecutionProfile &profile = node_profile.profile;
+    const GeometryDomainSizes &sizes = profile.output_sizes;
+    if (i > 0) {
+      stream << ",";
+    }
+    /* Chrome traces use microseconds, but allow fractions. */
+    stream << "\n{\"name\":";
+    write_json_string(stream, node_profile.node_name);
+    stream << ",\"cat\":";
+    write_json_string(stream, node_profile.tree_path.empty() ? "root" : node_profile.tree_path);
+    stream << ",\"ph\":\"X\",\"pid\":0,\"tid\":" << profile.thread_id
+           << ",\"ts\":" << duration<double, std::micro>(profile.begin).count()
+           << ",\"dur\":" << duration<double, std::micro>(profile.end - profile.begin).count()
+           << ",\"args\":{\"cpu_time_us\":" << profile.cpu_time.count()
+           << ",\"memory_delta_bytes\":" << profile.memory_delta
+           << ",\"points\":" << sizes.points << ",\"edges\":" << sizes.edges
+           << ",\"faces\":" << sizes.faces << ",\"face_corners\":" << sizes.face_corners
+           << ",\"curves\":" << sizes.curves << ",\"instances\":" << sizes.instances << "}}";
+  }
+  stream << "\n]}\n";
+}
+
+std::string ModifierLog::tree_path_for_profile(const DTreeContext &tree_context)
+{
+  const DTreeContext *parent_context = tree_context.parent_context();
+  if (parent_context == nullptr) {
+    return "";
+  }
+  std::string parent_path = tree_path_for_profile(*parent_context);
+  if (!parent_path.empty()) {
+    parent_path += "/";
+  }
+  return parent_path + tree_context.parent_node()->name();
 }
 
 TreeLog &ModifierLog::lookup_or_add_tree_log(LogByTreeContext &log_by_tree_context,
@@ -164,6 +269,20 @@ void TreeLog::foreach_node_log(FunctionRef<void(const NodeLog &)> fn) const
   }
 }
 
+bool TreeLog::has_socket_values() const
+{
+  for (const destruct_ptr<NodeLog> &node_log : node_logs_.values()) {
+    for (const Span<SocketLog> socket_logs : {node_log->input_logs(), node_log->output_logs()}) {
+      for (const SocketLog &socket_log : socket_logs) {
+        if (socket_log.value() != nullptr) {
+          return true;
+        }
+      }
+    }
+  }
+  return false;
+}
+
 const SocketLog *NodeLog::lookup_socket_log(eNodeSocketInOut in_out, int index) const
 {
   BLI_assert(index >= 0);
@@ -419,6 +538,17 @@ const NodeLog *ModifierLog::find_node_by_spreadsheet_editor_context(
 
 void LocalGeoLogger::log_value_for_sockets(Span<DSocket> sockets, GPointer value)
 {
+  Vector<DSocket, 16> sockets_to_log;
+  for (const DSocket &socket : sockets) {
+    if (main_logger_->should_log_value(socket)) {
+      sockets_to_log.append(socket);
+    }
+  }
+  if (sockets_to_log.is_empty()) {
+    return;
+  }
+  sockets = sockets_to_log;
+
   const CPPType &type = *value.type();
   Span<DSocket> copied_sockets = allocator_->construct_array_copy(sockets);
   if (type.is<GeometrySet>()) {
@@ -479,8 +609,11 @@ void LocalGeoLogger::log_value_for_sockets(Span<DSocket> sockets, GPointer value
 
 void LocalGeoLogger::log_multi_value_socket(DSocket socket, Span<GPointer> values)
 {
+  if (!main_logger_->should_log_value(socket)) {
+    return;
+  }
   /* Doesn't have to be logged currently. */
-  UNUSED_VARS(socket, values);
+  UNUSED_VARS(values);
 }
 
 void LocalGeoLogger::log_node_warning(DNode node, NodeWarningType type, std::string message)
@@ -493,6 +626,16 @@ void LocalGeoLogger::log_execution_time(DNode node, std::chrono::microseconds ex
   node_exec_times_.append({node, exec_time});
 }
 
+void LocalGeoLogger::log_execution_profile(DNode node, const NodeExecutionProfile &profile)
+{
+  node_profiles_.append({node, profile});
+}
+
+void LocalGeoLogger::log_eliminated_field_operations(DNode node, const int amount)
+{
+  node_eliminated_field_operations_.append({node, amount});
+}
+
 void LocalGeoLogger::log_used_named_attribute(DNode node,
                                               std::string attribute_name,
                                               NamedAttributeUsage usage)
@@ -505,4 +648,81 @@ void LocalGeoLogger::log_debug_message(DNode node, std::string message)
   node_debug_messages_.append({node, std::move(message)});
 }
 
+void GeometryDomainSizes::add_geometry(const GeometrySet &geometry_set)
+{
+  if (const Mesh *mesh = geometry_set.get_mesh_for_read()) {
+    points += mesh->totvert;
+    edges += mesh->totedge;
+    faces += mesh->totpoly;
+    face_corners += mesh->totloop;
+  }
+  if (const PointCloud *pointcloud = geometry_set.get_pointcloud_for_read()) {
+    points += pointcloud->totpoint;
+  }
+  if (const Curves *curves_id = geometry_set.get_curves_for_read()) {
+    points += curves_id->geometry.point_num;
+    curves += curves_id->geometry.curve_num;
+  }
+  if (const InstancesComponent *instances =
+          geometry_set.get_component_for_read<InstancesComponent>()) {
+    this->instances += instances->instances_num();
+  }
+}
+
+/** CPU time used by all threads of the process so far. */
+static std::chrono::microseconds get_process_cpu_time()
+{
+#ifdef WIN32
+  FILETIME creation_time, exit_time, kernel_time, user_time;
+  if (!GetProcessTimes(
+          GetCurrentProcess(), &creation_time, &exit_time, &kernel_time, &user_time)) {
+    return {};
+  }
+  auto to_microseconds = [](const FILETIME &time) {
+    const uint64_t ticks = (uint64_t(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+    /* File times are in units of 100 nanoseconds. */
+    return std::chrono::microseconds(ticks / 10);
+  };
+  return to_microseconds(kernel_time) + to_microseconds(user_time);
+#else
+  timespec time;
+  if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &time) != 0) {
+    return {};
+  }
+  return std::chrono::seconds(time.tv_sec) +
+         std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::nanoseconds(time.tv_nsec));
+#endif
+}
+
+/** Small index that identifies the current thread in profiles. */
+static int get_profile_thread_id()
+{
+  static std::atomic<int> next_id = 0;
+  static thread_local int thread_id = next_id.fetch_add(1, std::memory_order_relaxed);
+  return thread_id;
+}
+
+NodeExecutionProfiler::NodeExecutionProfiler(GeoLogger &logger)
+    : logger_(logger),
+      begin_(std::chrono::steady_clock::now()),
+      cpu_time_begin_(get_process_cpu_time()),
+      memory_begin_(int64_t(MEM_get_memory_in_use()))
+{
+}
+
+void NodeExecutionProfiler::finish(DNode node)
+{
+  const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+  NodeExecutionProfile profile;
+  profile.begin = begin_ - logger_.start_time_;
+  profile.end = end - logger_.start_time_;
+  profile.thread_id = get_profile_thread_id();
+  profile.cpu_time = get_process_cpu_time() - cpu_time_begin_;
+  profile.memory_delta = int64_t(MEM_get_memory_in_use()) - memory_begin_;
+  profile.output_sizes = output_sizes;
+  logger_.local().log_execution_profile(node, profile);
+}
+
 }  // namespace blender::nodes::geometry_nodes_eval_log
@@ -439,6 +439,16 @@ bool Geometry::only_instances() const
   return only_instances_;
 }
 
+bool Geometry::propagates_components() const
+{
+  return propagates_components_;
+}
+
+std::optional<GeometryComponentType> Geometry::propagated_component_type() const
+{
+  return propagated_component_type_;
+}
+
 GeometryBuilder &GeometryBuilder::supported_type(GeometryComponentType supported_type)
 {
   decl_->supported_types_ = {supported_type};
@@ -464,6 +474,18 @@ GeometryBuilder &GeometryBuilder::only_instances(bool value)
   return *this;
 }
 
+GeometryBuilder &GeometryBuilder::propagates_components(bool value)
+{
+  decl_->propagates_components_ = value;
+  return *this;
+}
+
+GeometryBuilder &GeometryBuilder::propagated_component_type(GeometryComponentType type)
+{
+  decl_->propagated_component_type_ = type;
+  return *this;
+}
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
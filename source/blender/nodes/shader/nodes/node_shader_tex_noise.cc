@@ -81,6 +81,51 @@ static void node_shader_update_tex_noise(bNodeTree *ntree, bNode *node)
   nodeSetSocketAvailability(ntree, sockW, storage.dimensions == 1 || storage.dimensions == 4);
 }
 
+/**
+ * Evaluate 3D noise in small batches, so that the SIMD batch functions can be used. This is only
+ * possible when the noise parameters are the same for all indices.
+ */
+static void noise_3d_batched(const IndexMask mask,
+                             const VArray<float3> &vector,
+                             const VArray<float> &scale,
+                             const float detail,
+                             const float roughness,
+                             const float distortion,
+                             MutableSpan<float> r_factor,
+                             MutableSpan<ColorGeometry4f> r_color)
+{
+  constexpr int64_t batch_size = 64;
+  std::array<float3, batch_size> positions;
+  std::array<float, batch_size> factors;
+  std::array<float3, batch_size> colors;
+
+  for (int64_t start = 0; start < mask.size(); start += batch_size) {
+    const IndexMask batch_mask = mask.slice(start, std::min(batch_size, mask.size() - start));
+    const int64_t size = batch_mask.size();
+    for (const int64_t i : IndexRange(size)) {
+      const int64_t index = batch_mask[i];
+      positions[i] = vector[index] * scale[index];
+    }
+    const Span<float3> batch_positions(positions.data(), size);
+
+    if (!r_factor.is_empty()) {
+      noise::perlin_fractal_distorted(
+          batch_positions, detail, roughness, distortion, {factors.data(), size});
+      for (const int64_t i : IndexRange(size)) {
+        r_factor[batch_mask[i]] = factors[i];
+      }
+    }
+    if (!r_color.is_empty()) {
+      noise::perlin_float3_fractal_distorted(
+          batch_positions, detail, roughness, distortion, {colors.data(), size});
+      for (const int64_t i : IndexRange(size)) {
+        const float3 &c = colors[i];
+        r_color[batch_mask[i]] = ColorGeometry4f(c[0], c[1], c[2], 1.0f);
+      }
+    }
+  }
+}
+
 class NoiseFunction : public fn::MultiFunction {
  private:
   int dimensions_;
@@ -177,6 +222,17 @@ class NoiseFunction : public fn::MultiFunction {
       }
       case 3: {
         const VArray<float3> &vector = params.readonly_single_input<float3>(0, "Vector");
+        if (detail.is_single() && roughness.is_single() && distortion.is_single()) {
+          noise_3d_batched(mask,
+                           vector,
+                           scale,
+                           detail.get_internal_single(),
+                           roughness.get_internal_single(),
+                           distortion.get_internal_single(),
+                           r_factor,
+                           r_color);
+          break;
+        }
         if (compute_factor) {
           for (int64_t i : mask) {
             const float3 position = vector[i] * scale[i];
@@ -611,6 +611,60 @@ class VoronoiMinowskiFunction : public fn::MultiFunction {
   }
 };
 
+/**
+ * Evaluate 3D F1 voronoi in small batches, so that the SIMD batch function can be used. This is
+ * only possible when the randomness is the same for all indices.
+ */
+static void voronoi_f1_3d_batched(const IndexMask mask,
+                                  const VArray<float3> &vector,
+                                  const VArray<float> &scale,
+                                  const float randomness,
+                                  const int metric,
+                                  MutableSpan<float> r_distance,
+                                  MutableSpan<ColorGeometry4f> r_color,
+                                  MutableSpan<float3> r_position)
+{
+  constexpr int64_t batch_size = 64;
+  std::array<float3, batch_size> coords;
+  std::array<float, batch_size> distances;
+  std::array<float3, batch_size> colors;
+  std::array<float3, batch_size> positions;
+  const bool calc_distance = !r_distance.is_empty();
+  const bool calc_color = !r_color.is_empty();
+  const bool calc_position = !r_position.is_empty();
+
+  for (int64_t start = 0; start < mask.size(); start += batch_size) {
+    const IndexMask batch_mask = mask.slice(start, std::min(batch_size, mask.size() - start));
+    const int64_t size = batch_mask.size();
+    for (const int64_t i : IndexRange(size)) {
+      const int64_t index = batch_mask[i];
+      coords[i] = vector[index] * scale[index];
+    }
+    noise::voronoi_f1(Span<float3>(coords.data(), size),
+                      0.0f,
+                      randomness,
+                      metric,
+                      calc_distance ? MutableSpan<float>(distances.data(), size) :
+                                      MutableSpan<float>(),
+                      calc_color ? MutableSpan<float3>(colors.data(), size) :
+                                   MutableSpan<float3>(),
+                      calc_position ? MutableSpan<float3>(positions.data(), size) :
+                                      MutableSpan<float3>());
+    for (const int64_t i : IndexRange(size)) {
+      const int64_t index = batch_mask[i];
+      if (calc_distance) {
+        r_distance[index] = distances[i];
+      }
+      if (calc_color) {
+        r_color[index] = ColorGeometry4f(colors[i][0], colors[i][1], colors[i][2], 1.0f);
+      }
+      if (calc_position) {
+        r_position[index] = math::safe_divide(positions[i], scale[index]);
+      }
+    }
+  }
+}
+
 class VoronoiMetricFunction : public fn::MultiFunction {
  private:
   int dimensions_;
@@ -907,6 +961,12 @@ class VoronoiMetricFunction : public fn::MultiFunction {
             const bool calc_distance = !r_distance.is_empty();
             const bool calc_color = !r_color.is_empty();
             const bool calc_position = !r_position.is_empty();
+            if (randomness.is_single()) {
+              const float rand = std::min(std::max(randomness.get_internal_single(), 0.0f), 1.0f);
+              voronoi_f1_3d_batched(
+                  mask, vector, scale, rand, metric_, r_distance, r_color, r_position);
+              break;
+            }
             for (int64_t i : mask) {
               const float rand = std::min(std::max(randomness[i], 0.0f), 1.0f);
               float3 col;
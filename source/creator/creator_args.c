@@ -566,6 +566,7 @@ static int arg_handle_print_help(int UNUSED(argc), const char **UNUSED(argv), vo
 #  endif
   BLI_args_print_arg_doc(ba, "--debug-memory");
   BLI_args_print_arg_doc(ba, "--debug-jobs");
+  BLI_args_print_arg_doc(ba, "--debug-geometry-nodes-profile");
   BLI_args_print_arg_doc(ba, "--debug-python");
   BLI_args_print_arg_doc(ba, "--debug-depsgraph");
   BLI_args_print_arg_doc(ba, "--debug-depsgraph-eval");
@@ -575,6 +576,7 @@ static int arg_handle_print_help(int UNUSED(argc), const char **UNUSED(argv), vo
   BLI_args_print_arg_doc(ba, "--debug-depsgraph-time");
   BLI_args_print_arg_doc(ba, "--debug-depsgraph-pretty");
   BLI_args_print_arg_doc(ba, "--debug-depsgraph-uuid");
+  BLI_args_print_arg_doc(ba, "--debug-depsgraph-incremental");
   BLI_args_print_arg_doc(ba, "--debug-ghost");
   BLI_args_print_arg_doc(ba, "--debug-wintab");
   BLI_args_print_arg_doc(ba, "--debug-gpu");
@@ -963,6 +965,10 @@ static const char arg_handle_debug_mode_generic_set_doc_xr_time[] =
 static const char arg_handle_debug_mode_generic_set_doc_jobs[] =
     "\n\t"
     "Enable time profiling for background jobs.";
+static const char arg_handle_debug_mode_generic_set_doc_geometry_nodes_profile[] =
+    "\n\t"
+    "Write a profile of every geometry nodes modifier evaluation to the temporary directory,\n"
+    "\tin the Chrome trace format.";
 static const char arg_handle_debug_mode_generic_set_doc_depsgraph[] =
     "\n\t"
     "Enable all debug messages from dependency graph.";
@@ -987,6 +993,9 @@ static const char arg_handle_debug_mode_generic_set_doc_depsgraph_pretty[] =
 static const char arg_handle_debug_mode_generic_set_doc_depsgraph_uuid[] =
     "\n\t"
     "Verify validness of session-wide identifiers assigned to ID datablocks.";
+static const char arg_handle_debug_mode_generic_set_doc_depsgraph_incremental[] =
+    "\n\t"
+    "Verify incremental dependency graph relations updates against a full rebuild.";
 static const char arg_handle_debug_mode_generic_set_doc_gpu_force_workarounds[] =
     "\n\t"
     "Enable workarounds for typical GPU issues and disable all GPU extensions.";
@@ -2164,6 +2173,11 @@ void main_args_setup(bContext *C, bArgs *ba)
                "--debug-jobs",
                CB_EX(arg_handle_debug_mode_generic_set, jobs),
                (void *)G_DEBUG_JOBS);
+  BLI_args_add(ba,
+               NULL,
+               "--debug-geometry-nodes-profile",
+               CB_EX(arg_handle_debug_mode_generic_set, geometry_nodes_profile),
+               (void *)G_DEBUG_GEOMETRY_NODES_PROFILE);
   BLI_args_add(ba, NULL, "--debug-gpu", CB(arg_handle_debug_gpu_set), NULL);
 
   BLI_args_add(ba,
@@ -2207,6 +2221,11 @@ void main_args_setup(bContext *C, bArgs *ba)
                "--debug-depsgraph-uuid",
                CB_EX(arg_handle_debug_mode_generic_set, depsgraph_uuid),
                (void *)G_DEBUG_DEPSGRAPH_UUID);
+  BLI_args_add(ba,
+               NULL,
+               "--debug-depsgraph-incremental",
+               CB_EX(arg_handle_debug_mode_generic_set, depsgraph_incremental),
+               (void *)G_DEBUG_DEPSGRAPH_INCREMENTAL);
   BLI_args_add(ba,
                NULL,
                "--debug-gpu-force-workarounds",